@@ -0,0 +1,275 @@
+#pragma once
+// Minimal Google-Benchmark-style harness for wce_bench.
+//
+// A benchmark is a (setup, body, ops) triple: setup runs untimed before every
+// batch, body runs `ops` operations and is timed. Batches repeat until
+// --benchmark_min_time seconds of body time are collected; the result is
+// reported per operation. Console and JSON output follow Google Benchmark's
+// field names so its tooling (compare.py) can read the JSON.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <optional>
+#include <regex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace wce_bench {
+
+// ─── Hardware cycle counter ───────────────────────────────────────────────────
+// User-space CPU cycles of this thread via perf_event_open. available() is false
+// when the kernel refuses (containers, perf_event_paranoid), in which case no
+// cycle counts are reported.
+
+class CycleCounter {
+public:
+    CycleCounter() {
+#if defined(__linux__)
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+    ~CycleCounter() {
+#if defined(__linux__)
+        if (fd_ >= 0) close(fd_);
+#endif
+    }
+    CycleCounter(const CycleCounter&) = delete;
+    CycleCounter& operator=(const CycleCounter&) = delete;
+
+    [[nodiscard]] bool available() const { return fd_ >= 0; }
+
+    void start() {
+#if defined(__linux__)
+        if (fd_ < 0) return;
+        ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    std::uint64_t stop() {
+        std::uint64_t cycles = 0;
+#if defined(__linux__)
+        if (fd_ < 0) return 0;
+        ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd_, &cycles, sizeof(cycles)) != static_cast<ssize_t>(sizeof(cycles))) cycles = 0;
+#endif
+        return cycles;
+    }
+
+private:
+    int fd_ = -1;
+};
+
+// ─── Benchmark definition and result ─────────────────────────────────────────
+
+struct Batch {
+    std::function<void()> setup;   // untimed, may be empty
+    std::function<void()> body;    // timed
+    std::size_t ops = 1;           // operations performed by one body() call
+    std::map<std::string, double> counters;  // values known once the fixture exists (bytes_per_sketch)
+};
+
+struct Benchmark {
+    std::string name;
+    std::function<Batch()> prepare;  // builds the fixture; called only if the benchmark runs
+    std::map<std::string, double> counters;  // static per-benchmark values (m, ...)
+};
+
+struct Result {
+    std::string name;
+    std::uint64_t iterations = 0;  // total operations timed
+    double real_ns = 0.0;          // per operation
+    double cpu_ns = 0.0;           // per operation
+    std::optional<double> cycles;  // per operation
+    std::map<std::string, double> counters;
+};
+
+struct Options {
+    std::string filter = ".*";
+    std::string format = "console";  // console | json
+    std::string out;                 // JSON file written in addition to the console report
+    double min_time = 0.1;           // seconds of timed body per benchmark
+    bool list = false;
+};
+
+inline double cpu_seconds() {
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+}
+
+inline Result run(const Benchmark& bench, const Options& opt, CycleCounter& counter) {
+    using Clock = std::chrono::steady_clock;
+    Batch batch = bench.prepare();
+    Result r;
+    r.name = bench.name;
+    r.counters = bench.counters;
+    r.counters.insert(batch.counters.begin(), batch.counters.end());
+
+    double real = 0.0;
+    double cpu = 0.0;
+    std::uint64_t cycles = 0;
+    std::uint64_t ops = 0;
+    // Without a per-batch setup, body() repeats `reps` times per timed region so
+    // clock and counter overhead stays below ~1% even for sub-microsecond ops.
+    std::size_t reps = 1;
+    auto timed = [&]() {
+        if (batch.setup) batch.setup();
+        const double cpu0 = cpu_seconds();
+        const auto t0 = Clock::now();
+        counter.start();
+        for (std::size_t k = 0; k < reps; ++k) batch.body();
+        const std::uint64_t c = counter.stop();
+        const auto t1 = Clock::now();
+        const double cpu1 = cpu_seconds();
+        return std::make_tuple(std::chrono::duration<double>(t1 - t0).count(), cpu1 - cpu0, c);
+    };
+    // Untimed warm-up regions calibrate reps. Batches with a setup already run
+    // many ops per body (and can be slow), so they go straight to timing.
+    while (!batch.setup && reps < (std::size_t{1} << 30)) {
+        if (std::get<0>(timed()) >= opt.min_time / 100) break;
+        reps *= 2;
+    }
+    do {
+        const auto [t, c, cyc] = timed();
+        real += t;
+        cpu += c;
+        cycles += cyc;
+        ops += batch.ops * reps;
+    } while (real < opt.min_time);
+
+    r.iterations = ops;
+    r.real_ns = real * 1e9 / static_cast<double>(ops);
+    r.cpu_ns = cpu * 1e9 / static_cast<double>(ops);
+    if (counter.available()) r.cycles = static_cast<double>(cycles) / static_cast<double>(ops);
+    return r;
+}
+
+// ─── Reporting ────────────────────────────────────────────────────────────────
+
+inline std::string json_escape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+inline void print_console_header(std::FILE* f, bool cycles) {
+    std::fprintf(f, "%-64s %12s %12s %12s %12s\n", "Benchmark", "ns/op", "CPU ns/op",
+                 cycles ? "cycles/op" : "", "Iterations");
+    std::fprintf(f, "%s\n", std::string(116, '-').c_str());
+}
+
+inline void print_console(std::FILE* f, const Result& r) {
+    char cyc[32] = "";
+    if (r.cycles) std::snprintf(cyc, sizeof(cyc), "%.1f", *r.cycles);
+    std::fprintf(f, "%-64s %12.1f %12.1f %12s %12llu", r.name.c_str(), r.real_ns, r.cpu_ns, cyc,
+                 static_cast<unsigned long long>(r.iterations));
+    for (const auto& [k, v] : r.counters) std::fprintf(f, " %s=%g", k.c_str(), v);
+    std::fprintf(f, "\n");
+    std::fflush(f);
+}
+
+inline void write_json(std::FILE* f, const std::map<std::string, std::string>& context,
+                       const std::vector<Result>& results) {
+    std::fprintf(f, "{\n  \"context\": {\n");
+    std::size_t i = 0;
+    for (const auto& [k, v] : context) {
+        std::fprintf(f, "    \"%s\": \"%s\"%s\n", json_escape(k).c_str(), json_escape(v).c_str(),
+                     ++i < context.size() ? "," : "");
+    }
+    std::fprintf(f, "  },\n  \"benchmarks\": [\n");
+    for (std::size_t j = 0; j < results.size(); ++j) {
+        const Result& r = results[j];
+        std::fprintf(f, "    {\n      \"name\": \"%s\",\n      \"run_name\": \"%s\",\n"
+                        "      \"run_type\": \"iteration\",\n      \"iterations\": %llu,\n"
+                        "      \"real_time\": %.3f,\n      \"cpu_time\": %.3f,\n      \"time_unit\": \"ns\"",
+                     json_escape(r.name).c_str(), json_escape(r.name).c_str(),
+                     static_cast<unsigned long long>(r.iterations), r.real_ns, r.cpu_ns);
+        if (r.cycles) std::fprintf(f, ",\n      \"cycles_per_op\": %.3f", *r.cycles);
+        for (const auto& [k, v] : r.counters) std::fprintf(f, ",\n      \"%s\": %.17g", json_escape(k).c_str(), v);
+        std::fprintf(f, "\n    }%s\n", j + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(f, "  ]\n}\n");
+}
+
+// ─── Driver ───────────────────────────────────────────────────────────────────
+
+inline bool parse_options(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto value = [&](const char* flag) -> std::optional<std::string> {
+            const std::string prefix = std::string(flag) + "=";
+            if (arg.rfind(prefix, 0) == 0) return arg.substr(prefix.size());
+            return std::nullopt;
+        };
+        if (auto v = value("--benchmark_filter")) opt.filter = *v;
+        else if (auto v = value("--benchmark_format")) opt.format = *v;
+        else if (auto v = value("--benchmark_out")) opt.out = *v;
+        else if (auto v = value("--benchmark_min_time")) opt.min_time = std::stod(*v);
+        else if (arg == "--benchmark_list_tests") opt.list = true;
+        else {
+            std::fprintf(stderr,
+                "usage: %s [--benchmark_filter=<regex>] [--benchmark_format=console|json]\n"
+                "          [--benchmark_out=<file.json>] [--benchmark_min_time=<seconds>]\n"
+                "          [--benchmark_list_tests]\n", argv[0]);
+            return false;
+        }
+    }
+    return opt.format == "console" || opt.format == "json";
+}
+
+inline int run_all(const std::vector<Benchmark>& benchmarks, const Options& opt,
+                   const std::map<std::string, std::string>& context) {
+    const std::regex filter(opt.filter);
+    if (opt.list) {
+        for (const auto& b : benchmarks)
+            if (std::regex_search(b.name, filter)) std::printf("%s\n", b.name.c_str());
+        return 0;
+    }
+    CycleCounter counter;
+    const bool console = opt.format == "console";
+    if (console) print_console_header(stdout, counter.available());
+
+    std::vector<Result> results;
+    for (const auto& b : benchmarks) {
+        if (!std::regex_search(b.name, filter)) continue;
+        results.push_back(run(b, opt, counter));
+        if (console) print_console(stdout, results.back());
+    }
+
+    if (!console) write_json(stdout, context, results);
+    if (!opt.out.empty()) {
+        std::FILE* f = std::fopen(opt.out.c_str(), "w");
+        if (f == nullptr) {
+            std::fprintf(stderr, "cannot open %s\n", opt.out.c_str());
+            return 1;
+        }
+        write_json(f, context, results);
+        std::fclose(f);
+    }
+    return 0;
+}
+
+}  // namespace wce_bench
@@ -0,0 +1,340 @@
+// Native microbenchmarks for every sketch bound in _bindings.cpp: ns/add,
+// ns/estimate, ns/merge and bytes/sketch without pybind11 conversion or
+// interpreter overhead.
+//
+// Names are  <op>/<Sketch>[/<param>...]/m:<m>[/engine:<rng>][/dist:<weights>].
+// Per class, the parameter sweep (bit widths, log bases, float formats) runs
+// with the default engine and uniform weights; the engine and weight-distribution
+// sweeps run for the first parameter value only.
+//
+//   wce_bench --benchmark_filter='^add/FastExpSketch/' --benchmark_out=bench.json
+
+#include "bench_harness.hpp"
+
+#include <wce/exp_sketch.hpp>
+#include <wce/exp_sketch_float32.hpp>
+#include <wce/fast_exp_sketch.hpp>
+#include <wce/fast_exp_sketch_custom_float.hpp>
+#include <wce/fast_exp_sketch_float16.hpp>
+#include <wce/fast_exp_sketch_t.hpp>
+#include <wce/fast_k_q_sketch.hpp>
+#include <wce/fast_k_q_sketch_rounding.hpp>
+#include <wce/fastgm_exp_sketch.hpp>
+#include <wce/hyper_log_log.hpp>
+#include <wce/k_q_sketch_rounded_dyn.hpp>
+#include <wce/k_q_sketch_shifted.hpp>
+#include <wce/log_exp_sketch_fast_no_shifted.hpp>
+#include <wce/log_exp_sketch_fast_shifted.hpp>
+#include <wce/log_exp_sketch_slow_no_shifted.hpp>
+#include <wce/log_exp_sketch_slow_shifted.hpp>
+#include <wce/martingale_min_hash.hpp>
+#include <wce/memory_flag.hpp>
+#include <wce/min_hash.hpp>
+#include <wce/q_sketch.hpp>
+#include <wce/q_sketch_dyn.hpp>
+#include <wce/weighted_hyper_log_log.hpp>
+#include <wce/weighted_hyper_log_log_custom_float.hpp>
+#include <wce/weighted_min_hash.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#ifndef WCE_VERSION
+#define WCE_VERSION "unknown"
+#endif
+#ifndef WCE_BUILD_TYPE
+#define WCE_BUILD_TYPE ""
+#endif
+
+namespace {
+
+using wce_bench::Batch;
+using wce_bench::Benchmark;
+
+constexpr std::uint64_t kSeed = 42;
+constexpr double kVMax = 1e5;            // LogExp sketches
+constexpr std::size_t kElements = 4096;  // elements per add batch and per filled fixture
+const std::vector<std::size_t> kSizes = {64, 1024, 16384, 65536};
+
+// ─── Input streams ────────────────────────────────────────────────────────────
+
+struct Stream {
+    std::string name;
+    std::vector<std::string> elems;
+    std::vector<double> weights;
+};
+
+std::vector<std::string> make_elements(std::size_t n) {
+    std::mt19937_64 rng(0);
+    std::vector<std::string> elems;
+    elems.reserve(n);
+    char buf[17];
+    for (std::size_t i = 0; i < n; ++i) {
+        std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(rng()));
+        elems.emplace_back(buf);
+    }
+    return elems;
+}
+
+// Same shapes as stat.py: Uniform(0.5, 1.5), Exponential(1), Pareto(1.5) + 1, Constant.
+std::vector<Stream> make_streams(std::size_t n) {
+    const auto elems = make_elements(n);
+    std::mt19937_64 rng(1);
+    auto draw = [&](auto dist) {
+        std::vector<double> w(n);
+        for (auto& x : w) x = dist(rng);
+        return w;
+    };
+    std::vector<double> pareto = draw(std::uniform_real_distribution<double>(0.0, 1.0));
+    for (auto& x : pareto) x = 1.0 / std::pow(1.0 - x, 1.0 / 1.5);
+    return {
+        {"uniform", elems, draw(std::uniform_real_distribution<double>(0.5, 1.5))},
+        {"exponential", elems, draw(std::exponential_distribution<double>(1.0))},
+        {"pareto", elems, std::move(pareto)},
+        {"constant", elems, std::vector<double>(n, 1.0)},
+    };
+}
+
+const std::vector<Stream>& streams() {
+    static const std::vector<Stream> s = make_streams(kElements);
+    return s;
+}
+
+// ─── Sketch traits ────────────────────────────────────────────────────────────
+
+template <typename S, typename = void>
+struct is_mergeable : std::false_type {};
+template <typename S>
+struct is_mergeable<S, std::void_t<decltype(std::declval<S&>().merge(std::declval<const S&>()))>>
+    : std::true_type {};
+
+template <typename S>
+constexpr bool is_weighted = std::is_base_of_v<Sketch, S>;
+
+const std::vector<std::pair<RngEngine, const char*>> kEngines = {
+    {RngEngine::XOSHIRO128PP, "xoshiro128pp"},  // kDefaultRngEngine first
+    {RngEngine::XOSHIRO256PP, "xoshiro256pp"},
+    {RngEngine::PCG64, "pcg64"},
+    {RngEngine::MT19937, "mt19937"},
+};
+
+template <typename S>
+void fill(S& sketch, const Stream& s, std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+        if constexpr (is_weighted<S>) sketch.add(s.elems[i], s.weights[i]);
+        else sketch.add(s.elems[i]);
+    }
+}
+
+volatile double g_sink = 0.0;
+
+// ─── Registration ─────────────────────────────────────────────────────────────
+
+template <typename S>
+using Factory = std::function<std::unique_ptr<S>(std::size_t m, RngEngine engine)>;
+
+template <typename S>
+void register_ops(std::vector<Benchmark>& out, const std::string& suffix, std::size_t m,
+                  RngEngine engine, const Stream* stream, const Factory<S>& make) {
+    const std::map<std::string, double> counters = {{"m", static_cast<double>(m)}};
+
+    out.push_back({"add/" + suffix, [=] {
+        auto sketch = std::make_shared<std::unique_ptr<S>>();
+        Batch b;
+        b.setup = [=] { *sketch = make(m, engine); };
+        b.body = [=] { fill(**sketch, *stream, 0, stream->elems.size()); };
+        b.ops = stream->elems.size();
+        auto probe = make(m, engine);
+        b.counters["bytes_per_sketch"] = static_cast<double>(probe->memory_usage(MemoryFlag::TOTAL));
+        if constexpr (kStatsEnabled) {
+            // One untimed pass over the stream for the WCE_ENABLE_STATS counters.
+            fill(*probe, *stream, 0, stream->elems.size());
+            const HotPathStats st = probe->stats();
+            if (st.adds > 0) {
+                const double adds = static_cast<double>(st.adds);
+                b.counters["iterations_per_add"] = static_cast<double>(st.iterations) / adds;
+                b.counters["prune_rate"] = static_cast<double>(st.early_exits) / adds;
+                b.counters["rescans_per_add"] = static_cast<double>(st.threshold_rescans) / adds;
+                b.counters["window_shifts"] = static_cast<double>(st.window_shifts);
+            }
+        }
+        return b;
+    }, counters});
+
+    out.push_back({"estimate/" + suffix, [=] {
+        std::shared_ptr<S> sketch = make(m, engine);
+        fill(*sketch, *stream, 0, stream->elems.size());
+        Batch b;
+        b.body = [=] { g_sink = g_sink + sketch->estimate(); };
+        b.counters["bytes_per_sketch"] = static_cast<double>(sketch->memory_usage(MemoryFlag::TOTAL));
+        return b;
+    }, counters});
+
+    if constexpr (is_mergeable<S>::value) {
+        out.push_back({"merge/" + suffix, [=] {
+            std::shared_ptr<S> a = make(m, engine);
+            std::shared_ptr<S> b_sketch = make(m, engine);
+            const std::size_t half = stream->elems.size() / 2;
+            fill(*a, *stream, 0, half);
+            fill(*b_sketch, *stream, half, stream->elems.size());
+            Batch b;
+            b.body = [=] { a->merge(*b_sketch); };
+            b.counters["bytes_per_sketch"] = static_cast<double>(a->memory_usage(MemoryFlag::TOTAL));
+            return b;
+        }, counters});
+    }
+}
+
+// Registers label over every m. With sweep_axes, also every RNG engine (when the
+// sketch takes one) and every weight distribution (when it is weighted).
+template <typename S>
+void register_sketch(std::vector<Benchmark>& out, const std::string& label, bool uses_engine,
+                     bool sweep_axes, Factory<S> make) {
+    const Stream& uniform = streams().front();
+    for (std::size_t m : kSizes) {
+        const std::string base = label + "/m:" + std::to_string(m);
+        auto tag = [&](const char* engine, const std::string& dist) {
+            std::string s = base;
+            if (uses_engine) s += std::string("/engine:") + engine;
+            if (is_weighted<S>) s += "/dist:" + dist;
+            return s;
+        };
+        register_ops<S>(out, tag(kEngines.front().second, uniform.name), m,
+                        kEngines.front().first, &uniform, make);
+        if (!sweep_axes) continue;
+        if (uses_engine) {
+            for (std::size_t e = 1; e < kEngines.size(); ++e)
+                register_ops<S>(out, tag(kEngines[e].second, uniform.name), m,
+                                kEngines[e].first, &uniform, make);
+        }
+        if (is_weighted<S>) {
+            for (std::size_t d = 1; d < streams().size(); ++d)
+                register_ops<S>(out, tag(kEngines.front().second, streams()[d].name), m,
+                                kEngines.front().first, &streams()[d], make);
+        }
+    }
+}
+
+// Sketches without parameters beyond (m, seed[, engine]).
+template <typename S>
+void register_plain(std::vector<Benchmark>& out, const std::string& label) {
+    if constexpr (std::is_constructible_v<S, std::size_t, std::uint64_t, RngEngine>) {
+        register_sketch<S>(out, label, true, true,
+            [](std::size_t m, RngEngine e) { return std::make_unique<S>(m, kSeed, e); });
+    } else {
+        register_sketch<S>(out, label, false, true,
+            [](std::size_t m, RngEngine) { return std::make_unique<S>(m, kSeed); });
+    }
+}
+
+std::vector<Benchmark> all_benchmarks() {
+    std::vector<Benchmark> out;
+
+    register_plain<ExpSketch>(out, "ExpSketch");
+    register_plain<ExpSketchFloat32>(out, "ExpSketchFloat32");
+    register_plain<FastExpSketch>(out, "FastExpSketch");
+    register_plain<FastExpSketchT<float>>(out, "FastExpSketchFloat32");
+    register_plain<FastExpSketchFloat16>(out, "FastExpSketchFloat16");
+    register_plain<FastExpSketchBFloat16>(out, "FastExpSketchBFloat16");
+    register_plain<FastGMExpSketch>(out, "FastGMExpSketch");
+    register_plain<WeightedMinHash>(out, "WeightedMinHash");
+    register_plain<WeightedHyperLogLog>(out, "WeightedHyperLogLog");
+    register_plain<WeightedHyperLogLogFloat32>(out, "WeightedHyperLogLogFloat32");
+    register_plain<MinHash>(out, "MinHash");
+    register_plain<MartingaleMinHash>(out, "MartingaleMinHash");
+    register_plain<HyperLogLog>(out, "HyperLogLog");
+
+    for (std::uint8_t b : {8, 16}) {
+        const std::string bits = "/b:" + std::to_string(b);
+        register_sketch<QSketch>(out, "QSketch" + bits, true, b == 8,
+            [b](std::size_t m, RngEngine e) { return std::make_unique<QSketch>(m, kSeed, b, e); });
+        register_sketch<QSketchDyn>(out, "QSketchDyn" + bits, false, b == 8,
+            [b](std::size_t m, RngEngine) { return std::make_unique<QSketchDyn>(m, kSeed, b); });
+    }
+
+    bool first = true;
+    for (std::uint8_t b : {8, 4}) {
+        for (float base : {2.0F, 1.5F, 4.0F}) {
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "/b:%d/base:%g", b, static_cast<double>(base));
+            const std::string p = buf;
+            register_sketch<kQSketch>(out, "kQSketch" + p, true, first,
+                [=](std::size_t m, RngEngine e) { return std::make_unique<kQSketch>(m, kSeed, b, base, e); });
+            register_sketch<kQSketchRounding>(out, "kQSketchRounding" + p, true, first,
+                [=](std::size_t m, RngEngine e) { return std::make_unique<kQSketchRounding>(m, kSeed, b, base, e); });
+            register_sketch<kQSketchShifted>(out, "kQSketchShifted" + p, true, first,
+                [=](std::size_t m, RngEngine e) { return std::make_unique<kQSketchShifted>(m, kSeed, b, base, e); });
+            register_sketch<kQSketchRoundedDyn>(out, "kQSketchRoundedDyn" + p, false, first,
+                [=](std::size_t m, RngEngine) { return std::make_unique<kQSketchRoundedDyn>(m, kSeed, b, base); });
+            first = false;
+        }
+    }
+
+    for (std::uint8_t b : {10, 8, 12}) {
+        const std::string bits = "/b:" + std::to_string(b);
+        const bool sweep = b == 10;
+        register_sketch<LogExpSketchSlowNoShifted>(out, "LogExpSketchSlowNoShifted" + bits, false, sweep,
+            [b](std::size_t m, RngEngine) { return std::make_unique<LogExpSketchSlowNoShifted>(m, kSeed, b, kVMax); });
+        register_sketch<LogExpSketchSlowShifted>(out, "LogExpSketchSlowShifted" + bits, false, sweep,
+            [b](std::size_t m, RngEngine) { return std::make_unique<LogExpSketchSlowShifted>(m, kSeed, b, kVMax); });
+        register_sketch<LogExpSketchFastNoShifted>(out, "LogExpSketchFastNoShifted" + bits, true, sweep,
+            [b](std::size_t m, RngEngine e) { return std::make_unique<LogExpSketchFastNoShifted>(m, kSeed, b, kVMax, e); });
+        register_sketch<LogExpSketchFastShifted>(out, "LogExpSketchFastShifted" + bits, true, sweep,
+            [b](std::size_t m, RngEngine e) { return std::make_unique<LogExpSketchFastShifted>(m, kSeed, b, kVMax, e); });
+    }
+
+    // fp16, bfloat16, fp8 E4M3, fp8 E5M2 register layouts.
+    const std::vector<std::pair<int, int>> formats = {{5, 10}, {8, 7}, {4, 3}, {5, 2}};
+    for (const auto& [e, mb] : formats) {
+        const std::string fmt = "/e:" + std::to_string(e) + "/mb:" + std::to_string(mb);
+        const bool sweep = e == formats.front().first && mb == formats.front().second;
+        const int exp_bits = e;
+        const int mant_bits = mb;
+        register_sketch<FastExpSketchCustomFloat>(out, "FastExpSketchCustomFloat" + fmt, true, sweep,
+            [=](std::size_t m, RngEngine rng) {
+                return std::make_unique<FastExpSketchCustomFloat>(m, kSeed, exp_bits, mant_bits, rng);
+            });
+        register_sketch<WeightedHyperLogLogCustomFloat>(out, "WeightedHyperLogLogCustomFloat" + fmt, false, sweep,
+            [=](std::size_t m, RngEngine) {
+                return std::make_unique<WeightedHyperLogLogCustomFloat>(m, kSeed, exp_bits, mant_bits);
+            });
+    }
+    return out;
+}
+
+std::map<std::string, std::string> context(const char* argv0) {
+    char host[256] = "";
+    gethostname(host, sizeof(host) - 1);
+    char date[64] = "";
+    const std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", std::localtime(&now));
+    return {
+        {"date", date},
+        {"host_name", host},
+        {"executable", argv0},
+        {"num_cpus", std::to_string(std::thread::hardware_concurrency())},
+        {"library_build_type", WCE_BUILD_TYPE},
+        {"wce_version", WCE_VERSION},
+        {"elements_per_batch", std::to_string(kElements)},
+        {"cycle_counter", wce_bench::CycleCounter().available() ? "perf_event" : "unavailable"},
+    };
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    wce_bench::Options opt;
+    if (!wce_bench::parse_options(argc, argv, opt)) return 2;
+    return wce_bench::run_all(all_benchmarks(), opt, context(argv[0]));
+}
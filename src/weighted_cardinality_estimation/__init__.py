@@ -3,11 +3,31 @@ from importlib import metadata as _md
 from . import stat  # noqa: F401
 from ._core import *  # noqa: F403  # pyright: ignore[reportMissingImports]
 from ._core import (  # noqa: F401  # pyright: ignore[reportMissingImports]
+    AggregationClient,
+    AggregationServer,
+    CheckpointFile,
+    CustomFloatFormat,
+    STATS_ENABLED,
     FastExpSketchCustomFloat,
+    HotPathStats,
+    IngestPipeline,
+    KeyedSketchMap,
     LogExpSketchFastNoShifted,
     LogExpSketchSlowNoShifted,
+    LshIndex,
     MemoryFlag,
+    QSketchPool,
     QuantizationMode,
+    TrialResults,
+    TunedConfig,
+    difference_estimate,
+    intersection_estimate,
+    jaccard_matrix,
+    jaccard_topk,
+    quantize_custom_float,
+    run_trials,
+    tune,
+    union_estimate,
 )
 
 __version__ = _md.version(__name__)
@@ -1,3 +1,8 @@
+from typing import Generic, TypeVar, overload
+
+import numpy as np
+import numpy.typing as npt
+
 from . import MemoryFlag as MemoryFlag
 from . import stat as stat
 
@@ -24,6 +29,38 @@ class RngEngine:
     XOSHIRO256PP: RngEngine
 
 
+# ─── HashScheme enum ─────────────────────────────────────────────────────────
+
+class HashScheme:
+    MODULO_TWO_HASHES: HashScheme
+    MULTIPLY_HIGH_128: HashScheme
+
+
+# ─── Hot-path stats ───────────────────────────────────────────────────────────
+
+STATS_ENABLED: bool
+
+class HotPathStats:
+
+
+    @property
+    def adds(self) -> int: ...
+    @property
+    def iterations(self) -> int: ...
+    @property
+    def early_exits(self) -> int: ...
+    @property
+    def register_updates(self) -> int: ...
+    @property
+    def threshold_rescans(self) -> int: ...
+    @property
+    def window_shifts(self) -> int: ...
+    @property
+    def iterations_per_add(self) -> float: ...
+    @property
+    def prune_rate(self) -> float: ...
+
+
 # ─── Base ─────────────────────────────────────────────────────────────────────
 
 class CardinalitySketch:
@@ -36,6 +73,8 @@ class CardinalitySketch:
     def estimate(self) -> float:
         ...
     def memory_usage(self, flags: int) -> int: ...
+    def stats(self) -> HotPathStats: ...
+    def reset_stats(self) -> None: ...
 
 
 # ─── Mixins ───────────────────────────────────────────────────────────────────
@@ -45,8 +84,10 @@ class WeightedMixin:
 
     def add(self, x: str, weight: float = ...) -> None:
         ...
-    def add_many(self, elems: list[str], weights: list[float] = ...) -> None:
+    def add_many(self, elems: list[str], weights: list[float] = ..., pre_aggregate: bool = ...) -> None:
         ...
+    @property
+    def pre_aggregation_exact(self) -> bool: ...
 
 class MergeableMixin:
 
@@ -103,29 +144,58 @@ class WeightedMinHash(MergeableMixin, WeightedMixin, CardinalitySketch):
 class WeightedHyperLogLog(MergeableMixin, WeightedMixin, CardinalitySketch):
 
 
-    def __init__(self, m: int, seed: int) -> None: ...
+    hash_scheme: HashScheme
+
+    def __init__(self, m: int, seed: int, hash_scheme: HashScheme = ...) -> None: ...
 
 class WeightedHyperLogLogFloat32(MergeableMixin, WeightedMixin, CardinalitySketch):
 
 
-    def __init__(self, m: int, seed: int) -> None: ...
+    hash_scheme: HashScheme
 
-class QSketch(MergeableMixin, WeightedMixin, CardinalitySketch):
+    def __init__(self, m: int, seed: int, hash_scheme: HashScheme = ...) -> None: ...
 
+class QSketch(JaccardMixin, MergeableMixin, WeightedMixin, CardinalitySketch):
 
-    def __init__(self, m: int, seed: int, amount_bits: int, rng_engine: RngEngine = ...) -> None: ...
+
+    small_capacity: int
+    small_mode: bool
+
+    def __init__(self, m: int, seed: int, amount_bits: int, rng_engine: RngEngine = ..., small_capacity: int = ...) -> None: ...
+    def to_wire(self) -> bytes: ...
+    @staticmethod
+    def from_wire(data: bytes) -> QSketch: ...
+    def merge_wire(self, data: bytes) -> None: ...
+    @staticmethod
+    def from_checkpoint(path: str) -> QSketch: ...
 
 class QSketchDyn(MergeableMixin, WeightedMixin, CardinalitySketch):
 
 
-    def __init__(self, m: int, seed: int, amount_bits: int, g_seed: int = ...) -> None: ...
+    hash_scheme: HashScheme
 
-class kQSketch(NewtonMixin, MergeableMixin, WeightedMixin, CardinalitySketch):
+    def __init__(self, m: int, seed: int, amount_bits: int, g_seed: int = ..., hash_scheme: HashScheme = ...) -> None: ...
 
+class kQSketch(NewtonMixin, JaccardMixin, MergeableMixin, WeightedMixin, CardinalitySketch):
 
-    def __init__(self, m: int, seed: int, amount_bits: int, logarithm_base: float, rng_engine: RngEngine = ...) -> None: ...
 
-class kQSketchRounding(NewtonMixin, MergeableMixin, WeightedMixin, CardinalitySketch):
+    change_epoch: int
+    small_capacity: int
+    small_mode: bool
+    pending_changes: int
+
+    def __init__(self, m: int, seed: int, amount_bits: int, logarithm_base: float, rng_engine: RngEngine = ..., small_capacity: int = ...) -> None: ...
+    def to_wire(self) -> bytes: ...
+    @staticmethod
+    def from_wire(data: bytes) -> kQSketch: ...
+    def merge_wire(self, data: bytes) -> None: ...
+    def track_changes(self) -> None: ...
+    def serialize_delta(self, since_epoch: int) -> bytes: ...
+    def apply_delta(self, data: bytes) -> None: ...
+    @staticmethod
+    def from_checkpoint(path: str) -> kQSketch: ...
+
+class kQSketchRounding(NewtonMixin, JaccardMixin, MergeableMixin, WeightedMixin, CardinalitySketch):
 
 
     def __init__(self, m: int, seed: int, amount_bits: int, logarithm_base: float, rng_engine: RngEngine = ...) -> None: ...
@@ -134,7 +204,9 @@ class kQSketchRounding(NewtonMixin, MergeableMixin, WeightedMixin, CardinalitySk
 class kQSketchRoundedDyn(NewtonMixin, WeightedMixin, CardinalitySketch):
 
 
-    def __init__(self, m: int, seed: int, amount_bits: int, logarithm_base: float, g_seed: int = ...) -> None: ...
+    hash_scheme: HashScheme
+
+    def __init__(self, m: int, seed: int, amount_bits: int, logarithm_base: float, g_seed: int = ..., hash_scheme: HashScheme = ...) -> None: ...
 
 class kQSketchShifted(NewtonMixin, MergeableMixin, WeightedMixin, CardinalitySketch):
 
@@ -155,12 +227,60 @@ class ExpSketchFloat32(JaccardMixin, MergeableMixin, WeightedMixin, CardinalityS
 class FastExpSketchFloat32(JaccardMixin, MergeableMixin, WeightedMixin, CardinalitySketch):
 
 
-    def __init__(self, m: int, seed: int, rng_engine: RngEngine = ...) -> None: ...
+    change_epoch: int
+    small_capacity: int
+    small_mode: bool
+    pending_changes: int
+
+    def __init__(self, m: int, seed: int, rng_engine: RngEngine = ..., small_capacity: int = ...) -> None: ...
+    def snapshot(self) -> FastExpSketchFloat32: ...
+    def to_wire(self) -> bytes: ...
+    @staticmethod
+    def from_wire(data: bytes) -> FastExpSketchFloat32: ...
+    def merge_wire(self, data: bytes) -> None: ...
+    def track_changes(self) -> None: ...
+    def serialize_delta(self, since_epoch: int) -> bytes: ...
+    def apply_delta(self, data: bytes) -> None: ...
+    @staticmethod
+    def from_checkpoint(path: str) -> FastExpSketchFloat32: ...
+
+class FastExpSketchFloat16(JaccardMixin, MergeableMixin, WeightedMixin, CardinalitySketch):
+
+
+    small_capacity: int
+    small_mode: bool
+
+    def __init__(self, m: int, seed: int, rng_engine: RngEngine = ..., small_capacity: int = ...) -> None: ...
+    def snapshot(self) -> FastExpSketchFloat16: ...
+
+class FastExpSketchBFloat16(JaccardMixin, MergeableMixin, WeightedMixin, CardinalitySketch):
+
+
+    small_capacity: int
+    small_mode: bool
+
+    def __init__(self, m: int, seed: int, rng_engine: RngEngine = ..., small_capacity: int = ...) -> None: ...
+    def snapshot(self) -> FastExpSketchBFloat16: ...
 
 class FastExpSketch(JaccardMixin, MergeableMixin, WeightedMixin, CardinalitySketch):
 
 
-    def __init__(self, m: int, seed: int, rng_engine: RngEngine = ...) -> None: ...
+    change_epoch: int
+    small_capacity: int
+    small_mode: bool
+    pending_changes: int
+
+    def __init__(self, m: int, seed: int, rng_engine: RngEngine = ..., small_capacity: int = ...) -> None: ...
+    def snapshot(self) -> FastExpSketch: ...
+    def to_wire(self) -> bytes: ...
+    @staticmethod
+    def from_wire(data: bytes) -> FastExpSketch: ...
+    def merge_wire(self, data: bytes) -> None: ...
+    def track_changes(self) -> None: ...
+    def serialize_delta(self, since_epoch: int) -> bytes: ...
+    def apply_delta(self, data: bytes) -> None: ...
+    @staticmethod
+    def from_checkpoint(path: str) -> FastExpSketch: ...
 
 class FastGMExpSketch(JaccardMixin, MergeableMixin, WeightedMixin, CardinalitySketch):
 
@@ -185,6 +305,10 @@ class LogExpSketchFastNoShifted(JaccardMixin, MergeableMixin, WeightedMixin, Car
 
 
     def __init__(self, m: int, seed: int, amount_bits: int, v_max: float, rng_engine: RngEngine = ...) -> None: ...
+    def to_wire(self) -> bytes: ...
+    @staticmethod
+    def from_wire(data: bytes) -> LogExpSketchFastNoShifted: ...
+    def merge_wire(self, data: bytes) -> None: ...
 
 
 class LogExpSketchFastShifted(JaccardMixin, MergeableMixin, WeightedMixin, CardinalitySketch):
@@ -204,6 +328,26 @@ class QuantizationMode:
     LINEAR: QuantizationMode
     LOGARITHMIC: QuantizationMode
 
+def quantize_custom_float(
+    value: float, sign_bits: int, exp_bits: int, mant_bits: int, mode: QuantizationMode = ...
+) -> float: ...
+
+class CustomFloatFormat:
+
+
+    exp_bits: int
+    mant_bits: int
+    max_code: int
+    max_value: float
+    min_value: float
+
+    def __init__(self, exp_bits: int, mant_bits: int) -> None: ...
+    def encode(self, value: float) -> int: ...
+    def decode(self, code: int) -> float: ...
+    def quantize(self, value: float) -> float: ...
+    def encode_many(self, values: list[float]) -> list[int]: ...
+    def quantize_many(self, values: list[float]) -> list[float]: ...
+
 class FastExpSketchCustomFloat(JaccardMixin, MergeableMixin, WeightedMixin, CardinalitySketch):
 
 
@@ -219,5 +363,231 @@ class WeightedHyperLogLogCustomFloat(MergeableMixin, WeightedMixin, CardinalityS
 
     exp_bits: int
     mant_bits: int
+    hash_scheme: HashScheme
+
+    def __init__(self, m: int, seed: int, exp_bits: int, mant_bits: int, hash_scheme: HashScheme = ...) -> None: ...
+
+
+# ─── Fused ingestion ──────────────────────────────────────────────────────────
+
+class SketchGroup:
+
+
+    def __init__(self, m: int, seed: int, rng_engine: RngEngine = ...) -> None: ...
+    def make_fast_exp_sketch(self) -> FastExpSketch: ...
+    def make_q_sketch(self, amount_bits: int) -> QSketch: ...
+    def make_k_q_sketch(self, amount_bits: int, logarithm_base: float) -> kQSketch: ...
+    def make_hyper_log_log(self) -> HyperLogLog: ...
+    def add(self, x: str, weight: float = ...) -> None: ...
+    def add_many(self, elems: list[str], weights: list[float] = ...) -> None: ...
+    def __len__(self) -> int: ...
+
+
+# ─── Group-by aggregation ─────────────────────────────────────────────────────
+
+_S = TypeVar("_S")
+
+class _KeyedSketchMap(Generic[_S]):
+
+
+    def add(self, key: str, x: str, weight: float = ...) -> None: ...
+    def add_many(self, keys: list[str], elems: list[str], weights: list[float]) -> None: ...
+    def estimate(self, key: str) -> float: ...
+    def estimate_all(self) -> npt.NDArray[np.float64]: ...
+    def get(self, key: str) -> _S: ...
+    def merge(self, other: _KeyedSketchMap[_S]) -> None: ...
+    def keys(self) -> list[str]: ...
+    def __contains__(self, key: str) -> bool: ...
+    def __len__(self) -> int: ...
+
+_Keyable = TypeVar(
+    "_Keyable",
+    ExpSketch,
+    FastExpSketch,
+    FastExpSketchFloat32,
+    FastGMExpSketch,
+    QSketch,
+    kQSketch,
+    kQSketchRounding,
+    WeightedMinHash,
+    WeightedHyperLogLog,
+    WeightedHyperLogLogFloat32,
+)
+
+def KeyedSketchMap(prototype: _Keyable) -> _KeyedSketchMap[_Keyable]: ...
+
+
+# ─── Pipelined ingestion ──────────────────────────────────────────────────────
+
+class QSketchDynPipeline:
+
+
+    def add_many(self, elems: list[str], weights: list[float] = ...) -> None: ...
+    @property
+    def producers(self) -> int: ...
+    @property
+    def ring_capacity(self) -> int: ...
+
+class kQSketchRoundedDynPipeline:
+
+
+    def add_many(self, elems: list[str], weights: list[float] = ...) -> None: ...
+    @property
+    def producers(self) -> int: ...
+    @property
+    def ring_capacity(self) -> int: ...
+
+class MartingaleMinHashPipeline:
+
+
+    def add_many(self, elems: list[str]) -> None: ...
+    @property
+    def producers(self) -> int: ...
+    @property
+    def ring_capacity(self) -> int: ...
+
+@overload
+def IngestPipeline(sketch: QSketchDyn, producers: int = ..., ring_capacity: int = ...) -> QSketchDynPipeline: ...
+@overload
+def IngestPipeline(sketch: kQSketchRoundedDyn, producers: int = ..., ring_capacity: int = ...) -> kQSketchRoundedDynPipeline: ...
+@overload
+def IngestPipeline(sketch: MartingaleMinHash, producers: int = ..., ring_capacity: int = ...) -> MartingaleMinHashPipeline: ...
+
+
+# ─── Pooled sketches ──────────────────────────────────────────────────────────
+
+class QSketchPool:
+
+
+    def __init__(self, m: int, seed: int, amount_bits: int) -> None: ...
+    def make(self) -> int: ...
+    def add(self, id: int, x: str, weight: float = ...) -> None: ...
+    def add_many(self, ids: list[int], elems: list[str], weights: list[float]) -> None: ...
+    def estimate(self, id: int) -> float: ...
+    def get(self, id: int) -> QSketch: ...
+    def reset(self) -> None: ...
+    @property
+    def bytes_reserved(self) -> int: ...
+    def __len__(self) -> int: ...
+
+
+# ─── Aggregation over Unix domain sockets ─────────────────────────────────────
+
+_Wire = QSketch | kQSketch | LogExpSketchFastNoShifted | FastExpSketch | FastExpSketchFloat32
+
+class AggregationServer:
+
+
+    def __init__(self, socket_path: str, prototype: _Wire) -> None: ...
+    def serve(self) -> None: ...
+    def stop(self) -> None: ...
+    @property
+    def socket_path(self) -> str: ...
+
+class AggregationClient:
+
+
+    def __init__(self, socket_path: str) -> None: ...
+    @overload
+    def add_many(self, name: str, elems: list[str], weights: list[float]) -> None: ...
+    @overload
+    def add_many(self, name: str, elems: list[str]) -> None: ...
+    def merge(self, name: str, sketch: _Wire) -> None: ...
+    def merge_wire(self, name: str, data: bytes) -> None: ...
+    def estimate(self, name: str) -> float: ...
+    def fetch_wire(self, name: str) -> bytes: ...
+    def close(self) -> None: ...
+
+
+# ─── Crash-consistent checkpoints ─────────────────────────────────────────────
+
+class CheckpointFile:
+
+
+    def __init__(self, path: str) -> None: ...
+    def write(self, sketch: QSketch | kQSketch | FastExpSketch | FastExpSketchFloat32) -> None: ...
+    @property
+    def generation(self) -> int: ...
+    @property
+    def path(self) -> str: ...
+
+
+# ─── Tuner ────────────────────────────────────────────────────────────────────
+
+class TunedConfig:
+
+
+    sketch: str
+    m: int
+    params: dict[str, float]
+    rel_error: float
+    ns_per_add: float
+    memory_bytes: int
+    meets_budget: bool
+
+    def __init__(self, sketch: str, m: int, params: dict[str, float], rel_error: float = ..., ns_per_add: float = ..., memory_bytes: int = ..., meets_budget: bool = ...) -> None: ...
+    def to_json(self) -> str: ...
+    def make_sketch(self, seed: int = ...) -> CardinalitySketch: ...
+
+
+def tune(elems: list[str], weights: list[float], max_rel_error: float = ..., max_memory_bytes: int = ..., min_adds_per_sec: float = ..., trials: int = ..., seed: int = ...) -> list[TunedConfig]: ...
+
+
+# ─── Accuracy trials ──────────────────────────────────────────────────────────
+
+class TrialResults:
+
+
+    @property
+    def estimates(self) -> npt.NDArray[np.float64]: ...
+    @property
+    def estimates_b(self) -> npt.NDArray[np.float64]: ...
+    @property
+    def jaccard(self) -> npt.NDArray[np.float64]: ...
+    @property
+    def union_estimates(self) -> npt.NDArray[np.float64]: ...
+
+
+@overload
+def run_trials(sketch: str, m: int, elems: list[str], weights: list[float], n_trials: int = ..., params: dict[str, float] = ..., threads: int = ..., seed: int = ..., elems_b: list[str] | None = ..., weights_b: list[float] | None = ..., jaccard: bool = ..., merge: bool = ...) -> TrialResults: ...
+@overload
+def run_trials(config: TunedConfig, elems: list[str], weights: list[float], n_trials: int = ..., threads: int = ..., seed: int = ..., elems_b: list[str] | None = ..., weights_b: list[float] | None = ..., jaccard: bool = ..., merge: bool = ...) -> TrialResults: ...
+
+
+# ─── Set operations ───────────────────────────────────────────────────────────
+
+_ExpFamily = (
+    ExpSketch
+    | ExpSketchFloat32
+    | FastExpSketch
+    | FastExpSketchFloat32
+    | FastExpSketchFloat16
+    | FastExpSketchBFloat16
+    | FastGMExpSketch
+)
+
+def union_estimate(a: _ExpFamily, b: _ExpFamily) -> float: ...
+def intersection_estimate(a: _ExpFamily, b: _ExpFamily) -> float: ...
+def difference_estimate(a: _ExpFamily, b: _ExpFamily) -> float: ...
+
+
+# ─── Batched Jaccard ──────────────────────────────────────────────────────────
+
+def jaccard_matrix(sketches: list[JaccardMixin], threads: int = ...) -> list[list[float]]: ...
+def jaccard_topk(query: JaccardMixin, sketches: list[JaccardMixin], k: int, threads: int = ...) -> list[tuple[int, float]]: ...
+
+class LshIndex:
+
+
+    bands: int
+    rows: int
 
-    def __init__(self, m: int, seed: int, exp_bits: int, mant_bits: int) -> None: ...
+    def __init__(self, bands: int, rows: int) -> None: ...
+    def insert(self, sketch: JaccardMixin) -> int: ...
+    def candidates(self, query: JaccardMixin) -> list[int]: ...
+    def query(self, query: JaccardMixin, threshold: float = ...) -> list[tuple[int, float]]: ...
+    def pairs(self, threshold: float = ...) -> list[tuple[int, int, float]]: ...
+    def save(self, path: str) -> None: ...
+    @staticmethod
+    def open(path: str) -> LshIndex: ...
+    def __len__(self) -> int: ...
@@ -1,10 +1,13 @@
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <mutex>
 #include "memory_flag.hpp"
 #include "exp_sketch.hpp"
 #include "exp_sketch_float32.hpp"
 #include "fast_exp_sketch.hpp"
 #include "fast_exp_sketch_t.hpp"
+#include "fast_exp_sketch_float16.hpp"
 #include "fastgm_exp_sketch.hpp"
 #include "q_sketch_dyn.hpp"
 #include "q_sketch.hpp"
@@ -13,6 +16,7 @@
 #include "k_q_sketch_rounded_dyn.hpp"
 #include "k_q_sketch_shifted.hpp"
 #include "weighted_min_hash.hpp"
+#include "custom_float_format.hpp"
 #include "fast_exp_sketch_custom_float.hpp"
 #include "log_exp_sketch_slow_no_shifted.hpp"
 #include "log_exp_sketch_slow_shifted.hpp"
@@ -24,9 +28,49 @@
 #include "weighted_hyper_log_log.hpp"
 #include "weighted_hyper_log_log_custom_float.hpp"
 #include "rng_engine_type.hpp"
+#include "hash_scheme_type.hpp"
+#include "sketch_group.hpp"
+#include "sketch_pool.hpp"
+#include "tuner.hpp"
+#include "trials.hpp"
+#include "jaccard_batch.hpp"
+#include "keyed_sketch_map.hpp"
+#include "ingest_pipeline.hpp"
+#include "lsh_index.hpp"
+#include "set_operations.hpp"
+#include "small_set.hpp"
+#include "wire_format.hpp"
+#include "aggregation_client.hpp"
+#include "aggregation_server.hpp"
+#include "checkpoint_file.hpp"
 
 namespace py = pybind11;
 
+// Drops the GIL around the C++ call, after arguments are converted and before
+// the result is. Used for everything that scales with m or the input size.
+// Concurrent calls on one sketch still need external locking (or snapshot()).
+using release_gil = py::call_guard<py::gil_scoped_release>;
+
+// 16-bit registers cross to Python as float, so get_registers() and pickling
+// work unchanged; loading rounds like the C++ constructor.
+namespace pybind11::detail {
+template <typename Half>
+struct half_caster {
+    PYBIND11_TYPE_CASTER(Half, const_name("float"));
+    bool load(handle src, bool convert) {
+        make_caster<double> d;
+        if (!d.load(src, convert)) { return false; }
+        value = Half(cast_op<double>(d));
+        return true;
+    }
+    static handle cast(Half src, return_value_policy, handle) {
+        return py::float_(static_cast<double>(src)).release();
+    }
+};
+template <> struct type_caster<Float16> : half_caster<Float16> {};
+template <> struct type_caster<BFloat16> : half_caster<BFloat16> {};
+}  // namespace pybind11::detail
+
 // ─── Method binders ──────────────────────────────────────────────────────────
 
 // Unweighted sketches: only get_registers (add/add_many/estimate/memory come from CardinalitySketch)
@@ -45,22 +89,175 @@ PyClass& bind_sketch_base(PyClass& cls) {
         .def("add",      static_cast<void (Sketch::*)(const std::string&)>(&Sketch::add),
              py::arg("x"))
         .def("add_many", static_cast<void (Cls::*)(const std::vector<std::string>&, const std::vector<double>&)>(&Cls::add_many),
-             py::arg("elems"), py::arg("weights"))
+             py::arg("elems"), py::arg("weights"), release_gil())
+        .def("add_many", static_cast<void (Cls::*)(const std::vector<std::string>&, const std::vector<double>&, bool)>(&Cls::add_many),
+             py::arg("elems"), py::arg("weights"), py::arg("pre_aggregate"), release_gil())
         .def("add_many", static_cast<void (Sketch::*)(const std::vector<std::string>&)>(&Sketch::add_many),
-             py::arg("elems"))
+             py::arg("elems"), release_gil())
+        .def_property_readonly("pre_aggregation_exact", &Cls::pre_aggregation_exact)
         .def("get_registers", &Cls::get_registers);
 }
 
+// to_wire / from_wire / merge_wire (see wire_format.hpp)
+template <typename PyClass>
+PyClass& bind_wire(PyClass& cls) {
+    using Cls = typename PyClass::type;
+    return cls
+        .def("to_wire", [](const Cls& s) {
+            std::string data;
+            {
+                py::gil_scoped_release release;
+                data = to_wire(s);
+            }
+            return py::bytes(data);
+        })
+        .def_static("from_wire", [](const std::string& data) { return from_wire<Cls>(data); },
+                    py::arg("data"), release_gil())
+        .def("merge_wire", [](Cls& s, const std::string& data) { merge_wire(s, data); },
+             py::arg("data"), release_gil());
+}
+
+// A SketchPool that Python threads can share: its members' add() use the
+// pool's scratch, so the QSketchPool methods hold mutex for every call.
+template <typename S>
+struct LockedSketchPool : SketchPool<S> {
+    using SketchPool<S>::SketchPool;
+    std::mutex mutex;
+};
+
+// track_changes / serialize_delta / apply_delta (see wire_format.hpp)
+template <typename PyClass>
+PyClass& bind_delta(PyClass& cls) {
+    using Cls = typename PyClass::type;
+    return cls
+        .def("track_changes", &Cls::track_changes)
+        .def_property_readonly("change_epoch", [](const Cls& s) { return s.changes().epoch(); })
+        .def_property_readonly("pending_changes", [](const Cls& s) { return s.changes().count(); })
+        .def("serialize_delta", [](Cls& s, std::uint64_t since_epoch) {
+            std::string data;
+            {
+                py::gil_scoped_release release;
+                data = serialize_delta(s, since_epoch);
+            }
+            return py::bytes(data);
+        }, py::arg("since_epoch"))
+        .def("apply_delta", [](Cls& s, const std::string& data) { apply_delta(s, data); },
+             py::arg("data"), release_gil());
+}
+
+// Cls.from_checkpoint (see checkpoint_file.hpp)
+template <typename PyClass>
+PyClass& bind_checkpoint_recovery(PyClass& cls) {
+    using Cls = typename PyClass::type;
+    return cls.def_static("from_checkpoint", [](const std::string& path) {
+        return CheckpointFile(path).recover<Cls>();
+    }, py::arg("path"), release_gil());
+}
+
+// CheckpointFile, with write() overloaded per class. Staging (a snapshot or a
+// register unpack, see checkpoint_file.hpp) holds the GIL; the copy into the
+// file and the syncs run without it, so other threads keep adding.
+template <typename... Classes>
+void bind_checkpoint(py::module_& m) {
+    auto cls = py::class_<CheckpointFile>(m, "CheckpointFile")
+        .def(py::init<const std::string&>(), py::arg("path"), release_gil())
+        .def_property_readonly("generation", &CheckpointFile::generation)
+        .def_property_readonly("path", &CheckpointFile::path);
+    (cls.def("write", [](CheckpointFile& self, Classes& sketch) {
+        const CheckpointFile::Staged staged = CheckpointFile::stage(sketch);
+        py::gil_scoped_release release;
+        self.commit(staged);
+    }, py::arg("sketch")), ...);
+}
+
+// AggregationServer and AggregationClient. The server's constructor and the
+// client's merge() are overloaded for every class with a wire format.
+template <typename... Classes>
+void bind_aggregation(py::module_& m) {
+    auto server = py::class_<AggregationServer>(m, "AggregationServer");
+    (server.def(py::init<const std::string&, Classes>(), py::arg("socket_path"), py::arg("prototype")), ...);
+    server
+        .def("serve", &AggregationServer::serve, release_gil())
+        .def("stop", &AggregationServer::stop)
+        .def_property_readonly("socket_path", &AggregationServer::socket_path);
+
+    using Client = AggregationClient;
+    auto client = py::class_<Client>(m, "AggregationClient")
+        .def(py::init<const std::string&>(), py::arg("socket_path"), release_gil())
+        .def("add_many", static_cast<void (Client::*)(const std::string&, const std::vector<std::string>&, const std::vector<double>&)>(&Client::add_many),
+             py::arg("name"), py::arg("elems"), py::arg("weights"), release_gil())
+        .def("add_many", static_cast<void (Client::*)(const std::string&, const std::vector<std::string>&)>(&Client::add_many),
+             py::arg("name"), py::arg("elems"), release_gil())
+        .def("merge_wire", [](Client& self, const std::string& name, const std::string& data) {
+            self.merge_wire(name, data);
+        }, py::arg("name"), py::arg("data"), release_gil())
+        .def("estimate", &Client::estimate, py::arg("name"), release_gil())
+        .def("fetch_wire", [](Client& self, const std::string& name) {
+            std::string data;
+            {
+                py::gil_scoped_release release;
+                data = self.fetch_wire(name);
+            }
+            return py::bytes(data);
+        }, py::arg("name"))
+        .def("close", &Client::close);
+    (client.def("merge", &Client::merge<Classes>, py::arg("name"), py::arg("sketch"), release_gil()), ...);
+}
+
 // ─── Pickle helpers ──────────────────────────────────────────────────────────
 
+// A sketch still in small mode pickles its buffered elements instead of
+// registers: the usual state with an empty register list, plus a trailing
+// (small_capacity, elems, weights). Loading replays them into a new
+// small-mode sketch, so states written before small mode still load.
+template <typename Cls>
+py::tuple small_set_state(const Cls& p) {
+    std::vector<std::string> elems;
+    std::vector<double> weights;
+    p.small_set().for_each([&](const std::string& elem, double weight) {
+        elems.push_back(elem);
+        weights.push_back(weight);
+    });
+    return py::make_tuple(p.small_capacity(), elems, weights);
+}
+
+template <typename Cls>
+Cls replay_small_set(Cls sketch, const py::tuple& state) {
+    const auto elems = state[1].cast<std::vector<std::string>>();
+    const auto weights = state[2].cast<std::vector<double>>();
+    sketch.add_many(elems, weights);
+    return sketch;
+}
+
+// Small-mode constructor arguments, and whether a sketch is still buffering.
+template <typename PyClass>
+PyClass& bind_small_mode(PyClass& cls) {
+    using Cls = typename PyClass::type;
+    return cls
+        .def_property_readonly("small_capacity", &Cls::small_capacity)
+        .def_property_readonly("small_mode", &Cls::small_mode);
+}
+
 // Shape: (m, master_seed, registers)
 template <typename Cls, typename RegT, typename... Bases>
 void bind_pickle_regs(py::class_<Cls, Bases...>& cls) {
     cls.def(py::pickle(
         [](const Cls& p) {
+            if constexpr (has_small_mode<Cls>::value) {
+                if (p.small_mode()) {
+                    return py::make_tuple(p.get_sketch_size(), p.get_master_seed(), py::list(), small_set_state(p));
+                }
+            }
             return py::make_tuple(p.get_sketch_size(), p.get_master_seed(), p.get_registers());
         },
         [](const py::tuple& t) {
+            if constexpr (has_small_mode<Cls>::value) {
+                if (t.size() == 4) {
+                    const auto small = t[3].cast<py::tuple>();
+                    return replay_small_set(Cls(t[0].cast<std::size_t>(), t[1].cast<std::uint64_t>(),
+                                                kDefaultRngEngine, small[0].cast<std::size_t>()), small);
+                }
+            }
             if (t.size() != 3) throw std::runtime_error("Invalid pickle state!");
             return Cls(t[0].cast<std::size_t>(),
                        t[1].cast<std::uint64_t>(),
@@ -70,14 +267,28 @@ void bind_pickle_regs(py::class_<Cls, Bases...>& cls) {
 }
 
 // Shape: (m, master_seed, amount_bits, registers)
-template <typename Cls>
-void bind_pickle_q(py::class_<Cls, CardinalitySketch, WeightedMixin, MergeableMixin>& cls) {
+template <typename Cls, typename... Bases>
+void bind_pickle_q(py::class_<Cls, Bases...>& cls) {
     cls.def(py::pickle(
         [](const Cls& p) {
+            if constexpr (has_small_mode<Cls>::value) {
+                if (p.small_mode()) {
+                    return py::make_tuple(p.get_sketch_size(), p.get_master_seed(),
+                                          p.get_amount_bits(), py::list(), small_set_state(p));
+                }
+            }
             return py::make_tuple(p.get_sketch_size(), p.get_master_seed(),
                                   p.get_amount_bits(), p.get_registers());
         },
         [](const py::tuple& t) {
+            if constexpr (has_small_mode<Cls>::value) {
+                if (t.size() == 5) {
+                    const auto small = t[4].cast<py::tuple>();
+                    return replay_small_set(Cls(t[0].cast<std::size_t>(), t[1].cast<std::uint64_t>(),
+                                                t[2].cast<std::uint8_t>(), kDefaultRngEngine,
+                                                small[0].cast<std::size_t>()), small);
+                }
+            }
             if (t.size() != 4) throw std::runtime_error("Invalid pickle state!");
             return Cls(t[0].cast<std::size_t>(),
                        t[1].cast<std::uint64_t>(),
@@ -92,10 +303,24 @@ template <typename Cls, typename... Bases>
 void bind_pickle_log_exp(py::class_<Cls, Bases...>& cls) {
     cls.def(py::pickle(
         [](const Cls& p) {
+            if constexpr (has_small_mode<Cls>::value) {
+                if (p.small_mode()) {
+                    return py::make_tuple(p.get_sketch_size(), p.get_master_seed(), p.get_amount_bits(),
+                                          py::list(), p.get_logarithm_base(), small_set_state(p));
+                }
+            }
             return py::make_tuple(p.get_sketch_size(), p.get_master_seed(),
                                   p.get_amount_bits(), p.get_registers(), p.get_logarithm_base());
         },
         [](const py::tuple& t) {
+            if constexpr (has_small_mode<Cls>::value) {
+                if (t.size() == 6) {
+                    const auto small = t[5].cast<py::tuple>();
+                    return replay_small_set(Cls(t[0].cast<std::size_t>(), t[1].cast<std::uint64_t>(),
+                                                t[2].cast<std::uint8_t>(), t[4].cast<float>(),
+                                                kDefaultRngEngine, small[0].cast<std::size_t>()), small);
+                }
+            }
             if (t.size() != 5) throw std::runtime_error("Invalid pickle state!");
             return Cls(t[0].cast<std::size_t>(),
                        t[1].cast<std::uint64_t>(),
@@ -106,6 +331,13 @@ void bind_pickle_log_exp(py::class_<Cls, Bases...>& cls) {
     ));
 }
 
+// Pickle states written before HashScheme existed have no trailing version field;
+// they restore as v1 so their bucket mapping (and mergeability) is preserved.
+inline HashScheme hash_scheme_from_state(const py::tuple& t, std::size_t legacy_size) {
+    return t.size() == legacy_size ? HashScheme::MODULO_TWO_HASHES
+                                   : hash_scheme_from_int(t[legacy_size].cast<int>());
+}
+
 // ─── Family binders ──────────────────────────────────────────────────────────
 
 // ExpSketch family: (m, seed) ctor, Jaccard + merge + regs pickle
@@ -114,9 +346,93 @@ void bind_jaccard_sketch(py::module_& m, const char* name) {
     auto cls = py::class_<Cls, CardinalitySketch, WeightedMixin, MergeableMixin, JaccardMixin>(m, name)
         .def(py::init<std::size_t, std::uint64_t>(), py::arg("m"), py::arg("seed"));
     bind_sketch_base(cls)
-        .def("jaccard_struct", &Cls::jaccard_struct)
-        .def("merge", &Cls::merge, py::arg("other"));
+        .def("jaccard_struct", &Cls::jaccard_struct, release_gil())
+        .def("merge", &Cls::merge, py::arg("other"), release_gil());
+    bind_pickle_regs<Cls, RegT>(cls);
+}
+
+// FastExpSketchT<RegT>: small mode, merge, snapshot
+template <typename Cls, typename RegT>
+void bind_fast_exp_sketch(py::module_& m, const char* name) {
+    auto cls = py::class_<Cls, CardinalitySketch, WeightedMixin, MergeableMixin, JaccardMixin>(m, name)
+        .def(py::init<std::size_t, std::uint64_t, RngEngine, std::size_t>(),
+             py::arg("m"), py::arg("seed"), py::arg("rng_engine") = kDefaultRngEngine,
+             py::arg("small_capacity") = 0);
+    bind_small_mode(cls);
+    bind_sketch_base(cls)
+        .def("jaccard_struct", &Cls::jaccard_struct, release_gil())
+        .def("merge", &Cls::merge, py::arg("other"), release_gil())
+        .def("snapshot", &Cls::snapshot);
     bind_pickle_regs<Cls, RegT>(cls);
+    if constexpr (std::is_floating_point_v<RegT>) {
+        bind_wire(cls);
+        bind_delta(cls);
+        bind_checkpoint_recovery(cls);
+    }
+}
+
+// union_estimate / intersection_estimate / difference_estimate, overloaded per class
+template <typename Cls>
+void bind_set_operations(py::module_& m) {
+    m.def("union_estimate", &union_estimate<Cls>, py::arg("a"), py::arg("b"), release_gil());
+    m.def("intersection_estimate", &intersection_estimate<Cls>, py::arg("a"), py::arg("b"), release_gil());
+    m.def("difference_estimate", &difference_estimate<Cls>, py::arg("a"), py::arg("b"), release_gil());
+}
+
+// KeyedSketchMap(prototype) is overloaded per sketch class; each overload
+// returns that class's map, registered as map_name.
+template <typename Cls>
+void bind_keyed_sketch_map(py::module_& m, const char* map_name) {
+    using Map = KeyedSketchMap<Cls>;
+    auto sketch_for = [](const Map& self, const std::string& key) -> const Cls& {
+        const Cls* sketch = self.find(key);
+        if (sketch == nullptr) throw py::key_error(key);
+        return *sketch;
+    };
+    py::class_<Map>(m, map_name)
+        .def("add", &Map::add, py::arg("key"), py::arg("x"), py::arg("weight") = 1.0)
+        .def("add_many", static_cast<void (Map::*)(const std::vector<std::string>&, const std::vector<std::string>&, const std::vector<double>&)>(&Map::template add_many<std::string>),
+             py::arg("keys"), py::arg("elems"), py::arg("weights"), release_gil())
+        .def("estimate", [sketch_for](const Map& self, const std::string& key) {
+            return sketch_for(self, key).estimate();
+        }, py::arg("key"))
+        .def("estimate_all", [](const Map& self) {
+            std::vector<double> estimates;
+            {
+                py::gil_scoped_release release;
+                estimates = self.estimate_all();
+            }
+            return py::array_t<double>(static_cast<py::ssize_t>(estimates.size()), estimates.data());
+        })
+        .def("get", [sketch_for](const Map& self, const std::string& key) {
+            return Cls(sketch_for(self, key));
+        }, py::arg("key"))
+        .def("merge", &Map::merge, py::arg("other"), release_gil())
+        .def("keys", &Map::keys)
+        .def("__contains__", [](const Map& self, const std::string& key) { return self.find(key) != nullptr; })
+        .def("__len__", &Map::size);
+    m.def("KeyedSketchMap", [](const Cls& prototype) { return Map(prototype); }, py::arg("prototype"));
+}
+
+// IngestPipeline(sketch, ...) is overloaded per non-mergeable sketch class;
+// each overload returns that class's pipeline, registered as pipeline_name.
+// The pipeline keeps its sketch alive and writes to it in place.
+template <typename Cls>
+void bind_ingest_pipeline(py::module_& m, const char* pipeline_name) {
+    using Pipeline = IngestPipeline<Cls>;
+    auto cls = py::class_<Pipeline>(m, pipeline_name);
+    if constexpr (std::is_base_of_v<Sketch, Cls>) {
+        cls.def("add_many", static_cast<void (Pipeline::*)(const std::vector<std::string>&, const std::vector<double>&)>(&Pipeline::add_many),
+                py::arg("elems"), py::arg("weights"), release_gil());
+    }
+    cls.def("add_many", static_cast<void (Pipeline::*)(const std::vector<std::string>&)>(&Pipeline::add_many),
+            py::arg("elems"), release_gil())
+        .def_property_readonly("producers", &Pipeline::producers)
+        .def_property_readonly("ring_capacity", &Pipeline::ring_capacity);
+    m.def("IngestPipeline", [](Cls& sketch, std::size_t producers, std::size_t ring_capacity) {
+        return Pipeline(sketch, producers, ring_capacity);
+    }, py::arg("sketch"), py::arg("producers") = 0, py::arg("ring_capacity") = Pipeline::kDefaultRingCapacity,
+       py::keep_alive<0, 1>());
 }
 
 // WeightedMinHash: (m, seed) ctor, merge only, regs pickle
@@ -125,13 +441,62 @@ void bind_mergeable_sketch(py::module_& m, const char* name) {
     auto cls = py::class_<Cls, CardinalitySketch, WeightedMixin, MergeableMixin>(m, name)
         .def(py::init<std::size_t, std::uint64_t>(), py::arg("m"), py::arg("seed"));
     bind_sketch_base(cls)
-        .def("merge", &Cls::merge, py::arg("other"));
+        .def("merge", &Cls::merge, py::arg("other"), release_gil());
     bind_pickle_regs<Cls, RegT>(cls);
 }
 
+// WeightedHyperLogLog family: (m, seed, hash_scheme) ctor, merge only
+// Shape: (m, master_seed, registers, hash_scheme)
+template <typename Cls, typename RegT>
+void bind_weighted_hll_sketch(py::module_& m, const char* name) {
+    auto cls = py::class_<Cls, CardinalitySketch, WeightedMixin, MergeableMixin>(m, name)
+        .def(py::init<std::size_t, std::uint64_t, HashScheme>(),
+             py::arg("m"), py::arg("seed"), py::arg("hash_scheme") = kDefaultHashScheme);
+    bind_sketch_base(cls)
+        .def("merge", &Cls::merge, py::arg("other"), release_gil())
+        .def_property_readonly("hash_scheme", &Cls::get_hash_scheme);
+    cls.def(py::pickle(
+        [](const Cls& p) {
+            return py::make_tuple(p.get_sketch_size(), p.get_master_seed(), p.get_registers(),
+                                  static_cast<int>(p.get_hash_scheme()));
+        },
+        [](const py::tuple& t) {
+            if (t.size() != 3 && t.size() != 4) throw std::runtime_error("Invalid pickle state!");
+            return Cls(t[0].cast<std::size_t>(),
+                       t[1].cast<std::uint64_t>(),
+                       t[2].cast<std::vector<RegT>>(),
+                       hash_scheme_from_state(t, 3));
+        }
+    ));
+}
+
 // ─── Module definition ───────────────────────────────────────────────────────
 
-PYBIND11_MODULE(_core, m) {
+PYBIND11_MODULE(_core, m, py::mod_gil_not_used()) {
+
+    // ── Hot-path stats (compiled in with WCE_STATS) ──────────────────────────
+    m.attr("STATS_ENABLED") = kStatsEnabled;
+    py::class_<HotPathStats>(m, "HotPathStats")
+        .def_readonly("adds",              &HotPathStats::adds)
+        .def_readonly("iterations",        &HotPathStats::iterations)
+        .def_readonly("early_exits",       &HotPathStats::early_exits)
+        .def_readonly("register_updates",  &HotPathStats::register_updates)
+        .def_readonly("threshold_rescans", &HotPathStats::threshold_rescans)
+        .def_readonly("window_shifts",     &HotPathStats::window_shifts)
+        .def_property_readonly("iterations_per_add", [](const HotPathStats& s) {
+            return s.adds == 0 ? 0.0 : static_cast<double>(s.iterations) / static_cast<double>(s.adds);
+        })
+        .def_property_readonly("prune_rate", [](const HotPathStats& s) {
+            return s.adds == 0 ? 0.0 : static_cast<double>(s.early_exits) / static_cast<double>(s.adds);
+        })
+        .def("__repr__", [](const HotPathStats& s) {
+            return "HotPathStats(adds=" + std::to_string(s.adds)
+                 + ", iterations=" + std::to_string(s.iterations)
+                 + ", early_exits=" + std::to_string(s.early_exits)
+                 + ", register_updates=" + std::to_string(s.register_updates)
+                 + ", threshold_rescans=" + std::to_string(s.threshold_rescans)
+                 + ", window_shifts=" + std::to_string(s.window_shifts) + ")";
+        });
 
     // ── Base marker classes ──────────────────────────────────────────────────
     py::class_<CardinalitySketch>(m, "CardinalitySketch")
@@ -140,11 +505,16 @@ PYBIND11_MODULE(_core, m) {
         }, py::arg("x"))
         .def("add_many", [](CardinalitySketch& self, const std::vector<std::string>& elems) {
             static_cast<SketchBase&>(self).add_many(elems);
-        }, py::arg("elems"))
-        .def("estimate",              [](const CardinalitySketch& self) { return static_cast<const SketchBase&>(self).estimate(); })
+        }, py::arg("elems"), release_gil())
+        .def("estimate",              [](const CardinalitySketch& self) { return static_cast<const SketchBase&>(self).estimate(); }, release_gil())
         .def("memory_usage", [](const CardinalitySketch& self, uint64_t flags) {
             return static_cast<const SketchBase&>(self).memory_usage(flags);
-        }, py::arg("flags"));
+        }, py::arg("flags"))
+        .def("stats", [](const CardinalitySketch& self) {
+            if (!kStatsEnabled) throw std::runtime_error("stats() needs a build with -DWCE_ENABLE_STATS=ON");
+            return static_cast<const SketchBase&>(self).stats();
+        })
+        .def("reset_stats", [](CardinalitySketch& self) { static_cast<SketchBase&>(self).reset_stats(); });
     py::class_<WeightedMixin>(m, "WeightedMixin");
     py::class_<MergeableMixin>(m, "MergeableMixin");
     py::class_<JaccardMixin>(m, "JaccardMixin");
@@ -168,50 +538,46 @@ PYBIND11_MODULE(_core, m) {
         .value("XOSHIRO128PP", RngEngine::XOSHIRO128PP)
         .value("XOSHIRO256PP", RngEngine::XOSHIRO256PP);
 
+    // ── HashScheme enum ──────────────────────────────────────────────────────
+    py::enum_<HashScheme>(m, "HashScheme")
+        .value("MODULO_TWO_HASHES", HashScheme::MODULO_TWO_HASHES)
+        .value("MULTIPLY_HIGH_128", HashScheme::MULTIPLY_HIGH_128);
+
     // ── ExpSketch family ─────────────────────────────────────────────────────
     bind_jaccard_sketch<ExpSketchT<double>, double>(m, "ExpSketch");
     bind_jaccard_sketch<ExpSketchT<float>,  float >(m, "ExpSketchFloat32");
-    {
-        using Cls = FastExpSketchT<float>;
-        auto cls = py::class_<Cls, CardinalitySketch, WeightedMixin, MergeableMixin, JaccardMixin>(m, "FastExpSketchFloat32")
-            .def(py::init<std::size_t, std::uint64_t, RngEngine>(),
-                 py::arg("m"), py::arg("seed"), py::arg("rng_engine") = kDefaultRngEngine);
-        bind_sketch_base(cls)
-            .def("jaccard_struct", &Cls::jaccard_struct)
-            .def("merge", &Cls::merge, py::arg("other"));
-        bind_pickle_regs<Cls, float>(cls);
-    }
-    {
-        using Cls = FastExpSketchT<double>;
-        auto cls = py::class_<Cls, CardinalitySketch, WeightedMixin, MergeableMixin, JaccardMixin>(m, "FastExpSketch")
-            .def(py::init<std::size_t, std::uint64_t, RngEngine>(),
-                 py::arg("m"), py::arg("seed"), py::arg("rng_engine") = kDefaultRngEngine);
-        bind_sketch_base(cls)
-            .def("jaccard_struct", &Cls::jaccard_struct)
-            .def("merge", &Cls::merge, py::arg("other"));
-        bind_pickle_regs<Cls, double>(cls);
-    }
+    bind_fast_exp_sketch<FastExpSketchT<float>, float>(m, "FastExpSketchFloat32");
+    bind_fast_exp_sketch<FastExpSketchFloat16, Float16>(m, "FastExpSketchFloat16");
+    bind_fast_exp_sketch<FastExpSketchBFloat16, BFloat16>(m, "FastExpSketchBFloat16");
+    bind_fast_exp_sketch<FastExpSketchT<double>, double>(m, "FastExpSketch");
     {
         using Cls = FastGMExpSketch;
         auto cls = py::class_<Cls, CardinalitySketch, WeightedMixin, MergeableMixin, JaccardMixin>(m, "FastGMExpSketch")
             .def(py::init<std::size_t, std::uint64_t, RngEngine>(),
                  py::arg("m"), py::arg("seed"), py::arg("rng_engine") = kDefaultRngEngine);
         bind_sketch_base(cls)
-            .def("jaccard_struct", &Cls::jaccard_struct)
-            .def("merge", &Cls::merge, py::arg("other"));
+            .def("jaccard_struct", &Cls::jaccard_struct, release_gil())
+            .def("merge", &Cls::merge, py::arg("other"), release_gil());
         bind_pickle_regs<Cls, double>(cls);
     }
+    bind_set_operations<ExpSketchT<double>>(m);
+    bind_set_operations<ExpSketchT<float>>(m);
+    bind_set_operations<FastExpSketchT<float>>(m);
+    bind_set_operations<FastExpSketchT<double>>(m);
+    bind_set_operations<FastExpSketchFloat16>(m);
+    bind_set_operations<FastExpSketchBFloat16>(m);
+    bind_set_operations<FastGMExpSketch>(m);
     bind_mergeable_sketch<WeightedMinHash, double>(m, "WeightedMinHash");
-    bind_mergeable_sketch<WeightedHyperLogLog, double>(m, "WeightedHyperLogLog");
-    bind_mergeable_sketch<WeightedHyperLogLogFloat32, float>(m, "WeightedHyperLogLogFloat32");
+    bind_weighted_hll_sketch<WeightedHyperLogLog, double>(m, "WeightedHyperLogLog");
+    bind_weighted_hll_sketch<WeightedHyperLogLogFloat32, float>(m, "WeightedHyperLogLogFloat32");
 
     {
         using Cls = MinHash;
         auto cls = py::class_<Cls, CardinalitySketch, MergeableMixin, JaccardMixin>(m, "MinHash")
             .def(py::init<std::size_t, std::uint64_t>(), py::arg("m"), py::arg("seed"));
         bind_unweighted_base(cls)
-            .def("jaccard_struct", &Cls::jaccard_struct)
-            .def("merge", &Cls::merge, py::arg("other"));
+            .def("jaccard_struct", &Cls::jaccard_struct, release_gil())
+            .def("merge", &Cls::merge, py::arg("other"), release_gil());
         bind_pickle_regs<Cls, double>(cls);
     }
 
@@ -241,7 +607,7 @@ PYBIND11_MODULE(_core, m) {
         auto cls = py::class_<Cls, CardinalitySketch, MergeableMixin>(m, "HyperLogLog")
             .def(py::init<std::size_t, std::uint64_t>(), py::arg("m"), py::arg("seed"));
         bind_unweighted_base(cls)
-            .def("merge", &Cls::merge, py::arg("other"));
+            .def("merge", &Cls::merge, py::arg("other"), release_gil());
         cls.def(py::pickle(
             [](const Cls& p) {
                 return py::make_tuple(p.get_sketch_size(), p.get_master_seed(), p.get_registers());
@@ -253,41 +619,51 @@ PYBIND11_MODULE(_core, m) {
                            t[2].cast<std::vector<uint8_t>>());
             }
         ));
+        bind_wire(cls);
     }
 
     // ── QSketch family ───────────────────────────────────────────────────────
     {
         using Cls = QSketch;
-        auto cls = py::class_<Cls, CardinalitySketch, WeightedMixin, MergeableMixin>(m, "QSketch")
-            .def(py::init<std::size_t, std::uint64_t, std::uint8_t, RngEngine>(),
-                 py::arg("m"), py::arg("seed"), py::arg("amount_bits"), py::arg("rng_engine") = kDefaultRngEngine);
+        auto cls = py::class_<Cls, CardinalitySketch, WeightedMixin, MergeableMixin, JaccardMixin>(m, "QSketch")
+            .def(py::init<std::size_t, std::uint64_t, std::uint8_t, RngEngine, std::size_t>(),
+                 py::arg("m"), py::arg("seed"), py::arg("amount_bits"), py::arg("rng_engine") = kDefaultRngEngine,
+                 py::arg("small_capacity") = 0);
+        bind_small_mode(cls);
         bind_sketch_base(cls)
-            .def("merge", &Cls::merge, py::arg("other"));
+            .def("merge", &Cls::merge, py::arg("other"), release_gil())
+            .def("jaccard_struct", &Cls::jaccard_struct, release_gil());
         bind_pickle_q(cls);
+        bind_wire(cls);
+        bind_checkpoint_recovery(cls);
     }
 
     {
         using Cls = QSketchDyn;
         auto cls = py::class_<Cls, CardinalitySketch, WeightedMixin>(m, "QSketchDyn")
-            .def(py::init<std::size_t, std::uint64_t, std::uint8_t, std::uint32_t>(),
-                 py::arg("m"), py::arg("seed"), py::arg("amount_bits"), py::arg("g_seed") = 42);
+            .def(py::init<std::size_t, std::uint64_t, std::uint8_t, std::uint32_t, HashScheme>(),
+                 py::arg("m"), py::arg("seed"), py::arg("amount_bits"), py::arg("g_seed") = 42,
+                 py::arg("hash_scheme") = kDefaultHashScheme);
         bind_sketch_base(cls)
+            .def_property_readonly("hash_scheme", &Cls::get_hash_scheme)
             .def(py::pickle(
                 [](const Cls& p) {
                     return py::make_tuple(
                         p.get_sketch_size(), p.get_amount_bits(), p.get_g_seed(),
                         p.get_master_seed(), p.get_registers(),
-                        p.get_t_histogram(), p.get_cardinality());
+                        p.get_t_histogram(), p.get_cardinality(),
+                        static_cast<int>(p.get_hash_scheme()));
                 },
                 [](const py::tuple& t) {
-                    if (t.size() != 7) throw std::runtime_error("Invalid pickle state!");
+                    if (t.size() != 7 && t.size() != 8) throw std::runtime_error("Invalid pickle state!");
                     return Cls(t[0].cast<std::size_t>(),
                                t[1].cast<std::uint8_t>(),
                                t[2].cast<std::uint32_t>(),
                                t[3].cast<std::uint64_t>(),
                                t[4].cast<std::vector<int>>(),
                                t[5].cast<std::vector<std::uint32_t>>(),
-                               t[6].cast<double>());
+                               t[6].cast<double>(),
+                               hash_scheme_from_state(t, 7));
                 }
             ));
     }
@@ -295,32 +671,39 @@ PYBIND11_MODULE(_core, m) {
     // ── kQSketch family ─────────────────────────────────────────────────────
     {
         using Cls = kQSketch;
-        auto cls = py::class_<Cls, CardinalitySketch, WeightedMixin, MergeableMixin, NewtonMixin>(m, "kQSketch")
-            .def(py::init<std::size_t, std::uint64_t, std::uint8_t, float, RngEngine>(),
-                 py::arg("m"), py::arg("seed"), py::arg("amount_bits"), py::arg("logarithm_base"), py::arg("rng_engine") = kDefaultRngEngine);
+        auto cls = py::class_<Cls, CardinalitySketch, WeightedMixin, MergeableMixin, JaccardMixin, NewtonMixin>(m, "kQSketch")
+            .def(py::init<std::size_t, std::uint64_t, std::uint8_t, float, RngEngine, std::size_t>(),
+                 py::arg("m"), py::arg("seed"), py::arg("amount_bits"), py::arg("logarithm_base"),
+                 py::arg("rng_engine") = kDefaultRngEngine, py::arg("small_capacity") = 0);
+        bind_small_mode(cls);
         bind_sketch_base(cls)
-            .def("merge", &Cls::merge, py::arg("other"))
-            .def("estimate_direct", &Cls::estimate_direct)
-            .def("estimate_newton_cold", &Cls::estimate_newton_cold)
-            .def("estimate_newton_warm", &Cls::estimate_newton_warm)
-            .def("estimate_newton_cold_iterations", &Cls::estimate_newton_cold_iterations)
-            .def("estimate_newton_warm_iterations", &Cls::estimate_newton_warm_iterations);
+            .def("merge", &Cls::merge, py::arg("other"), release_gil())
+            .def("jaccard_struct", &Cls::jaccard_struct, release_gil())
+            .def("estimate_direct", &Cls::estimate_direct, release_gil())
+            .def("estimate_newton_cold", &Cls::estimate_newton_cold, release_gil())
+            .def("estimate_newton_warm", &Cls::estimate_newton_warm, release_gil())
+            .def("estimate_newton_cold_iterations", &Cls::estimate_newton_cold_iterations, release_gil())
+            .def("estimate_newton_warm_iterations", &Cls::estimate_newton_warm_iterations, release_gil());
         bind_pickle_log_exp(cls);
+        bind_wire(cls);
+        bind_delta(cls);
+        bind_checkpoint_recovery(cls);
     }
 
     {
         using Cls = kQSketchRounding;
-        auto cls = py::class_<Cls, CardinalitySketch, WeightedMixin, MergeableMixin, NewtonMixin>(m, "kQSketchRounding")
+        auto cls = py::class_<Cls, CardinalitySketch, WeightedMixin, MergeableMixin, JaccardMixin, NewtonMixin>(m, "kQSketchRounding")
             .def(py::init<std::size_t, std::uint64_t, std::uint8_t, float, RngEngine>(),
                  py::arg("m"), py::arg("seed"), py::arg("amount_bits"), py::arg("logarithm_base"), py::arg("rng_engine") = kDefaultRngEngine);
         bind_sketch_base(cls)
-            .def("merge", &Cls::merge, py::arg("other"))
-            .def("estimate_corrected", &Cls::estimate_corrected)
-            .def("estimate_direct", &Cls::estimate_direct)
-            .def("estimate_newton_cold", &Cls::estimate_newton_cold)
-            .def("estimate_newton_warm", &Cls::estimate_newton_warm)
-            .def("estimate_newton_cold_iterations", &Cls::estimate_newton_cold_iterations)
-            .def("estimate_newton_warm_iterations", &Cls::estimate_newton_warm_iterations);
+            .def("merge", &Cls::merge, py::arg("other"), release_gil())
+            .def("jaccard_struct", &Cls::jaccard_struct, release_gil())
+            .def("estimate_corrected", &Cls::estimate_corrected, release_gil())
+            .def("estimate_direct", &Cls::estimate_direct, release_gil())
+            .def("estimate_newton_cold", &Cls::estimate_newton_cold, release_gil())
+            .def("estimate_newton_warm", &Cls::estimate_newton_warm, release_gil())
+            .def("estimate_newton_cold_iterations", &Cls::estimate_newton_cold_iterations, release_gil())
+            .def("estimate_newton_warm_iterations", &Cls::estimate_newton_warm_iterations, release_gil());
         bind_pickle_log_exp(cls);
     }
 
@@ -328,23 +711,26 @@ PYBIND11_MODULE(_core, m) {
     {
         using Cls = kQSketchRoundedDyn;
         auto cls = py::class_<Cls, CardinalitySketch, WeightedMixin, NewtonMixin>(m, "kQSketchRoundedDyn")
-            .def(py::init<std::size_t, std::uint64_t, std::uint8_t, float, std::uint32_t>(),
-                 py::arg("m"), py::arg("seed"), py::arg("amount_bits"), py::arg("logarithm_base"), py::arg("g_seed") = 42);
+            .def(py::init<std::size_t, std::uint64_t, std::uint8_t, float, std::uint32_t, HashScheme>(),
+                 py::arg("m"), py::arg("seed"), py::arg("amount_bits"), py::arg("logarithm_base"), py::arg("g_seed") = 42,
+                 py::arg("hash_scheme") = kDefaultHashScheme);
         bind_sketch_base(cls)
-            .def("estimate_direct", &Cls::estimate_direct)
-            .def("estimate_newton_cold", &Cls::estimate_newton_cold)
-            .def("estimate_newton_warm", &Cls::estimate_newton_warm)
-            .def("estimate_newton_cold_iterations", &Cls::estimate_newton_cold_iterations)
-            .def("estimate_newton_warm_iterations", &Cls::estimate_newton_warm_iterations)
+            .def_property_readonly("hash_scheme", &Cls::get_hash_scheme)
+            .def("estimate_direct", &Cls::estimate_direct, release_gil())
+            .def("estimate_newton_cold", &Cls::estimate_newton_cold, release_gil())
+            .def("estimate_newton_warm", &Cls::estimate_newton_warm, release_gil())
+            .def("estimate_newton_cold_iterations", &Cls::estimate_newton_cold_iterations, release_gil())
+            .def("estimate_newton_warm_iterations", &Cls::estimate_newton_warm_iterations, release_gil())
             .def(py::pickle(
                 [](const Cls& p) {
                     return py::make_tuple(
                         p.get_sketch_size(), p.get_amount_bits(), p.get_logarithm_base(),
                         p.get_g_seed(), p.get_master_seed(), p.get_registers(),
-                        p.get_t_histogram(), p.get_cardinality());
+                        p.get_t_histogram(), p.get_cardinality(),
+                        static_cast<int>(p.get_hash_scheme()));
                 },
                 [](const py::tuple& t) {
-                    if (t.size() != 8) throw std::runtime_error("Invalid pickle state!");
+                    if (t.size() != 8 && t.size() != 9) throw std::runtime_error("Invalid pickle state!");
                     return Cls(t[0].cast<std::size_t>(),
                                t[1].cast<std::uint8_t>(),
                                t[2].cast<float>(),
@@ -352,7 +738,8 @@ PYBIND11_MODULE(_core, m) {
                                t[4].cast<std::uint64_t>(),
                                t[5].cast<std::vector<int>>(),
                                t[6].cast<std::vector<std::uint32_t>>(),
-                               t[7].cast<double>());
+                               t[7].cast<double>(),
+                               hash_scheme_from_state(t, 8));
                 }
             ));
     }
@@ -365,13 +752,13 @@ PYBIND11_MODULE(_core, m) {
             .def(py::init<std::size_t, std::uint64_t, std::uint8_t, float, RngEngine>(),
                  py::arg("m"), py::arg("seed"), py::arg("amount_bits"), py::arg("logarithm_base"), py::arg("rng_engine") = kDefaultRngEngine);
         bind_sketch_base(cls)
-            .def("merge", &Cls::merge, py::arg("other"))
+            .def("merge", &Cls::merge, py::arg("other"), release_gil())
             .def("get_offset", &Cls::get_offset)
-            .def("estimate_direct", &Cls::estimate_direct)
-            .def("estimate_newton_cold", &Cls::estimate_newton_cold)
-            .def("estimate_newton_warm", &Cls::estimate_newton_warm)
-            .def("estimate_newton_cold_iterations", &Cls::estimate_newton_cold_iterations)
-            .def("estimate_newton_warm_iterations", &Cls::estimate_newton_warm_iterations);
+            .def("estimate_direct", &Cls::estimate_direct, release_gil())
+            .def("estimate_newton_cold", &Cls::estimate_newton_cold, release_gil())
+            .def("estimate_newton_warm", &Cls::estimate_newton_warm, release_gil())
+            .def("estimate_newton_cold_iterations", &Cls::estimate_newton_cold_iterations, release_gil())
+            .def("estimate_newton_warm_iterations", &Cls::estimate_newton_warm_iterations, release_gil());
         cls.def(py::pickle(
             [](const Cls& p) {
                 return py::make_tuple(p.get_sketch_size(), p.get_master_seed(),
@@ -397,6 +784,38 @@ PYBIND11_MODULE(_core, m) {
         .value("LINEAR",          QuantizationMode::LINEAR)
         .value("LOGARITHMIC",     QuantizationMode::LOGARITHMIC);
 
+    m.def("quantize_custom_float", &quantize_custom_float,
+          py::arg("value"), py::arg("sign_bits"), py::arg("exp_bits"), py::arg("mant_bits"),
+          py::arg("mode") = QuantizationMode::WITH_SUBNORMALS);
+
+    // ── CustomFloatFormat ────────────────────────────────────────────────────
+    {
+        using Cls = CustomFloatFormat;
+        py::class_<Cls>(m, "CustomFloatFormat")
+            .def(py::init<int, int>(), py::arg("exp_bits"), py::arg("mant_bits"))
+            .def_property_readonly("exp_bits",  &Cls::exp_bits)
+            .def_property_readonly("mant_bits", &Cls::mant_bits)
+            .def_property_readonly("max_code",  &Cls::max_code)
+            .def_property_readonly("max_value", &Cls::max_value)
+            .def_property_readonly("min_value", &Cls::min_value)
+            .def("encode",   &Cls::encode, py::arg("value"))
+            .def("decode", [](const Cls& self, std::uint64_t code) {
+                if (code > self.max_code()) throw std::invalid_argument("Code out of range for this format.");
+                return self.decode(code);
+            }, py::arg("code"))
+            .def("quantize", &Cls::quantize, py::arg("value"))
+            .def("encode_many", [](const Cls& self, const std::vector<double>& values) {
+                std::vector<std::uint64_t> codes(values.size());
+                self.encode_batch(values.data(), codes.data(), values.size());
+                return codes;
+            }, py::arg("values"))
+            .def("quantize_many", [](const Cls& self, const std::vector<double>& values) {
+                std::vector<double> out(values.size());
+                self.quantize_batch(values.data(), out.data(), values.size());
+                return out;
+            }, py::arg("values"));
+    }
+
     // ── LogExpSketchSlowNoShifted ─────────────────────────────────────────────────────────
     {
         using Cls = LogExpSketchSlowNoShifted;
@@ -404,8 +823,8 @@ PYBIND11_MODULE(_core, m) {
             .def(py::init<std::size_t, std::uint64_t, std::uint8_t, double>(),
                  py::arg("m"), py::arg("seed"), py::arg("amount_bits"), py::arg("v_max"));
         bind_sketch_base(cls)
-            .def("jaccard_struct", &Cls::jaccard_struct)
-            .def("merge", &Cls::merge, py::arg("other"));
+            .def("jaccard_struct", &Cls::jaccard_struct, release_gil())
+            .def("merge", &Cls::merge, py::arg("other"), release_gil());
         cls.def(py::pickle(
             [](const Cls& p) {
                 return py::make_tuple(p.get_sketch_size(), p.get_master_seed(),
@@ -430,8 +849,8 @@ PYBIND11_MODULE(_core, m) {
             .def(py::init<std::size_t, std::uint64_t, std::uint8_t, double>(),
                  py::arg("m"), py::arg("seed"), py::arg("amount_bits"), py::arg("v_max"));
         bind_sketch_base(cls)
-            .def("jaccard_struct", &Cls::jaccard_struct)
-            .def("merge", &Cls::merge, py::arg("other"))
+            .def("jaccard_struct", &Cls::jaccard_struct, release_gil())
+            .def("merge", &Cls::merge, py::arg("other"), release_gil())
             .def("get_offset", &Cls::get_offset);
         cls.def(py::pickle(
             [](const Cls& p) {
@@ -455,27 +874,31 @@ PYBIND11_MODULE(_core, m) {
     {
         using Cls = WeightedHyperLogLogCustomFloat;
         auto cls = py::class_<Cls, CardinalitySketch, WeightedMixin, MergeableMixin>(m, "WeightedHyperLogLogCustomFloat")
-            .def(py::init<std::size_t, std::uint64_t, int, int>(),
+            .def(py::init<std::size_t, std::uint64_t, int, int, HashScheme>(),
                  py::arg("m"), py::arg("seed"),
-                 py::arg("exp_bits"), py::arg("mant_bits"));
+                 py::arg("exp_bits"), py::arg("mant_bits"),
+                 py::arg("hash_scheme") = kDefaultHashScheme);
         bind_sketch_base(cls)
-            .def("merge", &Cls::merge, py::arg("other"))
+            .def("merge", &Cls::merge, py::arg("other"), release_gil())
             .def_property_readonly("exp_bits",  &Cls::get_exp_bits)
             .def_property_readonly("mant_bits", &Cls::get_mant_bits)
+            .def_property_readonly("hash_scheme", &Cls::get_hash_scheme)
             .def(py::pickle(
                 [](const Cls& p) {
                     return py::make_tuple(
                         p.get_sketch_size(), p.get_master_seed(),
                         p.get_exp_bits(), p.get_mant_bits(),
-                        p.get_registers());
+                        p.get_registers(),
+                        static_cast<int>(p.get_hash_scheme()));
                 },
                 [](const py::tuple& t) {
-                    if (t.size() != 5) throw std::runtime_error("Invalid pickle state!");
+                    if (t.size() != 5 && t.size() != 6) throw std::runtime_error("Invalid pickle state!");
                     return Cls(t[0].cast<std::size_t>(),
                                t[1].cast<std::uint64_t>(),
                                t[2].cast<int>(),
                                t[3].cast<int>(),
-                               t[4].cast<std::vector<double>>());
+                               t[4].cast<std::vector<double>>(),
+                               hash_scheme_from_state(t, 5));
                 }
             ));
     }
@@ -489,8 +912,8 @@ PYBIND11_MODULE(_core, m) {
                  py::arg("exp_bits"), py::arg("mant_bits"),
                  py::arg("rng_engine") = kDefaultRngEngine);
         bind_sketch_base(cls)
-            .def("jaccard_struct", &Cls::jaccard_struct)
-            .def("merge",      &Cls::merge, py::arg("other"))
+            .def("jaccard_struct", &Cls::jaccard_struct, release_gil())
+            .def("merge",      &Cls::merge, py::arg("other"), release_gil())
             .def("clone_with", &Cls::clone_with, py::arg("exp_bits"), py::arg("mant_bits"))
             .def_property_readonly("exp_bits",  &Cls::get_exp_bits)
             .def_property_readonly("mant_bits", &Cls::get_mant_bits)
@@ -519,8 +942,9 @@ PYBIND11_MODULE(_core, m) {
             .def(py::init<std::size_t, std::uint64_t, std::uint8_t, double, RngEngine>(),
                  py::arg("m"), py::arg("seed"), py::arg("amount_bits"), py::arg("v_max"), py::arg("rng_engine") = kDefaultRngEngine);
         bind_sketch_base(cls)
-            .def("jaccard_struct", &Cls::jaccard_struct)
-            .def("merge", &Cls::merge, py::arg("other"));
+            .def("jaccard_struct", &Cls::jaccard_struct, release_gil())
+            .def("merge", &Cls::merge, py::arg("other"), release_gil());
+        bind_wire(cls);
         cls.def(py::pickle(
             [](const Cls& p) {
                 return py::make_tuple(p.get_sketch_size(), p.get_master_seed(),
@@ -545,8 +969,8 @@ PYBIND11_MODULE(_core, m) {
             .def(py::init<std::size_t, std::uint64_t, std::uint8_t, double, RngEngine>(),
                  py::arg("m"), py::arg("seed"), py::arg("amount_bits"), py::arg("v_max"), py::arg("rng_engine") = kDefaultRngEngine);
         bind_sketch_base(cls)
-            .def("jaccard_struct", &Cls::jaccard_struct)
-            .def("merge", &Cls::merge, py::arg("other"))
+            .def("jaccard_struct", &Cls::jaccard_struct, release_gil())
+            .def("merge", &Cls::merge, py::arg("other"), release_gil())
             .def("get_offset", &Cls::get_offset);
         cls.def(py::pickle(
             [](const Cls& p) {
@@ -565,4 +989,185 @@ PYBIND11_MODULE(_core, m) {
             }
         ));
     }
+
+    // ── SketchGroup ──────────────────────────────────────────────────────────
+    // Members are owned by the group; reference_internal keeps it alive while they are in use.
+    {
+        using Cls = SketchGroup;
+        py::class_<Cls>(m, "SketchGroup")
+            .def(py::init<std::size_t, std::uint64_t, RngEngine>(),
+                 py::arg("m"), py::arg("seed"), py::arg("rng_engine") = kDefaultRngEngine)
+            .def("make_fast_exp_sketch", &Cls::make_fast_exp_sketch,
+                 py::return_value_policy::reference_internal)
+            .def("make_q_sketch", &Cls::make_q_sketch, py::arg("amount_bits"),
+                 py::return_value_policy::reference_internal)
+            .def("make_k_q_sketch", &Cls::make_k_q_sketch, py::arg("amount_bits"), py::arg("logarithm_base"),
+                 py::return_value_policy::reference_internal)
+            .def("make_hyper_log_log", &Cls::make_hyper_log_log,
+                 py::return_value_policy::reference_internal)
+            .def("add", &Cls::add, py::arg("x"), py::arg("weight") = 1.0)
+            .def("add_many", static_cast<void (Cls::*)(const std::vector<std::string>&, const std::vector<double>&)>(&Cls::add_many),
+                 py::arg("elems"), py::arg("weights"), release_gil())
+            .def("add_many", static_cast<void (Cls::*)(const std::vector<std::string>&)>(&Cls::add_many),
+                 py::arg("elems"), release_gil())
+            .def("__len__", &Cls::member_count);
+    }
+
+    // ── KeyedSketchMap ───────────────────────────────────────────────────────
+    bind_keyed_sketch_map<ExpSketchT<double>>(m, "KeyedExpSketchMap");
+    bind_keyed_sketch_map<FastExpSketchT<double>>(m, "KeyedFastExpSketchMap");
+    bind_keyed_sketch_map<FastExpSketchT<float>>(m, "KeyedFastExpSketchFloat32Map");
+    bind_keyed_sketch_map<FastGMExpSketch>(m, "KeyedFastGMExpSketchMap");
+    bind_keyed_sketch_map<QSketch>(m, "KeyedQSketchMap");
+    bind_keyed_sketch_map<kQSketch>(m, "KeyedkQSketchMap");
+    bind_keyed_sketch_map<kQSketchRounding>(m, "KeyedkQSketchRoundingMap");
+    bind_keyed_sketch_map<WeightedMinHash>(m, "KeyedWeightedMinHashMap");
+    bind_keyed_sketch_map<WeightedHyperLogLog>(m, "KeyedWeightedHyperLogLogMap");
+    bind_keyed_sketch_map<WeightedHyperLogLogFloat32>(m, "KeyedWeightedHyperLogLogFloat32Map");
+
+    // ── IngestPipeline ───────────────────────────────────────────────────────
+    bind_ingest_pipeline<QSketchDyn>(m, "QSketchDynPipeline");
+    bind_ingest_pipeline<kQSketchRoundedDyn>(m, "kQSketchRoundedDynPipeline");
+    bind_ingest_pipeline<MartingaleMinHash>(m, "MartingaleMinHashPipeline");
+
+    // ── QSketchPool ──────────────────────────────────────────────────────────
+    // Members are addressed by id, not exposed as objects: reset() reuses their
+    // memory. get() returns a stand-alone copy. Members share the pool's
+    // Fisher-Yates scratch, so every call takes the pool's lock, even for
+    // different ids; threads may share a pool without the GIL.
+    {
+        using Cls = LockedSketchPool<QSketch>;
+        using Lock = std::lock_guard<std::mutex>;
+        py::class_<Cls>(m, "QSketchPool")
+            .def(py::init<std::size_t, std::uint64_t, std::uint8_t>(),
+                 py::arg("m"), py::arg("seed"), py::arg("amount_bits"))
+            .def("make", [](Cls& self) {
+                Lock lock(self.mutex);
+                self.make();
+                return self.size() - 1;
+            }, release_gil())
+            .def("add", [](Cls& self, std::size_t id, const std::string& x, double weight) {
+                Lock lock(self.mutex);
+                self[id].add(x, weight);
+            }, py::arg("id"), py::arg("x"), py::arg("weight") = 1.0, release_gil())
+            .def("add_many", [](Cls& self, const std::vector<std::size_t>& ids, const std::vector<std::string>& elems,
+                                const std::vector<double>& weights) {
+                Lock lock(self.mutex);
+                self.add_many(ids, elems, weights);
+            }, py::arg("ids"), py::arg("elems"), py::arg("weights"), release_gil())
+            .def("estimate", [](Cls& self, std::size_t id) {
+                Lock lock(self.mutex);
+                return self[id].estimate();
+            }, py::arg("id"), release_gil())
+            .def("get", [](Cls& self, std::size_t id) {
+                Lock lock(self.mutex);
+                return QSketch(self[id]);
+            }, py::arg("id"), release_gil())
+            .def("reset", [](Cls& self) {
+                Lock lock(self.mutex);
+                self.reset();
+            }, release_gil())
+            .def_property_readonly("bytes_reserved", [](Cls& self) {
+                Lock lock(self.mutex);
+                return self.bytes_reserved();
+            })
+            .def("__len__", [](Cls& self) {
+                Lock lock(self.mutex);
+                return self.size();
+            }, release_gil());
+    }
+
+    // ── Aggregation over Unix domain sockets ─────────────────────────────────
+    bind_aggregation<QSketch, kQSketch, LogExpSketchFastNoShifted, FastExpSketch, FastExpSketchT<float>, HyperLogLog>(m);
+    bind_checkpoint<QSketch, kQSketch, FastExpSketch, FastExpSketchT<float>>(m);
+
+    // ── Tuner ────────────────────────────────────────────────────────────────
+    // make_sketch() hands back the concrete registered class (FastExpSketch, kQSketch, ...).
+    {
+        using Cls = TunedConfig;
+        py::class_<Cls>(m, "TunedConfig")
+            .def(py::init([](const std::string& sketch, std::size_t m, const std::map<std::string, double>& params,
+                             double rel_error, double ns_per_add, std::size_t memory_bytes, bool meets_budget) {
+                     return Cls{sketch, m, params, rel_error, ns_per_add, memory_bytes, meets_budget};
+                 }),
+                 py::arg("sketch"), py::arg("m"), py::arg("params"), py::arg("rel_error") = 0.0,
+                 py::arg("ns_per_add") = 0.0, py::arg("memory_bytes") = 0, py::arg("meets_budget") = false)
+            .def_readonly("sketch",       &Cls::sketch)
+            .def_readonly("m",            &Cls::m)
+            .def_readonly("params",       &Cls::params)
+            .def_readonly("rel_error",    &Cls::rel_error)
+            .def_readonly("ns_per_add",   &Cls::ns_per_add)
+            .def_readonly("memory_bytes", &Cls::memory_bytes)
+            .def_readonly("meets_budget", &Cls::meets_budget)
+            .def("to_json", &Cls::to_json)
+            .def("make_sketch", [](const Cls& self, std::uint64_t seed) {
+                return make_tuned_sketch(self.sketch, self.m, seed, self.params).release();
+            }, py::arg("seed") = 42, py::return_value_policy::take_ownership)
+            .def("__repr__", [](const Cls& self) { return "TunedConfig(" + self.to_json() + ")"; });
+    }
+    m.def("tune", [](const std::vector<std::string>& elems, const std::vector<double>& weights,
+                     double max_rel_error, std::size_t max_memory_bytes, double min_adds_per_sec,
+                     std::size_t trials, std::uint64_t seed) {
+        return tune(elems, weights, TunerBudget{max_rel_error, max_memory_bytes, min_adds_per_sec}, trials, seed);
+    }, py::arg("elems"), py::arg("weights"), py::arg("max_rel_error") = 0.05, py::arg("max_memory_bytes") = 0,
+       py::arg("min_adds_per_sec") = 0.0, py::arg("trials") = 5, py::arg("seed") = 42, release_gil());
+
+    // ── Accuracy trials ──────────────────────────────────────────────────────
+    {
+        using Cls = TrialResults;
+        auto as_array = [](std::vector<double> Cls::*field) {
+            return [field](const Cls& self) {
+                const std::vector<double>& v = self.*field;
+                return py::array_t<double>(static_cast<py::ssize_t>(v.size()), v.data());
+            };
+        };
+        py::class_<Cls>(m, "TrialResults")
+            .def_property_readonly("estimates",       as_array(&Cls::estimates))
+            .def_property_readonly("estimates_b",     as_array(&Cls::estimates_b))
+            .def_property_readonly("jaccard",         as_array(&Cls::jaccard))
+            .def_property_readonly("union_estimates", as_array(&Cls::union_estimates));
+    }
+    auto trials = [](const std::string& sketch, std::size_t m, const std::vector<std::string>& elems,
+                     const std::vector<double>& weights, std::size_t n_trials,
+                     const std::map<std::string, double>& params, std::size_t threads, std::uint64_t seed,
+                     const std::optional<std::vector<std::string>>& elems_b,
+                     const std::optional<std::vector<double>>& weights_b, bool jaccard, bool merge) {
+        py::gil_scoped_release release;
+        return run_trials(sketch, m, params, elems, weights, elems_b ? &*elems_b : nullptr,
+                          weights_b ? &*weights_b : nullptr, TrialOptions{n_trials, threads, seed, jaccard, merge});
+    };
+    m.def("run_trials", trials, py::arg("sketch"), py::arg("m"), py::arg("elems"), py::arg("weights"),
+          py::arg("n_trials") = 100, py::arg("params") = std::map<std::string, double>{}, py::arg("threads") = 0,
+          py::arg("seed") = 1,
+          py::arg("elems_b") = py::none(), py::arg("weights_b") = py::none(), py::arg("jaccard") = false,
+          py::arg("merge") = false);
+    m.def("run_trials", [trials](const TunedConfig& config, const std::vector<std::string>& elems,
+                                 const std::vector<double>& weights, std::size_t n_trials, std::size_t threads,
+                                 std::uint64_t seed, const std::optional<std::vector<std::string>>& elems_b,
+                                 const std::optional<std::vector<double>>& weights_b, bool jaccard, bool merge) {
+        return trials(config.sketch, config.m, elems, weights, n_trials, config.params, threads, seed,
+                      elems_b, weights_b, jaccard, merge);
+    }, py::arg("config"), py::arg("elems"), py::arg("weights"), py::arg("n_trials") = 100, py::arg("threads") = 0,
+       py::arg("seed") = 1, py::arg("elems_b") = py::none(), py::arg("weights_b") = py::none(),
+       py::arg("jaccard") = false, py::arg("merge") = false);
+
+    // ── Batched Jaccard ──────────────────────────────────────────────────────
+    m.def("jaccard_matrix", &jaccard_matrix, py::arg("sketches"), py::arg("threads") = 0, release_gil());
+    m.def("jaccard_topk", &jaccard_topk, py::arg("query"), py::arg("sketches"), py::arg("k"), py::arg("threads") = 0,
+          release_gil());
+
+    {
+        using Cls = LshIndex;
+        py::class_<Cls>(m, "LshIndex")
+            .def(py::init<std::size_t, std::size_t>(), py::arg("bands"), py::arg("rows"))
+            .def("insert", &Cls::insert, py::arg("sketch"), release_gil())
+            .def("candidates", &Cls::candidates, py::arg("query"), release_gil())
+            .def("query", &Cls::query, py::arg("query"), py::arg("threshold") = 0.0, release_gil())
+            .def("pairs", &Cls::pairs, py::arg("threshold") = 0.0, release_gil())
+            .def("save", &Cls::save, py::arg("path"), release_gil())
+            .def_static("open", &Cls::open, py::arg("path"), release_gil())
+            .def_property_readonly("bands", &Cls::bands)
+            .def_property_readonly("rows", &Cls::rows)
+            .def("__len__", &Cls::size);
+    }
 }
@@ -0,0 +1,147 @@
+#include "aggregation_client.hpp"
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "aggregation_protocol.hpp"
+#include "sketch.hpp"
+
+namespace {
+
+using aggregation::Op;
+using aggregation::put_u32;
+using aggregation::Status;
+
+// Frame length placeholder, op and name; finish_request() fills the length.
+std::string start_request(Op op, const std::string& name) {
+    std::string request(4, '\0');
+    request.push_back(static_cast<char>(op));
+    put_u32(request, static_cast<std::uint32_t>(name.size()));
+    request += name;
+    return request;
+}
+
+std::string finish_request(std::string request) {
+    if (request.size() - 4 > aggregation::kMaxFrameBytes) {
+        throw std::invalid_argument("Request exceeds " + std::to_string(aggregation::kMaxFrameBytes) + " bytes.");
+    }
+    std::string length;
+    put_u32(length, static_cast<std::uint32_t>(request.size() - 4));
+    request.replace(0, 4, length);
+    return request;
+}
+
+}  // namespace
+
+AggregationClient::AggregationClient(const std::string& socket_path) {
+    const sockaddr_un addr = aggregation::socket_address(socket_path);
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) { throw std::runtime_error(std::string("socket: ") + std::strerror(errno)); }
+    if (::connect(fd_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        const int err = errno;
+        close();
+        throw std::runtime_error("Cannot connect to " + socket_path + ": " + std::strerror(err));
+    }
+}
+
+AggregationClient::~AggregationClient() { close(); }
+
+AggregationClient::AggregationClient(AggregationClient&& other) noexcept : fd_(std::exchange(other.fd_, -1)) {}
+
+AggregationClient& AggregationClient::operator=(AggregationClient&& other) noexcept {
+    if (this != &other) {
+        close();
+        fd_ = std::exchange(other.fd_, -1);
+    }
+    return *this;
+}
+
+void AggregationClient::close() {
+    if (fd_ >= 0) { ::close(fd_); }
+    fd_ = -1;
+}
+
+void AggregationClient::add_many(const std::string& name, const std::vector<std::string>& elems,
+                                 const std::vector<double>& weights) {
+    if (elems.size() != weights.size()) {
+        throw std::invalid_argument("add_many: elems and weights size mismatch");
+    }
+    for (double w : weights) { SketchBase::validate_weight(w); }
+    std::size_t i = 0;
+    do {
+        std::string request = start_request(Op::Add, name);
+        const std::size_t count_at = request.size();
+        put_u32(request, 0);
+        std::uint32_t count = 0;
+        for (; i < elems.size() && (count == 0 || request.size() < kAddBatchBytes); ++i, ++count) {
+            put_u32(request, static_cast<std::uint32_t>(elems[i].size()));
+            request += elems[i];
+            aggregation::put_f64(request, weights[i]);
+        }
+        std::string encoded_count;
+        put_u32(encoded_count, count);
+        request.replace(count_at, 4, encoded_count);
+        call(finish_request(std::move(request)));
+    } while (i < elems.size());
+}
+
+void AggregationClient::add_many(const std::string& name, const std::vector<std::string>& elems) {
+    add_many(name, elems, std::vector<double>(elems.size(), 1.0));
+}
+
+void AggregationClient::merge_wire(const std::string& name, std::string_view data) {
+    std::string request = start_request(Op::MergeWire, name);
+    request += data;
+    call(finish_request(std::move(request)));
+}
+
+double AggregationClient::estimate(const std::string& name) {
+    const std::string reply = call(finish_request(start_request(Op::Estimate, name)));
+    if (reply.size() != 8) { throw std::runtime_error("Malformed reply from aggregation server."); }
+    return aggregation::get_f64(reply.data());
+}
+
+std::string AggregationClient::fetch_wire(const std::string& name) {
+    return call(finish_request(start_request(Op::FetchWire, name)));
+}
+
+// Sends one framed request; returns the reply payload after the status byte.
+std::string AggregationClient::call(const std::string& request) {
+    if (fd_ < 0) { throw std::runtime_error("AggregationClient is closed."); }
+    send_all(request.data(), request.size());
+    char header[4];
+    recv_all(header, sizeof(header));
+    const std::uint32_t length = aggregation::get_u32(header);
+    if (length == 0 || length > aggregation::kMaxFrameBytes) {
+        throw std::runtime_error("Malformed reply from aggregation server.");
+    }
+    std::string reply(length, '\0');
+    recv_all(reply.data(), reply.size());
+    if (static_cast<Status>(reply[0]) != Status::Ok) { throw std::invalid_argument(reply.substr(1)); }
+    return reply.substr(1);
+}
+
+void AggregationClient::send_all(const char* data, std::size_t size) {
+    while (size > 0) {
+        const ssize_t w = ::send(fd_, data, size, MSG_NOSIGNAL);
+        if (w < 0 && errno == EINTR) { continue; }
+        if (w <= 0) { throw std::runtime_error(std::string("Aggregation server send: ") + std::strerror(errno)); }
+        data += w;
+        size -= static_cast<std::size_t>(w);
+    }
+}
+
+void AggregationClient::recv_all(char* data, std::size_t size) {
+    while (size > 0) {
+        const ssize_t r = ::recv(fd_, data, size, 0);
+        if (r < 0 && errno == EINTR) { continue; }
+        if (r == 0) { throw std::runtime_error("Aggregation server closed the connection."); }
+        if (r < 0) { throw std::runtime_error(std::string("Aggregation server recv: ") + std::strerror(errno)); }
+        data += r;
+        size -= static_cast<std::size_t>(r);
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "wire_format.hpp"
+
+// Blocking client for an AggregationServer (see aggregation_server.hpp).
+// Each call sends one request and waits for its reply. Errors reported by the
+// server (bad weights, a sketch of another class, size, seed or parameters)
+// throw std::invalid_argument; socket failures throw std::runtime_error.
+// Move-only; not safe to share between threads without locking.
+class AggregationClient {
+public:
+    explicit AggregationClient(const std::string& socket_path);
+    ~AggregationClient();
+    AggregationClient(AggregationClient&& other) noexcept;
+    AggregationClient& operator=(AggregationClient&& other) noexcept;
+    AggregationClient(const AggregationClient&) = delete;
+    AggregationClient& operator=(const AggregationClient&) = delete;
+
+    // Adds (elems[i], weights[i]) to the sketch called name. Weights are
+    // checked before anything is sent; large batches go out in several
+    // requests.
+    void add_many(const std::string& name, const std::vector<std::string>& elems,
+                  const std::vector<double>& weights);
+    void add_many(const std::string& name, const std::vector<std::string>& elems);
+
+    // Merges a sketch, or its to_wire() bytes, into the sketch called name.
+    void merge_wire(const std::string& name, std::string_view data);
+    template <typename S>
+    void merge(const std::string& name, const S& sketch) { merge_wire(name, to_wire(sketch)); }
+
+    double estimate(const std::string& name);
+    // to_wire() of the sketch called name; from_wire() rebuilds it.
+    std::string fetch_wire(const std::string& name);
+
+    void close();
+
+private:
+    // Add requests are cut at about this size, so one batch does not hold
+    // the server's loop for long.
+    static constexpr std::size_t kAddBatchBytes = 1 << 20;
+
+    std::string call(const std::string& request);
+    void send_all(const char* data, std::size_t size);
+    void recv_all(char* data, std::size_t size);
+
+    int fd_ = -1;
+};
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <sys/un.h>
+
+// Framing shared by AggregationServer and AggregationClient.
+//
+// Every message is a little-endian u32 body length followed by the body. A
+// request body is an op byte, a u32 name length, the sketch name and the op's
+// payload:
+//
+//   Add        u32 count, then count x (u32 length, element bytes, f64 weight)
+//   MergeWire  the sender's to_wire() bytes
+//   Estimate   nothing
+//   FetchWire  nothing
+//
+// Each request gets one reply, in order: a status byte, then for Ok the f64
+// estimate (Estimate), the to_wire() bytes (FetchWire) or nothing, and for
+// Error the message.
+namespace aggregation {
+
+enum class Op : std::uint8_t { Add = 1, MergeWire = 2, Estimate = 3, FetchWire = 4 };
+enum class Status : std::uint8_t { Ok = 0, Error = 1 };
+
+// Larger frames are a protocol error; the server drops the connection.
+constexpr std::uint32_t kMaxFrameBytes = 64U << 20;
+
+// Throws std::invalid_argument for paths that do not fit sun_path.
+inline sockaddr_un socket_address(const std::string& path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        throw std::invalid_argument("Socket path must be 1.." + std::to_string(sizeof(addr.sun_path) - 1)
+                                    + " bytes long.");
+    }
+    std::memcpy(addr.sun_path, path.data(), path.size());
+    return addr;
+}
+
+inline void put_u32(std::string& out, std::uint32_t v) {
+    for (int i = 0; i < 4; ++i) { out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF)); }
+}
+
+inline void put_f64(std::string& out, double v) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    for (int i = 0; i < 8; ++i) { out.push_back(static_cast<char>((bits >> (8 * i)) & 0xFF)); }
+}
+
+inline std::uint32_t get_u32(const char* p) {
+    std::uint32_t v = 0;
+    for (int i = 0; i < 4; ++i) { v |= static_cast<std::uint32_t>(static_cast<unsigned char>(p[i])) << (8 * i); }
+    return v;
+}
+
+inline double get_f64(const char* p) {
+    std::uint64_t bits = 0;
+    for (int i = 0; i < 8; ++i) { bits |= static_cast<std::uint64_t>(static_cast<unsigned char>(p[i])) << (8 * i); }
+    double v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+}  // namespace aggregation
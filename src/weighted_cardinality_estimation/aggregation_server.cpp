@@ -0,0 +1,287 @@
+#include "aggregation_server.hpp"
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <iterator>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "aggregation_protocol.hpp"
+#include "sketch.hpp"
+
+namespace {
+
+using aggregation::get_f64;
+using aggregation::get_u32;
+using aggregation::Op;
+using aggregation::Status;
+using aggregation::socket_address;
+
+std::runtime_error os_error(const std::string& what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+// True when something accepts connections on addr.
+bool socket_is_live(const sockaddr_un& addr) {
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) { return false; }
+    const bool live = ::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0;
+    ::close(fd);
+    return live;
+}
+
+void epoll_set(int epoll_fd, int op, int fd, std::uint32_t events) {
+    epoll_event ev{};
+    ev.events = events;
+    ev.data.fd = fd;
+    if (::epoll_ctl(epoll_fd, op, fd, &ev) != 0) { throw os_error("epoll_ctl"); }
+}
+
+void reply_error(std::string& reply, const char* message) {
+    reply.push_back(static_cast<char>(Status::Error));
+    reply += message;
+}
+
+constexpr std::uint32_t kReadEvents = EPOLLIN | EPOLLRDHUP;
+
+bool has_frame(const std::string& in) { return in.size() >= 4 && in.size() - 4 >= get_u32(in.data()); }
+
+}  // namespace
+
+AggregationServer::AggregationServer(const std::string& socket_path, std::unique_ptr<StoreBase> store)
+    : socket_path_(socket_path), store_(std::move(store)) {
+    const sockaddr_un addr = socket_address(socket_path_);
+    try {
+        listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listen_fd_ < 0) { throw os_error("socket"); }
+        if (::bind(listen_fd_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+            if (errno != EADDRINUSE || socket_is_live(addr)) { throw os_error("Cannot bind " + socket_path_); }
+            ::unlink(socket_path_.c_str());
+            if (::bind(listen_fd_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+                throw os_error("Cannot bind " + socket_path_);
+            }
+        }
+        if (::listen(listen_fd_, SOMAXCONN) != 0) { throw os_error("listen"); }
+        epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd_ < 0) { throw os_error("epoll_create1"); }
+        wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wake_fd_ < 0) { throw os_error("eventfd"); }
+        epoll_set(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, EPOLLIN);
+        epoll_set(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, EPOLLIN);
+    } catch (...) {
+        for (int fd : {listen_fd_, epoll_fd_, wake_fd_}) {
+            if (fd >= 0) { ::close(fd); }
+        }
+        throw;
+    }
+}
+
+AggregationServer::~AggregationServer() {
+    for (const auto& [fd, conn] : connections_) { ::close(fd); }
+    ::close(wake_fd_);
+    ::close(epoll_fd_);
+    ::close(listen_fd_);
+    ::unlink(socket_path_.c_str());
+}
+
+void AggregationServer::stop() {
+    const std::uint64_t one = 1;
+    [[maybe_unused]] const ssize_t n = ::write(wake_fd_, &one, sizeof(one));
+}
+
+void AggregationServer::serve() {
+    constexpr int kMaxEvents = 64;
+    epoll_event events[kMaxEvents];
+    bool stopping = false;
+    while (!stopping) {
+        const int n = ::epoll_wait(epoll_fd_, events, kMaxEvents, -1);
+        if (n < 0) {
+            if (errno == EINTR) { continue; }
+            throw os_error("epoll_wait");
+        }
+        std::vector<int> ready;
+        for (int i = 0; i < n; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == wake_fd_) {
+                std::uint64_t count;
+                [[maybe_unused]] const ssize_t r = ::read(wake_fd_, &count, sizeof(count));
+                stopping = true;
+            } else if (fd == listen_fd_) {
+                accept_connections();
+            } else {
+                auto it = connections_.find(fd);
+                if (it == connections_.end()) { continue; }
+                const bool open = (events[i].events & (EPOLLERR | EPOLLHUP)) == 0 || (events[i].events & EPOLLIN) != 0;
+                if (open && read_connection(fd, it->second)) {
+                    ready.push_back(fd);
+                } else {
+                    close_connection(fd);
+                }
+            }
+        }
+        // Replies go out only after the queued rows are in, so an Ok for Add
+        // means later requests from anyone see those rows.
+        flush_adds();
+        for (int fd : ready) {
+            auto it = connections_.find(fd);
+            if (it != connections_.end() && !write_connection(fd, it->second)) { close_connection(fd); }
+        }
+    }
+}
+
+void AggregationServer::accept_connections() {
+    for (;;) {
+        const int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) { continue; }
+            return;  // EAGAIN, or a connection that died before we got to it
+        }
+        connections_.emplace(fd, Connection{{}, {}, kReadEvents});
+        epoll_set(epoll_fd_, EPOLL_CTL_ADD, fd, kReadEvents);
+    }
+}
+
+// Reads what is available, up to one maximal frame, and handles complete
+// frames until the reply backlog is full. False when the peer is gone or
+// broke the framing.
+bool AggregationServer::read_connection(int fd, Connection& conn) {
+    char buf[64 * 1024];
+    bool eof = false;
+    while (conn.out.size() < kMaxReplyBacklog && conn.in.size() < 4 + std::size_t{aggregation::kMaxFrameBytes}) {
+        const ssize_t r = ::read(fd, buf, sizeof(buf));
+        if (r > 0) {
+            conn.in.append(buf, static_cast<std::size_t>(r));
+            continue;
+        }
+        if (r == 0) { eof = true; }
+        else if (errno == EINTR) { continue; }
+        else if (errno != EAGAIN && errno != EWOULDBLOCK) { return false; }
+        break;
+    }
+
+    std::size_t pos = 0;
+    std::string reply;
+    while (conn.out.size() < kMaxReplyBacklog && conn.in.size() - pos >= 4) {
+        const std::uint32_t length = get_u32(conn.in.data() + pos);
+        if (length > aggregation::kMaxFrameBytes) { return false; }
+        if (conn.in.size() - pos - 4 < length) { break; }
+        reply.clear();
+        handle(std::string_view(conn.in).substr(pos + 4, length), reply);
+        aggregation::put_u32(conn.out, static_cast<std::uint32_t>(reply.size()));
+        conn.out += reply;
+        pos += 4 + length;
+    }
+    conn.in.erase(0, pos);
+    // A client that half-closes after its last request still gets the replies.
+    return !eof || !conn.out.empty();
+}
+
+void AggregationServer::handle(std::string_view body, std::string& reply) {
+    if (body.size() < 5) { return reply_error(reply, "Malformed request."); }
+    const auto op = static_cast<Op>(body[0]);
+    const std::uint32_t name_length = get_u32(body.data() + 1);
+    if (body.size() - 5 < name_length) { return reply_error(reply, "Malformed request."); }
+    const std::string name(body.substr(5, name_length));
+    const std::string_view payload = body.substr(5 + name_length);
+
+    try {
+        switch (op) {
+        case Op::Add: {
+            // Parse and validate the whole batch before queueing any of it.
+            if (payload.size() < 4) { return reply_error(reply, "Malformed request."); }
+            const std::uint32_t count = get_u32(payload.data());
+            std::vector<std::string> elems;
+            std::vector<double> weights;
+            std::size_t p = 4;
+            for (std::uint32_t i = 0; i < count; ++i) {
+                const std::size_t left = payload.size() - p;
+                if (left < 4) { return reply_error(reply, "Malformed request."); }
+                const std::uint32_t length = get_u32(payload.data() + p);
+                if (left - 4 < length || left - 4 - length < 8) { return reply_error(reply, "Malformed request."); }
+                elems.emplace_back(payload.substr(p + 4, length));
+                weights.push_back(get_f64(payload.data() + p + 4 + length));
+                SketchBase::validate_weight(weights.back());
+                p += 4 + length + 8;
+            }
+            if (p != payload.size()) { return reply_error(reply, "Malformed request."); }
+            // Rows applied early are just as visible, so a full queue is
+            // simply flushed.
+            if (pending_bytes_ + payload.size() > aggregation::kMaxFrameBytes) { flush_adds(); }
+            pending_bytes_ += payload.size();
+            pending_names_.insert(pending_names_.end(), elems.size(), pending_batch_names_.emplace_back(name));
+            pending_elems_.insert(pending_elems_.end(), std::make_move_iterator(elems.begin()),
+                                  std::make_move_iterator(elems.end()));
+            pending_weights_.insert(pending_weights_.end(), weights.begin(), weights.end());
+            reply.push_back(static_cast<char>(Status::Ok));
+            return;
+        }
+        case Op::MergeWire:
+            store_->merge_wire(name, payload);
+            reply.push_back(static_cast<char>(Status::Ok));
+            return;
+        case Op::Estimate:
+            flush_adds();
+            reply.push_back(static_cast<char>(Status::Ok));
+            aggregation::put_f64(reply, store_->estimate(name));
+            return;
+        case Op::FetchWire:
+            flush_adds();
+            reply.push_back(static_cast<char>(Status::Ok));
+            reply += store_->to_wire(name);
+            return;
+        }
+        reply_error(reply, "Unknown request.");
+    } catch (const std::exception& e) {
+        reply.clear();
+        reply_error(reply, e.what());
+    }
+}
+
+void AggregationServer::flush_adds() {
+    if (pending_elems_.empty()) { return; }
+    store_->add_many(pending_names_, pending_elems_, pending_weights_);
+    pending_batch_names_.clear();
+    pending_names_.clear();
+    pending_elems_.clear();
+    pending_weights_.clear();
+    pending_bytes_ = 0;
+}
+
+// Sends as much of conn.out as the socket takes, then polls for input only
+// below the reply backlog limit and for EPOLLOUT while replies are left or
+// frames wait in conn.in (the next wakeup handles them). False when the peer
+// is gone.
+bool AggregationServer::write_connection(int fd, Connection& conn) {
+    std::size_t sent = 0;
+    while (sent < conn.out.size()) {
+        const ssize_t w = ::send(fd, conn.out.data() + sent, conn.out.size() - sent, MSG_NOSIGNAL);
+        if (w > 0) {
+            sent += static_cast<std::size_t>(w);
+        } else if (w < 0 && errno == EINTR) {
+            continue;
+        } else if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            return false;
+        }
+    }
+    conn.out.erase(0, sent);
+    const std::uint32_t events = (conn.out.size() < kMaxReplyBacklog ? kReadEvents : 0U) |
+                                 (!conn.out.empty() || has_frame(conn.in) ? std::uint32_t{EPOLLOUT} : 0U);
+    if (events != conn.events) {
+        epoll_set(epoll_fd_, EPOLL_CTL_MOD, fd, events);
+        conn.events = events;
+    }
+    return true;
+}
+
+void AggregationServer::close_connection(int fd) {
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    connections_.erase(fd);
+}
@@ -0,0 +1,135 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "keyed_sketch_map.hpp"
+#include "sketch.hpp"
+#include "wire_format.hpp"
+
+// Long-lived named sketches behind a Unix domain socket, so short-lived
+// workers can hand off partial results without a Python coordinator.
+// AggregationClient speaks the protocol (aggregation_protocol.hpp); the
+// wce-aggregated tool runs a server from the command line.
+//
+// The sketches are a KeyedSketchMap of copies of the prototype, created on
+// first use; a name nobody has written to reads as the empty prototype. S is
+// any class with a wire format (see wire_format.hpp). Clients send raw
+// (element, weight) batches or to_wire() bytes, which are folded in with
+// merge_wire(). An unweighted class (HyperLogLog) adds each row once; its
+// weight is still checked.
+//
+// serve() runs a single-threaded epoll loop. Each wakeup reads every ready
+// connection, queues the Add rows of all of them and applies them with one
+// KeyedSketchMap::add_many() call, which groups rows by sketch. Queued rows
+// are applied before any Estimate or FetchWire, so a client always reads its
+// own writes. Bad weights and malformed or mismatched requests get an error
+// reply and change nothing; a failed MergeWire does not create its name.
+//
+// Memory per client stays bounded: a connection with kMaxReplyBacklog bytes
+// of unsent replies is not read from until the client takes them, and the
+// Add queue is applied early once it holds kMaxFrameBytes of requests.
+class AggregationServer {
+public:
+    // Binds and listens on socket_path. A stale socket file nobody listens on
+    // is replaced; a live one throws std::runtime_error.
+    template <typename S>
+    AggregationServer(const std::string& socket_path, S prototype)
+        : AggregationServer(socket_path, std::unique_ptr<StoreBase>(new Store<S>(std::move(prototype)))) {}
+
+    // Closes all connections and removes the socket file.
+    ~AggregationServer();
+    AggregationServer(const AggregationServer&) = delete;
+    AggregationServer& operator=(const AggregationServer&) = delete;
+
+    // Serves until stop(). Throws std::runtime_error on a failing epoll.
+    void serve();
+
+    // Makes serve() return after its current wakeup. Safe from any thread and
+    // from a signal handler.
+    void stop();
+
+    [[nodiscard]] const std::string& socket_path() const { return socket_path_; }
+
+private:
+    struct StoreBase {
+        virtual ~StoreBase() = default;
+        virtual void add_many(const std::vector<std::string_view>& names, const std::vector<std::string>& elems,
+                              const std::vector<double>& weights) = 0;
+        virtual void merge_wire(const std::string& name, std::string_view data) = 0;
+        [[nodiscard]] virtual double estimate(const std::string& name) const = 0;
+        [[nodiscard]] virtual std::string to_wire(const std::string& name) const = 0;
+    };
+
+    template <typename S>
+    struct Store final : StoreBase {
+        explicit Store(S prototype) : empty(prototype), sketches(std::move(prototype)) {}
+
+        void add_many(const std::vector<std::string_view>& names, const std::vector<std::string>& elems,
+                      const std::vector<double>& weights) override {
+            if constexpr (std::is_base_of_v<UnweightedSketch, S>) {
+                sketches.add_many(names, elems);
+            } else {
+                sketches.add_many(names, elems, weights);
+            }
+        }
+        // merge_wire() leaves its target unchanged on error, so a new name is
+        // validated into a copy of the prototype and created only on success.
+        void merge_wire(const std::string& name, std::string_view data) override {
+            if (S* sketch = sketches.find(name)) {
+                ::merge_wire(*sketch, data);
+                return;
+            }
+            S sketch = empty;
+            ::merge_wire(sketch, data);
+            sketches[name].merge(sketch);
+        }
+        [[nodiscard]] double estimate(const std::string& name) const override { return get(name).estimate(); }
+        [[nodiscard]] std::string to_wire(const std::string& name) const override { return ::to_wire(get(name)); }
+
+        [[nodiscard]] const S& get(const std::string& name) const {
+            const S* sketch = sketches.find(name);
+            return sketch != nullptr ? *sketch : empty;
+        }
+
+        S empty;
+        KeyedSketchMap<S> sketches;
+    };
+
+    static constexpr std::size_t kMaxReplyBacklog = 1 << 20;
+
+    struct Connection {
+        std::string in;
+        std::string out;
+        std::uint32_t events;  // registered epoll events
+    };
+
+    AggregationServer(const std::string& socket_path, std::unique_ptr<StoreBase> store);
+
+    void accept_connections();
+    bool read_connection(int fd, Connection& conn);
+    void handle(std::string_view body, std::string& reply);
+    void flush_adds();
+    bool write_connection(int fd, Connection& conn);
+    void close_connection(int fd);
+
+    std::string socket_path_;
+    std::unique_ptr<StoreBase> store_;
+    int listen_fd_ = -1;
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    std::unordered_map<int, Connection> connections_;
+
+    // Add rows queued during the current wakeup. Each batch's name is stored
+    // once; the rows point into pending_batch_names_.
+    std::deque<std::string> pending_batch_names_;
+    std::vector<std::string_view> pending_names_;
+    std::vector<std::string> pending_elems_;
+    std::vector<double> pending_weights_;
+    std::size_t pending_bytes_ = 0;
+};
@@ -0,0 +1,33 @@
+#include "arena.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+Arena::Arena(std::size_t slab_bytes) : slab_bytes_(slab_bytes) {
+    if (slab_bytes == 0) { throw std::invalid_argument("Arena slab size must be positive."); }
+}
+
+void* Arena::allocate(std::size_t bytes, std::size_t alignment) {
+    for (;;) {
+        if (current_ == slabs_.size()) {
+            const std::size_t size = std::max(slab_bytes_, bytes + alignment);
+            slabs_.push_back(Slab{std::unique_ptr<std::byte[]>(new std::byte[size]), size});
+            reserved_ += size;
+            offset_ = 0;
+        }
+        Slab& slab = slabs_[current_];
+        const auto base = reinterpret_cast<std::uintptr_t>(slab.data.get());
+        const std::size_t begin = ((base + offset_ + alignment - 1) & ~(alignment - 1)) - base;
+        if (begin + bytes <= slab.size) {
+            offset_ = begin + bytes;
+            return slab.data.get() + begin;
+        }
+        ++current_;
+        offset_ = 0;
+    }
+}
+
+void Arena::reset() {
+    current_ = 0;
+    offset_ = 0;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Bump allocator over large slabs for objects that die together.
+//
+// allocate() carves aligned chunks out of the current slab and moves to the
+// next slab (allocating one if needed) when it runs out. Nothing is freed one
+// by one: reset() rewinds to the first slab in O(1) and keeps every slab for
+// reuse, and the destructor releases them. Objects placed in an arena must not
+// own memory outside it, since reset() does not run their destructors.
+class Arena {
+public:
+    static constexpr std::size_t kDefaultSlabBytes = 1 << 20;
+
+    explicit Arena(std::size_t slab_bytes = kDefaultSlabBytes);
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    Arena(Arena&&) noexcept = default;
+    Arena& operator=(Arena&&) noexcept = default;
+
+    void* allocate(std::size_t bytes, std::size_t alignment);
+    void reset();
+
+    [[nodiscard]] std::size_t bytes_reserved() const { return reserved_; }
+
+private:
+    struct Slab {
+        std::unique_ptr<std::byte[]> data;
+        std::size_t size;
+    };
+
+    std::vector<Slab> slabs_;
+    std::size_t current_ = 0;  // slab being filled
+    std::size_t offset_ = 0;   // first free byte in it
+    std::size_t slab_bytes_;
+    std::size_t reserved_ = 0;
+};
+
+// Standard allocator over an Arena, or over the heap when constructed without
+// one, so a container type can serve both stand-alone and pooled objects.
+// deallocate() is a no-op for arena memory.
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    ArenaAllocator() noexcept = default;
+    explicit ArenaAllocator(Arena* arena) noexcept : arena_(arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena_(other.arena()) {}
+
+    T* allocate(std::size_t n) {
+        if (arena_ == nullptr) { return std::allocator<T>().allocate(n); }
+        return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        if (arena_ == nullptr) { std::allocator<T>().deallocate(p, n); }
+    }
+
+    [[nodiscard]] Arena* arena() const noexcept { return arena_; }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept { return arena_ == other.arena(); }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept { return arena_ != other.arena(); }
+
+private:
+    Arena* arena_ = nullptr;
+};
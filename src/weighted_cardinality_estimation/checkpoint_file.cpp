@@ -0,0 +1,344 @@
+#include "checkpoint_file.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "fast_exp_sketch_t.hpp"
+#include "fast_k_q_sketch.hpp"
+#include "q_sketch.hpp"
+#include "seeds.hpp"
+
+namespace {
+
+constexpr char kMagic[4] = {'W', 'C', 'E', 'C'};
+constexpr std::uint32_t kVersion = 1;
+
+// The header page and the unit of change detection. Regions start and end on
+// page boundaries, so they can be synced independently.
+constexpr std::size_t kPage = 4096;
+
+// The two slots sit in different 512-byte sectors, so a torn header write
+// can damage at most the slot being written.
+constexpr std::size_t kSlotOffset[2] = {512, 1024};
+
+enum class Tag : std::uint32_t {
+    QSketch = 1,
+    kQSketch = 2,
+    FastExpSketch = 3,
+    FastExpSketchFloat32 = 4,
+};
+
+struct Meta {
+    char magic[4];
+    std::uint32_t version;
+    CheckpointFile::Shape shape;
+    std::uint64_t region_bytes;
+};
+
+struct Slot {
+    std::uint64_t generation;
+    std::uint64_t check;  // ties the slot to the file's shape; zero pages never validate
+};
+
+std::runtime_error os_error(const std::string& what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+// msync() wants an address aligned to the system page, which may be larger
+// than kPage.
+bool sync(unsigned char* map, std::size_t offset, std::size_t bytes) {
+    const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const std::size_t start = offset / page * page;
+    return ::msync(map + start, offset + bytes - start, MS_SYNC) == 0;
+}
+
+// A new file's directory entry is durable only once its directory is synced.
+bool sync_parent_directory(const std::string& path) {
+    const std::size_t slash = path.rfind('/');
+    const std::string dir = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    const int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) { return false; }
+    const bool ok = ::fsync(fd) == 0;
+    const int saved = errno;
+    ::close(fd);
+    errno = saved;
+    return ok;
+}
+
+std::uint64_t slot_check(std::uint64_t generation, const CheckpointFile::Shape& shape) {
+    return splitmix64(generation ^ splitmix64(shape.seed ^ splitmix64(shape.m)));
+}
+
+std::size_t region_bytes_for(const CheckpointFile::Shape& shape) {
+    const std::size_t bytes = shape.m * shape.register_bytes;
+    return std::max<std::size_t>(kPage, (bytes + kPage - 1) / kPage * kPage);
+}
+
+Meta read_meta(const unsigned char* map) {
+    Meta meta;
+    std::memcpy(&meta, map, sizeof(meta));
+    return meta;
+}
+
+Slot read_slot(const unsigned char* map, int i) {
+    Slot slot;
+    std::memcpy(&slot, map + kSlotOffset[i], sizeof(slot));
+    return slot;
+}
+
+template <typename S>
+struct CheckpointTraits;
+
+// QSketch and kQSketch pack their registers, so staging unpacks them into a
+// buffer the runs are read from.
+template <typename S>
+std::function<void(const CheckpointFile::RunVisitor&)> unpacked_runs(const S& sketch) {
+    if (sketch.small_mode()) { return unpacked_runs(sketch.densified()); }
+    const std::size_t m = sketch.get_sketch_size();
+    auto bytes = std::make_shared<std::vector<unsigned char>>(m * sizeof(int));
+    for (std::size_t i = 0; i < m; ++i) {
+        const int r = sketch.register_at(i);
+        std::memcpy(bytes->data() + i * sizeof(int), &r, sizeof(int));
+    }
+    return [bytes](const CheckpointFile::RunVisitor& visit) { visit(bytes->data(), bytes->size()); };
+}
+
+template <>
+struct CheckpointTraits<QSketch> {
+    using Register = int;
+    static constexpr Tag kTag = Tag::QSketch;
+    static auto runs(const QSketch& s) { return unpacked_runs(s); }
+    static void describe(const QSketch& s, CheckpointFile::Shape& shape) { shape.amount_bits = s.get_amount_bits(); }
+    static QSketch make(const CheckpointFile::Shape& shape, const std::vector<int>& registers) {
+        return {shape.m, shape.seed, static_cast<std::uint8_t>(shape.amount_bits), registers,
+                static_cast<RngEngine>(shape.rng_engine)};
+    }
+};
+
+template <>
+struct CheckpointTraits<kQSketch> {
+    using Register = int;
+    static constexpr Tag kTag = Tag::kQSketch;
+    static auto runs(const kQSketch& s) { return unpacked_runs(s); }
+    static void describe(const kQSketch& s, CheckpointFile::Shape& shape) {
+        shape.amount_bits = s.get_amount_bits();
+        shape.logarithm_base = s.get_logarithm_base();
+    }
+    static kQSketch make(const CheckpointFile::Shape& shape, const std::vector<int>& registers) {
+        return {shape.m, shape.seed, static_cast<std::uint8_t>(shape.amount_bits),
+                static_cast<float>(shape.logarithm_base), registers, static_cast<RngEngine>(shape.rng_engine)};
+    }
+};
+
+// A snapshot shares the register blocks, and commit() copies them.
+template <typename T>
+struct FastExpCheckpointTraits {
+    using Register = T;
+    static std::function<void(const CheckpointFile::RunVisitor&)> runs(FastExpSketchT<T>& s) {
+        auto snapshot = std::make_shared<const FastExpSketchT<T>>(s.small_mode() ? s.densified() : s.snapshot());
+        return [snapshot](const CheckpointFile::RunVisitor& visit) {
+            snapshot->registers().for_each_block([&visit](const T* data, std::size_t n) {
+                visit(reinterpret_cast<const unsigned char*>(data), n * sizeof(T));
+            });
+        };
+    }
+    static void describe(const FastExpSketchT<T>&, CheckpointFile::Shape&) {}
+    static FastExpSketchT<T> make(const CheckpointFile::Shape& shape, const std::vector<T>& registers) {
+        return {shape.m, shape.seed, registers, static_cast<RngEngine>(shape.rng_engine)};
+    }
+};
+
+template <>
+struct CheckpointTraits<FastExpSketchT<double>> : FastExpCheckpointTraits<double> {
+    static constexpr Tag kTag = Tag::FastExpSketch;
+};
+
+template <>
+struct CheckpointTraits<FastExpSketchT<float>> : FastExpCheckpointTraits<float> {
+    static constexpr Tag kTag = Tag::FastExpSketchFloat32;
+};
+
+template <typename S>
+CheckpointFile::Staged stage_registers(S& sketch) {
+    using Traits = CheckpointTraits<S>;
+    using Register = typename Traits::Register;
+    CheckpointFile::Staged staged{};
+    staged.shape.tag = static_cast<std::uint32_t>(Traits::kTag);
+    staged.shape.register_bytes = sizeof(Register);
+    staged.shape.m = sketch.get_sketch_size();
+    staged.shape.seed = sketch.get_master_seed();
+    staged.shape.rng_engine = static_cast<std::uint32_t>(sketch.get_rng_engine());
+    Traits::describe(sketch, staged.shape);
+    staged.for_each_run = Traits::runs(sketch);
+    return staged;
+}
+
+template <typename S>
+S recover_registers(const unsigned char* map, int newest, const std::string& path) {
+    using Traits = CheckpointTraits<S>;
+    using Register = typename Traits::Register;
+    if (newest < 0) { throw std::runtime_error("No checkpoint in " + path); }
+    const Meta meta = read_meta(map);
+    if (meta.shape.tag != static_cast<std::uint32_t>(Traits::kTag) || meta.shape.register_bytes != sizeof(Register)) {
+        throw std::invalid_argument("Checkpoint file holds a different sketch class.");
+    }
+    std::vector<Register> registers(meta.shape.m);
+    std::memcpy(registers.data(), map + kPage + newest * meta.region_bytes, meta.shape.m * sizeof(Register));
+    return Traits::make(meta.shape, registers);
+}
+
+}  // namespace
+
+bool CheckpointFile::Shape::operator==(const Shape& o) const {
+    return tag == o.tag && register_bytes == o.register_bytes && m == o.m && seed == o.seed &&
+           amount_bits == o.amount_bits && rng_engine == o.rng_engine && logarithm_base == o.logarithm_base;
+}
+
+CheckpointFile::CheckpointFile(const std::string& path) : path_(path) { open_existing(); }
+
+CheckpointFile::~CheckpointFile() {
+    if (map_ != nullptr) { ::munmap(map_, map_bytes_); }
+    if (fd_ >= 0) { ::close(fd_); }
+}
+
+void CheckpointFile::open_existing() {
+    fd_ = ::open(path_.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd_ < 0) {
+        if (errno == ENOENT) { return; }
+        throw os_error("Cannot open " + path_);
+    }
+    auto fail = [this](const auto& e) {
+        if (map_ != nullptr) { ::munmap(map_, map_bytes_); }
+        ::close(fd_);
+        throw e;
+    };
+    struct stat st{};
+    if (::fstat(fd_, &st) != 0) { fail(os_error("Cannot stat " + path_)); }
+    // An empty file is one whose creation was cut short; the first commit()
+    // lays it out.
+    if (st.st_size == 0) { return; }
+    const auto size = static_cast<std::size_t>(st.st_size);
+    if (size < kPage) { fail(std::invalid_argument("Not a checkpoint file: " + path_)); }
+    void* map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (map == MAP_FAILED) { fail(os_error("Cannot map " + path_)); }
+    map_ = static_cast<unsigned char*>(map);
+    map_bytes_ = size;
+    const Meta meta = read_meta(map_);
+    if (std::all_of(meta.magic, meta.magic + 4, [](char c) { return c == 0; })) {
+        // Sized but cut short before its header reached the disk.
+        ::munmap(map_, map_bytes_);
+        map_ = nullptr;
+        return;
+    }
+    if (std::memcmp(meta.magic, kMagic, sizeof(kMagic)) != 0 || meta.version != kVersion ||
+        meta.region_bytes != region_bytes_for(meta.shape) || size != kPage + 2 * meta.region_bytes) {
+        fail(std::invalid_argument("Not a checkpoint file: " + path_));
+    }
+}
+
+void CheckpointFile::create(const Shape& shape) {
+    if (fd_ < 0) {
+        fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0) { throw os_error("Cannot create " + path_); }
+    }
+    const std::size_t region_bytes = region_bytes_for(shape);
+    const std::size_t size = kPage + 2 * region_bytes;
+    if (::ftruncate(fd_, static_cast<off_t>(size)) != 0) { throw os_error("Cannot size " + path_); }
+    void* map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (map == MAP_FAILED) { throw os_error("Cannot map " + path_); }
+    map_ = static_cast<unsigned char*>(map);
+    map_bytes_ = size;
+    Meta meta{};
+    std::memcpy(meta.magic, kMagic, sizeof(kMagic));
+    meta.version = kVersion;
+    meta.shape = shape;
+    meta.region_bytes = region_bytes;
+    std::memset(map_, 0, kPage);
+    std::memcpy(map_, &meta, sizeof(meta));
+    // fsync also persists the new file size.
+    if (!sync(map_, 0, kPage) || ::fsync(fd_) != 0) { throw os_error("Cannot sync " + path_); }
+    if (!sync_parent_directory(path_)) { throw os_error("Cannot sync the directory of " + path_); }
+}
+
+int CheckpointFile::newest_slot() const {
+    if (map_ == nullptr) { return -1; }
+    const Shape shape = read_meta(map_).shape;
+    int newest = -1;
+    std::uint64_t best = 0;
+    for (int i = 0; i < 2; ++i) {
+        const Slot slot = read_slot(map_, i);
+        if (slot.generation > best && slot.check == slot_check(slot.generation, shape)) {
+            best = slot.generation;
+            newest = i;
+        }
+    }
+    return newest;
+}
+
+std::uint64_t CheckpointFile::generation() const {
+    const int newest = newest_slot();
+    return newest < 0 ? 0 : read_slot(map_, newest).generation;
+}
+
+void CheckpointFile::commit(const Staged& staged) {
+    if (map_ == nullptr) {
+        create(staged.shape);
+    } else if (!(read_meta(map_).shape == staged.shape)) {
+        throw std::invalid_argument("Checkpoint file holds a different sketch.");
+    }
+    const std::size_t region_bytes = read_meta(map_).region_bytes;
+    const int newest = newest_slot();
+    const int target = newest == 0 ? 1 : 0;
+    const std::uint64_t generation = newest < 0 ? 1 : read_slot(map_, newest).generation + 1;
+
+    // The target region holds the checkpoint before the newest one, so only
+    // pages that changed over the last two commits are written.
+    unsigned char* region = map_ + kPage + target * region_bytes;
+    const std::size_t register_bytes = staged.shape.m * staged.shape.register_bytes;
+    std::size_t off = 0;
+    staged.for_each_run([&](const unsigned char* src, std::size_t n) {
+        if (n > register_bytes - off) { throw std::invalid_argument("Staged registers do not match their shape."); }
+        for (std::size_t done = 0; done < n;) {
+            const std::size_t len = std::min(n - done, kPage - off % kPage);
+            if (std::memcmp(region + off, src + done, len) != 0) { std::memcpy(region + off, src + done, len); }
+            off += len;
+            done += len;
+        }
+    });
+    if (off != register_bytes) { throw std::invalid_argument("Staged registers do not match their shape."); }
+    if (!sync(map_, region - map_, region_bytes)) { throw os_error("Cannot sync " + path_); }
+
+    const Slot slot{generation, slot_check(generation, staged.shape)};
+    std::memcpy(map_ + kSlotOffset[target], &slot, sizeof(slot));
+    if (!sync(map_, 0, kPage)) { throw os_error("Cannot sync " + path_); }
+}
+
+template <> CheckpointFile::Staged CheckpointFile::stage(QSketch& sketch) { return stage_registers(sketch); }
+template <> QSketch CheckpointFile::recover<QSketch>() const {
+    return recover_registers<QSketch>(map_, newest_slot(), path_);
+}
+
+template <> CheckpointFile::Staged CheckpointFile::stage(kQSketch& sketch) { return stage_registers(sketch); }
+template <> kQSketch CheckpointFile::recover<kQSketch>() const {
+    return recover_registers<kQSketch>(map_, newest_slot(), path_);
+}
+
+template <> CheckpointFile::Staged CheckpointFile::stage(FastExpSketchT<double>& sketch) {
+    return stage_registers(sketch);
+}
+template <> FastExpSketchT<double> CheckpointFile::recover<FastExpSketchT<double>>() const {
+    return recover_registers<FastExpSketchT<double>>(map_, newest_slot(), path_);
+}
+
+template <> CheckpointFile::Staged CheckpointFile::stage(FastExpSketchT<float>& sketch) {
+    return stage_registers(sketch);
+}
+template <> FastExpSketchT<float> CheckpointFile::recover<FastExpSketchT<float>>() const {
+    return recover_registers<FastExpSketchT<float>>(map_, newest_slot(), path_);
+}
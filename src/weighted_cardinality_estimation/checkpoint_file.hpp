@@ -0,0 +1,100 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+class QSketch;
+class kQSketch;
+template <typename T>
+class FastExpSketchT;
+
+// Crash-consistent on-disk checkpoints of one sketch, so a long-running
+// collector survives a crash without periodically pickling the whole sketch.
+//
+// The file is memory-mapped: a header page, then two register regions used
+// alternately. commit() copies the registers into the region the newest
+// checkpoint does not use, skipping pages whose bytes are unchanged, so
+// msync() writes back only the dirty pages. Once that region is on disk it
+// stores the next generation in the region's header slot and syncs the
+// header. A crash at any point leaves the previous checkpoint intact, and
+// recover() takes the newest valid slot.
+//
+// stage() is the only step that reads the sketch, and it copies as little as
+// it can: FastExpSketch and FastExpSketchFloat32 take a snapshot(), one
+// pointer per 4 KiB register block, and QSketch and kQSketch unpack their
+// registers into one buffer. commit() copies into the file and does the I/O
+// while the sketch keeps taking adds (the Python binding releases the GIL for
+// it). recover() copies the newest registers out of the mapping into a new
+// sketch, with no decoding; the sketch does not keep the file mapped, since
+// its register storage is not file-backed.
+//
+// Registers are stored raw in native byte order: the file is for restarting
+// on the same machine, to_wire() is for shipping. A file holds one sketch
+// shape (class, m, seed, parameters), fixed by its first commit; committing
+// another shape or a file that is not a checkpoint throws
+// std::invalid_argument. OS errors and recovering a file without a
+// checkpoint throw std::runtime_error. One process writes a file at a time.
+class CheckpointFile {
+public:
+    struct Shape {
+        std::uint32_t tag;
+        std::uint32_t register_bytes;
+        std::uint64_t m;
+        std::uint64_t seed;
+        std::uint32_t amount_bits;
+        std::uint32_t rng_engine;
+        double logarithm_base;
+        bool operator==(const Shape& o) const;
+    };
+
+    using RunVisitor = std::function<void(const unsigned char* bytes, std::size_t n)>;
+
+    struct Staged {
+        Shape shape;
+        // Calls the visitor for consecutive runs of the register bytes, read
+        // from a copy or snapshot that later adds do not change.
+        std::function<void(const RunVisitor&)> for_each_run;
+    };
+
+    // Opens path if it exists; otherwise the first commit() creates it.
+    explicit CheckpointFile(const std::string& path);
+    ~CheckpointFile();
+    CheckpointFile(const CheckpointFile&) = delete;
+    CheckpointFile& operator=(const CheckpointFile&) = delete;
+
+    // Takes the sketch mutably because a snapshot() marks its blocks shared.
+    template <typename S>
+    [[nodiscard]] static Staged stage(S& sketch);
+
+    void commit(const Staged& staged);
+
+    template <typename S>
+    void write(S& sketch) { commit(stage(sketch)); }
+
+    template <typename S>
+    [[nodiscard]] S recover() const;
+
+    // Generation of the newest checkpoint; 0 before the first.
+    [[nodiscard]] std::uint64_t generation() const;
+    [[nodiscard]] const std::string& path() const { return path_; }
+
+private:
+    void open_existing();
+    void create(const Shape& shape);
+    [[nodiscard]] int newest_slot() const;
+
+    std::string path_;
+    int fd_ = -1;
+    unsigned char* map_ = nullptr;
+    std::size_t map_bytes_ = 0;
+};
+
+template <> CheckpointFile::Staged CheckpointFile::stage(QSketch& sketch);
+template <> QSketch CheckpointFile::recover<QSketch>() const;
+template <> CheckpointFile::Staged CheckpointFile::stage(kQSketch& sketch);
+template <> kQSketch CheckpointFile::recover<kQSketch>() const;
+template <> CheckpointFile::Staged CheckpointFile::stage(FastExpSketchT<double>& sketch);
+template <> FastExpSketchT<double> CheckpointFile::recover<FastExpSketchT<double>>() const;
+template <> CheckpointFile::Staged CheckpointFile::stage(FastExpSketchT<float>& sketch);
+template <> FastExpSketchT<float> CheckpointFile::recover<FastExpSketchT<float>>() const;
@@ -0,0 +1,141 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Register array stored in fixed 4 KiB blocks that copies can share.
+//
+// share() hands out a second CowRegisters pointing at the same blocks and
+// marks every block shared on both sides. Whichever side writes to a shared
+// block first copies that block and writes to the copy, so the other side's
+// view never changes. A snapshot costs one pointer per block, and a writer
+// that keeps adding pays one block copy per block it touches afterwards.
+//
+// Shared blocks are never written, so once share() has returned, the two
+// sides may be used from different threads without locking. share() itself
+// must not race with writes to the source. Copying a CowRegisters (copy
+// constructor or assignment) is a deep copy that shares nothing.
+template <typename T>
+class CowRegisters {
+public:
+    static constexpr std::size_t kBlockSize = 4096 / sizeof(T);
+
+    CowRegisters(std::size_t size, T fill) : size_(size) {
+        for (std::size_t bi = 0; bi < block_count_for(size); ++bi) {
+            std::fill_n(allocate(block_length(bi)), block_length(bi), fill);
+        }
+    }
+
+    explicit CowRegisters(const std::vector<T>& values) : size_(values.size()) {
+        for (std::size_t bi = 0; bi < block_count_for(size_); ++bi) {
+            std::copy_n(values.data() + bi * kBlockSize, block_length(bi), allocate(block_length(bi)));
+        }
+    }
+
+    CowRegisters(const CowRegisters& other) : size_(other.size_) {
+        for (std::size_t bi = 0; bi < other.blocks_.size(); ++bi) {
+            std::copy_n(other.blocks_[bi].data, block_length(bi), allocate(block_length(bi)));
+        }
+    }
+
+    CowRegisters& operator=(const CowRegisters& other) {
+        if (this != &other) { *this = CowRegisters(other); }
+        return *this;
+    }
+
+    CowRegisters(CowRegisters&&) noexcept = default;
+    CowRegisters& operator=(CowRegisters&&) noexcept = default;
+
+    [[nodiscard]] std::size_t size() const { return size_; }
+
+    T operator[](std::size_t i) const { return blocks_[i / kBlockSize].data[i % kBlockSize]; }
+
+    void set(std::size_t i, T value) {
+        Block& b = blocks_[i / kBlockSize];
+        if (b.shared) { detach(b, i / kBlockSize); }
+        b.data[i % kBlockSize] = value;
+    }
+
+    // Lowers every register to min(this, other); blocks that other does not
+    // lower stay shared.
+    void min_with(const CowRegisters& other) {
+        for (std::size_t bi = 0; bi < blocks_.size(); ++bi) {
+            Block& b = blocks_[bi];
+            const T* src = other.blocks_[bi].data;
+            const std::size_t n = block_length(bi);
+            std::size_t i = 0;
+            while (i < n && !(src[i] < b.data[i])) { ++i; }
+            if (i == n) { continue; }
+            if (b.shared) { detach(b, bi); }
+            for (; i < n; ++i) { b.data[i] = std::min(b.data[i], src[i]); }
+        }
+    }
+
+    [[nodiscard]] std::size_t block_count() const { return blocks_.size(); }
+    [[nodiscard]] const T* block(std::size_t bi) const { return blocks_[bi].data; }
+    [[nodiscard]] std::size_t block_length(std::size_t bi) const { return std::min(kBlockSize, size_ - bi * kBlockSize); }
+
+    // Calls f(const T* data, std::size_t count) for each block in order.
+    template <typename F>
+    void for_each_block(F&& f) const {
+        for (std::size_t bi = 0; bi < blocks_.size(); ++bi) { f(block(bi), block_length(bi)); }
+    }
+
+    [[nodiscard]] T max() const {
+        T result = blocks_[0].data[0];
+        for_each_block([&result](const T* data, std::size_t n) {
+            result = std::max(result, *std::max_element(data, data + n));
+        });
+        return result;
+    }
+
+    [[nodiscard]] std::vector<T> to_vector() const {
+        std::vector<T> out;
+        out.reserve(size_);
+        for_each_block([&out](const T* data, std::size_t n) { out.insert(out.end(), data, data + n); });
+        return out;
+    }
+
+    CowRegisters share() {
+        for (Block& b : blocks_) { b.shared = true; }
+        CowRegisters view;
+        view.size_ = size_;
+        view.blocks_ = blocks_;
+        return view;
+    }
+
+    [[nodiscard]] std::size_t block_table_bytes() const { return blocks_.capacity() * sizeof(Block); }
+
+private:
+    struct Block {
+        T* data;
+        std::shared_ptr<T[]> owner;
+        bool shared;
+    };
+
+    CowRegisters() = default;
+
+    static std::size_t block_count_for(std::size_t size) { return (size + kBlockSize - 1) / kBlockSize; }
+
+    // Appends an unshared block of n registers and returns its storage.
+    T* allocate(std::size_t n) {
+        if (blocks_.empty()) { blocks_.reserve(block_count_for(size_)); }
+        std::shared_ptr<T[]> owner(new T[n]);
+        T* data = owner.get();
+        blocks_.push_back(Block{data, std::move(owner), false});
+        return data;
+    }
+
+    void detach(Block& b, std::size_t bi) {
+        const std::size_t n = block_length(bi);
+        std::shared_ptr<T[]> owner(new T[n]);
+        std::copy_n(b.data, n, owner.get());
+        b.data = owner.get();
+        b.owner = std::move(owner);
+        b.shared = false;
+    }
+
+    std::size_t size_ = 0;
+    std::vector<Block> blocks_;
+};
@@ -0,0 +1,112 @@
+#include "custom_float_format.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#endif
+
+// pow2_table()[k] == 2^k for k in [-1023, 1024], every exponent an exp_bits <= 11 format uses.
+static const double* pow2_table() {
+    static const std::array<double, 2048> table = [] {
+        std::array<double, 2048> t{};
+        for (int i = 0; i < 2048; ++i) { t[i] = std::ldexp(1.0, i - 1023); }
+        return t;
+    }();
+    return table.data() + 1023;
+}
+
+static std::uint64_t double_bits(double value) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static int checked_exp_bits(int exp_bits, int mant_bits) {
+    if (exp_bits < 1 || exp_bits > CustomFloatFormat::kMaxExpBits
+        || mant_bits < 0 || mant_bits > CustomFloatFormat::kMaxMantBits) {
+        throw std::invalid_argument("Custom float format needs 1 <= exp_bits <= 11 and 0 <= mant_bits <= 52.");
+    }
+    return exp_bits;
+}
+
+CustomFloatFormat::CustomFloatFormat(int exp_bits, int mant_bits)
+    : exp_bits_(checked_exp_bits(exp_bits, mant_bits)),
+      mant_bits_(mant_bits),
+      mant_shift_(static_cast<unsigned>(52 - mant_bits)),
+      exp_offset_(static_cast<std::uint64_t>(static_cast<std::int64_t>((1 << (exp_bits - 1)) - 1) - 1023)),
+      mant_mask_((std::uint64_t{1} << mant_bits) - 1),
+      max_code_((std::uint64_t{1} << (exp_bits + mant_bits)) - 1),
+      min_bits_(double_bits(all_normal_min(exp_bits, mant_bits))),
+      max_bits_(double_bits(all_normal_max(exp_bits, mant_bits))),
+      min_value_(all_normal_min(exp_bits, mant_bits)),
+      max_value_(all_normal_max(exp_bits, mant_bits)),
+      inv_mant_scale_(std::ldexp(1.0, -mant_bits)),
+      pow2_(pow2_table() - ((1 << (exp_bits - 1)) - 1)) {}
+
+void CustomFloatFormat::encode_batch_scalar(const double* values, std::uint64_t* codes, std::size_t n) const {
+    for (std::size_t i = 0; i < n; ++i) { codes[i] = encode(values[i]); }
+}
+
+#if defined(__x86_64__) && defined(__GNUC__)
+// Four lanes of the scalar encode(). Every operand of a signed 64-bit compare
+// has the sign bit cleared, so cmpgt_epi64 orders them like unsigned values.
+__attribute__((target("avx2")))
+void CustomFloatFormat::encode_batch_avx2(const double* values, std::uint64_t* codes, std::size_t n) const {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i abs_mask = _mm256_set1_epi64x(static_cast<long long>(~kSignBit));
+    const __m256i mant_mask = _mm256_set1_epi64x(static_cast<long long>(kMantMask));
+    const __m256i inf_below = _mm256_set1_epi64x(static_cast<long long>(kInfBits - 1));
+    const __m256i max_below = _mm256_set1_epi64x(static_cast<long long>(max_bits_ - 1));
+    const __m256i min_bits = _mm256_set1_epi64x(static_cast<long long>(min_bits_));
+    const __m256i exp_offset = _mm256_set1_epi64x(static_cast<long long>(exp_offset_));
+    const __m256i max_code = _mm256_set1_epi64x(static_cast<long long>(max_code_));
+    const __m128i mant_shift = _mm_cvtsi32_si128(static_cast<int>(mant_shift_));
+    const __m128i mant_bits = _mm_cvtsi32_si128(mant_bits_);
+
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m256i bits = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        const __m256i abs = _mm256_and_si256(bits, abs_mask);
+        const __m256i neg = _mm256_cmpgt_epi64(zero, bits);
+        const __m256i special = _mm256_cmpgt_epi64(abs, inf_below);
+        const __m256i high = _mm256_or_si256(special, _mm256_andnot_si256(neg, _mm256_cmpgt_epi64(abs, max_below)));
+        const __m256i low = _mm256_andnot_si256(special, _mm256_or_si256(neg, _mm256_cmpgt_epi64(min_bits, abs)));
+
+        const __m256i exp_field = _mm256_srli_epi64(abs, 52);
+        const __m256i subnormal = _mm256_cmpeq_epi64(exp_field, zero);
+        const __m256i aligned = _mm256_blendv_epi8(abs, _mm256_slli_epi64(abs, 1), subnormal);
+        const __m256i mant = _mm256_srl_epi64(_mm256_and_si256(aligned, mant_mask), mant_shift);
+        const __m256i code = _mm256_or_si256(
+            _mm256_sll_epi64(_mm256_add_epi64(exp_field, exp_offset), mant_bits), mant);
+
+        const __m256i result = _mm256_or_si256(
+            _mm256_andnot_si256(_mm256_or_si256(high, low), code),
+            _mm256_and_si256(high, max_code));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(codes + i), result);
+    }
+    encode_batch_scalar(values + i, codes + i, n - i);
+}
+#endif
+
+void CustomFloatFormat::encode_batch(const double* values, std::uint64_t* codes, std::size_t n) const {
+#if defined(__x86_64__) && defined(__GNUC__)
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    if (has_avx2) {
+        encode_batch_avx2(values, codes, n);
+        return;
+    }
+#endif
+    encode_batch_scalar(values, codes, n);
+}
+
+void CustomFloatFormat::quantize_batch(const double* values, double* out, std::size_t n) const {
+    constexpr std::size_t kChunk = 256;
+    std::uint64_t codes[kChunk];
+    for (std::size_t start = 0; start < n; start += kChunk) {
+        const std::size_t len = std::min(kChunk, n - start);
+        encode_batch(values + start, codes, len);
+        for (std::size_t i = 0; i < len; ++i) { out[start + i] = decode(codes[i]); }
+    }
+}
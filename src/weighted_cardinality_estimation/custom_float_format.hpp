@@ -0,0 +1,99 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "quantize_custom_float.hpp"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// CustomFloatFormat: precomputed unsigned ALL_NORMAL format
+// ─────────────────────────────────────────────────────────────────────────────
+//
+// Built once per sketch. Quantizes by working on the IEEE-754 bits of the
+// input double instead of going through frexp/floor/ldexp:
+//
+//      code = ((double_exp + bias - 1023) << mant_bits) | (double_mant >> (52 - mant_bits))
+//
+// Dropping the low mantissa bits is exactly quantize_all_normal's truncation.
+// Out-of-range inputs are clamped with masks: values at or above the largest
+// representable value (plus inf/NaN) go to the max code, and values below the
+// smallest one (plus zero and negatives) go to code 0. For exp_bits = 11 the
+// smallest exponent lands on double subnormals, which lack the implicit bit.
+// Their mantissa is shifted up by one to compensate.
+//
+// The code is the register representation: exponent above mantissa, no sign,
+// so codes sort in the same order as the values they encode. decode() turns a
+// code back into the double quantize_all_normal(value, 0, exp_bits, mant_bits)
+// would have returned, using a shared power-of-two table.
+//
+class CustomFloatFormat {
+public:
+    static constexpr int kMaxExpBits = 11;
+    static constexpr int kMaxMantBits = 52;
+
+    CustomFloatFormat(int exp_bits, int mant_bits);
+
+    [[nodiscard]] int exp_bits() const { return exp_bits_; }
+    [[nodiscard]] int mant_bits() const { return mant_bits_; }
+    [[nodiscard]] int width() const { return exp_bits_ + mant_bits_; }
+    [[nodiscard]] std::uint64_t max_code() const { return max_code_; }
+    [[nodiscard]] double max_value() const { return max_value_; }
+    [[nodiscard]] double min_value() const { return min_value_; }
+
+    [[nodiscard]] std::uint64_t encode(double value) const {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        const std::uint64_t abs = bits & ~kSignBit;
+        const std::uint64_t neg = bits >> 63;
+        const std::uint64_t special = static_cast<std::uint64_t>(abs >= kInfBits);
+        const std::uint64_t high = special | ((neg ^ 1U) & static_cast<std::uint64_t>(abs >= max_bits_));
+        const std::uint64_t low = (special ^ 1U) & (neg | static_cast<std::uint64_t>(abs < min_bits_));
+
+        const std::uint64_t exp_field = abs >> 52;
+        const std::uint64_t subnormal = static_cast<std::uint64_t>(exp_field == 0);
+        const std::uint64_t mant = ((abs << subnormal) & kMantMask) >> mant_shift_;
+        const std::uint64_t code = ((exp_field + exp_offset_) << mant_bits_) | mant;
+
+        const std::uint64_t keep = (high | low) - 1;  // all ones iff in range
+        return (code & keep) | (max_code_ & (0 - high));
+    }
+
+    [[nodiscard]] double decode(std::uint64_t code) const {
+        const double mantissa = 1.0 + static_cast<double>(code & mant_mask_) * inv_mant_scale_;
+        return mantissa * pow2_[code >> mant_bits_];
+    }
+
+    [[nodiscard]] double quantize(double value) const { return decode(encode(value)); }
+
+    // Batch forms of encode/quantize; vectorized where the CPU allows.
+    void encode_batch(const double* values, std::uint64_t* codes, std::size_t n) const;
+    void quantize_batch(const double* values, double* out, std::size_t n) const;
+
+    bool operator==(const CustomFloatFormat& other) const {
+        return exp_bits_ == other.exp_bits_ && mant_bits_ == other.mant_bits_;
+    }
+    bool operator!=(const CustomFloatFormat& other) const { return !(*this == other); }
+
+private:
+    static constexpr std::uint64_t kSignBit = std::uint64_t{1} << 63;
+    static constexpr std::uint64_t kInfBits = 0x7FF0000000000000ULL;
+    static constexpr std::uint64_t kMantMask = (std::uint64_t{1} << 52) - 1;
+
+    int exp_bits_;
+    int mant_bits_;
+    unsigned mant_shift_;        // 52 - mant_bits
+    std::uint64_t exp_offset_;   // bias - 1023, wrapped; added to the double exponent field
+    std::uint64_t mant_mask_;
+    std::uint64_t max_code_;
+    std::uint64_t min_bits_;     // IEEE bits of min_value_
+    std::uint64_t max_bits_;     // IEEE bits of max_value_ (+inf when it overflows a double)
+    double min_value_;
+    double max_value_;
+    double inv_mant_scale_;
+    const double* pow2_;         // pow2_[e] == 2^(e - bias)
+
+    void encode_batch_scalar(const double* values, std::uint64_t* codes, std::size_t n) const;
+#if defined(__x86_64__) && defined(__GNUC__)
+    __attribute__((target("avx2")))
+    void encode_batch_avx2(const double* values, std::uint64_t* codes, std::size_t n) const;
+#endif
+};
@@ -0,0 +1,76 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Opt-in record of which registers a sketch has changed since its last
+// checkpoint, so replicas can be sent only those (serialize_delta() in
+// wire_format.hpp) and replication cost follows the change rate, not m.
+//
+// Until track() is called, mark() is a single well-predicted branch. The
+// early-exit add loops only reach it when a register actually moves, which
+// is rare once the sketch's threshold has settled. Tracking costs one bit per
+// register. checkpoint() clears the bits and advances the epoch, which
+// starts at 0 when tracking begins. track() marks every register, since a
+// replica at epoch 0 has seen none of what the sketch already holds.
+class DirtyRegisters {
+public:
+    void track(std::size_t size) {
+        if (tracking_) { return; }
+        size_ = size;
+        words_.assign((size + 63) / 64, ~std::uint64_t{0});
+        if (size % 64 != 0) { words_.back() = (std::uint64_t{1} << (size % 64)) - 1; }
+        tracking_ = true;
+    }
+
+    [[nodiscard]] bool tracking() const { return tracking_; }
+    [[nodiscard]] std::uint64_t epoch() const { return epoch_; }
+
+    void mark(std::size_t i) {
+        if (tracking_) { words_[i >> 6] |= std::uint64_t{1} << (i & 63); }
+    }
+
+    [[nodiscard]] std::size_t count() const {
+        std::size_t n = 0;
+        for (std::uint64_t w : words_) { n += static_cast<std::size_t>(__builtin_popcountll(w)); }
+        return n;
+    }
+
+    // Calls f(begin, length) for every maximal run of marked registers, in
+    // order.
+    template <typename F>
+    void for_each_run(F&& f) const {
+        for (std::size_t begin = next(0, true); begin < size_;) {
+            const std::size_t end = next(begin, false);
+            f(begin, end - begin);
+            begin = next(end, true);
+        }
+    }
+
+    void checkpoint() {
+        std::fill(words_.begin(), words_.end(), 0);
+        ++epoch_;
+    }
+
+    [[nodiscard]] std::size_t bytes() const { return words_.capacity() * sizeof(std::uint64_t); }
+
+private:
+    // First position >= pos whose bit equals marked, or size_. Bits past
+    // size_ are never set, so a run of marked registers always ends by size_.
+    [[nodiscard]] std::size_t next(std::size_t pos, bool marked) const {
+        std::size_t w = pos >> 6;
+        if (w >= words_.size()) { return size_; }
+        std::uint64_t bits = (marked ? words_[w] : ~words_[w]) & (~std::uint64_t{0} << (pos & 63));
+        while (bits == 0) {
+            if (++w == words_.size()) { return size_; }
+            bits = marked ? words_[w] : ~words_[w];
+        }
+        return std::min(size_, w * 64 + static_cast<std::size_t>(__builtin_ctzll(bits)));
+    }
+
+    std::vector<std::uint64_t> words_;
+    std::size_t size_ = 0;
+    std::uint64_t epoch_ = 0;
+    bool tracking_ = false;
+};
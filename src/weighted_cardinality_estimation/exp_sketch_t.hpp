@@ -42,6 +42,10 @@ public:
         return static_cast<double>(equal) / static_cast<double>(size);
     }
 
+    [[nodiscard]] JaccardCodes jaccard_codes() const override {
+        return pack_jaccard_codes<decltype(float_code(T{}))>(size, [this](std::size_t i) { return float_code(M_[i]); });
+    }
+
     const std::vector<T>& get_registers() const { return M_; }
 
     void merge(const ExpSketchT& other) {
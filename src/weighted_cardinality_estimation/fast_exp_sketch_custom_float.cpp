@@ -9,10 +9,13 @@ FastExpSketchCustomFloat::FastExpSketchCustomFloat(
     int exp_bits, int mant_bits,
     RngEngine engine
 ) : Sketch(sketch_size, master_seed),
-    exp_bits_(exp_bits), mant_bits_(mant_bits),
-    M_(sketch_size, custom_float_max(exp_bits, mant_bits, kMode)),
+    format_(exp_bits, mant_bits),
+    M_(format_.width(), sketch_size),
     fisher_yates(sketch_size, engine),
-    max_(custom_float_max(exp_bits, mant_bits, kMode)) {}
+    max_code_(format_.max_code()),
+    max_(format_.max_value()) {
+    for (std::size_t i = 0; i < sketch_size; ++i) { M_[i] = max_code_; }
+}
 
 FastExpSketchCustomFloat::FastExpSketchCustomFloat(
     std::size_t sketch_size,
@@ -21,10 +24,23 @@ FastExpSketchCustomFloat::FastExpSketchCustomFloat(
     const std::vector<double>& registers,
     RngEngine engine
 ) : Sketch(sketch_size, master_seed),
-    exp_bits_(exp_bits), mant_bits_(mant_bits),
-    M_(registers),
+    format_(exp_bits, mant_bits),
+    M_(format_.width(), sketch_size),
     fisher_yates(sketch_size, engine),
-    max_(*std::max_element(registers.begin(), registers.end())) {}
+    max_code_(0), max_(0.0) {
+    if (registers.size() != sketch_size) {
+        throw std::invalid_argument("Register count does not match sketch size.");
+    }
+    std::vector<std::uint64_t> codes(sketch_size);
+    format_.encode_batch(registers.data(), codes.data(), sketch_size);
+    std::copy(codes.begin(), codes.end(), M_.begin());
+    refresh_max();
+}
+
+void FastExpSketchCustomFloat::refresh_max() {
+    max_code_ = *std::max_element(M_.begin(), M_.end());
+    max_ = format_.decode(max_code_);
+}
 
 void FastExpSketchCustomFloat::add(const std::string& elem, double weight) {
     validate_weight(weight);
@@ -38,25 +54,27 @@ void FastExpSketchCustomFloat::add(const std::string& elem, double weight) {
         double E = -std::log(U) / weight;
 
         S += E / static_cast<double>(size - k);
-        if (S >= max_) { break; }
+        stats_.on_iteration();
+        if (S >= max_) { stats_.on_early_exit(); break; }
 
         std::uint32_t j = fisher_yates.get_fisher_yates_element(k);
-        double quantized = quantize_custom_float(S, 0, exp_bits_, mant_bits_, kMode);
+        std::uint64_t code = format_.encode(S);
 
-        if (quantized < M_[j]) {
-            if (M_[j] == max_) { update_max = true; }
-            M_[j] = quantized;
+        std::uint64_t current = M_[j];
+        if (code < current) {
+            stats_.on_register_update();
+            if (current == max_code_) { update_max = true; }
+            M_[j] = code;
         }
     }
 
-    if (update_max) {
-        max_ = *std::max_element(M_.begin(), M_.end());
-    }
+    stats_.on_add();
+    if (update_max) { stats_.on_rescan(); refresh_max(); }
 }
 
 double FastExpSketchCustomFloat::estimate() const {
     double total = 0.0;
-    for (double val : M_) { total += val; }
+    for (std::size_t i = 0; i < size; ++i) { total += format_.decode(M_[i]); }
     return (static_cast<double>(size) - 1.0) / total;
 }
 
@@ -69,32 +87,43 @@ double FastExpSketchCustomFloat::jaccard_struct(const FastExpSketchCustomFloat&
     return static_cast<double>(equal) / static_cast<double>(size);
 }
 
-const std::vector<double>& FastExpSketchCustomFloat::get_registers() const { return M_; }
+std::vector<double> FastExpSketchCustomFloat::get_registers() const {
+    std::vector<double> regs(size);
+    for (std::size_t i = 0; i < size; ++i) { regs[i] = format_.decode(M_[i]); }
+    return regs;
+}
+
+JaccardCodes FastExpSketchCustomFloat::jaccard_codes() const {
+    const auto code_of = [this](std::size_t i) { return static_cast<std::uint64_t>(M_[i]); };
+    const int bits = format_.exp_bits() + format_.mant_bits();
+    JaccardCodes codes = bits <= 32 ? pack_small_register_codes(size, static_cast<unsigned>(bits), code_of)
+                                    : pack_jaccard_codes<std::uint64_t>(size, code_of);
+    codes.params = {static_cast<double>(format_.exp_bits()), static_cast<double>(format_.mant_bits())};
+    return codes;
+}
 
 void FastExpSketchCustomFloat::merge(const FastExpSketchCustomFloat& other) {
     if (other.size != size)
         throw std::invalid_argument("Cannot merge sketches of different sizes.");
-    if (other.exp_bits_ != exp_bits_ || other.mant_bits_ != mant_bits_)
+    if (other.format_ != format_)
         throw std::invalid_argument("Cannot merge sketches with different float formats.");
     for (std::size_t i = 0; i < size; ++i)
-        M_[i] = std::min(M_[i], other.M_[i]);
-    max_ = *std::max_element(M_.begin(), M_.end());
+        M_[i] = std::min<std::uint64_t>(M_[i], other.M_[i]);
+    refresh_max();
 }
 
 FastExpSketchCustomFloat FastExpSketchCustomFloat::clone_with(int exp_bits, int mant_bits) const {
-    if (exp_bits > exp_bits_ || mant_bits > mant_bits_)
+    if (exp_bits > format_.exp_bits() || mant_bits > format_.mant_bits())
         throw std::invalid_argument("clone_with: new format must not exceed original precision");
-    std::vector<double> new_regs(size);
-    for (std::size_t i = 0; i < size; ++i)
-        new_regs[i] = quantize_custom_float(M_[i], 0, exp_bits, mant_bits, kMode);
-    return FastExpSketchCustomFloat(size, get_master_seed(), exp_bits, mant_bits, new_regs);
+    // The registers ctor re-encodes (truncates) each decoded value into the narrower format.
+    return FastExpSketchCustomFloat(size, get_master_seed(), exp_bits, mant_bits, get_registers());
 }
 
 size_t FastExpSketchCustomFloat::memory_usage(uint64_t flags) const {
     uint64_t f = resolve_flags(flags);
     size_t s = 0;
-    if (f & MemoryFlag::REGISTERS) s += M_.capacity() * sizeof(double);
-    if (f & MemoryFlag::ALL_WRITE_NO_REGISTERS) s += sizeof(size) + sizeof(max_);
+    if (f & MemoryFlag::REGISTERS) s += M_.bytes();
+    if (f & MemoryFlag::ALL_WRITE_NO_REGISTERS) s += sizeof(size) + sizeof(max_code_) + sizeof(max_);
     s += fisher_yates.memory_usage(f);
     if (f & MemoryFlag::SEEDS) s += seeds_.bytes();
     return s;
@@ -4,12 +4,15 @@
 #include <vector>
 #include <string>
 #include <cstdint>
+#include "compact_vector.hpp"
+#include "custom_float_format.hpp"
 #include "fisher_yates.hpp"
 #include "hash_util.hpp"
-#include "quantize_custom_float.hpp"
 #include "rng_engine_type.hpp"
 #include "sketch.hpp"
 
+// Registers are stored bit-packed as ALL_NORMAL codes (exp_bits + mant_bits bits each)
+// rather than as decoded doubles; see CustomFloatFormat.
 class FastExpSketchCustomFloat : public Sketch, public MergeableMixin, public JaccardMixin {
 public:
     FastExpSketchCustomFloat(
@@ -29,21 +32,23 @@ public:
     void add(const std::string& elem, double weight = 1.0) override;
     [[nodiscard]] double estimate() const override;
     [[nodiscard]] double jaccard_struct(const FastExpSketchCustomFloat& other) const;
+    [[nodiscard]] JaccardCodes jaccard_codes() const override;
     void merge(const FastExpSketchCustomFloat& other);
 
-    const std::vector<double>& get_registers() const;
+    [[nodiscard]] std::vector<double> get_registers() const;
     [[nodiscard]] FastExpSketchCustomFloat clone_with(int exp_bits, int mant_bits) const;
 
-    [[nodiscard]] int get_exp_bits() const { return exp_bits_; }
-    [[nodiscard]] int get_mant_bits() const { return mant_bits_; }
+    [[nodiscard]] int get_exp_bits() const { return format_.exp_bits(); }
+    [[nodiscard]] int get_mant_bits() const { return format_.mant_bits(); }
 
     [[nodiscard]] size_t memory_usage(uint64_t flags) const override;
 
 private:
-    static constexpr QuantizationMode kMode = QuantizationMode::ALL_NORMAL;
-    int exp_bits_;
-    int mant_bits_;
-    std::vector<double> M_;
+    CustomFloatFormat format_;
+    compact::vector<std::uint64_t> M_;
     FisherYates fisher_yates;
+    std::uint64_t max_code_;
     double max_;
+
+    void refresh_max();
 };
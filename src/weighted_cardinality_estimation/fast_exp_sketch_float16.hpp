@@ -0,0 +1,5 @@
+#pragma once
+#include "fast_exp_sketch_t.hpp"
+#include "float16.hpp"
+using FastExpSketchFloat16 = FastExpSketchT<Float16>;
+using FastExpSketchBFloat16 = FastExpSketchT<BFloat16>;
@@ -2,65 +2,113 @@
 #include <algorithm>
 #include <cmath>
 #include <limits>
+#include <optional>
 #include <vector>
 #include <string>
 #include <cstdint>
+#include "cow_registers.hpp"
+#include "dirty_registers.hpp"
 #include "fisher_yates.hpp"
 #include "hash_util.hpp"
 #include "rng_engine_type.hpp"
 #include "sketch.hpp"
+#include "small_set.hpp"
+
+// total plus the registers, in order; float16.hpp overloads it for Float16.
+template <typename T>
+double accumulate_registers(double total, const T* data, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) { total += static_cast<double>(data[i]); }
+    return total;
+}
 
 template <typename T>
 class FastExpSketchT : public Sketch, public MergeableMixin, public JaccardMixin {
 public:
-    FastExpSketchT(std::size_t sketch_size, std::uint64_t master_seed, RngEngine engine = kDefaultRngEngine)
+    // small_capacity > 0 starts in small mode (see SmallSet): registers and
+    // Fisher-Yates scratch are allocated once more than small_capacity
+    // distinct elements arrive.
+    FastExpSketchT(std::size_t sketch_size, std::uint64_t master_seed, RngEngine engine = kDefaultRngEngine,
+                   std::size_t small_capacity = 0)
         : Sketch(sketch_size, master_seed),
-          M_(sketch_size, std::numeric_limits<T>::infinity()),
-          fisher_yates(sketch_size, engine),
-          max(std::numeric_limits<T>::infinity())
-    {}
+          M_(small_capacity == 0 ? sketch_size : 0, std::numeric_limits<T>::infinity()),
+          engine_(engine),
+          max(std::numeric_limits<T>::infinity()),
+          small_(small_capacity)
+    {
+        if (!small_.active()) { fisher_yates.emplace(sketch_size, engine); }
+    }
 
     FastExpSketchT(std::size_t sketch_size, std::uint64_t master_seed, const std::vector<T>& registers, RngEngine engine = kDefaultRngEngine)
         : Sketch(sketch_size, master_seed),
           M_(registers),
-          fisher_yates(sketch_size, engine)
+          fisher_yates(std::in_place, sketch_size, engine),
+          engine_(engine)
     {
-        max = *std::max_element(M_.begin(), M_.end());
+        max = M_.max();
     }
 
     void add(const std::string& elem, double weight = 1.0) override {
         validate_weight(weight);
-        double S = 0;
-        bool updateMax = false;
+        if (small_.active()) {
+            if (small_.insert(elem, weight)) { return; }
+            promote();
+        }
+        AddStep step;
 
-        fisher_yates.initialize(elem);
+        if (!fisher_yates) { fisher_yates.emplace(size, engine_); }
+        fisher_yates->initialize(elem);
         for (std::size_t k = 0; k < size; ++k) {
             std::uint64_t hashed = murmur64(elem, seeds_[k]);
             double U = to_unit_interval(hashed);
-            double E = -std::log(U) / weight;
-
-            S += E / static_cast<double>(size - k);
-            if (S >= static_cast<double>(max)) { break; }
+            if (!advance(step, k, -std::log(U), weight)) { break; }
+            update_register(step, fisher_yates->get_fisher_yates_element(k));
+        }
+        finish_element(step);
+    }
 
-            std::uint32_t j = fisher_yates.get_fisher_yates_element(k);
+    // add() split at the per-step work shared with SketchGroup members:
+    // neg_log_u = -log(U_k), j = k-th Fisher-Yates index.
+    bool advance(AddStep& step, std::size_t k, double neg_log_u, double weight) const {
+        double E = neg_log_u / weight;
+        step.sum += E / static_cast<double>(size - k);
+        stats_.on_iteration();
+        if (step.sum < static_cast<double>(max)) { return true; }
+        stats_.on_early_exit();
+        return false;
+    }
 
-            if (M_[j] == max) { updateMax = true; }
-            M_[j] = std::min(static_cast<T>(S), M_[j]);
+    // Stores only when the register drops, so snapshot-shared blocks are
+    // copied only when they actually change. A max register that the rounded
+    // sum merely ties (common with 16-bit registers) does not force a rescan.
+    void update_register(AddStep& step, std::uint32_t j) {
+        const T current = M_[j];
+        const T value = static_cast<T>(step.sum);
+        if (value < current) {
+            if (current == max) { step.touched = true; }
+            stats_.on_register_update();
+            M_.set(j, value);
+            changes_.mark(j);
         }
+    }
 
-        if (updateMax) {
-            max = *std::max_element(M_.begin(), M_.end());
+    void finish_element(const AddStep& step) {
+        stats_.on_add();
+        if (step.touched) {
+            stats_.on_rescan();
+            max = M_.max();
         }
     }
 
     [[nodiscard]] double estimate() const override {
+        if (small_.active()) { return small_.total_weight(); }
         double total = 0.0;
-        for (T val : M_) { total += static_cast<double>(val); }
+        M_.for_each_block([&total](const T* data, std::size_t n) { total = accumulate_registers(total, data, n); });
         return (static_cast<double>(size) - 1.0) / total;
     }
 
     [[nodiscard]] double jaccard_struct(const FastExpSketchT& other) const {
         if (other.size != size) { return 0.0; }
+        if (small_.active() || other.small_.active()) { return densified().jaccard_struct(other.densified()); }
         std::size_t equal = 0;
         for (std::size_t i = 0; i < size; ++i) {
             if (M_[i] == other.M_[i]) { ++equal; }
@@ -68,28 +116,130 @@ public:
         return static_cast<double>(equal) / static_cast<double>(size);
     }
 
-    const std::vector<T>& get_registers() const { return M_; }
+    [[nodiscard]] JaccardCodes jaccard_codes() const override {
+        if (small_.active()) { return densified().jaccard_codes(); }
+        return pack_jaccard_codes<decltype(float_code(T{}))>(size, [this](std::size_t i) { return float_code(M_[i]); });
+    }
+
+    [[nodiscard]] RngEngine get_rng_engine() const { return engine_; }
+    std::vector<T> get_registers() const { return small_.active() ? densified().get_registers() : M_.to_vector(); }
+    // Empty in small mode; see densified().
+    const CowRegisters<T>& registers() const { return M_; }
 
+    // A small-mode other is replayed into this sketch; a dense one promotes it.
     void merge(const FastExpSketchT& other) {
         if (other.size != size) { throw std::invalid_argument("Cannot merge sketches of different sizes."); }
+        if (other.small_.active()) {
+            other.small_.for_each([this](const std::string& elem, double weight) { add(elem, weight); });
+            return;
+        }
+        promote();
+        if (changes_.tracking()) {
+            for (std::size_t i = 0; i < size; ++i) {
+                if (other.M_[i] < M_[i]) {
+                    M_.set(i, other.M_[i]);
+                    changes_.mark(i);
+                }
+            }
+        } else {
+            M_.min_with(other.M_);
+        }
+        max = M_.max();
+    }
+
+    // Merges a register array of another sketch of this size (as decoded by
+    // merge_wire()) without constructing it.
+    void merge_registers(const T* registers, std::size_t count) {
+        if (count != size) { throw std::invalid_argument("Cannot merge sketches of different sizes."); }
+        promote();
         for (std::size_t i = 0; i < size; ++i) {
-            M_[i] = std::min(M_[i], other.M_[i]);
+            if (registers[i] < M_[i]) {
+                M_.set(i, registers[i]);
+                changes_.mark(i);
+            }
+        }
+        max = M_.max();
+    }
+
+    // The same for registers indices[0..count) only (as decoded by
+    // apply_delta()). Throws std::invalid_argument, changing nothing, for an
+    // index past the end.
+    void merge_registers_at(const std::uint32_t* indices, const T* registers, std::size_t count) {
+        if (std::any_of(indices, indices + count, [this](std::uint32_t i) { return i >= size; })) {
+            throw std::invalid_argument("Register index out of range.");
         }
-        max = *std::max_element(M_.begin(), M_.end());
+        promote();
+        bool touched = false;
+        for (std::size_t k = 0; k < count; ++k) {
+            const std::uint32_t i = indices[k];
+            if (registers[k] < M_[i]) {
+                touched = touched || M_[i] == max;
+                M_.set(i, registers[k]);
+                changes_.mark(i);
+            }
+        }
+        if (touched) { max = M_.max(); }
+    }
+
+    // Opt-in change tracking for delta replication (see DirtyRegisters and
+    // serialize_delta()). Deltas are register runs, so a small-mode sketch
+    // is promoted.
+    void track_changes() {
+        promote();
+        changes_.track(size);
+    }
+    [[nodiscard]] const DirtyRegisters& changes() const { return changes_; }
+    void checkpoint_changes() { changes_.checkpoint(); }
+
+    [[nodiscard]] bool small_mode() const { return small_.active(); }
+    [[nodiscard]] std::size_t small_capacity() const { return small_.capacity(); }
+    const SmallSet& small_set() const { return small_; }
+
+    // Leaves small mode: allocates the registers and replays the buffered elements.
+    void promote() {
+        if (!small_.active()) { return; }
+        const SmallSet buffered = small_.release();
+        M_ = CowRegisters<T>(size, std::numeric_limits<T>::infinity());
+        max = std::numeric_limits<T>::infinity();
+        buffered.for_each([this](const std::string& elem, double weight) { add(elem, weight); });
+    }
+
+    // Dense copy with the registers this sketch has or would promote to.
+    [[nodiscard]] FastExpSketchT densified() const {
+        FastExpSketchT copy(*this);
+        copy.promote();
+        return copy;
+    }
+
+    // Frozen copy of the current state that shares register blocks with this
+    // sketch (see CowRegisters) and builds its Fisher-Yates scratch only if it
+    // is added to. Call it on the thread that writes; the snapshot can then be
+    // estimated, compared and merged from other threads while this sketch
+    // keeps ingesting.
+    FastExpSketchT snapshot() {
+        if (small_.active()) { return FastExpSketchT(*this); }
+        return FastExpSketchT(*this, M_.share());
     }
 
     [[nodiscard]] size_t memory_usage(uint64_t flags) const override {
         uint64_t f = resolve_flags(flags);
         size_t s = 0;
-        if (f & MemoryFlag::REGISTERS) s += M_.capacity() * sizeof(T);
-        if (f & MemoryFlag::ALL_WRITE_NO_REGISTERS) s += sizeof(size) + sizeof(max);
-        s += fisher_yates.memory_usage(f);
+        if (f & MemoryFlag::REGISTERS) s += M_.size() * sizeof(T) + small_.bytes();
+        if (f & MemoryFlag::ALL_WRITE_NO_REGISTERS) s += sizeof(size) + sizeof(max) + M_.block_table_bytes() + changes_.bytes();
+        if (fisher_yates) { s += fisher_yates->memory_usage(f); }
         if (f & MemoryFlag::SEEDS) s += seeds_.bytes();
         return s;
     }
 
 private:
-    std::vector<T> M_;
-    FisherYates fisher_yates;
+    FastExpSketchT(const FastExpSketchT& source, CowRegisters<T> shared)
+        : Sketch(source), M_(std::move(shared)), engine_(source.engine_), max(source.max), small_(source.small_),
+          changes_(source.changes_) {}
+
+    CowRegisters<T> M_;
+    std::optional<FisherYates> fisher_yates;  // empty in snapshots until their first add()
+    RngEngine engine_;
     T max;
+    SmallSet small_;
+    DirtyRegisters changes_;
 };
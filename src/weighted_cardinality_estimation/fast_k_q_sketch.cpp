@@ -2,6 +2,7 @@
 #include <cmath>
 #include <stdexcept>
 #include "hash_util.hpp"
+#include "jaccard_batch.hpp"
 #include<cstring>
 #include "utils.hpp"
 #include"fast_k_q_sketch.hpp"
@@ -11,18 +12,26 @@ kQSketch::kQSketch(
     std::uint64_t master_seed, 
     uint8_t amount_bits,
     float logarithm_base,
-    RngEngine engine
+    RngEngine engine,
+    std::size_t small_capacity
 )
     : Sketch(sketch_size, master_seed),
-      fisher_yates(size, engine),
       amount_bits_(amount_bits),
       logarithm_base(logarithm_base),
       r_max((1 << (amount_bits - 1)) - 1),
       r_min(-(1 << (amount_bits - 1)) + 1),
-      M_(amount_bits, sketch_size)
+      M_(amount_bits, small_capacity == 0 ? sketch_size : 0),
+      engine_(engine),
+      small_(small_capacity)
 {
     if (amount_bits < 2) { throw std::invalid_argument("Amount of bits 'b' must be >= 2."); }
+    if (small_.active()) {
+        min_sketch_value = r_min;
+        min_value_to_change_sketch = std::pow(logarithm_base, -r_min);
+        return;
+    }
 
+    fisher_yates.emplace(size, engine);
     std::fill(M_.begin(), M_.end(), r_min);
     update_treshold();
 }
@@ -36,12 +45,13 @@ kQSketch::kQSketch(
     RngEngine engine
 )
     : Sketch(sketch_size, master_seed),
-      fisher_yates(size, engine),
+      fisher_yates(std::in_place, size, engine),
       amount_bits_(amount_bits),
       logarithm_base(logarithm_base),
       r_max((1 << (amount_bits - 1)) - 1),
       r_min(-(1 << (amount_bits - 1)) + 1),
-      M_(amount_bits, sketch_size)
+      M_(amount_bits, sketch_size),
+      engine_(engine)
 {
     if (amount_bits < 2) { throw std::invalid_argument("Amount of bits 'b' must be >= 2."); }
     if (registers.size() != sketch_size) { throw std::invalid_argument("Invalid state: registers vector size mismatch"); }
@@ -55,9 +65,9 @@ kQSketch::kQSketch(
 size_t kQSketch::memory_usage(uint64_t flags) const {
     uint64_t f = resolve_flags(flags);
     size_t s = 0;
-    if (f & MemoryFlag::REGISTERS) s += M_.bytes();
-    if (f & MemoryFlag::ALL_WRITE_NO_REGISTERS) s += sizeof(size) + sizeof(amount_bits_) + sizeof(r_max) + sizeof(r_min) + sizeof(logarithm_base) + sizeof(min_sketch_value) + sizeof(min_value_to_change_sketch);
-    s += fisher_yates.memory_usage(f);
+    if (f & MemoryFlag::REGISTERS) s += M_.bytes() + small_.bytes();
+    if (f & MemoryFlag::ALL_WRITE_NO_REGISTERS) s += sizeof(size) + sizeof(amount_bits_) + sizeof(r_max) + sizeof(r_min) + sizeof(logarithm_base) + sizeof(min_sketch_value) + sizeof(min_value_to_change_sketch) + changes_.bytes();
+    if (fisher_yates) { s += fisher_yates->memory_usage(f); }
     if (f & MemoryFlag::SEEDS) s += seeds_.bytes();
     return s;
 }
@@ -65,6 +75,7 @@ size_t kQSketch::memory_usage(uint64_t flags) const {
 std::uint8_t kQSketch::get_amount_bits() const { return amount_bits_; }
 float kQSketch::get_logarithm_base() const { return logarithm_base; }
 std::vector<int> kQSketch::get_registers() const {
+    if (small_.active()) { return densified().get_registers(); }
     return std::vector<int>(M_.begin(), M_.end());
 }
 
@@ -75,34 +86,69 @@ void kQSketch::update_treshold(){
 
 void kQSketch::add(const std::string& elem, double weight){ 
     validate_weight(weight);
-    double S = 0;
-    bool touched_min = false; 
+    if (small_.active()) {
+        if (small_.insert(elem, weight)) { return; }
+        promote();
+    }
+    AddStep step;
 
-    fisher_yates.initialize(elem); 
+    fisher_yates->initialize(elem); 
     for (size_t k = 0; k < this->size; ++k){
         std::uint64_t hashed = murmur64(elem, seeds_[k]); 
         double unit_interval_hash = to_unit_interval(hashed); 
-        double exponential_variable = -std::log(unit_interval_hash) / weight; 
-        S += exponential_variable/(double)(this->size-k); 
+        if (!advance(step, k, -std::log(unit_interval_hash), weight)) { break; }
+        update_register(step, fisher_yates->get_fisher_yates_element(k));
+    }
+    finish_element(step);
+} 
 
-        if ( S >= this->min_value_to_change_sketch ) { break; } 
+void kQSketch::promote() {
+    if (!small_.active()) { return; }
+    const SmallSet buffered = small_.release();
+    fisher_yates.emplace(size, engine_);
+    compact::vector<int> registers(amount_bits_, size);
+    std::fill(registers.begin(), registers.end(), r_min);
+    std::swap(M_, registers);
+    update_treshold();
+    buffered.for_each([this](const std::string& elem, double weight) { add(elem, weight); });
+}
 
-        auto j = fisher_yates.get_fisher_yates_element(k);
-        int q = static_cast<int>(std::floor(-std::log(S)/std::log(logarithm_base)));
+kQSketch kQSketch::densified() const {
+    kQSketch copy(*this);
+    copy.promote();
+    return copy;
+}
+
+bool kQSketch::advance(AddStep& step, std::size_t k, double neg_log_u, double weight) const {
+    double exponential_variable = neg_log_u / weight; 
+    step.sum += exponential_variable/(double)(this->size-k); 
+    stats_.on_iteration();
+    if (step.sum < this->min_value_to_change_sketch) { return true; }
+    stats_.on_early_exit();
+    return false;
+}
 
-        q = std::min(q, r_max);
-        if (q > this->M_[j]){
-            if (this->M_[j] == min_sketch_value){
-                touched_min = true;
-            }
-            this->M_[j] = q;
+void kQSketch::update_register(AddStep& step, std::uint32_t j) {
+    int q = static_cast<int>(std::floor(-std::log(step.sum)/std::log(logarithm_base)));
+
+    q = std::min(q, r_max);
+    if (q > this->M_[j]){
+        stats_.on_register_update();
+        if (this->M_[j] == min_sketch_value){
+            step.touched = true;
         }
+        this->M_[j] = q;
+        changes_.mark(j);
     }
+}
 
-    if(touched_min){
+void kQSketch::finish_element(const AddStep& step) {
+    stats_.on_add();
+    if(step.touched){
+        stats_.on_rescan();
         this->update_treshold();
     }
-} 
+}
 
 double kQSketch::initialValue() const {
     double tmp_sum = 0.0;
@@ -152,6 +198,7 @@ std::pair<double, int> kQSketch::Newton_with_iterations(double c0) const {
 }
 
 double kQSketch::estimate_direct() const {
+    if (small_.active()) { return small_.total_weight(); }
     double tmp_sum = 0.0;
     for (int r: M_) {
         tmp_sum += std::pow(logarithm_base, -r);
@@ -162,31 +209,102 @@ double kQSketch::estimate_direct() const {
 }
 
 double kQSketch::estimate_newton_cold() const {
+    if (small_.active()) { return small_.total_weight(); }
     const int r_min_val = *std::min_element(M_.begin(), M_.end());
     return Newton(std::pow(logarithm_base, r_min_val));
 }
 
 double kQSketch::estimate_newton_warm() const {
+    if (small_.active()) { return small_.total_weight(); }
     return Newton(estimate_direct());
 }
 
 int kQSketch::estimate_newton_cold_iterations() const {
+    if (small_.active()) { return 0; }
     const int r_min_val = *std::min_element(M_.begin(), M_.end());
     return Newton_with_iterations(std::pow(logarithm_base, r_min_val)).second;
 }
 
 int kQSketch::estimate_newton_warm_iterations() const {
+    if (small_.active()) { return 0; }
     return Newton_with_iterations(estimate_direct()).second;
 }
 
 double kQSketch::estimate() const {
+    if (small_.active()) { return small_.total_weight(); }
     return Newton(initialValue());
 }
 
 void kQSketch::merge(const kQSketch& other) {
     if (other.size != size) { throw std::invalid_argument("Cannot merge sketches of different sizes."); }
+    if (other.small_.active()) {
+        other.small_.for_each([this](const std::string& elem, double weight) { add(elem, weight); });
+        return;
+    }
+    promote();
     for (std::size_t i = 0; i < size; ++i) {
-        M_[i] = std::max((int)M_[i], (int)other.M_[i]);
+        if (other.M_[i] > M_[i]) {
+            M_[i] = other.M_[i];
+            changes_.mark(i);
+        }
     }
     update_treshold();
 }
+
+void kQSketch::merge_registers(const int* registers, std::size_t count) {
+    if (count != size) { throw std::invalid_argument("Cannot merge sketches of different sizes."); }
+    promote();
+    for (std::size_t i = 0; i < size; ++i) {
+        if (registers[i] > M_[i]) {
+            M_[i] = registers[i];
+            changes_.mark(i);
+        }
+    }
+    update_treshold();
+}
+
+void kQSketch::merge_registers_at(const std::uint32_t* indices, const int* registers, std::size_t count) {
+    if (std::any_of(indices, indices + count, [this](std::uint32_t i) { return i >= size; })) {
+        throw std::invalid_argument("Register index out of range.");
+    }
+    promote();
+    bool touched = false;
+    for (std::size_t k = 0; k < count; ++k) {
+        const std::uint32_t i = indices[k];
+        if (registers[k] > M_[i]) {
+            touched = touched || M_[i] == min_sketch_value;
+            M_[i] = registers[k];
+            changes_.mark(i);
+        }
+    }
+    if (touched) { update_treshold(); }
+}
+
+void kQSketch::track_changes() {
+    promote();
+    changes_.track(size);
+}
+
+double kQSketch::jaccard_struct(const kQSketch& other) const {
+    if (other.size != size) { return 0.0; }
+    if (small_.active() || other.small_.active()) { return densified().jaccard_struct(other.densified()); }
+    std::size_t equal = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        if (M_[i] == other.M_[i]) { ++equal; }
+    }
+    return quantized_jaccard(equal, size, estimate(), other.estimate(), quantization());
+}
+
+JaccardCodes kQSketch::jaccard_codes() const {
+    if (small_.active()) { return densified().jaccard_codes(); }
+    JaccardCodes codes = pack_small_register_codes(size, amount_bits_, [this](std::size_t i) {
+        return static_cast<std::uint32_t>(static_cast<int>(M_[i]) - r_min);
+    });
+    codes.quantization = quantization();
+    codes.weight = estimate();
+    return codes;
+}
+
+RegisterQuantization kQSketch::quantization() const {
+    return {logarithm_base, 0.0, r_min, r_max};
+}
@@ -1,23 +1,28 @@
 #pragma once
 #include "compact_vector.hpp"
+#include <optional>
 #include <vector>
 #include <string>
 #include <cstdint>
 #include <utility>
+#include "dirty_registers.hpp"
 #include "fisher_yates.hpp"
 #include "rng_engine_type.hpp"
 #include "sketch.hpp"
+#include "small_set.hpp"
 
-class kQSketch : public Sketch, public MergeableMixin, public NewtonMixin {
+class kQSketch : public Sketch, public MergeableMixin, public JaccardMixin, public NewtonMixin {
 public:
     static constexpr double newton_max_error = 1e-6;
     static constexpr int newton_max_iterations = 100;
+    // small_capacity > 0 starts in small mode (see SmallSet).
     kQSketch(
         std::size_t sketch_size,
         std::uint64_t master_seed,
         std::uint8_t amount_bits,
         float logarithm_base,
-        RngEngine engine = kDefaultRngEngine
+        RngEngine engine = kDefaultRngEngine,
+        std::size_t small_capacity = 0
     );
     kQSketch(
         std::size_t sketch_size,
@@ -28,6 +33,13 @@ public:
         RngEngine engine = kDefaultRngEngine
     );
     void add(const std::string& elem, double weight = 1.0);
+
+    // add() split at the per-step work shared with SketchGroup members.
+    bool advance(AddStep& step, std::size_t k, double neg_log_u, double weight) const;
+    void update_register(AddStep& step, std::uint32_t j);
+    void finish_element(const AddStep& step);
+
+    // In small mode every estimator returns the exact weight sum (0 iterations).
     [[nodiscard]] double estimate() const;
     [[nodiscard]] double estimate_direct() const;
     [[nodiscard]] double estimate_newton_cold() const;
@@ -38,10 +50,38 @@ public:
     std::uint8_t get_amount_bits() const;
     std::vector<int> get_registers() const;
     float get_logarithm_base() const;
+    [[nodiscard]] RngEngine get_rng_engine() const { return engine_; }
+    // A small-mode other is replayed into this sketch; a dense one promotes it.
     void merge(const kQSketch& other);
+    // Merges a register array of another sketch with this size and parameters
+    // (as decoded by merge_wire()) without constructing it.
+    void merge_registers(const int* registers, std::size_t count);
+    // The same for registers indices[0..count) only (as decoded by
+    // apply_delta()). Throws std::invalid_argument, changing nothing, for an
+    // index past the end.
+    void merge_registers_at(const std::uint32_t* indices, const int* registers, std::size_t count);
+    [[nodiscard]] int register_at(std::size_t i) const { return M_[i]; }
+    [[nodiscard]] double jaccard_struct(const kQSketch& other) const;
+    [[nodiscard]] JaccardCodes jaccard_codes() const override;
+
+    [[nodiscard]] bool small_mode() const { return small_.active(); }
+    [[nodiscard]] std::size_t small_capacity() const { return small_.capacity(); }
+    const SmallSet& small_set() const { return small_; }
+    // Leaves small mode: allocates the registers and replays the buffered elements.
+    void promote();
+    // Dense copy with the registers this sketch has or would promote to.
+    [[nodiscard]] kQSketch densified() const;
+
+    // Opt-in change tracking for delta replication (see DirtyRegisters and
+    // serialize_delta()). Deltas are register runs, so a small-mode sketch
+    // is promoted.
+    void track_changes();
+    [[nodiscard]] const DirtyRegisters& changes() const { return changes_; }
+    void checkpoint_changes() { changes_.checkpoint(); }
 
     [[nodiscard]] size_t memory_usage(uint64_t flags) const override;
 private:
+    [[nodiscard]] RegisterQuantization quantization() const;
     double initialValue() const;
     double ffunc_divided_by_dffunc(double w) const;
     double Newton(double c0) const;
@@ -49,7 +89,7 @@ private:
 
     void update_treshold();
 
-    FisherYates fisher_yates;
+    std::optional<FisherYates> fisher_yates;  // empty in small mode
     std::uint8_t amount_bits_;
     float logarithm_base;
     std::int32_t r_max; // maximum possible value in sketch due to amount of bits per register
@@ -58,4 +98,7 @@ private:
     compact::vector<int> M_; // sketch structure with elements between < r_min ... r_max >
     int min_sketch_value; 
     double min_value_to_change_sketch; // that's 2**{-min_sketch_value}
+    RngEngine engine_;
+    SmallSet small_;
+    DirtyRegisters changes_;
 };
@@ -2,6 +2,7 @@
 #include <cmath>
 #include <stdexcept>
 #include "hash_util.hpp"
+#include "jaccard_batch.hpp"
 #include "fast_k_q_sketch_rounding.hpp"
 
 kQSketchRounding::kQSketchRounding(
@@ -78,20 +79,23 @@ void kQSketchRounding::add(const std::string& elem, double weight) {
         double unit_interval_hash = to_unit_interval(hashed);
         double exponential_variable = -std::log(unit_interval_hash) / weight;
         S += exponential_variable / (double)(this->size - k);
+        stats_.on_iteration();
 
-        if (S >= this->min_value_to_change_sketch) { break; }
+        if (S >= this->min_value_to_change_sketch) { stats_.on_early_exit(); break; }
 
         auto j = fisher_yates.get_fisher_yates_element(k);
         int q = static_cast<int>(std::round(-std::log(S) / std::log(logarithm_base)));
 
         q = std::min(q, r_max);
         if (q > this->M_[j]) {
+            stats_.on_register_update();
             if (this->M_[j] == min_sketch_value) { touched_min = true; }
             this->M_[j] = q;
         }
     }
 
-    if (touched_min) { this->update_treshold(); }
+    stats_.on_add();
+    if (touched_min) { stats_.on_rescan(); this->update_treshold(); }
 }
 
 double kQSketchRounding::estimate_direct() const {
@@ -122,3 +126,25 @@ void kQSketchRounding::merge(const kQSketchRounding& other) {
     }
     update_treshold();
 }
+
+double kQSketchRounding::jaccard_struct(const kQSketchRounding& other) const {
+    if (other.size != size) { return 0.0; }
+    std::size_t equal = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        if (M_[i] == other.M_[i]) { ++equal; }
+    }
+    return quantized_jaccard(equal, size, estimate_corrected(), other.estimate_corrected(), quantization());
+}
+
+JaccardCodes kQSketchRounding::jaccard_codes() const {
+    JaccardCodes codes = pack_small_register_codes(size, amount_bits_, [this](std::size_t i) {
+        return static_cast<std::uint32_t>(static_cast<int>(M_[i]) - r_min);
+    });
+    codes.quantization = quantization();
+    codes.weight = estimate_corrected();
+    return codes;
+}
+
+RegisterQuantization kQSketchRounding::quantization() const {
+    return {logarithm_base, 0.5, r_min, r_max};
+}
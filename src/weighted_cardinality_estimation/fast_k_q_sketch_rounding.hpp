@@ -7,7 +7,7 @@
 #include "rng_engine_type.hpp"
 #include "sketch.hpp"
 
-class kQSketchRounding : public Sketch, public MergeableMixin, public NewtonMixin {
+class kQSketchRounding : public Sketch, public MergeableMixin, public JaccardMixin, public NewtonMixin {
 public:
     kQSketchRounding(
         std::size_t sketch_size,
@@ -37,9 +37,12 @@ public:
     std::vector<int> get_registers() const;
     float get_logarithm_base() const;
     void merge(const kQSketchRounding& other);
+    [[nodiscard]] double jaccard_struct(const kQSketchRounding& other) const;
+    [[nodiscard]] JaccardCodes jaccard_codes() const override;
 
     [[nodiscard]] size_t memory_usage(uint64_t flags) const override;
 private:
+    [[nodiscard]] RegisterQuantization quantization() const;
     void update_treshold();
 
     FisherYates fisher_yates;
@@ -47,31 +47,39 @@ void FastGMExpSketch::add(const std::string& elem, double weight)
         std::uint64_t hashed = murmur64(elem, seeds_[t]); 
         double U = to_unit_interval(hashed); 
         b = b - ((1/weight)*(std::log(U)/(double)(size-t)));
+        stats_.on_iteration();
         uint32_t c = fisher_yates.get_fisher_yates_element(t);
 
         if (!flagFastPrune){
             if (M_[c] < 0){
+                stats_.on_register_update();
                 M_[c] = b;
                 k_star--;
                 if(k_star == 0){ 
                     flagFastPrune = true;
+                    stats_.on_rescan();
                     j_star = argmax(M_);
                 }
             } else if(b < M_[c]){
+                stats_.on_register_update();
                 M_[c] = b;
             }
         } else if (flagFastPrune) {
             if ( b > M_[j_star]){
+                stats_.on_early_exit();
                 break;
             }
             if ( b < M_[c]){
+                stats_.on_register_update();
                 M_[c] = b;
                 if ( c == j_star){
+                    stats_.on_rescan();
                     j_star = argmax(M_);
                 }
             }
         }
     }
+    stats_.on_add();
 } 
 
 size_t FastGMExpSketch::memory_usage(uint64_t flags) const {
@@ -100,6 +108,10 @@ double FastGMExpSketch::jaccard_struct(const FastGMExpSketch& other) const {
 }
 
 
+JaccardCodes FastGMExpSketch::jaccard_codes() const {
+    return pack_jaccard_codes<std::uint64_t>(size, [this](std::size_t i) { return float_code(M_[i]); });
+}
+
 const std::vector<double>& FastGMExpSketch::get_registers() const {
     return M_;
 }
@@ -15,6 +15,7 @@ public:
     void add(const std::string& elem, double weight = 1.0);
     [[nodiscard]] double estimate() const;
     [[nodiscard]] double jaccard_struct(const FastGMExpSketch& other) const;
+    [[nodiscard]] JaccardCodes jaccard_codes() const override;
 
     const std::vector<double>& get_registers() const;
     void merge(const FastGMExpSketch& other);
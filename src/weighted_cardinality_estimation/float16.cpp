@@ -0,0 +1,66 @@
+#include "float16.hpp"
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+double accumulate_registers_scalar(double total, const Float16* data, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) { total += static_cast<double>(data[i]); }
+    return total;
+}
+
+#if defined(__x86_64__) && defined(__GNUC__)
+// vcvtph2ps widens eight registers at once; the adds stay sequential so the
+// result matches the scalar loop bit for bit.
+__attribute__((target("avx,f16c")))
+double accumulate_registers_f16c(double total, const Float16* data, std::size_t n) {
+    alignas(32) float widened[8];
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m128i halves = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        _mm256_store_ps(widened, _mm256_cvtph_ps(halves));
+        for (float w : widened) { total += static_cast<double>(w); }
+    }
+    return accumulate_registers_scalar(total, data + i, n - i);
+}
+#endif
+
+}  // namespace
+
+#if defined(WCE_FLOAT16_DISPATCH)
+namespace float16_detail {
+
+namespace {
+
+// Read as false until static initialization reaches it, which only costs
+// speed.
+const bool kHasF16C = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("f16c") != 0;
+}();
+
+__attribute__((target("f16c")))
+std::uint16_t float_to_half_f16c(float f) {
+    return static_cast<std::uint16_t>(_cvtss_sh(f, _MM_FROUND_TO_NEAREST_INT));
+}
+
+__attribute__((target("f16c")))
+float half_to_float_f16c(std::uint16_t h) { return _cvtsh_ss(h); }
+
+}  // namespace
+
+std::uint16_t float_to_half_dispatch(float f) { return kHasF16C ? float_to_half_f16c(f) : float_to_half_soft(f); }
+
+float half_to_float_dispatch(std::uint16_t h) { return kHasF16C ? half_to_float_f16c(h) : half_to_float_soft(h); }
+
+}  // namespace float16_detail
+#endif
+
+double accumulate_registers(double total, const Float16* data, std::size_t n) {
+#if defined(__x86_64__) && defined(__GNUC__)
+    static const bool has_f16c = __builtin_cpu_supports("f16c");
+    if (has_f16c) { return accumulate_registers_f16c(total, data, n); }
+#endif
+    return accumulate_registers_scalar(total, data, n);
+}
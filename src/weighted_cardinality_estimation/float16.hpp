@@ -0,0 +1,234 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+// 16-bit register types for FastExpSketchT: IEEE binary16 (Float16: 5
+// exponent bits, 10 mantissa bits, finite range [6e-8, 65504]) and bfloat16
+// (BFloat16: the top half of a float, 8 exponent and 7 mantissa bits, float's
+// range).
+//
+// Both store raw bits and convert like a float cast: from double through
+// float, rounding to nearest even at each step, with overflow to infinity and
+// gradual underflow. Float16 uses the F16C conversion instructions: inline
+// when the build targets them (-mf16c, -march=native), otherwise on x86-64
+// through a call that checks the CPU once, and bit arithmetic with identical
+// results where F16C is missing. bfloat16 widening is a shift and narrowing
+// three integer operations, so it never needs hardware support.
+//
+// Comparisons work on the bits: for non-NaN values, sign-magnitude patterns
+// order like the values they encode once negatives are flipped, so min and
+// max over registers never convert. +0 and -0 compare equal, NaN compares
+// false, as for float.
+
+namespace float16_detail {
+
+template <std::uint16_t kExpMask>
+struct Bits16 {
+    static bool is_nan(std::uint16_t b) { return (b & 0x7FFF) > kExpMask; }
+    static bool is_zero(std::uint16_t b) { return (b & 0x7FFF) == 0; }
+    // Monotone in the encoded value for non-NaN, non-zero patterns.
+    static std::uint16_t key(std::uint16_t b) {
+        return static_cast<std::uint16_t>((b & 0x8000) != 0 ? ~b : (b | 0x8000));
+    }
+    static bool less(std::uint16_t a, std::uint16_t b) {
+        if (is_nan(a) || is_nan(b)) { return false; }
+        if (is_zero(a) && is_zero(b)) { return false; }
+        return key(a) < key(b);
+    }
+    static bool equal(std::uint16_t a, std::uint16_t b) {
+        if (is_nan(a) || is_nan(b)) { return false; }
+        return a == b || (is_zero(a) && is_zero(b));
+    }
+};
+
+inline std::uint32_t float_bits(float f) {
+    std::uint32_t x;
+    std::memcpy(&x, &f, sizeof(x));
+    return x;
+}
+
+inline float bits_float(std::uint32_t x) {
+    float f;
+    std::memcpy(&f, &x, sizeof(f));
+    return f;
+}
+
+// IEEE float -> binary16, round to nearest even (what F16C does with imm 0).
+inline std::uint16_t float_to_half_soft(float f) {
+    std::uint32_t x = float_bits(f);
+    const std::uint32_t sign = (x >> 16) & 0x8000;
+    x &= 0x7FFFFFFF;
+    if (x >= 0x7F800000) {  // inf, NaN (quieted, top payload bits kept)
+        return static_cast<std::uint16_t>(sign | 0x7C00 | (x > 0x7F800000 ? 0x200 | ((x >> 13) & 0x3FF) : 0));
+    }
+    if (x >= 0x477FF000) { return static_cast<std::uint16_t>(sign | 0x7C00); }  // rounds past 65504
+    if (x < 0x38800000) {  // below 2^-14: subnormal result
+        if (x <= 0x33000000) { return static_cast<std::uint16_t>(sign); }  // at most half of 2^-24
+        const std::uint32_t mant = (x & 0x7FFFFF) | 0x800000;
+        const std::uint32_t shift = 126 - (x >> 23);
+        std::uint32_t h = mant >> shift;
+        const std::uint32_t rem = mant & ((1U << shift) - 1);
+        const std::uint32_t half = 1U << (shift - 1);
+        h += static_cast<std::uint32_t>(rem > half || (rem == half && (h & 1) != 0));
+        return static_cast<std::uint16_t>(sign | h);
+    }
+    std::uint32_t h = (x - 0x38000000) >> 13;  // rebias 127 -> 15
+    const std::uint32_t rem = x & 0x1FFF;
+    h += static_cast<std::uint32_t>(rem > 0x1000 || (rem == 0x1000 && (h & 1) != 0));
+    return static_cast<std::uint16_t>(sign | h);
+}
+
+inline float half_to_float_soft(std::uint16_t h) {
+    const std::uint32_t sign = static_cast<std::uint32_t>(h & 0x8000) << 16;
+    std::uint32_t exp = (h >> 10) & 0x1F;
+    std::uint32_t mant = h & 0x3FF;
+    if (exp == 0x1F) {  // inf, NaN (quieted, as vcvtph2ps does)
+        return bits_float(sign | 0x7F800000 | ((mant != 0 ? mant | 0x200 : 0) << 13));
+    }
+    if (exp != 0) { return bits_float(sign | ((exp + 112) << 23) | (mant << 13)); }
+    if (mant == 0) { return bits_float(sign); }
+    exp = 113;  // subnormal: normalize
+    while ((mant & 0x400) == 0) {
+        mant <<= 1;
+        --exp;
+    }
+    return bits_float(sign | (exp << 23) | ((mant & 0x3FF) << 13));
+}
+
+#if !defined(__F16C__) && defined(__x86_64__) && defined(__GNUC__)
+#define WCE_FLOAT16_DISPATCH 1
+// F16C when the CPU has it, the soft conversions otherwise (float16.cpp).
+std::uint16_t float_to_half_dispatch(float f);
+float half_to_float_dispatch(std::uint16_t h);
+#endif
+
+inline std::uint16_t float_to_half(float f) {
+#if defined(__F16C__)
+    return static_cast<std::uint16_t>(_cvtss_sh(f, _MM_FROUND_TO_NEAREST_INT));
+#elif defined(WCE_FLOAT16_DISPATCH)
+    return float_to_half_dispatch(f);
+#else
+    return float_to_half_soft(f);
+#endif
+}
+
+inline float half_to_float(std::uint16_t h) {
+#if defined(__F16C__)
+    return _cvtsh_ss(h);
+#elif defined(WCE_FLOAT16_DISPATCH)
+    return half_to_float_dispatch(h);
+#else
+    return half_to_float_soft(h);
+#endif
+}
+
+inline std::uint16_t float_to_bfloat16(float f) {
+    const std::uint32_t x = float_bits(f);
+    if ((x & 0x7FFFFFFF) > 0x7F800000) { return static_cast<std::uint16_t>((x >> 16) | 0x40); }  // quiet NaN
+    return static_cast<std::uint16_t>((x + 0x7FFF + ((x >> 16) & 1)) >> 16);
+}
+
+inline float bfloat16_to_float(std::uint16_t b) { return bits_float(static_cast<std::uint32_t>(b) << 16); }
+
+}  // namespace float16_detail
+
+class Float16 {
+public:
+    Float16() = default;
+    explicit Float16(double value) : bits_(float16_detail::float_to_half(static_cast<float>(value))) {}
+
+    static Float16 from_bits(std::uint16_t bits) {
+        Float16 h;
+        h.bits_ = bits;
+        return h;
+    }
+    [[nodiscard]] std::uint16_t bits() const { return bits_; }
+
+    explicit operator float() const { return float16_detail::half_to_float(bits_); }
+    explicit operator double() const { return static_cast<double>(static_cast<float>(*this)); }
+
+    friend bool operator<(Float16 a, Float16 b) { return Ops::less(a.bits_, b.bits_); }
+    friend bool operator>(Float16 a, Float16 b) { return b < a; }
+    friend bool operator<=(Float16 a, Float16 b) { return a < b || a == b; }
+    friend bool operator>=(Float16 a, Float16 b) { return b <= a; }
+    friend bool operator==(Float16 a, Float16 b) { return Ops::equal(a.bits_, b.bits_); }
+    friend bool operator!=(Float16 a, Float16 b) { return !(a == b); }
+
+private:
+    using Ops = float16_detail::Bits16<0x7C00>;
+    std::uint16_t bits_;
+};
+
+class BFloat16 {
+public:
+    BFloat16() = default;
+    explicit BFloat16(double value) : bits_(float16_detail::float_to_bfloat16(static_cast<float>(value))) {}
+
+    static BFloat16 from_bits(std::uint16_t bits) {
+        BFloat16 b;
+        b.bits_ = bits;
+        return b;
+    }
+    [[nodiscard]] std::uint16_t bits() const { return bits_; }
+
+    explicit operator float() const { return float16_detail::bfloat16_to_float(bits_); }
+    explicit operator double() const { return static_cast<double>(static_cast<float>(*this)); }
+
+    friend bool operator<(BFloat16 a, BFloat16 b) { return Ops::less(a.bits_, b.bits_); }
+    friend bool operator>(BFloat16 a, BFloat16 b) { return b < a; }
+    friend bool operator<=(BFloat16 a, BFloat16 b) { return a < b || a == b; }
+    friend bool operator>=(BFloat16 a, BFloat16 b) { return b <= a; }
+    friend bool operator==(BFloat16 a, BFloat16 b) { return Ops::equal(a.bits_, b.bits_); }
+    friend bool operator!=(BFloat16 a, BFloat16 b) { return !(a == b); }
+
+private:
+    using Ops = float16_detail::Bits16<0x7F80>;
+    std::uint16_t bits_;
+};
+
+// total + data[0] + ... + data[n - 1] in double, added in order, as
+// FastExpSketchT::estimate() does for wider registers. Float16 widens eight
+// registers per instruction with F16C where the CPU has it; the sum is the
+// same either way.
+double accumulate_registers(double total, const Float16* data, std::size_t n);
+
+namespace std {
+
+template <>
+class numeric_limits<Float16> {
+public:
+    static constexpr bool is_specialized = true;
+    static constexpr bool is_signed = true;
+    static constexpr bool has_infinity = true;
+    static constexpr bool has_quiet_NaN = true;
+    static constexpr int digits = 11;
+    static Float16 infinity() { return Float16::from_bits(0x7C00); }
+    static Float16 quiet_NaN() { return Float16::from_bits(0x7E00); }
+    static Float16 max() { return Float16::from_bits(0x7BFF); }
+    static Float16 lowest() { return Float16::from_bits(0xFBFF); }
+    static Float16 min() { return Float16::from_bits(0x0400); }
+    static Float16 denorm_min() { return Float16::from_bits(0x0001); }
+};
+
+template <>
+class numeric_limits<BFloat16> {
+public:
+    static constexpr bool is_specialized = true;
+    static constexpr bool is_signed = true;
+    static constexpr bool has_infinity = true;
+    static constexpr bool has_quiet_NaN = true;
+    static constexpr int digits = 8;
+    static BFloat16 infinity() { return BFloat16::from_bits(0x7F80); }
+    static BFloat16 quiet_NaN() { return BFloat16::from_bits(0x7FC0); }
+    static BFloat16 max() { return BFloat16::from_bits(0x7F7F); }
+    static BFloat16 lowest() { return BFloat16::from_bits(0xFF7F); }
+    static BFloat16 min() { return BFloat16::from_bits(0x0080); }
+    static BFloat16 denorm_min() { return BFloat16::from_bits(0x0001); }
+};
+
+}  // namespace std
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+#include <stdexcept>
+
+// Bucket-selection scheme of the stochastic-averaging sketches. The value is a
+// version number: it is persisted alongside the registers so a sketch restored
+// from an older pickle keeps routing elements to the same registers.
+//   MODULO_TWO_HASHES  (v1): bucket = murmur64(x, s1) % m, u = murmur64(x, s2)
+//   MULTIPLY_HIGH_128  (v2): one MurmurHash3_x64_128(x, s1) call,
+//                            bucket = (h.lo * m) >> 64, u = h.hi
+enum class HashScheme : std::uint8_t {
+    MODULO_TWO_HASHES = 1,
+    MULTIPLY_HIGH_128 = 2,
+};
+
+inline constexpr HashScheme kDefaultHashScheme = HashScheme::MULTIPLY_HIGH_128;
+
+inline HashScheme hash_scheme_from_int(int version) {
+    switch (version) {
+        case 1: return HashScheme::MODULO_TWO_HASHES;
+        case 2: return HashScheme::MULTIPLY_HIGH_128;
+        default: throw std::invalid_argument("Unknown hash scheme version.");
+    }
+}
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
 #include <limits>
 #include <string>
@@ -19,6 +20,31 @@ inline std::uint64_t murmur64(
     return hash_answer[0];                              // pierwsze 64 bity
 }
 
+struct Hash128 {
+    std::uint64_t lo;
+    std::uint64_t hi;
+};
+
+inline Hash128 murmur128(
+    const std::string& key,
+    std::uint32_t seed
+)
+{
+    std::uint64_t hash_answer[2];
+    MurmurHash3_x64_128(key.data(),
+                        static_cast<int>(key.size()),
+                        seed,
+                        hash_answer);
+    return {hash_answer[0], hash_answer[1]};
+}
+
+// Lemire's multiply-high range reduction: maps h onto [0, n) without a division.
+inline std::size_t fast_range(std::uint64_t h, std::size_t n)
+{
+    __extension__ using uint128 = unsigned __int128;
+    return static_cast<std::size_t>((static_cast<uint128>(h) * n) >> 64);
+}
+
 inline double to_unit_interval(std::uint64_t num)
 {
     static const double MAX_UINT64 = static_cast<double>(std::numeric_limits<std::uint64_t>::max());
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+
+// Hot-path counters for the early-exit add() loops (FastExp, FastGM, Q, kQ,
+// LogExpFast). Compiled in only with WCE_STATS (CMake: -DWCE_ENABLE_STATS=ON);
+// otherwise every hook is an empty inline function on a static recorder, so the
+// default build has the same object layout and add() code as without the hooks.
+//
+// WCE_STATS changes class layout: define it for every translation unit that
+// includes sketch headers (the wce target exports it as a PUBLIC definition).
+
+struct HotPathStats {
+    std::uint64_t adds = 0;               // elements added (finished add() calls)
+    std::uint64_t iterations = 0;         // early-exit loop steps across all adds
+    std::uint64_t early_exits = 0;        // adds whose loop stopped before m steps
+    std::uint64_t register_updates = 0;   // register writes that changed a value
+    std::uint64_t threshold_rescans = 0;  // full max/argmin/threshold rescans over M
+    std::uint64_t window_shifts = 0;      // window moves of the Shifted sketches
+};
+
+#ifdef WCE_STATS
+inline constexpr bool kStatsEnabled = true;
+#else
+inline constexpr bool kStatsEnabled = false;
+#endif
+
+template <bool Enabled>
+class StatsRecorderT {
+public:
+    void on_iteration() { ++s_.iterations; }
+    void on_early_exit() { ++s_.early_exits; }
+    void on_register_update() { ++s_.register_updates; }
+    void on_rescan() { ++s_.threshold_rescans; }
+    void on_window_shift() { ++s_.window_shifts; }
+    void on_add() { ++s_.adds; }
+
+    [[nodiscard]] HotPathStats get() const { return s_; }
+    void reset() { s_ = HotPathStats{}; }
+
+private:
+    HotPathStats s_;
+};
+
+template <>
+class StatsRecorderT<false> {
+public:
+    void on_iteration() {}
+    void on_early_exit() {}
+    void on_register_update() {}
+    void on_rescan() {}
+    void on_window_shift() {}
+    void on_add() {}
+
+    [[nodiscard]] HotPathStats get() const { return {}; }
+    void reset() {}
+};
+
+using StatsRecorder = StatsRecorderT<kStatsEnabled>;
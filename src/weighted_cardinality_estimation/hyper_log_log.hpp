@@ -23,8 +23,10 @@ public:
         : UnweightedSketch(sketch_size, master_seed), M_(registers),
           seed_(seeds_[0]) {}
 
-    void add(const std::string& elem) override {
-        std::uint64_t h = murmur64(elem, seed_);
+    void add(const std::string& elem) override { add_hashed(elem, murmur64(elem, seed_)); }
+
+    // add() with h = murmur64(elem, seeds_[0]) already computed (SketchGroup shares it).
+    void add_hashed(const std::string& elem, std::uint64_t h) {
         // Bucket selection: use upper bits modulo m for non-power-of-2 support
         std::size_t j = h % size;
         // Remaining bits → rho: rehash with different seed for independent bits
@@ -57,6 +59,15 @@ public:
             M_[i] = std::max(M_[i], other.M_[i]);
     }
 
+    // Merges a register array of another sketch of this size (as decoded by
+    // merge_wire()) without constructing it.
+    void merge_registers(const int* registers, std::size_t count) {
+        if (count != size)
+            throw std::invalid_argument("Cannot merge sketches of different sizes.");
+        for (std::size_t i = 0; i < size; ++i)
+            M_[i] = std::max<int>(M_[i], registers[i]);
+    }
+
     [[nodiscard]] std::vector<uint8_t> get_registers() const { return M_; }
 
     [[nodiscard]] size_t memory_usage(uint64_t flags) const override {
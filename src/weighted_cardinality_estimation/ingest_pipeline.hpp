@@ -0,0 +1,157 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "sketch.hpp"
+#include "spsc_ring.hpp"
+
+// Multi-threaded ingestion for sketches that cannot be split and merged
+// (QSketchDyn, kQSketchRoundedDyn, MartingaleMinHash): their running estimate
+// depends on arrival order, so one instance has to see every element in order.
+//
+// S splits add() into prepare(), which hashes and reads no mutable state, and
+// apply(), which folds a S::Prepared record into the sketch. add_many() runs
+// prepare() on `producers` threads and apply() on the calling thread. Element
+// i is prepared by producer i % producers and sent through that producer's
+// SPSC ring, and the consumer pops the rings round-robin, so records are
+// applied in input order and the sketch ends up identical to calling add()
+// element by element. Throughput scales with producers while hashing
+// dominates apply(): always for MartingaleMinHash (m hashes per element),
+// and for the Dyn sketches once most elements no longer move a register.
+//
+// The pipeline borrows the sketch; do not touch it from elsewhere while an
+// add_many() is running. Rings and their records are reused across calls.
+template <typename S>
+class IngestPipeline {
+public:
+    static constexpr std::size_t kDefaultRingCapacity = 1024;
+
+    // producers == 0 uses hardware_concurrency() - 1 (at least one).
+    explicit IngestPipeline(S& sketch, std::size_t producers = 0,
+                            std::size_t ring_capacity = kDefaultRingCapacity)
+        : sketch_(sketch) {
+        if (producers == 0) {
+            producers = std::max<std::size_t>(1, std::thread::hardware_concurrency()) - 1;
+            producers = std::max<std::size_t>(1, producers);
+        }
+        rings_.reserve(producers);
+        for (std::size_t p = 0; p < producers; ++p) {
+            rings_.push_back(std::make_unique<SpscRing<Record>>(ring_capacity));
+        }
+    }
+
+    [[nodiscard]] std::size_t producers() const { return rings_.size(); }
+    [[nodiscard]] std::size_t ring_capacity() const { return rings_.front()->capacity(); }
+
+    // Weights are validated before any element is applied, so a bad weight
+    // leaves the sketch untouched.
+    void add_many(const std::vector<std::string>& elems, const std::vector<double>& weights) {
+        static_assert(kWeighted, "add_many(elems, weights) needs a weighted sketch");
+        if (elems.size() != weights.size()) {
+            throw std::invalid_argument("add_many: elems and weights size mismatch");
+        }
+        for (double w : weights) { Sketch::validate_weight(w); }
+        run(elems, &weights);
+    }
+
+    // Weight 1 for weighted sketches.
+    void add_many(const std::vector<std::string>& elems) { run(elems, nullptr); }
+
+private:
+    static constexpr bool kWeighted = std::is_base_of_v<Sketch, S>;
+    // Below this many elements thread start-up costs more than it saves.
+    static constexpr std::size_t kMinPipelinedBatch = 4096;
+
+    using Record = typename S::Prepared;
+
+    void prepare(const std::vector<std::string>& elems, const std::vector<double>* weights,
+                 std::size_t i, Record& out) const {
+        if constexpr (kWeighted) {
+            sketch_.prepare(elems[i], weights != nullptr ? (*weights)[i] : 1.0, out);
+        } else {
+            sketch_.prepare(elems[i], out);
+        }
+    }
+
+    // Spins briefly, then yields: producers and consumer may share a core.
+    static void backoff(unsigned& spins) {
+        if (++spins < 64) { return; }
+        std::this_thread::yield();
+    }
+
+    void run(const std::vector<std::string>& elems, const std::vector<double>* weights) {
+        const std::size_t n = elems.size();
+        const std::size_t lanes = rings_.size();
+        if (n < kMinPipelinedBatch) {
+            Record record;
+            for (std::size_t i = 0; i < n; ++i) {
+                prepare(elems, weights, i, record);
+                sketch_.apply(record);
+            }
+            return;
+        }
+
+        std::atomic<bool> failed{false};
+        std::vector<std::exception_ptr> errors(lanes + 1);
+        auto producer = [&](std::size_t lane) {
+            try {
+                SpscRing<Record>& ring = *rings_[lane];
+                for (std::size_t i = lane; i < n; i += lanes) {
+                    Record* slot;
+                    unsigned spins = 0;
+                    while ((slot = ring.try_claim()) == nullptr) {
+                        if (failed.load(std::memory_order_relaxed)) { return; }
+                        backoff(spins);
+                    }
+                    prepare(elems, weights, i, *slot);
+                    ring.publish();
+                }
+            } catch (...) {
+                errors[lane] = std::current_exception();
+                failed.store(true, std::memory_order_relaxed);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(lanes);
+        for (std::size_t lane = 0; lane < lanes; ++lane) { threads.emplace_back(producer, lane); }
+
+        try {
+            for (std::size_t i = 0; i < n && !failed.load(std::memory_order_relaxed); ++i) {
+                SpscRing<Record>& ring = *rings_[i % lanes];
+                const Record* record;
+                unsigned spins = 0;
+                while ((record = ring.try_front()) == nullptr && !failed.load(std::memory_order_relaxed)) {
+                    backoff(spins);
+                }
+                if (record == nullptr) { break; }
+                sketch_.apply(*record);
+                ring.pop();
+            }
+        } catch (...) {
+            errors[lanes] = std::current_exception();
+            failed.store(true, std::memory_order_relaxed);
+        }
+        for (std::thread& t : threads) { t.join(); }
+
+        if (failed.load(std::memory_order_relaxed)) {
+            // Drop records left behind so the next call starts from empty rings.
+            for (auto& ring : rings_) {
+                while (ring->try_front() != nullptr) { ring->pop(); }
+            }
+            for (const std::exception_ptr& e : errors) {
+                if (e) { std::rethrow_exception(e); }
+            }
+        }
+    }
+
+    S& sketch_;
+    std::vector<std::unique_ptr<SpscRing<Record>>> rings_;
+};
@@ -0,0 +1,343 @@
+#include "jaccard_batch.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <typeinfo>
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#endif
+#include "parallel_for.hpp"
+
+namespace {
+
+constexpr std::size_t kRowAlign = 32;
+// Two tiles of rows stay within a typical 256 KiB L2.
+constexpr std::size_t kTileBytes = 128 * 1024;
+
+// ─── Equality counts ──────────────────────────────────────────────────────────
+
+template <typename Code>
+std::size_t count_equal_scalar(const std::uint8_t* a, const std::uint8_t* b, std::size_t size) {
+    std::size_t equal = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        Code x;
+        Code y;
+        std::memcpy(&x, a + i * sizeof(Code), sizeof(Code));
+        std::memcpy(&y, b + i * sizeof(Code), sizeof(Code));
+        equal += (x == y);
+    }
+    return equal;
+}
+
+#if defined(__x86_64__) && defined(__GNUC__)
+// Counts equal codes over whole 32-byte blocks: lanes of equal codes compare to
+// all-ones, so the popcount of the byte mask is code_bytes per equal code.
+// Rows are zero-padded, so the padding counts as equal and the caller subtracts it.
+template <std::size_t CodeBytes>
+__attribute__((target("avx2,popcnt")))
+std::size_t count_equal_avx2(const std::uint8_t* a, const std::uint8_t* b, std::size_t stride) {
+    std::size_t bits = 0;
+    for (std::size_t off = 0; off < stride; off += kRowAlign) {
+        const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + off));
+        const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + off));
+        __m256i eq;
+        if constexpr (CodeBytes == 1) eq = _mm256_cmpeq_epi8(va, vb);
+        else if constexpr (CodeBytes == 2) eq = _mm256_cmpeq_epi16(va, vb);
+        else if constexpr (CodeBytes == 4) eq = _mm256_cmpeq_epi32(va, vb);
+        else eq = _mm256_cmpeq_epi64(va, vb);
+        bits += static_cast<std::size_t>(_mm_popcnt_u32(static_cast<unsigned>(_mm256_movemask_epi8(eq))));
+    }
+    return bits / CodeBytes;
+}
+#endif
+
+bool has_avx2() {
+#if defined(__x86_64__) && defined(__GNUC__)
+    static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+// Codes of n compatible sketches, one zero-padded row of `stride` bytes each.
+class CodeTable {
+public:
+    explicit CodeTable(const std::vector<JaccardCodes>& rows) : n_(rows.size()) {
+        if (rows.empty()) return;
+        const JaccardCodes& first = rows.front();
+        size_ = first.size();
+        code_bytes_ = first.code_bytes;
+        quantization_ = first.quantization;
+        stride_ = (size_ * code_bytes_ + kRowAlign - 1) / kRowAlign * kRowAlign;
+        padding_codes_ = (stride_ - size_ * code_bytes_) / code_bytes_;
+        data_.assign(n_ * stride_, 0);
+        weights_.reserve(n_);
+        for (std::size_t r = 0; r < n_; ++r) {
+            const JaccardCodes& c = rows[r];
+            if (c.code_bytes != code_bytes_ || c.size() != size_ || c.params != first.params
+                || c.quantization != quantization_) {
+                throw std::invalid_argument("Jaccard needs sketches of the same size and parameters.");
+            }
+            std::copy(c.bytes.begin(), c.bytes.end(), data_.begin() + static_cast<std::ptrdiff_t>(r * stride_));
+            weights_.push_back(c.weight);
+        }
+        use_avx2_ = has_avx2();
+    }
+
+    [[nodiscard]] std::size_t rows() const { return n_; }
+    [[nodiscard]] std::size_t stride() const { return stride_; }
+    [[nodiscard]] const std::uint8_t* row(std::size_t r) const { return data_.data() + r * stride_; }
+
+    [[nodiscard]] std::size_t count_equal(const std::uint8_t* a, const std::uint8_t* b) const {
+#if defined(__x86_64__) && defined(__GNUC__)
+        if (use_avx2_) {
+            switch (code_bytes_) {
+                case 1: return count_equal_avx2<1>(a, b, stride_) - padding_codes_;
+                case 2: return count_equal_avx2<2>(a, b, stride_) - padding_codes_;
+                case 4: return count_equal_avx2<4>(a, b, stride_) - padding_codes_;
+                default: return count_equal_avx2<8>(a, b, stride_) - padding_codes_;
+            }
+        }
+#endif
+        switch (code_bytes_) {
+            case 1: return count_equal_scalar<std::uint8_t>(a, b, size_);
+            case 2: return count_equal_scalar<std::uint16_t>(a, b, size_);
+            case 4: return count_equal_scalar<std::uint32_t>(a, b, size_);
+            default: return count_equal_scalar<std::uint64_t>(a, b, size_);
+        }
+    }
+
+    [[nodiscard]] double jaccard(std::size_t equal, double weight_a, double weight_b) const {
+        if (quantization_) return quantized_jaccard(equal, size_, weight_a, weight_b, *quantization_);
+        return static_cast<double>(equal) / static_cast<double>(size_);
+    }
+
+    [[nodiscard]] double jaccard(std::size_t i, std::size_t j) const {
+        return jaccard(count_equal(row(i), row(j)), weights_[i], weights_[j]);
+    }
+
+    [[nodiscard]] double weight(std::size_t r) const { return weights_[r]; }
+    [[nodiscard]] bool quantized() const { return quantization_.has_value(); }
+    [[nodiscard]] std::size_t size() const { return size_; }
+
+private:
+    std::size_t n_;
+    std::size_t size_ = 0;
+    std::size_t code_bytes_ = 1;
+    std::size_t stride_ = 0;
+    std::size_t padding_codes_ = 0;
+    std::optional<RegisterQuantization> quantization_;
+    std::vector<std::uint8_t> data_;
+    std::vector<double> weights_;
+    bool use_avx2_ = false;
+};
+
+std::vector<JaccardCodes> collect_codes(const std::vector<const CardinalitySketch*>& sketches,
+                                        const CardinalitySketch* query) {
+    const CardinalitySketch* reference = query != nullptr ? query : (sketches.empty() ? nullptr : sketches.front());
+    std::vector<JaccardCodes> rows;
+    rows.reserve(sketches.size() + 1);
+    auto append = [&](const CardinalitySketch* s) {
+        const auto* j = dynamic_cast<const JaccardMixin*>(s);
+        if (j == nullptr) throw std::invalid_argument("Sketch does not support Jaccard estimation.");
+        if (typeid(*s) != typeid(*reference)) throw std::invalid_argument("Jaccard needs sketches of one type.");
+        rows.push_back(j->jaccard_codes());
+    };
+    if (query != nullptr) append(query);
+    for (const CardinalitySketch* s : sketches) append(s);
+    return rows;
+}
+
+// ─── Quantized registers ──────────────────────────────────────────────────────
+
+// Relevant codes cover x in [kMinTail / weight_max, kMaxTail / weight_min]; the
+// outermost codes absorb the rest (P(X > 50 / w) = e^-50, and P(X < 1e-6 / w)
+// is far below the 1 / size resolution of the match rate).
+constexpr double kMinTail = 1e-6;
+constexpr double kMaxTail = 50.0;
+
+// P(code_A == code_B) as a function of the shared rate c. With s, t register
+// bounds, P(X_A > s, X_B > t) = e^(-weight_a s - weight_b t + c min(s, t)), so
+// summed over codes the match probability is sum_j coef_j e^(c bound_j) with
+// c-independent coefficients: one exp per bound per evaluation.
+class MatchModel {
+public:
+    MatchModel(double weight_a, double weight_b, const RegisterQuantization& q) {
+        auto code_of = [&](double x) {
+            return static_cast<int>(std::floor(-std::log(x) / std::log(q.base) + q.phase));
+        };
+        const int v_lo = std::max(q.r_min, code_of(kMaxTail / std::min(weight_a, weight_b)));
+        const int v_hi = std::min(q.r_max, std::max(v_lo, code_of(kMinTail / std::max(weight_a, weight_b))));
+        // Code v_lo covers (bound(v_lo + 1), inf), code v_hi covers (0, bound(v_hi)].
+        std::vector<double> bounds;
+        double bound = std::pow(q.base, -(v_lo + 1 - q.phase));
+        for (int v = v_lo + 1; v <= v_hi; ++v, bound /= q.base) bounds.push_back(bound);
+        bounds.push_back(0.0);
+        coef_.assign(bounds.size(), 0.0);
+        double ea_hi = 0.0;  // e^(-weight_a hi) at hi = inf
+        double eb_hi = 0.0;
+        for (std::size_t j = 0; j < bounds.size(); ++j) {
+            const double ea_lo = std::exp(-weight_a * bounds[j]);
+            const double eb_lo = std::exp(-weight_b * bounds[j]);
+            // Code above bounds[j]: P(lo, lo) - P(lo, hi) - P(hi, lo) + P(hi, hi);
+            // the last term belongs to the previous bound.
+            coef_[j] += ea_lo * eb_lo - ea_lo * eb_hi - ea_hi * eb_lo;
+            if (j > 0) coef_[j - 1] += ea_hi * eb_hi;
+            ea_hi = ea_lo;
+            eb_hi = eb_lo;
+        }
+        bound_ = std::move(bounds);
+    }
+
+    // Match probability and its derivative in c.
+    [[nodiscard]] std::pair<double, double> operator()(double c) const {
+        double p = 0.0;
+        double dp = 0.0;
+        for (std::size_t j = 0; j < bound_.size(); ++j) {
+            const double term = coef_[j] * std::exp(c * bound_[j]);
+            p += term;
+            dp += term * bound_[j];
+        }
+        return {p, dp};
+    }
+
+private:
+    std::vector<double> bound_;
+    std::vector<double> coef_;
+};
+
+} // namespace
+
+double quantized_jaccard(std::size_t equal, std::size_t size, double weight_a, double weight_b,
+                         const RegisterQuantization& q) {
+    const double p = static_cast<double>(equal) / static_cast<double>(size);
+    if (equal >= size) return 1.0;
+    if (!(weight_a > 0.0) || !(weight_b > 0.0) || !std::isfinite(weight_a) || !std::isfinite(weight_b)) return p;
+    if (weight_a > weight_b) std::swap(weight_a, weight_b);  // symmetric to the last bit
+
+    const MatchModel match(weight_a, weight_b, q);
+    double c_lo = 0.0;
+    double c_hi = weight_a;
+    if (match(c_lo).first >= p) return 0.0;
+    if (match(c_hi).first <= p) return weight_a / weight_b;
+    // Newton from the uncorrected estimate, kept inside the bracket
+    // [c_lo, c_hi] (the match probability increases in c) by bisecting
+    // whenever a step leaves it.
+    double c = std::clamp(p * (weight_a + weight_b) / (1.0 + p), c_lo, c_hi);
+    for (int it = 0; it < 50; ++it) {
+        const auto [f, df] = match(c);
+        if (f < p) c_lo = c;
+        else c_hi = c;
+        double next = c - (f - p) / df;
+        if (!(next > c_lo && next < c_hi)) next = 0.5 * (c_lo + c_hi);
+        const bool done = std::abs(next - c) <= 1e-6 * c_hi;
+        c = next;
+        if (done) break;
+    }
+    return c / (weight_a + weight_b - c);
+}
+
+std::size_t count_equal_codes(const std::uint8_t* a, const std::uint8_t* b, std::size_t size,
+                              std::size_t code_bytes) {
+    std::size_t equal = 0;
+    std::size_t done = 0;
+#if defined(__x86_64__) && defined(__GNUC__)
+    if (has_avx2()) {
+        const std::size_t block_bytes = size * code_bytes / kRowAlign * kRowAlign;
+        switch (code_bytes) {
+            case 1: equal = count_equal_avx2<1>(a, b, block_bytes); break;
+            case 2: equal = count_equal_avx2<2>(a, b, block_bytes); break;
+            case 4: equal = count_equal_avx2<4>(a, b, block_bytes); break;
+            default: equal = count_equal_avx2<8>(a, b, block_bytes); break;
+        }
+        done = block_bytes / code_bytes;
+    }
+#endif
+    a += done * code_bytes;
+    b += done * code_bytes;
+    switch (code_bytes) {
+        case 1: return equal + count_equal_scalar<std::uint8_t>(a, b, size - done);
+        case 2: return equal + count_equal_scalar<std::uint16_t>(a, b, size - done);
+        case 4: return equal + count_equal_scalar<std::uint32_t>(a, b, size - done);
+        default: return equal + count_equal_scalar<std::uint64_t>(a, b, size - done);
+    }
+}
+
+double jaccard_from_codes(const JaccardCodes& a, const JaccardCodes& b) {
+    const CodeTable table({a, b});
+    return table.jaccard(0, 1);
+}
+
+std::vector<std::vector<double>> jaccard_matrix(const std::vector<const CardinalitySketch*>& sketches,
+                                                std::size_t threads) {
+    const CodeTable table(collect_codes(sketches, nullptr));
+    const std::size_t n = table.rows();
+    std::vector<std::vector<double>> out(n, std::vector<double>(n, 1.0));
+    if (n < 2) return out;
+
+    const std::size_t tile = std::max<std::size_t>(1, kTileBytes / table.stride());
+    const std::size_t tiles = (n + tile - 1) / tile;
+    std::vector<std::pair<std::size_t, std::size_t>> pairs;
+    for (std::size_t ti = 0; ti < tiles; ++ti) {
+        for (std::size_t tj = ti; tj < tiles; ++tj) pairs.emplace_back(ti, tj);
+    }
+    parallel_for(pairs.size(), threads, [&](std::size_t item) {
+        const auto [ti, tj] = pairs[item];
+        const std::size_t i_end = std::min(n, (ti + 1) * tile);
+        const std::size_t j_end = std::min(n, (tj + 1) * tile);
+        for (std::size_t i = ti * tile; i < i_end; ++i) {
+            for (std::size_t j = std::max(tj * tile, i + 1); j < j_end; ++j) {
+                const double jac = table.jaccard(i, j);
+                out[i][j] = jac;
+                out[j][i] = jac;
+            }
+        }
+    });
+    return out;
+}
+
+std::vector<std::pair<std::size_t, double>> jaccard_topk(const CardinalitySketch& query,
+                                                         const std::vector<const CardinalitySketch*>& sketches,
+                                                         std::size_t k, std::size_t threads) {
+    const CodeTable table(collect_codes(sketches, &query));
+    const std::size_t n = sketches.size();
+    k = std::min(k, n);
+    if (k == 0) return {};
+
+    // Row 0 is the query.
+    std::vector<std::size_t> equal(n);
+    const std::size_t chunk = std::max<std::size_t>(1, kTileBytes / table.stride());
+    parallel_for((n + chunk - 1) / chunk, threads, [&](std::size_t item) {
+        const std::size_t end = std::min(n, (item + 1) * chunk);
+        for (std::size_t r = item * chunk; r < end; ++r) equal[r] = table.count_equal(table.row(0), table.row(r + 1));
+    });
+
+    auto better = [](const std::pair<std::size_t, double>& x, const std::pair<std::size_t, double>& y) {
+        return x.second > y.second || (x.second == y.second && x.first < y.first);
+    };
+    std::vector<std::pair<std::size_t, double>> out;
+    if (!table.quantized()) {
+        out.reserve(n);
+        for (std::size_t r = 0; r < n; ++r) out.emplace_back(r, table.jaccard(equal[r], 0.0, 0.0));
+        std::partial_sort(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(k), out.end(), better);
+        out.resize(k);
+        return out;
+    }
+
+    // The corrected Jaccard never exceeds the raw match rate, so candidates are
+    // corrected in decreasing match order until the k-th best beats the next rate.
+    std::vector<std::size_t> order(n);
+    for (std::size_t r = 0; r < n; ++r) order[r] = r;
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t x, std::size_t y) { return equal[x] > equal[y]; });
+    for (std::size_t r : order) {
+        const double bound = static_cast<double>(equal[r]) / static_cast<double>(table.size());
+        if (out.size() == k && bound < out.back().second) break;
+        out.emplace_back(r, table.jaccard(equal[r], table.weight(0), table.weight(r + 1)));
+        std::sort(out.begin(), out.end(), better);
+        if (out.size() > k) out.pop_back();
+    }
+    return out;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "jaccard_codes.hpp"
+#include "sketch.hpp"
+
+// Batched Jaccard over many sketches of one JaccardMixin type.
+//
+// Sketches are packed once into a row-major table of register codes (rows
+// padded to 32 bytes), and every pair is compared with a packed equality count:
+// on AVX2 machines one cmpeq + movemask + popcount handles 32 bytes of codes
+// (32 registers of QSketch b <= 8, 4 of FastExpSketch). jaccard_matrix() walks
+// the upper triangle in cache-sized tiles of rows spread over threads;
+// jaccard_topk() scans the rows against one query.
+//
+// All sketches must share type, size, seed and parameters (seeds are not
+// checked, as in jaccard_struct()). Results equal jaccard_struct() pair by pair.
+
+// Jaccard from `equal` matching registers out of `size` for registers quantized
+// as in `q`. Models register x of A and B as min(S, A'), min(S, B') with S, A',
+// B' exponential of rates c, weight_a - c, weight_b - c, solves
+// P(code_A == code_B) = equal / size for the shared rate c, and returns
+// c / (weight_a + weight_b - c). Without the correction, independent registers
+// collide often enough (about 1 in 3 at base 2) to make disjoint sets look similar.
+double quantized_jaccard(std::size_t equal, std::size_t size, double weight_a, double weight_b,
+                         const RegisterQuantization& q);
+
+// Equal codes among `size` codes of code_bytes each at a and b; no padding needed.
+std::size_t count_equal_codes(const std::uint8_t* a, const std::uint8_t* b, std::size_t size,
+                              std::size_t code_bytes);
+
+// One pair; codes must come from compatible sketches.
+double jaccard_from_codes(const JaccardCodes& a, const JaccardCodes& b);
+
+// Symmetric n x n matrix with 1.0 on the diagonal. threads == 0 uses every hardware thread.
+// Throws std::invalid_argument for non-Jaccard or mismatched sketches.
+std::vector<std::vector<double>> jaccard_matrix(const std::vector<const CardinalitySketch*>& sketches,
+                                                std::size_t threads = 0);
+
+// The k sketches most similar to `query` as (index, jaccard), best first, ties by index.
+std::vector<std::pair<std::size_t, double>> jaccard_topk(const CardinalitySketch& query,
+                                                         const std::vector<const CardinalitySketch*>& sketches,
+                                                         std::size_t k, std::size_t threads = 0);
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+// Registers of a JaccardMixin sketch as fixed-width codes for the batched
+// estimators in jaccard_batch.hpp: two sketches' register i are equal exactly
+// when their codes are byte-equal.
+
+// Registers that hold q = floor(-log_base(x) + phase) of an exponential minimum
+// x, clamped to [r_min, r_max] (QSketch, kQSketch: phase 0; kQSketchRounding:
+// phase 0.5). Equal codes then also arise from different minima, which
+// quantized_jaccard() corrects for.
+struct RegisterQuantization {
+    double base = 2.0;
+    double phase = 0.0;
+    int r_min = 0;
+    int r_max = 0;
+
+    bool operator==(const RegisterQuantization& o) const {
+        return base == o.base && phase == o.phase && r_min == o.r_min && r_max == o.r_max;
+    }
+    bool operator!=(const RegisterQuantization& o) const { return !(*this == o); }
+};
+
+struct JaccardCodes {
+    std::size_t code_bytes = 0;            // 1, 2, 4 or 8
+    std::vector<std::uint8_t> bytes;       // register i at [i * code_bytes, (i + 1) * code_bytes)
+    std::vector<double> params;            // construction parameters that must agree (bits, v_max, ...)
+    std::optional<RegisterQuantization> quantization;
+    double weight = 0.0;                   // estimate(), set with quantization
+
+    [[nodiscard]] std::size_t size() const { return code_bytes == 0 ? 0 : bytes.size() / code_bytes; }
+};
+
+// Packs code_of(i), i < size, as Code-sized codes.
+template <typename Code, typename Fn>
+JaccardCodes pack_jaccard_codes(std::size_t size, Fn code_of) {
+    static_assert(sizeof(Code) == 1 || sizeof(Code) == 2 || sizeof(Code) == 4 || sizeof(Code) == 8);
+    JaccardCodes out;
+    out.code_bytes = sizeof(Code);
+    out.bytes.resize(size * sizeof(Code));
+    for (std::size_t i = 0; i < size; ++i) {
+        const Code c = static_cast<Code>(code_of(i));
+        std::memcpy(out.bytes.data() + i * sizeof(Code), &c, sizeof(Code));
+    }
+    return out;
+}
+
+// Bit pattern of a float register; equal for equal non-NaN values except +-0,
+// which registers never hold.
+template <typename T>
+auto float_code(T value) {
+    using Code = std::conditional_t<sizeof(T) == 2, std::uint16_t,
+                                    std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>>;
+    Code c;
+    std::memcpy(&c, &value, sizeof(c));
+    return c;
+}
+
+// Smallest code type for registers of amount_bits bits.
+template <typename Fn>
+JaccardCodes pack_small_register_codes(std::size_t size, unsigned amount_bits, Fn code_of) {
+    if (amount_bits <= 8) return pack_jaccard_codes<std::uint8_t>(size, code_of);
+    if (amount_bits <= 16) return pack_jaccard_codes<std::uint16_t>(size, code_of);
+    return pack_jaccard_codes<std::uint32_t>(size, code_of);
+}
@@ -5,13 +5,15 @@
 
 kQSketchRoundedDyn::kQSketchRoundedDyn(
     std::size_t sketch_size, std::uint64_t master_seed,
-    std::uint8_t amount_bits, float logarithm_base, std::uint32_t g_seed)
+    std::uint8_t amount_bits, float logarithm_base, std::uint32_t g_seed,
+    HashScheme hash_scheme)
     : Sketch(sketch_size, master_seed),
       amount_bits_(amount_bits),
       logarithm_base_(logarithm_base),
       r_min(-(1 << (amount_bits - 1)) + 1),
       r_max((1 << (amount_bits - 1)) - 1),
       g_seed_(g_seed),
+      hash_scheme_(hash_scheme),
       cardinality_(0.0),
       q_r_(0.0),
       R_(amount_bits, sketch_size),
@@ -27,13 +29,15 @@ kQSketchRoundedDyn::kQSketchRoundedDyn(
     std::size_t sketch_size, std::uint8_t amount_bits, float logarithm_base,
     std::uint32_t g_seed, std::uint64_t master_seed,
     const std::vector<int>& registers,
-    const std::vector<std::uint32_t>& t_histogram, double cardinality)
+    const std::vector<std::uint32_t>& t_histogram, double cardinality,
+    HashScheme hash_scheme)
     : Sketch(sketch_size, master_seed),
       amount_bits_(amount_bits),
       logarithm_base_(logarithm_base),
       r_min(-(1 << (amount_bits - 1)) + 1),
       r_max((1 << (amount_bits - 1)) - 1),
       g_seed_(g_seed),
+      hash_scheme_(hash_scheme),
       cardinality_(cardinality),
       q_r_(0.0),
       R_(amount_bits, sketch_size),
@@ -45,17 +49,39 @@ kQSketchRoundedDyn::kQSketchRoundedDyn(
 }
 
 void kQSketchRoundedDyn::add(const std::string& elem, double weight) {
-    validate_weight(weight);
-    const uint64_t g_hash = murmur64(elem, g_seed_);
-    const size_t j = g_hash % size;
+    Prepared p;
+    prepare(elem, weight, p);
+    apply(p);
+}
 
-    const uint64_t u_hash = murmur64(elem, seeds_[j]);
-    const double u = to_unit_interval(u_hash);
+void kQSketchRoundedDyn::prepare(const std::string& elem, double weight, Prepared& out) const {
+    validate_weight(weight);
+    out.skip = true;
+    size_t j;
+    double u;
+    if (hash_scheme_ == HashScheme::MULTIPLY_HIGH_128) {
+        const Hash128 h = murmur128(elem, g_seed_);
+        j = fast_range(h.lo, size);
+        u = to_unit_interval(h.hi);
+    } else {
+        j = murmur64(elem, g_seed_) % size;
+        u = to_unit_interval(murmur64(elem, seeds_[j]));
+    }
     if (u == 0.0) { return; }
     const double r = -std::log(u) / weight;
 
     // kQSketchRounding quantization: round(-log_k(r))
-    const int y = static_cast<int>(std::round(-std::log(r) / std::log(logarithm_base_)));
+    out.j = j;
+    out.y = static_cast<int>(std::round(-std::log(r) / std::log(logarithm_base_)));
+    out.weight = weight;
+    out.skip = false;
+}
+
+void kQSketchRoundedDyn::apply(const Prepared& p) {
+    if (p.skip) { return; }
+    const size_t j = p.j;
+    const int y = p.y;
+    const double weight = p.weight;
 
     if (y <= R_[j]) { return; }
 
@@ -93,6 +119,7 @@ int kQSketchRoundedDyn::estimate_newton_warm_iterations() const { return 0; }
 std::uint8_t kQSketchRoundedDyn::get_amount_bits() const { return amount_bits_; }
 float kQSketchRoundedDyn::get_logarithm_base() const { return logarithm_base_; }
 std::uint32_t kQSketchRoundedDyn::get_g_seed() const { return g_seed_; }
+HashScheme kQSketchRoundedDyn::get_hash_scheme() const { return hash_scheme_; }
 std::vector<int> kQSketchRoundedDyn::get_registers() const {
     return std::vector<int>(R_.begin(), R_.end());
 }
@@ -105,7 +132,7 @@ size_t kQSketchRoundedDyn::memory_usage(uint64_t flags) const {
     uint64_t f = resolve_flags(flags);
     size_t s = 0;
     if (f & MemoryFlag::REGISTERS) s += R_.bytes() + T_.bytes();
-    if (f & MemoryFlag::ALL_WRITE_NO_REGISTERS) s += sizeof(size) + sizeof(amount_bits_) + sizeof(logarithm_base_) + sizeof(r_min) + sizeof(r_max) + sizeof(g_seed_) + sizeof(cardinality_) + sizeof(q_r_);
+    if (f & MemoryFlag::ALL_WRITE_NO_REGISTERS) s += sizeof(size) + sizeof(amount_bits_) + sizeof(logarithm_base_) + sizeof(r_min) + sizeof(r_max) + sizeof(g_seed_) + sizeof(hash_scheme_) + sizeof(cardinality_) + sizeof(q_r_);
     if (f & MemoryFlag::SEEDS) s += seeds_.bytes();
     return s;
 }
@@ -60,6 +60,7 @@ void kQSketchShifted::shift_up() {
         threshold_ = std::pow(logarithm_base, -offset_);
         return;
     }
+    stats_.on_window_shift();
     offset_ += min_val;
     for (std::size_t i = 0; i < size; ++i) {
         M_[i] = static_cast<int>(M_[i]) - min_val;
@@ -79,8 +80,9 @@ void kQSketchShifted::add(const std::string& elem, double weight) {
         double u = to_unit_interval(h);
         double g = -std::log(u) / weight;
         S += g / (double)(size - k);
+        stats_.on_iteration();
 
-        if (S >= threshold_) { break; }
+        if (S >= threshold_) { stats_.on_early_exit(); break; }
 
         auto j = fisher_yates.get_fisher_yates_element(k);
         int q_abs = static_cast<int>(std::floor(-std::log(S) / std::log(logarithm_base)));
@@ -88,6 +90,7 @@ void kQSketchShifted::add(const std::string& elem, double weight) {
 
         // Shift-on-overflow: if the value doesn't fit, shift offset up immediately
         if (rel > capacity_) {
+            stats_.on_window_shift();
             int delta = rel - capacity_;
             offset_ += delta;
             threshold_ = std::pow(logarithm_base, -offset_);
@@ -101,6 +104,7 @@ void kQSketchShifted::add(const std::string& elem, double weight) {
         }
 
         if (rel > static_cast<int>(M_[j])) {
+            stats_.on_register_update();
             if (static_cast<int>(M_[j]) == 0) {
                 if (--num_zeros_ == 0) { triggered_shift = true; }
             }
@@ -108,7 +112,8 @@ void kQSketchShifted::add(const std::string& elem, double weight) {
         }
     }
 
-    if (triggered_shift) { shift_up(); }
+    stats_.on_add();
+    if (triggered_shift) { stats_.on_rescan(); shift_up(); }
 }
 
 // ─── Estimation (absolute values = M_[i] + offset_) ─────────────────────────
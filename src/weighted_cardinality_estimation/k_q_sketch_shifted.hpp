@@ -29,6 +29,8 @@ public:
         RngEngine engine = kDefaultRngEngine);
 
     void add(const std::string& elem, double weight = 1.0);
+    // Window shifts clamp registers, so the result depends on arrival order.
+    [[nodiscard]] bool pre_aggregation_exact() const override { return false; }
     [[nodiscard]] double estimate() const;
     [[nodiscard]] double estimate_direct() const;
     [[nodiscard]] double estimate_newton_cold() const;
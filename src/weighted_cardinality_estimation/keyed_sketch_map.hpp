@@ -0,0 +1,142 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Group-by aggregation: one sketch per group key, fed from (key, elem, weight)
+// rows.
+//
+// Keys map to dense slots through an open-addressing table (linear probing,
+// load <= 1/2) that stores slot + 1 and compares the cached std::hash before
+// the key. A new key gets a copy of the prototype sketch (normally empty), so
+// any sketch class with add(elem, weight) and estimate() works; merge() also
+// needs S::merge, and the add_many() without weights S::add(elem).
+//
+// add_many() resolves every row's slot first, then stable-radix-sorts the row
+// indices by slot, so each sketch takes its rows back to back, in their
+// original order, while its registers are cache-hot. Sketches end up identical
+// to adding the rows one by one.
+template <typename S>
+class KeyedSketchMap {
+public:
+    explicit KeyedSketchMap(S prototype) : prototype_(std::move(prototype)), table_(kInitialCapacity, 0) {}
+
+    // The sketch for key, created from the prototype if key is new.
+    S& operator[](const std::string& key) { return sketches_[slot_for(key)]; }
+
+    // nullptr when key has no sketch yet.
+    const S* find(std::string_view key) const {
+        const std::size_t hash = std::hash<std::string_view>{}(key);
+        for (std::size_t i = hash & (table_.size() - 1);; i = (i + 1) & (table_.size() - 1)) {
+            const std::uint32_t entry = table_[i];
+            if (entry == 0) { return nullptr; }
+            if (hashes_[entry - 1] == hash && keys_[entry - 1] == key) { return &sketches_[entry - 1]; }
+        }
+    }
+    S* find(std::string_view key) { return const_cast<S*>(std::as_const(*this).find(key)); }
+
+    void add(const std::string& key, const std::string& elem, double weight) {
+        sketches_[slot_for(key)].add(elem, weight);
+    }
+
+    // Key is std::string or std::string_view.
+    template <typename Key>
+    void add_many(const std::vector<Key>& keys, const std::vector<std::string>& elems,
+                  const std::vector<double>& weights) {
+        if (keys.size() != elems.size() || elems.size() != weights.size()) {
+            throw std::invalid_argument("add_many: keys, elems and weights size mismatch");
+        }
+        for_each_row(keys, [&](S& sketch, std::size_t row) { sketch.add(elems[row], weights[row]); });
+    }
+
+    // Rows without weights, for unweighted sketches.
+    template <typename Key>
+    void add_many(const std::vector<Key>& keys, const std::vector<std::string>& elems) {
+        if (keys.size() != elems.size()) { throw std::invalid_argument("add_many: keys and elems size mismatch"); }
+        for_each_row(keys, [&](S& sketch, std::size_t row) { sketch.add(elems[row]); });
+    }
+
+    // Estimates in key order (see keys()).
+    [[nodiscard]] std::vector<double> estimate_all() const {
+        std::vector<double> out;
+        out.reserve(sketches_.size());
+        for (const S& sketch : sketches_) { out.push_back(sketch.estimate()); }
+        return out;
+    }
+
+    // Merges other's sketch for each key into this map's, adding missing keys.
+    void merge(const KeyedSketchMap& other) {
+        for (std::size_t i = 0; i < other.keys_.size(); ++i) {
+            sketches_[slot_for(other.keys_[i])].merge(other.sketches_[i]);
+        }
+    }
+
+    // Keys in order of first appearance.
+    [[nodiscard]] const std::vector<std::string>& keys() const { return keys_; }
+    [[nodiscard]] std::size_t size() const { return keys_.size(); }
+
+private:
+    static constexpr std::size_t kInitialCapacity = 16;
+
+    std::uint32_t slot_for(std::string_view key) {
+        const std::size_t hash = std::hash<std::string_view>{}(key);
+        std::size_t i = hash & (table_.size() - 1);
+        for (; table_[i] != 0; i = (i + 1) & (table_.size() - 1)) {
+            const std::uint32_t slot = table_[i] - 1;
+            if (hashes_[slot] == hash && keys_[slot] == key) { return slot; }
+        }
+        const auto slot = static_cast<std::uint32_t>(keys_.size());
+        keys_.emplace_back(key);
+        hashes_.push_back(hash);
+        sketches_.push_back(prototype_);
+        table_[i] = slot + 1;
+        if (2 * keys_.size() > table_.size()) { grow(); }
+        return slot;
+    }
+
+    // Calls f(sketch, row) for every row, grouped by sketch.
+    template <typename Key, typename F>
+    void for_each_row(const std::vector<Key>& keys, F f) {
+        std::vector<std::uint32_t> slots(keys.size());
+        for (std::size_t i = 0; i < keys.size(); ++i) { slots[i] = slot_for(keys[i]); }
+        for (const std::uint32_t row : order_by_slot(slots)) { f(sketches_[slots[row]], row); }
+    }
+
+    void grow() {
+        std::vector<std::uint32_t> table(table_.size() * 2, 0);
+        for (std::size_t slot = 0; slot < keys_.size(); ++slot) {
+            std::size_t i = hashes_[slot] & (table.size() - 1);
+            while (table[i] != 0) { i = (i + 1) & (table.size() - 1); }
+            table[i] = static_cast<std::uint32_t>(slot + 1);
+        }
+        table_.swap(table);
+    }
+
+    // Row indices stably sorted by slot: LSD radix sort, 8 bits per pass, as
+    // many passes as the largest slot needs.
+    [[nodiscard]] std::vector<std::uint32_t> order_by_slot(const std::vector<std::uint32_t>& slots) const {
+        std::vector<std::uint32_t> order(slots.size());
+        for (std::uint32_t i = 0; i < order.size(); ++i) { order[i] = i; }
+        std::vector<std::uint32_t> scratch(slots.size());
+        for (unsigned shift = 0; shift < 32 && (keys_.size() - 1) >> shift != 0; shift += 8) {
+            std::array<std::size_t, 257> start{};
+            for (std::uint32_t row : order) { ++start[((slots[row] >> shift) & 0xFF) + 1]; }
+            for (std::size_t d = 1; d < start.size(); ++d) { start[d] += start[d - 1]; }
+            for (std::uint32_t row : order) { scratch[start[(slots[row] >> shift) & 0xFF]++] = row; }
+            order.swap(scratch);
+        }
+        return order;
+    }
+
+    S prototype_;
+    std::deque<S> sketches_;
+    std::vector<std::string> keys_;
+    std::vector<std::size_t> hashes_;
+    std::vector<std::uint32_t> table_;  // slot + 1, 0 = empty
+};
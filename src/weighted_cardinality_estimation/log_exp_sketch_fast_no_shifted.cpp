@@ -86,18 +86,22 @@ void LogExpSketchFastNoShifted::add(const std::string& elem, double weight) {
         double E = -std::log(U) / weight;
 
         S += E / static_cast<double>(size - k);
-        if (S >= max_threshold) { break; }
+        stats_.on_iteration();
+        if (S >= max_threshold) { stats_.on_early_exit(); break; }
 
         std::uint32_t j = fisher_yates.get_fisher_yates_element(k);
         int idx = quantize(S);
 
         if (idx < static_cast<int>(M_[j])) {
+            stats_.on_register_update();
             if (static_cast<int>(M_[j]) == max_register_) { update_max = true; }
             M_[j] = static_cast<unsigned>(idx);
         }
     }
 
+    stats_.on_add();
     if (update_max) {
+        stats_.on_rescan();
         update_max_register();
     }
 }
@@ -119,6 +123,12 @@ double LogExpSketchFastNoShifted::jaccard_struct(const LogExpSketchFastNoShifted
     return static_cast<double>(equal) / static_cast<double>(size);
 }
 
+JaccardCodes LogExpSketchFastNoShifted::jaccard_codes() const {
+    JaccardCodes codes = pack_small_register_codes(size, amount_bits_, [this](std::size_t i) { return M_[i]; });
+    codes.params = {static_cast<double>(amount_bits_), v_max_};
+    return codes;
+}
+
 void LogExpSketchFastNoShifted::merge(const LogExpSketchFastNoShifted& other) {
     if (other.size != size) {
         throw std::invalid_argument("Cannot merge sketches of different sizes.");
@@ -134,6 +144,18 @@ void LogExpSketchFastNoShifted::merge(const LogExpSketchFastNoShifted& other) {
     update_max_register();
 }
 
+void LogExpSketchFastNoShifted::merge_registers(const int* registers, std::size_t count) {
+    if (count != size) {
+        throw std::invalid_argument("Cannot merge sketches of different sizes.");
+    }
+    for (std::size_t i = 0; i < size; ++i) {
+        if (static_cast<unsigned>(registers[i]) < M_[i]) {
+            M_[i] = static_cast<unsigned>(registers[i]);
+        }
+    }
+    update_max_register();
+}
+
 std::vector<int> LogExpSketchFastNoShifted::get_registers() const {
     return std::vector<int>(M_.begin(), M_.end());
 }
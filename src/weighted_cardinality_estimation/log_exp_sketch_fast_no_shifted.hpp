@@ -29,7 +29,11 @@ public:
     void add(const std::string& elem, double weight = 1.0) override;
     [[nodiscard]] double estimate() const override;
     [[nodiscard]] double jaccard_struct(const LogExpSketchFastNoShifted& other) const;
+    [[nodiscard]] JaccardCodes jaccard_codes() const override;
     void merge(const LogExpSketchFastNoShifted& other);
+    // Merges a register array of another sketch with this size and parameters
+    // (as decoded by merge_wire()) without constructing it.
+    void merge_registers(const int* registers, std::size_t count);
 
     [[nodiscard]] std::vector<int> get_registers() const;
     [[nodiscard]] std::uint8_t get_amount_bits() const;
@@ -74,6 +74,7 @@ void LogExpSketchFastShifted::shift_down() {
         num_maxed_ = static_cast<int>(std::count(M_.begin(), M_.end(), static_cast<unsigned>(capacity_)));
         return;
     }
+    stats_.on_window_shift();
     offset_ -= min_val;
     for (std::size_t i = 0; i < size; ++i) {
         M_[i] = static_cast<int>(M_[i]) - min_val;
@@ -96,12 +97,14 @@ void LogExpSketchFastShifted::add(const std::string& elem, double weight) {
         double E = -std::log(U) / weight;
 
         S += E / static_cast<double>(size - k);
+        stats_.on_iteration();
         if (S >= max_threshold) {
             // If sentinel registers remain, shift window up to cover S
             if (num_maxed_ > 0) {
                 int q_abs = quantize(S);
                 int delta = q_abs - (offset_ + capacity_ - 1);
                 if (delta > 0) {
+                    stats_.on_window_shift();
                     offset_ += delta;
                     num_maxed_ = 0;
                     for (std::size_t ii = 0; ii < size; ++ii) {
@@ -115,6 +118,7 @@ void LogExpSketchFastShifted::add(const std::string& elem, double weight) {
                     max_threshold = reconstruct(capacity_ + offset_);
                 }
             } else {
+                stats_.on_early_exit();
                 break;
             }
         }
@@ -125,6 +129,7 @@ void LogExpSketchFastShifted::add(const std::string& elem, double weight) {
 
         // Shift down if value underflows the current window
         if (rel < 0) {
+            stats_.on_window_shift();
             int delta = -rel;
             offset_ -= delta;
             num_maxed_ = 0;
@@ -138,6 +143,7 @@ void LogExpSketchFastShifted::add(const std::string& elem, double weight) {
         }
 
         if (rel < static_cast<int>(M_[j])) {
+            stats_.on_register_update();
             if (static_cast<int>(M_[j]) == capacity_) {
                 if (--num_maxed_ == 0) { triggered_shift = true; }
             }
@@ -145,7 +151,8 @@ void LogExpSketchFastShifted::add(const std::string& elem, double weight) {
         }
     }
 
-    if (triggered_shift) { shift_down(); }
+    stats_.on_add();
+    if (triggered_shift) { stats_.on_rescan(); shift_down(); }
 }
 
 double LogExpSketchFastShifted::estimate() const {
@@ -168,6 +175,15 @@ double LogExpSketchFastShifted::jaccard_struct(const LogExpSketchFastShifted& ot
     return static_cast<double>(equal) / static_cast<double>(size);
 }
 
+JaccardCodes LogExpSketchFastShifted::jaccard_codes() const {
+    // Absolute indices, so sketches with different offsets compare like jaccard_struct().
+    JaccardCodes codes = pack_jaccard_codes<std::uint32_t>(size, [this](std::size_t i) {
+        return static_cast<std::uint32_t>(static_cast<int>(M_[i]) + offset_);
+    });
+    codes.params = {static_cast<double>(amount_bits_), v_max_};
+    return codes;
+}
+
 void LogExpSketchFastShifted::merge(const LogExpSketchFastShifted& other) {
     if (other.size != size) {
         throw std::invalid_argument("Cannot merge sketches of different sizes.");
@@ -91,6 +91,12 @@ double LogExpSketchSlowNoShifted::jaccard_struct(const LogExpSketchSlowNoShifted
     return static_cast<double>(equal) / static_cast<double>(size);
 }
 
+JaccardCodes LogExpSketchSlowNoShifted::jaccard_codes() const {
+    JaccardCodes codes = pack_small_register_codes(size, amount_bits_, [this](std::size_t i) { return M_[i]; });
+    codes.params = {static_cast<double>(amount_bits_), v_max_};
+    return codes;
+}
+
 void LogExpSketchSlowNoShifted::merge(const LogExpSketchSlowNoShifted& other) {
     if (other.size != size) {
         throw std::invalid_argument("Cannot merge sketches of different sizes.");
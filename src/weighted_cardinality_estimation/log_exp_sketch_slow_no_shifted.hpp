@@ -24,6 +24,7 @@ public:
     void add(const std::string& elem, double weight = 1.0) override;
     [[nodiscard]] double estimate() const override;
     [[nodiscard]] double jaccard_struct(const LogExpSketchSlowNoShifted& other) const;
+    [[nodiscard]] JaccardCodes jaccard_codes() const override;
     void merge(const LogExpSketchSlowNoShifted& other);
 
     [[nodiscard]] std::vector<int> get_registers() const;
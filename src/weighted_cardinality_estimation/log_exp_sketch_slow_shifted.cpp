@@ -78,6 +78,7 @@ void LogExpSketchSlowShifted::shift_down() {
         num_maxed_ = static_cast<int>(std::count(M_.begin(), M_.end(), static_cast<unsigned>(capacity_)));
         return;
     }
+    stats_.on_window_shift();
     offset_ -= min_val;
     for (std::size_t i = 0; i < size; ++i) {
         M_[i] = static_cast<int>(M_[i]) - min_val;
@@ -98,6 +99,7 @@ void LogExpSketchSlowShifted::add(const std::string& elem, double weight) {
 
         // If the quantized value underflows (below current window), shift offset down.
         if (rel < 0) {
+            stats_.on_window_shift();
             int delta = -rel;
             offset_ -= delta;
             num_maxed_ = 0;
@@ -112,6 +114,7 @@ void LogExpSketchSlowShifted::add(const std::string& elem, double weight) {
         // window up to cover it. Set registers stay put; only unset (sentinel) ones are
         // still waiting for a value, so this just positions the window on early inserts.
         else if (rel > capacity_ && num_maxed_ > 0) {
+            stats_.on_window_shift();
             int delta = rel - capacity_;
             offset_ += delta;
             num_maxed_ = 0;
@@ -127,6 +130,7 @@ void LogExpSketchSlowShifted::add(const std::string& elem, double weight) {
         }
 
         if (rel < static_cast<int>(M_[i])) {
+            stats_.on_register_update();
             if (static_cast<int>(M_[i]) == capacity_) {
                 if (--num_maxed_ == 0) { triggered_shift = true; }
             }
@@ -134,7 +138,8 @@ void LogExpSketchSlowShifted::add(const std::string& elem, double weight) {
         }
     }
 
-    if (triggered_shift) { shift_down(); }
+    stats_.on_add();
+    if (triggered_shift) { stats_.on_rescan(); shift_down(); }
 }
 
 double LogExpSketchSlowShifted::estimate() const {
@@ -157,6 +162,15 @@ double LogExpSketchSlowShifted::jaccard_struct(const LogExpSketchSlowShifted& ot
     return static_cast<double>(equal) / static_cast<double>(size);
 }
 
+JaccardCodes LogExpSketchSlowShifted::jaccard_codes() const {
+    // Absolute indices, so sketches with different offsets compare like jaccard_struct().
+    JaccardCodes codes = pack_jaccard_codes<std::uint32_t>(size, [this](std::size_t i) {
+        return static_cast<std::uint32_t>(static_cast<int>(M_[i]) + offset_);
+    });
+    codes.params = {static_cast<double>(amount_bits_), v_max_};
+    return codes;
+}
+
 void LogExpSketchSlowShifted::merge(const LogExpSketchSlowShifted& other) {
     if (other.size != size) {
         throw std::invalid_argument("Cannot merge sketches of different sizes.");
@@ -23,8 +23,11 @@ public:
     );
 
     void add(const std::string& elem, double weight = 1.0) override;
+    // Window shifts clamp registers, so the result depends on arrival order.
+    [[nodiscard]] bool pre_aggregation_exact() const override { return false; }
     [[nodiscard]] double estimate() const override;
     [[nodiscard]] double jaccard_struct(const LogExpSketchSlowShifted& other) const;
+    [[nodiscard]] JaccardCodes jaccard_codes() const override;
     void merge(const LogExpSketchSlowShifted& other);
 
     [[nodiscard]] std::vector<int> get_registers() const;
@@ -0,0 +1,327 @@
+#include "lsh_index.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <typeinfo>
+#include <unordered_set>
+#include "MurmurHash3.h"
+#include "jaccard_batch.hpp"
+
+namespace {
+
+constexpr char kMagic[8] = {'w', 'c', 'e', '-', 'l', 's', 'h', '1'};
+constexpr std::size_t kMinPending = 4096;
+
+void write_bytes(std::ofstream& out, const void* data, std::size_t size) {
+    out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+}
+
+void write_u64(std::ofstream& out, std::uint64_t v) { write_bytes(out, &v, sizeof(v)); }
+
+void pad_to_8(std::ofstream& out, std::size_t written) {
+    static constexpr char zeros[8] = {};
+    if (written % 8 != 0) write_bytes(out, zeros, 8 - written % 8);
+}
+
+// Bounds-checked cursor over the mapped file; arrays are 8-byte aligned.
+class Reader {
+public:
+    Reader(const std::uint8_t* data, std::size_t size) : data_(data), size_(size) {}
+
+    template <typename T>
+    T value() {
+        T v;
+        std::memcpy(&v, take(sizeof(T)), sizeof(T));
+        return v;
+    }
+
+    template <typename T>
+    const T* array(std::size_t n) {
+        if (n > (size_ - pos_) / sizeof(T)) corrupt();
+        const auto* p = reinterpret_cast<const T*>(take(n * sizeof(T)));
+        align();
+        return p;
+    }
+
+    void align() { pos_ = std::min(size_, (pos_ + 7) / 8 * 8); }
+
+    [[noreturn]] static void corrupt() { throw std::runtime_error("Corrupt LSH index file."); }
+
+private:
+    const std::uint8_t* data_;
+    std::size_t size_;
+    std::size_t pos_ = 0;
+
+    const std::uint8_t* take(std::size_t n) {
+        if (n > size_ - pos_) corrupt();
+        const std::uint8_t* p = data_ + pos_;
+        pos_ += n;
+        return p;
+    }
+};
+
+} // namespace
+
+LshIndex::LshIndex(std::size_t bands, std::size_t rows) : bands_(bands), rows_(rows), band_(bands) {
+    if (bands == 0 || rows == 0) throw std::invalid_argument("LshIndex needs bands > 0 and rows > 0.");
+    if (rows > SIZE_MAX / bands) throw std::invalid_argument("LshIndex bands * rows is too large.");
+}
+
+JaccardCodes LshIndex::codes_of(const CardinalitySketch& sketch) const {
+    const auto* j = dynamic_cast<const JaccardMixin*>(&sketch);
+    if (j == nullptr) throw std::invalid_argument("Sketch does not support Jaccard estimation.");
+    JaccardCodes codes = j->jaccard_codes();
+    if (codes.size() < bands_ * rows_) {
+        throw std::invalid_argument("LshIndex needs sketches with at least bands * rows registers.");
+    }
+    if (!type_.empty()) {
+        if (typeid(sketch).name() != type_) throw std::invalid_argument("LshIndex holds sketches of one type.");
+        if (codes.code_bytes != code_bytes_ || codes.size() != registers_ || codes.params != params_
+            || codes.quantization != quantization_) {
+            throw std::invalid_argument("LshIndex needs sketches of the same size and parameters.");
+        }
+    } else if (rows_ > INT_MAX / codes.code_bytes) {
+        // band_key() hashes rows * code_bytes bytes with an int length.
+        throw std::invalid_argument("LshIndex rows are too many to hash.");
+    }
+    return codes;
+}
+
+std::uint64_t LshIndex::band_key(const std::uint8_t* codes, std::size_t band) const {
+    const std::size_t band_bytes = rows_ * code_bytes_;
+    std::uint64_t h[2];
+    MurmurHash3_x64_128(codes + band * band_bytes, static_cast<int>(band_bytes), static_cast<std::uint32_t>(band), h);
+    return h[0];
+}
+
+const std::uint8_t* LshIndex::row(std::size_t id) const {
+    return codes_.data() + id * registers_ * code_bytes_;
+}
+
+double LshIndex::jaccard(const std::uint8_t* a, double weight_a, const std::uint8_t* b, double weight_b) const {
+    const std::size_t equal = count_equal_codes(a, b, registers_, code_bytes_);
+    if (quantization_) return quantized_jaccard(equal, registers_, weight_a, weight_b, *quantization_);
+    return static_cast<double>(equal) / static_cast<double>(registers_);
+}
+
+std::size_t LshIndex::insert(const CardinalitySketch& sketch) {
+    if (count_ >= std::numeric_limits<std::uint32_t>::max()) throw std::runtime_error("LshIndex is full.");
+    JaccardCodes codes = codes_of(sketch);
+    if (type_.empty()) {
+        type_ = typeid(sketch).name();
+        code_bytes_ = codes.code_bytes;
+        registers_ = codes.size();
+        params_ = codes.params;
+        quantization_ = codes.quantization;
+    }
+    const auto id = static_cast<std::uint32_t>(count_);
+    for (std::size_t b = 0; b < bands_; ++b) {
+        band_[b].pending.emplace_back(band_key(codes.bytes.data(), b), id);
+        if (band_[b].pending.size() > std::max(kMinPending, band_[b].keys.size() / 8)) merge_pending(band_[b]);
+    }
+    auto& stored = codes_.own();
+    stored.insert(stored.end(), codes.bytes.begin(), codes.bytes.end());
+    weights_.own().push_back(codes.weight);
+    return count_++;
+}
+
+void LshIndex::merge_pending(Band& band) {
+    std::sort(band.pending.begin(), band.pending.end());
+    const std::size_t old_size = band.keys.size();
+    const std::uint64_t* old_keys = band.keys.data();
+    const std::uint32_t* old_ids = band.ids.data();
+    std::vector<std::uint64_t> keys;
+    std::vector<std::uint32_t> ids;
+    keys.reserve(old_size + band.pending.size());
+    ids.reserve(old_size + band.pending.size());
+    std::size_t i = 0;
+    for (const auto& [key, id] : band.pending) {
+        // Pending ids are newer than every sorted id, so equal keys keep ids ascending.
+        for (; i < old_size && old_keys[i] <= key; ++i) {
+            keys.push_back(old_keys[i]);
+            ids.push_back(old_ids[i]);
+        }
+        keys.push_back(key);
+        ids.push_back(id);
+    }
+    keys.insert(keys.end(), old_keys + i, old_keys + old_size);
+    ids.insert(ids.end(), old_ids + i, old_ids + old_size);
+    band.keys.assign(std::move(keys));
+    band.ids.assign(std::move(ids));
+    band.pending.clear();
+}
+
+std::vector<std::size_t> LshIndex::candidates(const CardinalitySketch& query) const {
+    return candidate_ids(codes_of(query));
+}
+
+std::vector<std::size_t> LshIndex::candidate_ids(const JaccardCodes& codes) const {
+    std::vector<std::size_t> out;
+    if (count_ == 0) return out;
+    for (std::size_t b = 0; b < bands_; ++b) {
+        const Band& band = band_[b];
+        const std::uint64_t key = band_key(codes.bytes.data(), b);
+        const std::uint64_t* keys = band.keys.data();
+        const auto range = std::equal_range(keys, keys + band.keys.size(), key);
+        for (auto it = range.first; it != range.second; ++it) out.push_back(band.ids.data()[it - keys]);
+        for (const auto& [k, id] : band.pending) {
+            if (k == key) out.push_back(id);
+        }
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return out;
+}
+
+std::vector<std::pair<std::size_t, double>> LshIndex::query(const CardinalitySketch& query, double threshold) const {
+    const JaccardCodes codes = codes_of(query);
+    std::vector<std::pair<std::size_t, double>> out;
+    for (std::size_t id : candidate_ids(codes)) {
+        const double jac = jaccard(codes.bytes.data(), codes.weight, row(id), weights_.data()[id]);
+        if (jac >= threshold) out.emplace_back(id, jac);
+    }
+    std::sort(out.begin(), out.end(), [](const auto& x, const auto& y) {
+        return x.second > y.second || (x.second == y.second && x.first < y.first);
+    });
+    return out;
+}
+
+std::vector<std::tuple<std::size_t, std::size_t, double>> LshIndex::pairs(double threshold) const {
+    std::unordered_set<std::uint64_t> seen;
+    std::vector<std::tuple<std::size_t, std::size_t, double>> out;
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> entries;
+    for (const Band& band : band_) {
+        entries.assign(band.pending.begin(), band.pending.end());
+        for (std::size_t i = 0; i < band.keys.size(); ++i) entries.emplace_back(band.keys.data()[i], band.ids.data()[i]);
+        std::sort(entries.begin(), entries.end());
+        for (std::size_t lo = 0; lo < entries.size();) {
+            std::size_t hi = lo + 1;
+            while (hi < entries.size() && entries[hi].first == entries[lo].first) ++hi;
+            for (std::size_t x = lo; x < hi; ++x) {
+                for (std::size_t y = x + 1; y < hi; ++y) {
+                    const std::uint32_t i = entries[x].second;
+                    const std::uint32_t j = entries[y].second;
+                    if (!seen.insert((std::uint64_t{i} << 32) | j).second) continue;
+                    const double jac = jaccard(row(i), weights_.data()[i], row(j), weights_.data()[j]);
+                    if (jac >= threshold) out.emplace_back(i, j, jac);
+                }
+            }
+            lo = hi;
+        }
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+void LshIndex::save(const std::string& path) const {
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) throw std::runtime_error("Cannot write " + tmp);
+        write_bytes(out, kMagic, sizeof(kMagic));
+        for (std::uint64_t v : {std::uint64_t{bands_}, std::uint64_t{rows_}, std::uint64_t{count_},
+                                std::uint64_t{code_bytes_}, std::uint64_t{registers_},
+                                std::uint64_t{type_.size()}, std::uint64_t{params_.size()},
+                                std::uint64_t{quantization_.has_value()}}) {
+            write_u64(out, v);
+        }
+        const RegisterQuantization q = quantization_.value_or(RegisterQuantization{});
+        const std::int64_t r_min = q.r_min;
+        const std::int64_t r_max = q.r_max;
+        write_bytes(out, &q.base, sizeof(double));
+        write_bytes(out, &q.phase, sizeof(double));
+        write_bytes(out, &r_min, sizeof(r_min));
+        write_bytes(out, &r_max, sizeof(r_max));
+        write_bytes(out, type_.data(), type_.size());
+        pad_to_8(out, type_.size());
+        write_bytes(out, params_.data(), params_.size() * sizeof(double));
+        write_bytes(out, codes_.data(), codes_.size());
+        pad_to_8(out, codes_.size());
+        write_bytes(out, weights_.data(), weights_.size() * sizeof(double));
+        for (const Band& band : band_) {
+            Band merged;
+            const Band* src = &band;
+            if (!band.pending.empty()) {
+                merged.keys.view(band.keys.data(), band.keys.size());
+                merged.ids.view(band.ids.data(), band.ids.size());
+                merged.pending = band.pending;
+                merge_pending(merged);
+                src = &merged;
+            }
+            const std::size_t n = src->keys.size();
+            write_u64(out, n);
+            write_bytes(out, src->keys.data(), n * sizeof(std::uint64_t));
+            write_bytes(out, src->ids.data(), n * sizeof(std::uint32_t));
+            pad_to_8(out, n * sizeof(std::uint32_t));
+        }
+        out.flush();
+        if (!out) throw std::runtime_error("Cannot write " + tmp);
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("Cannot replace " + path);
+    }
+}
+
+LshIndex LshIndex::open(const std::string& path) {
+    auto file = std::make_shared<const MappedFile>(path);
+    Reader in(file->data(), file->size());
+    char magic[8];
+    for (char& c : magic) c = in.value<char>();
+    if (std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) throw std::runtime_error(path + " is not an LSH index file.");
+    const auto bands = in.value<std::uint64_t>();
+    const auto rows = in.value<std::uint64_t>();
+    const auto count = in.value<std::uint64_t>();
+    const auto code_bytes = in.value<std::uint64_t>();
+    const auto registers = in.value<std::uint64_t>();
+    const auto type_size = in.value<std::uint64_t>();
+    const auto params_size = in.value<std::uint64_t>();
+    const auto has_quantization = in.value<std::uint64_t>();
+    RegisterQuantization q;
+    q.base = in.value<double>();
+    q.phase = in.value<double>();
+    q.r_min = static_cast<int>(in.value<std::int64_t>());
+    q.r_max = static_cast<int>(in.value<std::int64_t>());
+    // An index that never took a sketch has no type and no register shape;
+    // any other must hold bands * rows registers that band_key() can hash.
+    const bool shaped = count > 0 || type_size > 0;
+    if (bands == 0 || rows == 0 || rows > SIZE_MAX / bands || bands > file->size()
+        || count > std::numeric_limits<std::uint32_t>::max()
+        || (shaped && (registers < bands * rows
+                       || (code_bytes != 1 && code_bytes != 2 && code_bytes != 4 && code_bytes != 8)
+                       || rows > INT_MAX / code_bytes))
+        || (!shaped && (registers != 0 || code_bytes != 0))) {
+        Reader::corrupt();
+    }
+
+    LshIndex index(bands, rows);
+    index.file_ = file;
+    index.count_ = count;
+    const char* type = in.array<char>(type_size);
+    index.type_.assign(type, type_size);
+    const double* params = in.array<double>(params_size);
+    index.params_.assign(params, params + params_size);
+    if (has_quantization != 0) index.quantization_ = q;
+    index.code_bytes_ = code_bytes;
+    index.registers_ = registers;
+    if (registers != 0 && count > file->size() / registers / std::max<std::uint64_t>(code_bytes, 1)) {
+        Reader::corrupt();
+    }
+    const std::size_t code_size = count * registers * code_bytes;
+    index.codes_.view(in.array<std::uint8_t>(code_size), code_size);
+    index.weights_.view(in.array<double>(count), count);
+    for (Band& band : index.band_) {
+        const auto n = in.value<std::uint64_t>();
+        band.keys.view(in.array<std::uint64_t>(n), n);
+        band.ids.view(in.array<std::uint32_t>(n), n);
+        for (std::size_t i = 0; i < n; ++i) {
+            if (band.ids.data()[i] >= count) Reader::corrupt();
+        }
+    }
+    return index;
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "jaccard_codes.hpp"
+#include "mapped_file.hpp"
+#include "sketch.hpp"
+
+// Banded locality-sensitive index over JaccardMixin sketches of one type, size
+// and seed (FastExpSketch, MinHash, LogExpSketch*, ...).
+//
+// The first bands * rows registers (as jaccard_codes()) are cut into `bands`
+// bands of `rows` registers; each band is hashed into a 64-bit bucket key. Two
+// sketches whose registers agree with probability J share a bucket in some
+// band with probability 1 - (1 - J^rows)^bands, so near-duplicates surface as
+// candidates without comparing every pair. Candidates are verified against
+// the stored codes, which gives jaccard_struct() exactly.
+//
+// Each band keeps its (key, id) entries in flat arrays sorted by key, plus an
+// unsorted tail of recent inserts that is merged in once it outgrows an eighth
+// of the sorted part. save() writes the index in native byte order; open() maps
+// such a file and reads the sorted arrays and codes in place, copying them only
+// when later inserts modify them.
+class LshIndex {
+public:
+    LshIndex(std::size_t bands, std::size_t rows);
+
+    // Adds the sketch's registers; ids run 0, 1, ... in insertion order.
+    // Throws std::invalid_argument for sketches that do not match the index.
+    std::size_t insert(const CardinalitySketch& sketch);
+
+    // Ids sharing a bucket with `query` in at least one band, ascending.
+    [[nodiscard]] std::vector<std::size_t> candidates(const CardinalitySketch& query) const;
+
+    // Verified candidates as (id, jaccard) with jaccard >= threshold, best first, ties by id.
+    [[nodiscard]] std::vector<std::pair<std::size_t, double>> query(const CardinalitySketch& query,
+                                                                    double threshold = 0.0) const;
+
+    // Stored pairs (i < j) that share a bucket and have jaccard >= threshold, by (i, j).
+    [[nodiscard]] std::vector<std::tuple<std::size_t, std::size_t, double>> pairs(double threshold = 0.0) const;
+
+    // Writes to path + ".tmp" and renames it over path, so an index mapped from path stays valid.
+    void save(const std::string& path) const;
+    static LshIndex open(const std::string& path);
+
+    [[nodiscard]] std::size_t size() const { return count_; }
+    [[nodiscard]] std::size_t bands() const { return bands_; }
+    [[nodiscard]] std::size_t rows() const { return rows_; }
+
+private:
+    // Read-only view into the mapped file until the first own().
+    template <typename T>
+    class FlatArray {
+    public:
+        [[nodiscard]] const T* data() const { return view_ != nullptr ? view_ : owned_.data(); }
+        [[nodiscard]] std::size_t size() const { return view_ != nullptr ? view_size_ : owned_.size(); }
+        void view(const T* data, std::size_t size) {
+            owned_.clear();
+            view_ = size > 0 ? data : nullptr;
+            view_size_ = size;
+        }
+        void assign(std::vector<T> values) {
+            owned_ = std::move(values);
+            view_ = nullptr;
+            view_size_ = 0;
+        }
+        std::vector<T>& own() {
+            if (view_ != nullptr) {
+                owned_.assign(view_, view_ + view_size_);
+                view_ = nullptr;
+                view_size_ = 0;
+            }
+            return owned_;
+        }
+
+    private:
+        std::vector<T> owned_;
+        const T* view_ = nullptr;
+        std::size_t view_size_ = 0;
+    };
+
+    struct Band {
+        FlatArray<std::uint64_t> keys;   // sorted
+        FlatArray<std::uint32_t> ids;    // ascending within a key
+        std::vector<std::pair<std::uint64_t, std::uint32_t>> pending;
+    };
+
+    std::size_t bands_;
+    std::size_t rows_;
+    std::size_t count_ = 0;
+    // Layout of the stored codes, fixed by the first insert.
+    std::string type_;
+    std::size_t code_bytes_ = 0;
+    std::size_t registers_ = 0;
+    std::vector<double> params_;
+    std::optional<RegisterQuantization> quantization_;
+    FlatArray<std::uint8_t> codes_;   // count_ rows of registers_ * code_bytes_
+    FlatArray<double> weights_;
+    std::vector<Band> band_;
+    std::shared_ptr<const MappedFile> file_;
+
+    [[nodiscard]] JaccardCodes codes_of(const CardinalitySketch& sketch) const;
+    [[nodiscard]] std::uint64_t band_key(const std::uint8_t* codes, std::size_t band) const;
+    [[nodiscard]] std::vector<std::size_t> candidate_ids(const JaccardCodes& codes) const;
+    [[nodiscard]] const std::uint8_t* row(std::size_t id) const;
+    [[nodiscard]] double jaccard(const std::uint8_t* a, double weight_a, const std::uint8_t* b, double weight_b) const;
+    static void merge_pending(Band& band);
+};
@@ -23,6 +23,27 @@ public:
         : UnweightedSketch(sketch_size, master_seed), M_(registers), E_(E) {}
 
     void add(const std::string& elem) override {
+        Prepared p;
+        prepare(elem, p);
+        apply(p);
+    }
+
+    // add() in two halves for IngestPipeline: prepare() computes the m
+    // per-register hashes without touching the registers, so producer threads
+    // may run it concurrently; apply() must see elements in arrival order.
+    // Reusing a Prepared keeps its buffer allocated.
+    struct Prepared {
+        std::vector<double> g;
+    };
+
+    void prepare(const std::string& elem, Prepared& out) const {
+        out.g.resize(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            out.g[i] = -std::log(to_unit_interval(murmur64(elem, seeds_[i])));
+        }
+    }
+
+    void apply(const Prepared& p) {
         // Compute P_k = probability of state change BEFORE updating registers.
         // P = 1 - prod_i exp(-M[i]) = 1 - exp(-sum(M[i]))
         // When registers are infinity (empty sketch), P = 1.
@@ -37,8 +58,7 @@ public:
         // Update registers
         bool changed = false;
         for (std::size_t i = 0; i < size; ++i) {
-            double g = -std::log(to_unit_interval(murmur64(elem, seeds_[i])));
-            if (g < M_[i]) { M_[i] = g; changed = true; }
+            if (p.g[i] < M_[i]) { M_[i] = p.g[i]; changed = true; }
         }
 
         // Accumulate martingale estimate
@@ -40,6 +40,10 @@ public:
         return static_cast<double>(equal) / static_cast<double>(size);
     }
 
+    [[nodiscard]] JaccardCodes jaccard_codes() const override {
+        return pack_jaccard_codes<std::uint64_t>(size, [this](std::size_t i) { return float_code(M_[i]); });
+    }
+
     void merge(const MinHash& other) {
         if (other.size != size) throw std::invalid_argument("Cannot merge sketches of different sizes.");
         for (std::size_t i = 0; i < size; ++i)
@@ -0,0 +1,43 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// threads == 0 means every hardware thread; never more threads than work items.
+inline std::size_t resolve_threads(std::size_t threads, std::size_t work) {
+    if (threads == 0) threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    return std::max<std::size_t>(1, std::min(threads, work));
+}
+
+// Runs body(item) for item < work on `threads` threads, items handed out in order.
+// The first exception thrown by body stops further items and is rethrown here.
+template <typename Body>
+void parallel_for(std::size_t work, std::size_t threads, Body body) {
+    threads = resolve_threads(threads, work);
+    if (threads == 1) {
+        for (std::size_t item = 0; item < work; ++item) body(item);
+        return;
+    }
+    std::atomic<std::size_t> next{0};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto worker = [&]() {
+        try {
+            for (std::size_t item = next++; item < work; item = next++) body(item);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) error = std::current_exception();
+            next = work;
+        }
+    };
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (std::size_t t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& t : pool) t.join();
+    if (error) std::rethrow_exception(error);
+}
@@ -3,32 +3,36 @@
 #include <cmath>
 #include <stdexcept>
 #include "hash_util.hpp"
+#include "jaccard_batch.hpp"
 #include<cstring>
 #include "utils.hpp"
 
-QSketch::QSketch(std::size_t sketch_size, std::uint64_t master_seed, uint8_t amount_bits, RngEngine engine)
+QSketch::QSketch(std::size_t sketch_size, std::uint64_t master_seed, uint8_t amount_bits, RngEngine engine, std::size_t small_capacity)
     : Sketch(sketch_size, master_seed),
-      fisher_yates(size, engine),
+      own_fisher_yates(small_capacity == 0 ? std::make_unique<FisherYates>(size, engine) : nullptr),
+      fisher_yates(own_fisher_yates.get()),
       amount_bits_(amount_bits),
       r_max((1 << (amount_bits - 1)) - 1),
       r_min(-(1 << (amount_bits - 1)) + 1),
-      M_(amount_bits, sketch_size),
-      j_star(0)
+      M_(amount_bits, small_capacity == 0 ? sketch_size : 0),
+      j_star(0),
+      engine_(engine),
+      small_(small_capacity)
 {
     if (amount_bits < 2) { throw std::invalid_argument("Amount of bits 'b' must be >= 2."); }
-    for (std::size_t i = 0; i < size; ++i) {
-        M_[i] = r_min;
-    }
+    fill(M_, r_min);
 }
 
 QSketch::QSketch(std::size_t sketch_size, std::uint64_t master_seed, std::uint8_t amount_bits, const std::vector<int>& registers, RngEngine engine)
     : Sketch(sketch_size, master_seed),
-      fisher_yates(size, engine),
+      own_fisher_yates(std::make_unique<FisherYates>(size, engine)),
+      fisher_yates(own_fisher_yates.get()),
       amount_bits_(amount_bits),
       r_max((1 << (amount_bits - 1)) - 1),
       r_min(-(1 << (amount_bits - 1)) + 1),
       M_(amount_bits, sketch_size),
-      j_star(argmin(registers))
+      j_star(argmin(registers)),
+      engine_(engine)
 {
     if (amount_bits < 2) { throw std::invalid_argument("Amount of bits 'b' must be >= 2."); }
     if (registers.size() != sketch_size) { throw std::invalid_argument("Invalid state: registers vector size mismatch"); }
@@ -37,46 +41,109 @@ QSketch::QSketch(std::size_t sketch_size, std::uint64_t master_seed, std::uint8_
     }
 }
 
+QSketch::QSketch(std::size_t sketch_size, std::uint64_t master_seed, std::uint8_t amount_bits, Arena& arena, FisherYates& shared_fisher_yates)
+    : Sketch(sketch_size, master_seed),
+      fisher_yates(&shared_fisher_yates),
+      amount_bits_(amount_bits),
+      r_max((1 << (amount_bits - 1)) - 1),
+      r_min(-(1 << (amount_bits - 1)) + 1),
+      M_(amount_bits, sketch_size, ArenaAllocator<std::uint64_t>(&arena)),
+      j_star(0),
+      engine_(shared_fisher_yates.engine_type())
+{
+    if (amount_bits < 2) { throw std::invalid_argument("Amount of bits 'b' must be >= 2."); }
+    fill(M_, r_min);
+}
+
+QSketch::QSketch(const QSketch& other)
+    : Sketch(other),
+      own_fisher_yates(other.fisher_yates != nullptr ? std::make_unique<FisherYates>(other.size, other.engine_) : nullptr),
+      fisher_yates(own_fisher_yates.get()),
+      amount_bits_(other.amount_bits_),
+      r_max(other.r_max),
+      r_min(other.r_min),
+      M_(other.amount_bits_, other.M_.size()),
+      j_star(other.j_star),
+      engine_(other.engine_),
+      small_(other.small_)
+{
+    for (std::size_t i = 0; i < M_.size(); ++i) {
+        M_[i] = other.M_[i];
+    }
+}
+
 
 size_t QSketch::memory_usage(uint64_t flags) const {
     uint64_t f = resolve_flags(flags);
     size_t s = 0;
-    if (f & MemoryFlag::REGISTERS) s += M_.bytes();
+    if (f & MemoryFlag::REGISTERS) s += M_.bytes() + small_.bytes();
     if (f & MemoryFlag::ALL_WRITE_NO_REGISTERS) s += sizeof(size) + sizeof(amount_bits_) + sizeof(r_max) + sizeof(r_min) + sizeof(j_star);
-    s += fisher_yates.memory_usage(f);
+    if (own_fisher_yates) { s += own_fisher_yates->memory_usage(f); }
     if (f & MemoryFlag::SEEDS) s += seeds_.bytes();
     return s;
 }
 
 std::uint8_t QSketch::get_amount_bits() const { return amount_bits_; }
 std::vector<int> QSketch::get_registers() const {
+    if (small_.active()) { return densified().get_registers(); }
     return std::vector<int>(M_.begin(), M_.end());
 }
 
 void QSketch::add(const std::string& elem, double weight){ 
     validate_weight(weight);
-    double r = 0;
+    if (small_.active()) {
+        if (small_.insert(elem, weight)) { return; }
+        promote();
+    }
+    AddStep step;
 
-    fisher_yates.initialize(elem); 
+    fisher_yates->initialize(elem);
     for (size_t k = 0; k < this->size; ++k){
         std::uint64_t hashed = murmur64(elem, seeds_[k]); 
         double unit_interval_hash = to_unit_interval(hashed); 
-        r -= (std::log(unit_interval_hash) / (weight*(double)(size - k))); 
-        int y = static_cast<int>(std::floor(-std::log2(r)));
+        if (!advance(step, k, -std::log(unit_interval_hash), weight)) { break; }
+        update_register(step, fisher_yates->get_fisher_yates_element(k));
+    }
+    finish_element(step);
+} 
 
-        if ( y <= M_[j_star] ) { break; } 
+void QSketch::promote() {
+    if (!small_.active()) { return; }
+    const SmallSet buffered = small_.release();
+    own_fisher_yates = std::make_unique<FisherYates>(size, engine_);
+    fisher_yates = own_fisher_yates.get();
+    Registers registers(amount_bits_, size);
+    fill(registers, r_min);
+    std::swap(M_, registers);
+    j_star = 0;
+    buffered.for_each([this](const std::string& elem, double weight) { add(elem, weight); });
+}
 
-        auto j = fisher_yates.get_fisher_yates_element(k);
+QSketch QSketch::densified() const {
+    QSketch copy(*this);
+    copy.promote();
+    return copy;
+}
 
-        if (y > this->M_[j]){
-            M_[j] = std::min(std::max(y, r_min), r_max);
-            if (j == j_star){
-                j_star = argmin(M_);
-            }
+bool QSketch::advance(AddStep& step, std::size_t k, double neg_log_u, double weight) const {
+    step.sum += neg_log_u / (weight*(double)(size - k));
+    step.level = static_cast<int>(std::floor(-std::log2(step.sum)));
+    stats_.on_iteration();
+    if (step.level > M_[j_star]) { return true; }
+    stats_.on_early_exit();
+    return false;
+}
+
+void QSketch::update_register(AddStep& step, std::uint32_t j) {
+    if (step.level > this->M_[j]){
+        stats_.on_register_update();
+        M_[j] = std::min(std::max(step.level, r_min), r_max);
+        if (j == j_star){
+            stats_.on_rescan();
+            j_star = argmin(M_);
         }
     }
-
-} 
+}
 
 double QSketch::initialValue() const {
     double tmp_sum = 0.0;
@@ -111,13 +178,52 @@ double QSketch::Newton(double c0) const {
 }
 
 double QSketch::estimate() const {
+    if (small_.active()) { return small_.total_weight(); }
     return Newton(initialValue());
 }
 
 void QSketch::merge(const QSketch& other) {
     if (other.size != size) { throw std::invalid_argument("Cannot merge sketches of different sizes."); }
+    if (other.small_.active()) {
+        other.small_.for_each([this](const std::string& elem, double weight) { add(elem, weight); });
+        return;
+    }
+    promote();
     for (std::size_t i = 0; i < size; ++i) {
         M_[i] = std::max((int)M_[i], (int)other.M_[i]);
     }
     j_star = argmin(M_);
 }
+
+void QSketch::merge_registers(const int* registers, std::size_t count) {
+    if (count != size) { throw std::invalid_argument("Cannot merge sketches of different sizes."); }
+    promote();
+    for (std::size_t i = 0; i < size; ++i) {
+        M_[i] = std::max((int)M_[i], registers[i]);
+    }
+    j_star = argmin(M_);
+}
+
+double QSketch::jaccard_struct(const QSketch& other) const {
+    if (other.size != size) { return 0.0; }
+    if (small_.active() || other.small_.active()) { return densified().jaccard_struct(other.densified()); }
+    std::size_t equal = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        if (M_[i] == other.M_[i]) { ++equal; }
+    }
+    return quantized_jaccard(equal, size, estimate(), other.estimate(), quantization());
+}
+
+JaccardCodes QSketch::jaccard_codes() const {
+    if (small_.active()) { return densified().jaccard_codes(); }
+    JaccardCodes codes = pack_small_register_codes(size, amount_bits_, [this](std::size_t i) {
+        return static_cast<std::uint32_t>(static_cast<int>(M_[i]) - r_min);
+    });
+    codes.quantization = quantization();
+    codes.weight = estimate();
+    return codes;
+}
+
+RegisterQuantization QSketch::quantization() const {
+    return {2.0, 0.0, r_min, r_max};
+}
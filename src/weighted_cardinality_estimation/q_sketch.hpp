@@ -1,22 +1,27 @@
 #pragma once
 #include "compact_vector.hpp"
+#include <memory>
 #include <vector>
 #include <string>
 #include <cstdint>
+#include "arena.hpp"
 #include "fisher_yates.hpp"
 #include "rng_engine_type.hpp"
 #include "sketch.hpp"
+#include "small_set.hpp"
 
-class QSketch : public Sketch, public MergeableMixin {
+class QSketch : public Sketch, public MergeableMixin, public JaccardMixin {
 // Paper: https://arxiv.org/abs/2406.19143v1
 public:
     static constexpr double newton_max_error = 1e-6;
     static constexpr int newton_max_iterations = 5;
+    // small_capacity > 0 starts in small mode (see SmallSet).
     QSketch(
         std::size_t sketch_size,
         std::uint64_t master_seed,
         std::uint8_t amount_bits,
-        RngEngine engine = kDefaultRngEngine
+        RngEngine engine = kDefaultRngEngine,
+        std::size_t small_capacity = 0
     );
     QSketch(
         std::size_t sketch_size,
@@ -25,24 +30,65 @@ public:
         const std::vector<int>& registers,
         RngEngine engine = kDefaultRngEngine
     );
+    // SketchPool member: registers in the pool's arena, and add() borrows the
+    // pool's Fisher-Yates scratch, so the sketch owns no heap memory.
+    QSketch(
+        std::size_t sketch_size,
+        std::uint64_t master_seed,
+        std::uint8_t amount_bits,
+        Arena& arena,
+        FisherYates& shared_fisher_yates
+    );
+    // Copies are stand-alone: heap registers and their own Fisher-Yates.
+    QSketch(const QSketch& other);
+    QSketch(QSketch&&) noexcept = default;
+    QSketch& operator=(const QSketch&) = delete;
 
     void add(const std::string& elem, double weight = 1.0);
     [[nodiscard]] double estimate() const;
+
+    // add() split at the per-step work shared with SketchGroup members.
+    bool advance(AddStep& step, std::size_t k, double neg_log_u, double weight) const;
+    void update_register(AddStep& step, std::uint32_t j);
+    void finish_element(const AddStep& /*step*/) { stats_.on_add(); }
+
     std::uint8_t get_amount_bits() const;
+    [[nodiscard]] RngEngine get_rng_engine() const { return engine_; }
     std::vector<int> get_registers() const;
+    // A small-mode other is replayed into this sketch; a dense one promotes it.
     void merge(const QSketch& other);
+    // Merges a register array of another sketch with this size and parameters
+    // (as decoded by merge_wire()) without constructing it.
+    void merge_registers(const int* registers, std::size_t count);
+    [[nodiscard]] int register_at(std::size_t i) const { return M_[i]; }
+    [[nodiscard]] double jaccard_struct(const QSketch& other) const;
+    [[nodiscard]] JaccardCodes jaccard_codes() const override;
+
+    [[nodiscard]] bool small_mode() const { return small_.active(); }
+    [[nodiscard]] std::size_t small_capacity() const { return small_.capacity(); }
+    const SmallSet& small_set() const { return small_; }
+    // Leaves small mode: allocates the registers and replays the buffered elements.
+    void promote();
+    // Dense copy with the registers this sketch has or would promote to.
+    [[nodiscard]] QSketch densified() const;
 
     [[nodiscard]] size_t memory_usage(uint64_t flags) const override;
 private:
+    [[nodiscard]] RegisterQuantization quantization() const;
     double initialValue() const;
     double ffunc_divided_by_dffunc(double w) const;
     double Newton(double c0) const;
 
-    FisherYates fisher_yates;
+    using Registers = compact::vector<int, 0, std::uint64_t, ArenaAllocator<std::uint64_t>>;
+
+    std::unique_ptr<FisherYates> own_fisher_yates; // null for SketchPool members and in small mode
+    FisherYates* fisher_yates;
     std::uint8_t amount_bits_;
     std::int32_t r_max; // maximum possible value in sketch due to amount of bits per register
     std::int32_t r_min; // minimum possible value in sketch due to amount of bits per register
 
-    compact::vector<int> M_; // sketch structure with elements between < r_min ... r_max >
+    Registers M_; // sketch structure with elements between < r_min ... r_max >
     uint32_t j_star;
+    RngEngine engine_;
+    SmallSet small_;
 };
@@ -3,6 +3,7 @@
 #include <string>
 #include <cstdint>
 #include "compact_vector.hpp"
+#include "hash_scheme_type.hpp"
 #include "sketch.hpp"
 
 class QSketchDyn : public Sketch {
@@ -11,7 +12,8 @@ public:
         std::size_t sketch_size,
         std::uint64_t master_seed,
         std::uint8_t amount_bits,
-        std::uint32_t g_seed = 42
+        std::uint32_t g_seed = 42,
+        HashScheme hash_scheme = kDefaultHashScheme
     );
     QSketchDyn(
         std::size_t sketch_size,
@@ -20,13 +22,30 @@ public:
         std::uint64_t master_seed,
         const std::vector<int>& registers,
         const std::vector<std::uint32_t>& t_histogram,
-        double cardinality
+        double cardinality,
+        HashScheme hash_scheme = kDefaultHashScheme
     );
 
     void add(const std::string& elem, double weight = 1.0);
+
+    // add() in two halves for IngestPipeline: prepare() does the hashing and
+    // reads no mutable state, so producer threads may run it concurrently;
+    // apply() folds the result in and must see elements in arrival order.
+    // add(e, w) is exactly prepare(e, w, p) followed by apply(p).
+    struct Prepared {
+        std::size_t j = 0;
+        int y = 0;
+        double weight = 0.0;
+        bool skip = true;
+    };
+    void prepare(const std::string& elem, double weight, Prepared& out) const;
+    void apply(const Prepared& p);
+    // Running estimate is updated per arrival; collapsing repeats changes it.
+    [[nodiscard]] bool pre_aggregation_exact() const override { return false; }
     [[nodiscard]] double estimate() const;
     std::uint8_t get_amount_bits() const;
     std::uint32_t get_g_seed() const;
+    HashScheme get_hash_scheme() const;
     std::vector<int> get_registers() const;
     std::vector<std::uint32_t> get_t_histogram() const;
     double get_cardinality() const;
@@ -38,6 +57,7 @@ private:
     std::int32_t r_min;
     std::int32_t r_max;
     std::uint32_t g_seed_;
+    HashScheme hash_scheme_;
 
     double cardinality_;
     double q_r_;
@@ -0,0 +1,146 @@
+#include "set_operations.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+template <typename T>
+void compare_scalar(const T* a, const T* b, std::size_t begin, std::size_t end, RegisterComparison& out) {
+    const T inf = std::numeric_limits<T>::infinity();
+    const T zero = T(0);
+    for (std::size_t i = begin; i < end; ++i) {
+        const T x = a[i] < zero ? inf : a[i];
+        const T y = b[i] < zero ? inf : b[i];
+        const T lo = std::min(x, y);
+        out.min_sum += static_cast<double>(lo == inf ? std::max(a[i], b[i]) : lo);
+        out.equal += (x == y);
+        out.a_less += (x < y);
+        out.b_less += (y < x);
+    }
+}
+
+#if defined(__x86_64__) && defined(__GNUC__)
+__attribute__((target("avx2")))
+double horizontal_sum(__m256d v) {
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, v);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+__attribute__((target("avx2")))
+std::size_t horizontal_sum_epi64(__m256i v) {
+    alignas(32) std::uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), v);
+    return static_cast<std::size_t>(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+}
+
+__attribute__((target("avx2")))
+std::size_t horizontal_sum_epi32(__m256i v) {
+    alignas(32) std::uint32_t lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), v);
+    std::size_t total = 0;
+    for (std::uint32_t lane : lanes) total += lane;
+    return total;
+}
+
+__attribute__((target("avx2")))
+std::size_t compare_avx2(const double* a, const double* b, std::size_t size, RegisterComparison& out) {
+    const __m256d inf = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+    const __m256d zero = _mm256_setzero_pd();
+    __m256d sum = _mm256_setzero_pd();
+    __m256i equal = _mm256_setzero_si256();
+    __m256i a_less = _mm256_setzero_si256();
+    __m256i b_less = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        const __m256d ra = _mm256_loadu_pd(a + i);
+        const __m256d rb = _mm256_loadu_pd(b + i);
+        const __m256d x = _mm256_blendv_pd(ra, inf, _mm256_cmp_pd(ra, zero, _CMP_LT_OQ));
+        const __m256d y = _mm256_blendv_pd(rb, inf, _mm256_cmp_pd(rb, zero, _CMP_LT_OQ));
+        const __m256d lo = _mm256_min_pd(x, y);
+        const __m256d both_empty = _mm256_cmp_pd(lo, inf, _CMP_EQ_OQ);
+        sum = _mm256_add_pd(sum, _mm256_blendv_pd(lo, _mm256_max_pd(ra, rb), both_empty));
+        // Compare masks are all-ones (-1) per matching lane.
+        equal = _mm256_sub_epi64(equal, _mm256_castpd_si256(_mm256_cmp_pd(x, y, _CMP_EQ_OQ)));
+        a_less = _mm256_sub_epi64(a_less, _mm256_castpd_si256(_mm256_cmp_pd(x, y, _CMP_LT_OQ)));
+        b_less = _mm256_sub_epi64(b_less, _mm256_castpd_si256(_mm256_cmp_pd(y, x, _CMP_LT_OQ)));
+    }
+    out.min_sum += horizontal_sum(sum);
+    out.equal += horizontal_sum_epi64(equal);
+    out.a_less += horizontal_sum_epi64(a_less);
+    out.b_less += horizontal_sum_epi64(b_less);
+    return i;
+}
+
+// Lanes are compared as float and summed as double, like estimate().
+__attribute__((target("avx2")))
+std::size_t compare_avx2(const float* a, const float* b, std::size_t size, RegisterComparison& out) {
+    const __m256 inf = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+    const __m256 zero = _mm256_setzero_ps();
+    __m256d sum = _mm256_setzero_pd();
+    // 32-bit lane counters; each lane sees at most size / 8 matches.
+    __m256i equal = _mm256_setzero_si256();
+    __m256i a_less = _mm256_setzero_si256();
+    __m256i b_less = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        const __m256 ra = _mm256_loadu_ps(a + i);
+        const __m256 rb = _mm256_loadu_ps(b + i);
+        const __m256 x = _mm256_blendv_ps(ra, inf, _mm256_cmp_ps(ra, zero, _CMP_LT_OQ));
+        const __m256 y = _mm256_blendv_ps(rb, inf, _mm256_cmp_ps(rb, zero, _CMP_LT_OQ));
+        const __m256 lo = _mm256_min_ps(x, y);
+        const __m256 both_empty = _mm256_cmp_ps(lo, inf, _CMP_EQ_OQ);
+        const __m256 term = _mm256_blendv_ps(lo, _mm256_max_ps(ra, rb), both_empty);
+        sum = _mm256_add_pd(sum, _mm256_cvtps_pd(_mm256_castps256_ps128(term)));
+        sum = _mm256_add_pd(sum, _mm256_cvtps_pd(_mm256_extractf128_ps(term, 1)));
+        equal = _mm256_sub_epi32(equal, _mm256_castps_si256(_mm256_cmp_ps(x, y, _CMP_EQ_OQ)));
+        a_less = _mm256_sub_epi32(a_less, _mm256_castps_si256(_mm256_cmp_ps(x, y, _CMP_LT_OQ)));
+        b_less = _mm256_sub_epi32(b_less, _mm256_castps_si256(_mm256_cmp_ps(y, x, _CMP_LT_OQ)));
+    }
+    out.min_sum += horizontal_sum(sum);
+    out.equal += horizontal_sum_epi32(equal);
+    out.a_less += horizontal_sum_epi32(a_less);
+    out.b_less += horizontal_sum_epi32(b_less);
+    return i;
+}
+#endif
+
+template <typename T>
+RegisterComparison compare(const T* a, const T* b, std::size_t size) {
+    RegisterComparison out;
+    std::size_t done = 0;
+#if defined(__x86_64__) && defined(__GNUC__)
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    if (has_avx2) done = compare_avx2(a, b, size, out);
+#endif
+    compare_scalar(a, b, done, size, out);
+    return out;
+}
+
+} // namespace
+
+RegisterComparison compare_registers(const double* a, const double* b, std::size_t size) {
+    return compare(a, b, size);
+}
+
+RegisterComparison compare_registers(const float* a, const float* b, std::size_t size) {
+    return compare(a, b, size);
+}
+
+// 16-bit registers stay scalar: the compares work on the raw bits and only
+// the min is widened.
+RegisterComparison compare_registers(const Float16* a, const Float16* b, std::size_t size) {
+    RegisterComparison out;
+    compare_scalar(a, b, 0, size, out);
+    return out;
+}
+
+RegisterComparison compare_registers(const BFloat16* a, const BFloat16* b, std::size_t size) {
+    RegisterComparison out;
+    compare_scalar(a, b, 0, size, out);
+    return out;
+}
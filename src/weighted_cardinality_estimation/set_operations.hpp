@@ -0,0 +1,90 @@
+#pragma once
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+#include "cow_registers.hpp"
+#include "float16.hpp"
+#include "small_set.hpp"
+
+// Non-mutating set-operation estimates for two ExpSketch-family sketches of the
+// same size and seed (ExpSketchT, FastExpSketchT, FastGMExpSketch).
+//
+// Register i of the union would be min(a_i, b_i), so the union estimate is
+// (m - 1) / sum_i min(a_i, b_i), equal to merging and calling estimate(). The
+// element behind that minimum lies in A and B exactly when a_i == b_i, and in
+// A \ B exactly when a_i < b_i, with probability w(A n B) / w(A u B) and
+// w(A \ B) / w(A u B). One pass over both register arrays yields all three
+// counts and the sum, without allocating.
+
+struct RegisterComparison {
+    double min_sum = 0.0;       // sum of the union registers
+    std::size_t equal = 0;      // a_i == b_i
+    std::size_t a_less = 0;     // a_i < b_i
+    std::size_t b_less = 0;     // b_i < a_i
+};
+
+// Negative registers (FastGMExpSketch before it fills) count as empty: they
+// lose every min, and a register empty in both keeps the larger raw value, as
+// merge() does.
+RegisterComparison compare_registers(const double* a, const double* b, std::size_t size);
+RegisterComparison compare_registers(const float* a, const float* b, std::size_t size);
+RegisterComparison compare_registers(const Float16* a, const Float16* b, std::size_t size);
+RegisterComparison compare_registers(const BFloat16* a, const BFloat16* b, std::size_t size);
+
+// Block by block for FastExpSketchT, whose blocks line up for equal sizes.
+template <typename T>
+RegisterComparison compare_registers(const CowRegisters<T>& a, const CowRegisters<T>& b) {
+    RegisterComparison total;
+    for (std::size_t bi = 0; bi < a.block_count(); ++bi) {
+        const RegisterComparison c = compare_registers(a.block(bi), b.block(bi), a.block_length(bi));
+        total.min_sum += c.min_sum;
+        total.equal += c.equal;
+        total.a_less += c.a_less;
+        total.b_less += c.b_less;
+    }
+    return total;
+}
+
+template <typename T>
+RegisterComparison compare_registers(const std::vector<T>& a, const std::vector<T>& b) {
+    return compare_registers(a.data(), b.data(), a.size());
+}
+
+// Takes registers() where a sketch has it (copy-on-write storage), else get_registers().
+template <typename S>
+auto register_storage(const S& s, int) -> decltype(s.registers()) { return s.registers(); }
+
+template <typename S>
+decltype(auto) register_storage(const S& s, long) { return s.get_registers(); }
+
+template <typename S>
+RegisterComparison compare_registers(const S& a, const S& b) {
+    if (a.get_sketch_size() != b.get_sketch_size()) {
+        throw std::invalid_argument("Set operations need sketches of the same size.");
+    }
+    if constexpr (has_small_mode<S>::value) {
+        if (a.small_mode() || b.small_mode()) { return compare_registers(a.densified(), b.densified()); }
+    }
+    return compare_registers(register_storage(a, 0), register_storage(b, 0));
+}
+
+template <typename S>
+double union_estimate(const S& a, const S& b) {
+    const RegisterComparison c = compare_registers(a, b);
+    return (static_cast<double>(a.get_sketch_size()) - 1.0) / c.min_sum;
+}
+
+template <typename S>
+double intersection_estimate(const S& a, const S& b) {
+    const RegisterComparison c = compare_registers(a, b);
+    const auto m = static_cast<double>(a.get_sketch_size());
+    return (m - 1.0) / c.min_sum * static_cast<double>(c.equal) / m;
+}
+
+// Weight of A \ B.
+template <typename S>
+double difference_estimate(const S& a, const S& b) {
+    const RegisterComparison c = compare_registers(a, b);
+    const auto m = static_cast<double>(a.get_sketch_size());
+    return (m - 1.0) / c.min_sum * static_cast<double>(c.a_less) / m;
+}
@@ -2,6 +2,9 @@
 
 #include "seeds.hpp"
 #include "memory_flag.hpp"
+#include "dedup_table.hpp"
+#include "hot_path_stats.hpp"
+#include "jaccard_codes.hpp"
 #include <cstddef>
 #include <cmath>
 #include <stdexcept>
@@ -26,6 +29,8 @@ public:
 class JaccardMixin {
 public:
     virtual ~JaccardMixin() = default;
+    // Registers as codes for jaccard_matrix() / jaccard_topk().
+    [[nodiscard]] virtual JaccardCodes jaccard_codes() const = 0;
 };
 
 class NewtonMixin {
@@ -57,15 +62,24 @@ public:
         for (const auto& e : elems) this->add(e);
     }
 
-protected:
-    std::size_t size;
-    Seeds seeds_;
+    // Hot-path counters; all zero unless built with WCE_STATS (see hot_path_stats.hpp).
+    [[nodiscard]] HotPathStats stats() const { return stats_.get(); }
+    void reset_stats() { stats_.reset(); }
 
     static void validate_weight(double weight) {
         if (weight <= 0.0 || std::isnan(weight) || std::isinf(weight))
             throw std::invalid_argument("Weight must be a finite positive number.");
     }
 
+protected:
+    std::size_t size;
+    Seeds seeds_;
+#ifdef WCE_STATS
+    mutable StatsRecorder stats_;  // mutable: the const advance() steps count iterations
+#else
+    static inline StatsRecorder stats_{};  // empty no-op recorder; keeps the layout unchanged
+#endif
+
     // Resolves the flag bitmask: if TOTAL bit is set, the other bits are EXCLUSIONS;
     // otherwise the bits specify which components to INCLUDE.
     static uint64_t resolve_flags(uint64_t flags) {
@@ -121,4 +135,49 @@ public:
     void add_many(const std::vector<std::string>& elems) {
         for (const auto& e : elems) this->add(e, 1.0);
     }
+
+    // add_many with an optional DedupTable front end: repeats of a key inside a
+    // window collapse to one add() with their max weight. Ignored (plain add_many)
+    // for sketches whose state depends on arrival order, see pre_aggregation_exact().
+    void add_many(const std::vector<std::string>& elems,
+                  const std::vector<double>& weights, bool pre_aggregate) {
+        if (!pre_aggregate || !pre_aggregation_exact()) {
+            add_many(elems, weights);
+            return;
+        }
+        if (elems.size() != weights.size())
+            throw std::invalid_argument("add_many: elems and weights size mismatch");
+        DedupTable table;
+        auto flush = [this](const std::string& e, double w) { this->add(e, w); };
+        for (std::size_t i = 0; i < elems.size(); ++i) {
+            try {
+                validate_weight(weights[i]);
+            } catch (...) {
+                // The plain loop has added every earlier row by now.
+                table.drain(flush);
+                throw;
+            }
+            if (!table.insert(elems[i], weights[i])) {
+                table.drain(flush);
+                table.insert(elems[i], weights[i]);
+            }
+        }
+        table.drain(flush);
+    }
+
+    // True when the final state depends only on each key's max weight, so
+    // pre-aggregated add_many gives the same registers as the plain one.
+    // Online-estimator and sliding-window sketches override this to false.
+    [[nodiscard]] virtual bool pre_aggregation_exact() const { return true; }
+};
+
+// ─── AddStep ──────────────────────────────────────────────────────────────────
+// Per-element scratch for sketches whose add() is split into advance() /
+// update_register() / finish_element(), so SketchGroup can drive several of
+// them from one shared hash + Fisher-Yates stream.
+
+struct AddStep {
+    double sum = 0.0;      // running sum of E_k / (m - k)
+    int level = 0;         // quantized register candidate for step k (q-sketches)
+    bool touched = false;  // a register sitting at the early-exit threshold was overwritten
 };
@@ -0,0 +1,122 @@
+#include "sketch_group.hpp"
+#include <cmath>
+#include <stdexcept>
+#include "hash_util.hpp"
+
+namespace {
+
+// Helpers over SketchGroup::Members<T>: {sketches, steps, live}.
+
+template <typename Group>
+void begin_element(Group& g) {
+    g.steps.assign(g.sketches.size(), AddStep{});
+    g.live.assign(g.sketches.size(), 1);
+}
+
+// Advance every live member by step k; returns whether any of them still wants j_k.
+template <typename Group>
+bool advance_all(Group& g, std::size_t k, double neg_log_u, double weight) {
+    bool any = false;
+    for (std::size_t i = 0; i < g.sketches.size(); ++i) {
+        if (!g.live[i]) continue;
+        g.live[i] = g.sketches[i].advance(g.steps[i], k, neg_log_u, weight) ? 1 : 0;
+        any |= (g.live[i] != 0);
+    }
+    return any;
+}
+
+template <typename Group>
+void update_all(Group& g, std::uint32_t j) {
+    for (std::size_t i = 0; i < g.sketches.size(); ++i) {
+        if (g.live[i]) g.sketches[i].update_register(g.steps[i], j);
+    }
+}
+
+template <typename Group>
+void finish_all(Group& g) {
+    for (std::size_t i = 0; i < g.sketches.size(); ++i) g.sketches[i].finish_element(g.steps[i]);
+}
+
+} // namespace
+
+SketchGroup::SketchGroup(std::size_t sketch_size, std::uint64_t master_seed, RngEngine engine)
+    : size_(sketch_size), seeds_(master_seed), fisher_yates_(sketch_size, engine) {
+    if (sketch_size == 0) throw std::invalid_argument("Sketch size 'm' must be positive.");
+}
+
+void SketchGroup::check_can_grow() const {
+    if (started_) {
+        throw std::runtime_error("Cannot add a member to a SketchGroup that has already ingested elements.");
+    }
+}
+
+FastExpSketch& SketchGroup::make_fast_exp_sketch() {
+    check_can_grow();
+    return fast_exp_.sketches.emplace_back(size_, get_master_seed(), get_rng_engine());
+}
+
+QSketch& SketchGroup::make_q_sketch(std::uint8_t amount_bits) {
+    check_can_grow();
+    return q_.sketches.emplace_back(size_, get_master_seed(), amount_bits, get_rng_engine());
+}
+
+kQSketch& SketchGroup::make_k_q_sketch(std::uint8_t amount_bits, float logarithm_base) {
+    check_can_grow();
+    return k_q_.sketches.emplace_back(size_, get_master_seed(), amount_bits, logarithm_base, get_rng_engine());
+}
+
+HyperLogLog& SketchGroup::make_hyper_log_log() {
+    check_can_grow();
+    return hll_.emplace_back(size_, get_master_seed());
+}
+
+std::size_t SketchGroup::member_count() const {
+    return fast_exp_.sketches.size() + q_.sketches.size() + k_q_.sketches.size() + hll_.size();
+}
+
+void SketchGroup::add(const std::string& elem, double weight) {
+    if (weight <= 0.0 || std::isnan(weight) || std::isinf(weight))
+        throw std::invalid_argument("Weight must be a finite positive number.");
+    started_ = true;
+
+    begin_element(fast_exp_);
+    begin_element(q_);
+    begin_element(k_q_);
+
+    std::uint64_t first_hash = 0;
+    if (fast_exp_.sketches.empty() && q_.sketches.empty() && k_q_.sketches.empty()) {
+        first_hash = murmur64(elem, seeds_[0]);
+    } else {
+        fisher_yates_.initialize(elem);
+        for (std::size_t k = 0; k < size_; ++k) {
+            std::uint64_t hashed = murmur64(elem, seeds_[k]);
+            if (k == 0) first_hash = hashed;
+            double neg_log_u = -std::log(to_unit_interval(hashed));
+
+            bool any = advance_all(fast_exp_, k, neg_log_u, weight);
+            any |= advance_all(q_, k, neg_log_u, weight);
+            any |= advance_all(k_q_, k, neg_log_u, weight);
+            if (!any) break;
+
+            std::uint32_t j = fisher_yates_.get_fisher_yates_element(k);
+            update_all(fast_exp_, j);
+            update_all(q_, j);
+            update_all(k_q_, j);
+        }
+        finish_all(fast_exp_);
+        finish_all(q_);
+        finish_all(k_q_);
+    }
+
+    for (auto& hll : hll_) hll.add_hashed(elem, first_hash);
+}
+
+void SketchGroup::add_many(const std::vector<std::string>& elems, const std::vector<double>& weights) {
+    if (elems.size() != weights.size())
+        throw std::invalid_argument("add_many: elems and weights size mismatch");
+    for (std::size_t i = 0; i < elems.size(); ++i) add(elems[i], weights[i]);
+}
+
+void SketchGroup::add_many(const std::vector<std::string>& elems) {
+    for (const auto& e : elems) add(e, 1.0);
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+#include "fast_exp_sketch.hpp"
+#include "fast_k_q_sketch.hpp"
+#include "fisher_yates.hpp"
+#include "hyper_log_log.hpp"
+#include "q_sketch.hpp"
+#include "rng_engine_type.hpp"
+#include "seeds.hpp"
+
+// Fused ingestion: one (elem, weight) stream feeding several sketches at once.
+//
+// Members built by the group share its size, master seed and RNG engine. With
+// those fixed, every member would derive the same per-step hash murmur64(elem,
+// seeds_[k]), the same -log(U_k) and the same Fisher-Yates index j_k. add()
+// computes that stream once and hands each step to every member that can still
+// change (advance() / update_register() / finish_element()), and it stops when
+// the last member prunes. HyperLogLog reuses the k = 0 hash as its bucket hash.
+// Member registers end up identical to adding the stream to each sketch alone.
+//
+// Members live as long as the group; references stay valid as members are added.
+class SketchGroup {
+public:
+    SketchGroup(std::size_t sketch_size, std::uint64_t master_seed, RngEngine engine = kDefaultRngEngine);
+
+    FastExpSketch& make_fast_exp_sketch();
+    QSketch& make_q_sketch(std::uint8_t amount_bits);
+    kQSketch& make_k_q_sketch(std::uint8_t amount_bits, float logarithm_base);
+    HyperLogLog& make_hyper_log_log();
+
+    void add(const std::string& elem, double weight = 1.0);
+    void add_many(const std::vector<std::string>& elems, const std::vector<double>& weights);
+    void add_many(const std::vector<std::string>& elems);
+
+    [[nodiscard]] std::size_t get_sketch_size() const { return size_; }
+    [[nodiscard]] std::uint64_t get_master_seed() const { return seeds_.get_master_seed(); }
+    [[nodiscard]] RngEngine get_rng_engine() const { return fisher_yates_.engine_type(); }
+    [[nodiscard]] std::size_t member_count() const;
+
+private:
+    template <typename T>
+    struct Members {
+        std::deque<T> sketches;
+        std::vector<AddStep> steps;
+        std::vector<char> live;
+    };
+
+    std::size_t size_;
+    Seeds seeds_;
+    FisherYates fisher_yates_;
+    Members<FastExpSketch> fast_exp_;
+    Members<QSketch> q_;
+    Members<kQSketch> k_q_;
+    std::deque<HyperLogLog> hll_;
+    bool started_ = false;
+
+    void check_can_grow() const;
+};
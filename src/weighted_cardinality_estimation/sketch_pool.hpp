@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "arena.hpp"
+#include "fisher_yates.hpp"
+
+// Slab storage for many sketches of one shape (m, seed and S's parameters,
+// e.g. QSketch's amount_bits), such as one sketch per key.
+//
+// make() placement-constructs the sketch and its registers in the pool's Arena
+// through S's (m, seed, params..., Arena&, FisherYates&) constructor, and every
+// member borrows the pool's Fisher-Yates scratch for add(). A member therefore
+// costs one bump allocation and no heap memory, and reset() drops all members
+// in O(1) without running destructors; memory is reused by later make() calls.
+// References to members are invalidated by reset(). Members share scratch
+// state, so a pool and its members belong to one thread at a time.
+template <typename S>
+class SketchPool {
+public:
+    template <typename... Params>
+    SketchPool(std::size_t sketch_size, std::uint64_t master_seed, Params... params)
+        : sketch_size_(sketch_size),
+          master_seed_(master_seed),
+          fisher_yates_(sketch_size),
+          construct_([=](void* where, Arena& arena, FisherYates& fisher_yates) {
+              return new (where) S(sketch_size, master_seed, params..., arena, fisher_yates);
+          }) {}
+
+    SketchPool(const SketchPool&) = delete;
+    SketchPool& operator=(const SketchPool&) = delete;
+
+    S& make() {
+        void* where = arena_.allocate(sizeof(S), alignof(S));
+        S* sketch = construct_(where, arena_, fisher_yates_);
+        members_.push_back(sketch);
+        return *sketch;
+    }
+
+    S& operator[](std::size_t id) { return *members_[checked(id)]; }
+    const S& operator[](std::size_t id) const { return *members_[checked(id)]; }
+
+    // Adds elems[i] with weights[i] to member ids[i].
+    void add_many(const std::vector<std::size_t>& ids, const std::vector<std::string>& elems,
+                  const std::vector<double>& weights) {
+        if (ids.size() != elems.size() || elems.size() != weights.size()) {
+            throw std::invalid_argument("add_many: ids, elems and weights size mismatch");
+        }
+        for (std::size_t id : ids) { checked(id); }
+        for (std::size_t i = 0; i < ids.size(); ++i) { members_[ids[i]]->add(elems[i], weights[i]); }
+    }
+
+    void reset() {
+        members_.clear();
+        arena_.reset();
+    }
+
+    [[nodiscard]] std::size_t size() const { return members_.size(); }
+    [[nodiscard]] std::size_t get_sketch_size() const { return sketch_size_; }
+    [[nodiscard]] std::uint64_t get_master_seed() const { return master_seed_; }
+    [[nodiscard]] std::size_t bytes_reserved() const { return arena_.bytes_reserved(); }
+
+private:
+    std::size_t checked(std::size_t id) const {
+        if (id >= members_.size()) { throw std::out_of_range("SketchPool id out of range."); }
+        return id;
+    }
+
+    std::size_t sketch_size_;
+    std::uint64_t master_seed_;
+    Arena arena_;
+    FisherYates fisher_yates_;
+    std::function<S*(void*, Arena&, FisherYates&)> construct_;
+    std::vector<S*> members_;
+};
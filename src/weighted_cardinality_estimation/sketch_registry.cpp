@@ -0,0 +1,103 @@
+#include "sketch_registry.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include "exp_sketch.hpp"
+#include "exp_sketch_float32.hpp"
+#include "fast_exp_sketch.hpp"
+#include "fast_exp_sketch_custom_float.hpp"
+#include "fast_exp_sketch_float16.hpp"
+#include "fast_k_q_sketch.hpp"
+#include "fast_k_q_sketch_rounding.hpp"
+#include "fastgm_exp_sketch.hpp"
+#include "k_q_sketch_rounded_dyn.hpp"
+#include "k_q_sketch_shifted.hpp"
+#include "log_exp_sketch_fast_no_shifted.hpp"
+#include "log_exp_sketch_fast_shifted.hpp"
+#include "q_sketch.hpp"
+#include "q_sketch_dyn.hpp"
+#include "tuner.hpp"
+#include "weighted_hyper_log_log.hpp"
+#include "weighted_hyper_log_log_custom_float.hpp"
+#include "weighted_min_hash.hpp"
+
+namespace {
+
+using Params = std::map<std::string, double>;
+
+// make is left to find_sketch_kind().
+template <typename T>
+SketchKind kind(std::vector<std::string> params = {}) {
+    SketchKind k;
+    k.params = std::move(params);
+    if constexpr (std::is_base_of_v<MergeableMixin, T>) {
+        k.merge = [](Sketch& into, const Sketch& from) {
+            static_cast<T&>(into).merge(static_cast<const T&>(from));
+        };
+    }
+    k.registers = [](const Sketch& s) {
+        std::vector<double> out;
+        for (const auto& r : static_cast<const T&>(s).get_registers()) { out.push_back(static_cast<double>(r)); }
+        return out;
+    };
+    return k;
+}
+
+// The O(m)-per-add sketches, which tune() leaves out.
+template <typename T>
+SketchKind untuned_kind() {
+    SketchKind k = kind<T>();
+    k.make = [](std::size_t m, std::uint64_t seed, const Params&) { return std::make_unique<T>(m, seed); };
+    return k;
+}
+
+}  // namespace
+
+const SketchKind* find_sketch_kind(const std::string& name) {
+    static const std::unordered_map<std::string, SketchKind> table = [] {
+        std::unordered_map<std::string, SketchKind> kinds = {
+            {"ExpSketch", untuned_kind<ExpSketch>()},
+            {"ExpSketchFloat32", untuned_kind<ExpSketchFloat32>()},
+            {"WeightedMinHash", untuned_kind<WeightedMinHash>()},
+            {"FastExpSketch", kind<FastExpSketch>()},
+            {"FastExpSketchFloat32", kind<FastExpSketchT<float>>()},
+            {"FastExpSketchFloat16", kind<FastExpSketchFloat16>()},
+            {"FastExpSketchBFloat16", kind<FastExpSketchBFloat16>()},
+            {"FastGMExpSketch", kind<FastGMExpSketch>()},
+            {"FastExpSketchCustomFloat", kind<FastExpSketchCustomFloat>({"exp_bits", "mant_bits"})},
+            {"QSketch", kind<QSketch>({"amount_bits"})},
+            {"QSketchDyn", kind<QSketchDyn>({"amount_bits"})},
+            {"kQSketch", kind<kQSketch>({"amount_bits", "logarithm_base"})},
+            {"kQSketchRounding", kind<kQSketchRounding>({"amount_bits", "logarithm_base"})},
+            {"kQSketchShifted", kind<kQSketchShifted>({"amount_bits", "logarithm_base"})},
+            {"kQSketchRoundedDyn", kind<kQSketchRoundedDyn>({"amount_bits", "logarithm_base"})},
+            {"LogExpSketchFastNoShifted", kind<LogExpSketchFastNoShifted>({"amount_bits", "v_max"})},
+            {"LogExpSketchFastShifted", kind<LogExpSketchFastShifted>({"amount_bits", "v_max"})},
+            {"WeightedHyperLogLog", kind<WeightedHyperLogLog>()},
+            {"WeightedHyperLogLogFloat32", kind<WeightedHyperLogLogFloat32>()},
+            {"WeightedHyperLogLogCustomFloat", kind<WeightedHyperLogLogCustomFloat>({"exp_bits", "mant_bits"})},
+        };
+        for (auto& [kind_name, k] : kinds) {
+            decltype(k.make) build = std::move(k.make);
+            if (!build) {
+                // The rest are what tune() calibrates, built by make_tuned_sketch().
+                build = [kind_name = kind_name](std::size_t m, std::uint64_t seed, const Params& params) {
+                    return make_tuned_sketch(kind_name, m, seed, params);
+                };
+            }
+            k.make = [kind_name = kind_name, known = k.params, build = std::move(build)](
+                         std::size_t m, std::uint64_t seed, const Params& params) {
+                for (const auto& [param, value] : params) {
+                    if (std::find(known.begin(), known.end(), param) == known.end()) {
+                        throw std::invalid_argument("Unknown parameter '" + param + "' for " + kind_name + ".");
+                    }
+                }
+                return build(m, seed, params);
+            };
+        }
+        return kinds;
+    }();
+    const auto it = table.find(name);
+    return it == table.end() ? nullptr : &it->second;
+}
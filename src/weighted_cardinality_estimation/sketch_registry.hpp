@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "sketch.hpp"
+
+// Every sketch class by its Python class name, for code that picks the class
+// at run time: run_trials() and the wce-ingest and wce-aggregated tools.
+// Parameters use the Python keyword names, as for make_tuned_sketch(); the
+// O(m)-per-add classes tune() leaves out (ExpSketch, ExpSketchFloat32,
+// WeightedMinHash) take none.
+struct SketchKind {
+    // Throws std::invalid_argument for a missing parameter or one not in params.
+    std::function<std::unique_ptr<Sketch>(std::size_t, std::uint64_t, const std::map<std::string, double>&)> make;
+    // Merges the second sketch into the first, both of this class. Empty for
+    // non-mergeable sketches.
+    std::function<void(Sketch&, const Sketch&)> merge;
+    // get_registers(), widened to double, which is exact for every register type.
+    std::function<std::vector<double>(const Sketch&)> registers;
+    std::vector<std::string> params;  // the parameter names make() takes
+};
+
+// nullptr for an unknown name.
+const SketchKind* find_sketch_kind(const std::string& name);
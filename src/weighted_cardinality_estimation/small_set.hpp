@@ -0,0 +1,110 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Exact front end for min-register sketches that usually see few distinct
+// elements (for example one sketch per key of a long-tailed key population).
+//
+// While a sketch is in small mode it keeps every distinct element with its
+// max weight here instead of allocating registers and Fisher-Yates scratch:
+// its estimate is the exact weight sum, and an add costs one scan over at
+// most capacity() cached hashes instead of the early-exit register loop. On
+// overflow the sketch allocates its registers and replays the set, one add()
+// per element with its max weight. For sketches whose state depends only on
+// each element's max weight (pre_aggregation_exact()), the registers then
+// equal those of a sketch that never buffered.
+//
+// The element strings are kept because replay needs them: every register step
+// hashes the element with its own seed.
+class SmallSet {
+public:
+    static constexpr std::size_t kMaxCapacity = 1024;
+
+    explicit SmallSet(std::size_t capacity = 0) : capacity_(capacity), active_(capacity != 0) {
+        if (capacity > kMaxCapacity) {
+            throw std::invalid_argument("small_capacity must be at most " + std::to_string(kMaxCapacity) + ".");
+        }
+    }
+
+    // True until the owning sketch promotes to registers.
+    [[nodiscard]] bool active() const { return active_; }
+    [[nodiscard]] std::size_t capacity() const { return capacity_; }
+    [[nodiscard]] std::size_t size() const { return hashes_.size(); }
+
+    // Folds (elem, weight) in, keeping the max weight. Returns false, leaving
+    // the set untouched, if elem is new and the set already holds capacity()
+    // elements.
+    bool insert(const std::string& elem, double weight) {
+        const std::size_t hash = std::hash<std::string>{}(elem);
+        for (std::size_t i = 0; i < hashes_.size(); ++i) {
+            if (hashes_[i] == hash && elems_[i] == elem) {
+                if (weight > weights_[i]) { weights_[i] = weight; }
+                return true;
+            }
+        }
+        if (hashes_.size() == capacity_) { return false; }
+        if (hashes_.empty()) { reserve(); }
+        hashes_.push_back(hash);
+        weights_.push_back(weight);
+        elems_.push_back(elem);
+        return true;
+    }
+
+    // Exact weighted cardinality: the sum of max weights.
+    [[nodiscard]] double total_weight() const {
+        double total = 0.0;
+        for (double w : weights_) { total += w; }
+        return total;
+    }
+
+    // Calls fn(elem, max_weight) for every element in first-seen order.
+    template <typename F>
+    void for_each(F&& fn) const {
+        for (std::size_t i = 0; i < hashes_.size(); ++i) { fn(elems_[i], weights_[i]); }
+    }
+
+    // Ends small mode and returns the buffered elements for replay.
+    [[nodiscard]] SmallSet release() {
+        SmallSet buffered(std::move(*this));
+        *this = SmallSet();
+        capacity_ = buffered.capacity_;
+        return buffered;
+    }
+
+    [[nodiscard]] std::size_t bytes() const {
+        std::size_t s = hashes_.capacity() * sizeof(std::size_t) + weights_.capacity() * sizeof(double)
+                      + elems_.capacity() * sizeof(std::string);
+        for (const std::string& e : elems_) {
+            if (e.capacity() > std::string().capacity()) { s += e.capacity() + 1; }
+        }
+        return s;
+    }
+
+private:
+    // A handful of slots first: most small-mode sketches stay tiny.
+    void reserve() {
+        const std::size_t n = capacity_ < 8 ? capacity_ : 8;
+        hashes_.reserve(n);
+        weights_.reserve(n);
+        elems_.reserve(n);
+    }
+
+    std::size_t capacity_;
+    bool active_;
+    std::vector<std::size_t> hashes_;
+    std::vector<double> weights_;
+    std::vector<std::string> elems_;
+};
+
+// has_small_mode<S>: S can buffer a SmallSet (small_mode(), densified()).
+template <typename S, typename = void>
+struct has_small_mode : std::false_type {};
+
+template <typename S>
+struct has_small_mode<S, std::void_t<decltype(std::declval<const S&>().small_mode())>> : std::true_type {};
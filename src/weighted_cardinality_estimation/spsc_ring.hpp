@@ -0,0 +1,69 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+// Bounded single-producer single-consumer ring of T, lock free.
+//
+// Slots are default-constructed once and then written in place: the producer
+// claims the tail slot, fills it and publishes it, the consumer reads the head
+// slot and pops it. A slot's heap buffers (say a std::vector member) therefore
+// survive reuse, so a steady stream allocates nothing.
+//
+// head_ and tail_ count pops and pushes since construction; each side caches
+// the other's counter and only reloads it when the ring looks full (empty), so
+// the shared cache lines move once per wrap instead of once per record.
+template <typename T>
+class SpscRing {
+public:
+    // capacity is rounded up to a power of two.
+    explicit SpscRing(std::size_t capacity) {
+        if (capacity == 0) { throw std::invalid_argument("SpscRing capacity must be positive."); }
+        std::size_t n = 1;
+        while (n < capacity) { n <<= 1; }
+        slots_.resize(n);
+        mask_ = n - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    [[nodiscard]] std::size_t capacity() const { return slots_.size(); }
+
+    // Producer: the slot to fill next, or nullptr while the ring is full.
+    T* try_claim() {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ == slots_.size()) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ == slots_.size()) { return nullptr; }
+        }
+        return &slots_[tail & mask_];
+    }
+
+    // Producer: hands the claimed slot to the consumer.
+    void publish() { tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    // Consumer: the oldest published slot, or nullptr while the ring is empty.
+    const T* try_front() {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_) { return nullptr; }
+        }
+        return &slots_[head & mask_];
+    }
+
+    // Consumer: returns the front slot to the producer.
+    void pop() { head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+private:
+    static constexpr std::size_t kCacheLine = 64;
+
+    std::vector<T> slots_;
+    std::size_t mask_ = 0;
+    alignas(kCacheLine) std::atomic<std::size_t> head_{0};
+    std::size_t tail_cache_ = 0;  // consumer's view of tail_
+    alignas(kCacheLine) std::atomic<std::size_t> tail_{0};
+    std::size_t head_cache_ = 0;  // producer's view of head_
+};
@@ -141,6 +141,32 @@ def weighted_stream(
     return elements, weights
 
 
+def skewed_stream(
+    n: int,
+    distinct: int,
+    exponent: float = 1.2,
+    dist: WeightDist = Uniform(),
+    seed: int | None = None,
+) -> tuple[list[str], list[float]]:
+    """Generate n arrivals over `distinct` keys with Zipf(exponent) key popularity.
+
+    Unlike weighted_stream, keys repeat: key i is drawn with probability
+    proportional to 1 / i**exponent, so a few hot keys dominate. Each arrival
+    gets its own weight drawn from dist (not normalised).
+
+    Returns:
+        (elements, weights), one entry per arrival.
+
+    """
+    dist = _resolve_dist(dist)
+    rng = np.random.default_rng(seed)
+    keys = elements_stream(distinct, seed)
+    popularity = 1.0 / np.arange(1, distinct + 1) ** exponent
+    idx = rng.choice(distinct, size=n, p=popularity / popularity.sum())
+    weights = _raw_weights(dist, n, rng).tolist()
+    return [keys[i] for i in idx], weights
+
+
 def jaccard_streams(
     n: int,
     total_weight: float,
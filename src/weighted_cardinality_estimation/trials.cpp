@@ -0,0 +1,117 @@
+#include "trials.hpp"
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include "jaccard_batch.hpp"
+#include "parallel_for.hpp"
+#include "sketch_registry.hpp"
+
+namespace {
+
+using Params = std::map<std::string, double>;
+
+// A validated stream, collapsed to distinct elements with their largest weight
+// when the sketch allows it. Views the caller's vectors otherwise.
+class TrialStream {
+public:
+    TrialStream(const std::vector<std::string>& elems, const std::vector<double>& weights, bool collapse) {
+        if (elems.size() != weights.size()) {
+            throw std::invalid_argument("run_trials: elems and weights size mismatch");
+        }
+        for (double w : weights) { Sketch::validate_weight(w); }
+        if (!collapse) {
+            elems_ = &elems;
+            weights_ = &weights;
+            return;
+        }
+        std::unordered_map<std::string, std::size_t> index;
+        index.reserve(elems.size());
+        for (std::size_t i = 0; i < elems.size(); ++i) {
+            const auto [it, inserted] = index.emplace(elems[i], distinct_elems_.size());
+            if (inserted) {
+                distinct_elems_.push_back(elems[i]);
+                distinct_weights_.push_back(weights[i]);
+            } else if (weights[i] > distinct_weights_[it->second]) {
+                distinct_weights_[it->second] = weights[i];
+            }
+        }
+        elems_ = &distinct_elems_;
+        weights_ = &distinct_weights_;
+    }
+
+    TrialStream(const TrialStream&) = delete;
+    TrialStream& operator=(const TrialStream&) = delete;
+
+    void feed(Sketch& sketch) const { sketch.add_many(*elems_, *weights_); }
+
+private:
+    const std::vector<std::string>* elems_ = nullptr;
+    const std::vector<double>* weights_ = nullptr;
+    std::vector<std::string> distinct_elems_;
+    std::vector<double> distinct_weights_;
+};
+
+double estimate_or_nan(const Sketch& sketch) {
+    try {
+        return sketch.estimate();
+    } catch (const std::runtime_error&) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+}
+
+}  // namespace
+
+TrialResults run_trials(const std::string& sketch, std::size_t m, const Params& params,
+                        const std::vector<std::string>& elems, const std::vector<double>& weights,
+                        const std::vector<std::string>* elems_b, const std::vector<double>* weights_b,
+                        const TrialOptions& options) {
+    const SketchKind* k = find_sketch_kind(sketch);
+    if (k == nullptr) { throw std::invalid_argument("Unknown sketch '" + sketch + "'."); }
+    auto make = [&](std::uint64_t seed) { return k->make(m, seed, params); };
+
+    // Built up front so bad parameters throw here, not on a worker thread.
+    const std::unique_ptr<Sketch> probe = make(options.seed);
+    const bool two_streams = elems_b != nullptr;
+    if (two_streams != (weights_b != nullptr)) {
+        throw std::invalid_argument("run_trials: pass both elems_b and weights_b, or neither");
+    }
+    if ((options.jaccard || options.merge) && !two_streams) {
+        throw std::invalid_argument("run_trials: jaccard and merge need a second stream");
+    }
+    if (options.jaccard && dynamic_cast<const JaccardMixin*>(probe.get()) == nullptr) {
+        throw std::invalid_argument(sketch + " does not support Jaccard estimation.");
+    }
+    if (options.merge && !k->merge) { throw std::invalid_argument(sketch + " is not mergeable."); }
+
+    const bool collapse = probe->pre_aggregation_exact();
+    const TrialStream a(elems, weights, collapse);
+    const std::unique_ptr<TrialStream> b =
+        two_streams ? std::make_unique<TrialStream>(*elems_b, *weights_b, collapse) : nullptr;
+
+    const std::size_t n = options.n_trials;
+    TrialResults out;
+    out.estimates.resize(n);
+    if (two_streams) { out.estimates_b.resize(n); }
+    if (options.jaccard) { out.jaccard.resize(n); }
+    if (options.merge) { out.union_estimates.resize(n); }
+
+    parallel_for(n, options.threads, [&](std::size_t t) {
+        const std::unique_ptr<Sketch> sa = make(options.seed + t);
+        a.feed(*sa);
+        out.estimates[t] = estimate_or_nan(*sa);
+        if (!two_streams) { return; }
+        const std::unique_ptr<Sketch> sb = make(options.seed + t);
+        b->feed(*sb);
+        out.estimates_b[t] = estimate_or_nan(*sb);
+        if (options.jaccard) {
+            out.jaccard[t] = jaccard_from_codes(dynamic_cast<const JaccardMixin&>(*sa).jaccard_codes(),
+                                                dynamic_cast<const JaccardMixin&>(*sb).jaccard_codes());
+        }
+        if (options.merge) {
+            k->merge(*sa, *sb);
+            out.union_estimates[t] = estimate_or_nan(*sa);
+        }
+    });
+    return out;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Accuracy experiments run natively.
+//
+// run_trials() feeds one stream into n_trials sketches of one configuration
+// with master seeds seed, seed + 1, ..., spread over threads, and collects the
+// estimates. The stream is converted once and shared read-only by every trial;
+// for sketches whose state depends only on each element's largest weight
+// (pre_aggregation_exact()) it is also collapsed once to its distinct
+// elements, so repeats cost nothing per trial. Trial t's results equal
+// building that sketch with seed + t and calling add_many() on the full stream.
+//
+// With a second stream B, each trial also sketches B with the same seed and
+// can report jaccard_from_codes(A, B) and A.merge(B).estimate().
+//
+// Sketches are named by their Python class and take the Python keyword
+// arguments as params, as in make_tuned_sketch(). An estimate that throws
+// std::runtime_error (Newton non-convergence) is recorded as NaN.
+
+struct TrialOptions {
+    std::size_t n_trials = 100;
+    std::size_t threads = 0;    // 0 = every hardware thread
+    std::uint64_t seed = 1;     // trial t uses seed + t
+    bool jaccard = false;       // needs stream B and a JaccardMixin sketch
+    bool merge = false;         // needs stream B and a mergeable sketch
+};
+
+// One entry per trial; the B-side vectors stay empty unless requested.
+struct TrialResults {
+    std::vector<double> estimates;
+    std::vector<double> estimates_b;
+    std::vector<double> jaccard;
+    std::vector<double> union_estimates;
+};
+
+// elems_b / weights_b may be null for a single-stream run. Throws
+// std::invalid_argument for unknown sketches, bad parameters or weights,
+// mismatched streams, or jaccard / merge requests the sketch cannot serve.
+TrialResults run_trials(const std::string& sketch, std::size_t m, const std::map<std::string, double>& params,
+                        const std::vector<std::string>& elems, const std::vector<double>& weights,
+                        const std::vector<std::string>* elems_b, const std::vector<double>* weights_b,
+                        const TrialOptions& options);
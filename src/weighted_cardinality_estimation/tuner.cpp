@@ -0,0 +1,293 @@
+#include "tuner.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include "fast_exp_sketch.hpp"
+#include "fast_exp_sketch_custom_float.hpp"
+#include "fast_exp_sketch_float16.hpp"
+#include "fast_k_q_sketch.hpp"
+#include "fast_k_q_sketch_rounding.hpp"
+#include "fastgm_exp_sketch.hpp"
+#include "k_q_sketch_rounded_dyn.hpp"
+#include "k_q_sketch_shifted.hpp"
+#include "log_exp_sketch_fast_no_shifted.hpp"
+#include "log_exp_sketch_fast_shifted.hpp"
+#include "memory_flag.hpp"
+#include "q_sketch.hpp"
+#include "q_sketch_dyn.hpp"
+#include "weighted_hyper_log_log.hpp"
+#include "weighted_hyper_log_log_custom_float.hpp"
+
+namespace {
+
+using Params = std::map<std::string, double>;
+using Factory = std::function<std::unique_ptr<Sketch>(std::size_t, std::uint64_t, const Params&)>;
+
+constexpr std::size_t kMinTunerM = 16;
+
+double param(const Params& params, const char* name) {
+    auto it = params.find(name);
+    if (it == params.end()) {
+        throw std::invalid_argument(std::string("Missing tuned parameter '") + name + "'.");
+    }
+    return it->second;
+}
+
+std::uint8_t bits(const Params& p) { return static_cast<std::uint8_t>(param(p, "amount_bits")); }
+float base(const Params& p) { return static_cast<float>(param(p, "logarithm_base")); }
+int exp_bits(const Params& p) { return static_cast<int>(param(p, "exp_bits")); }
+int mant_bits(const Params& p) { return static_cast<int>(param(p, "mant_bits")); }
+
+template <typename T>
+Factory plain() {
+    return [](std::size_t m, std::uint64_t seed, const Params&) { return std::make_unique<T>(m, seed); };
+}
+
+template <typename T>
+Factory with_bits() {
+    return [](std::size_t m, std::uint64_t seed, const Params& p) { return std::make_unique<T>(m, seed, bits(p)); };
+}
+
+template <typename T>
+Factory with_bits_base() {
+    return [](std::size_t m, std::uint64_t seed, const Params& p) {
+        return std::make_unique<T>(m, seed, bits(p), base(p));
+    };
+}
+
+// The Dyn sketches draw their bucket and rank from g_seed alone (MULTIPLY_HIGH_128),
+// so it follows the sketch seed; seed 42 gives the constructor default.
+template <typename T>
+Factory with_bits_dyn() {
+    return [](std::size_t m, std::uint64_t seed, const Params& p) {
+        return std::make_unique<T>(m, seed, bits(p), static_cast<std::uint32_t>(seed));
+    };
+}
+
+template <typename T>
+Factory with_bits_base_dyn() {
+    return [](std::size_t m, std::uint64_t seed, const Params& p) {
+        return std::make_unique<T>(m, seed, bits(p), base(p), static_cast<std::uint32_t>(seed));
+    };
+}
+
+template <typename T>
+Factory with_bits_v_max() {
+    return [](std::size_t m, std::uint64_t seed, const Params& p) {
+        return std::make_unique<T>(m, seed, bits(p), param(p, "v_max"));
+    };
+}
+
+template <typename T>
+Factory with_float_format() {
+    return [](std::size_t m, std::uint64_t seed, const Params& p) {
+        return std::make_unique<T>(m, seed, exp_bits(p), mant_bits(p));
+    };
+}
+
+// Keyed by the Python class name; params use the Python keyword names.
+const std::unordered_map<std::string, Factory>& factories() {
+    static const std::unordered_map<std::string, Factory> table = {
+        {"FastExpSketch", plain<FastExpSketchT<double>>()},
+        {"FastExpSketchFloat32", plain<FastExpSketchT<float>>()},
+        {"FastExpSketchFloat16", plain<FastExpSketchFloat16>()},
+        {"FastExpSketchBFloat16", plain<FastExpSketchBFloat16>()},
+        {"FastGMExpSketch", plain<FastGMExpSketch>()},
+        {"FastExpSketchCustomFloat", with_float_format<FastExpSketchCustomFloat>()},
+        {"QSketch", with_bits<QSketch>()},
+        {"QSketchDyn", with_bits_dyn<QSketchDyn>()},
+        {"kQSketch", with_bits_base<kQSketch>()},
+        {"kQSketchRounding", with_bits_base<kQSketchRounding>()},
+        {"kQSketchShifted", with_bits_base<kQSketchShifted>()},
+        {"kQSketchRoundedDyn", with_bits_base_dyn<kQSketchRoundedDyn>()},
+        {"LogExpSketchFastNoShifted", with_bits_v_max<LogExpSketchFastNoShifted>()},
+        {"LogExpSketchFastShifted", with_bits_v_max<LogExpSketchFastShifted>()},
+        {"WeightedHyperLogLog", plain<WeightedHyperLogLog>()},
+        {"WeightedHyperLogLogFloat32", plain<WeightedHyperLogLogFloat32>()},
+        {"WeightedHyperLogLogCustomFloat", with_float_format<WeightedHyperLogLogCustomFloat>()},
+    };
+    return table;
+}
+
+struct Candidate {
+    std::string sketch;
+    Params params;
+};
+
+// Parameter grids follow the configurations the benchmarks and tests exercise.
+std::vector<Candidate> candidates() {
+    std::vector<Candidate> out;
+    for (const char* name : {"FastExpSketch", "FastExpSketchFloat32", "FastExpSketchFloat16",
+                             "FastExpSketchBFloat16", "FastGMExpSketch", "WeightedHyperLogLog",
+                             "WeightedHyperLogLogFloat32"}) {
+        out.push_back({name, {}});
+    }
+    for (const char* name : {"FastExpSketchCustomFloat", "WeightedHyperLogLogCustomFloat"}) {
+        for (auto [e, mb] : {std::pair{8, 7}, std::pair{5, 10}, std::pair{4, 3}}) {
+            out.push_back({name, {{"exp_bits", e}, {"mant_bits", mb}}});
+        }
+    }
+    for (const char* name : {"QSketch", "QSketchDyn"}) {
+        for (int b : {8, 6}) out.push_back({name, {{"amount_bits", b}}});
+    }
+    for (const char* name : {"kQSketch", "kQSketchRounding", "kQSketchShifted", "kQSketchRoundedDyn"}) {
+        for (int b : {8, 4}) {
+            for (double r : {2.0, 1.5}) out.push_back({name, {{"amount_bits", b}, {"logarithm_base", r}}});
+        }
+    }
+    for (const char* name : {"LogExpSketchFastNoShifted", "LogExpSketchFastShifted"}) {
+        for (int b : {10, 8}) out.push_back({name, {{"amount_bits", b}, {"v_max", 1e5}}});
+    }
+    return out;
+}
+
+struct Measurement {
+    double rel_error = std::numeric_limits<double>::infinity();
+    double ns_per_add = std::numeric_limits<double>::infinity();
+    std::size_t memory_bytes = 0;
+};
+
+Measurement measure(const Factory& factory, std::size_t m, const Params& params,
+                    const std::vector<std::string>& elems, const std::vector<double>& weights,
+                    double truth, std::size_t trials, std::uint64_t seed) {
+    using Clock = std::chrono::steady_clock;
+    Measurement r;
+    double sq = 0.0;
+    for (std::size_t t = 0; t < trials; ++t) {
+        auto sketch = factory(m, seed + t, params);
+        if (t == 0) r.memory_bytes = sketch->memory_usage(MemoryFlag::TOTAL);
+        const auto t0 = Clock::now();
+        sketch->add_many(elems, weights);
+        const auto t1 = Clock::now();
+        const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+        r.ns_per_add = std::min(r.ns_per_add, ns / static_cast<double>(elems.size()));
+        double est = std::numeric_limits<double>::quiet_NaN();
+        try {
+            est = sketch->estimate();
+        } catch (const std::runtime_error&) {
+            // Newton non-convergence: the configuration does not fit this stream.
+        }
+        const double rel = (est - truth) / truth;
+        sq += std::isfinite(rel) ? rel * rel : std::numeric_limits<double>::infinity();
+    }
+    r.rel_error = std::sqrt(sq / static_cast<double>(trials));
+    return r;
+}
+
+double exact_weighted_cardinality(const std::vector<std::string>& elems, const std::vector<double>& weights) {
+    std::unordered_map<std::string, double> max_weight;
+    max_weight.reserve(elems.size());
+    for (std::size_t i = 0; i < elems.size(); ++i) {
+        auto [it, inserted] = max_weight.emplace(elems[i], weights[i]);
+        if (!inserted) it->second = std::max(it->second, weights[i]);
+    }
+    double total = 0.0;
+    for (const auto& [elem, w] : max_weight) total += w;
+    return total;
+}
+
+void append_json_number(std::string& out, double v) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.17g", v);
+    out += std::isfinite(v) ? buf : "null";
+}
+
+} // namespace
+
+std::string TunedConfig::to_json() const {
+    std::string out = "{\"sketch\": \"" + sketch + "\", \"m\": " + std::to_string(m) + ", \"params\": {";
+    bool first = true;
+    for (const auto& [k, v] : params) {
+        if (!first) out += ", ";
+        first = false;
+        out += "\"" + k + "\": ";
+        append_json_number(out, v);
+    }
+    out += "}, \"rel_error\": ";
+    append_json_number(out, rel_error);
+    out += ", \"ns_per_add\": ";
+    append_json_number(out, ns_per_add);
+    out += ", \"memory_bytes\": " + std::to_string(memory_bytes);
+    out += ", \"meets_budget\": ";
+    out += meets_budget ? "true" : "false";
+    out += "}";
+    return out;
+}
+
+std::unique_ptr<Sketch> make_tuned_sketch(const std::string& sketch, std::size_t m, std::uint64_t seed,
+                                          const std::map<std::string, double>& params) {
+    const auto& table = factories();
+    auto it = table.find(sketch);
+    if (it == table.end()) throw std::invalid_argument("Unknown tuned sketch '" + sketch + "'.");
+    return it->second(m, seed, params);
+}
+
+std::vector<TunedConfig> tune(const std::vector<std::string>& elems, const std::vector<double>& weights,
+                              const TunerBudget& budget, std::size_t trials, std::uint64_t seed) {
+    if (elems.empty()) throw std::invalid_argument("tune: sample must not be empty");
+    if (elems.size() != weights.size()) throw std::invalid_argument("tune: elems and weights size mismatch");
+    if (trials == 0) throw std::invalid_argument("tune: trials must be positive");
+    if (!(budget.max_rel_error > 0.0)) throw std::invalid_argument("tune: max_rel_error must be positive");
+    for (double w : weights) {
+        if (!(w > 0.0) || !std::isfinite(w)) throw std::invalid_argument("tune: weights must be positive and finite");
+    }
+    const double truth = exact_weighted_cardinality(elems, weights);
+
+    auto fits_memory = [&](std::size_t bytes) {
+        return budget.max_memory_bytes == 0 || bytes <= budget.max_memory_bytes;
+    };
+    auto fits_throughput = [&](double ns_per_add) {
+        return budget.min_adds_per_sec <= 0.0 || 1e9 / ns_per_add >= budget.min_adds_per_sec;
+    };
+
+    std::vector<TunedConfig> out;
+    for (const auto& c : candidates()) {
+        const Factory& factory = factories().at(c.sketch);
+        TunedConfig best{c.sketch, kMinTunerM, c.params};
+        Measurement best_m;
+        int stalls = 0;
+        for (std::size_t m = kMinTunerM; m <= kMaxTunerM; m *= 2) {
+            if (m > kMinTunerM && !fits_memory(factory(m, seed, c.params)->memory_usage(MemoryFlag::TOTAL))) break;
+            Measurement r = measure(factory, m, c.params, elems, weights, truth, trials, seed);
+            if (r.rel_error <= budget.max_rel_error) {
+                // A handful of trials can pass by luck at small m: confirm on as
+                // many fresh seeds and judge the pooled error.
+                const Measurement again = measure(factory, m, c.params, elems, weights, truth, trials, seed + trials);
+                r.rel_error = std::sqrt((r.rel_error * r.rel_error + again.rel_error * again.rel_error) / 2);
+                r.ns_per_add = std::min(r.ns_per_add, again.ns_per_add);
+            }
+            // Quantized registers stop improving past some m; two doublings
+            // without a 10% gain end the walk.
+            stalls = r.rel_error < 0.9 * best_m.rel_error ? 0 : stalls + 1;
+            if (m == kMinTunerM || r.rel_error < best_m.rel_error) {
+                best.m = m;
+                best_m = r;
+            }
+            if (r.rel_error <= budget.max_rel_error) {
+                best.m = m;
+                best_m = r;
+                break;
+            }
+            // Larger m never makes add() faster.
+            if (stalls >= 2 || !fits_throughput(r.ns_per_add)) break;
+        }
+        best.rel_error = best_m.rel_error;
+        best.ns_per_add = best_m.ns_per_add;
+        best.memory_bytes = best_m.memory_bytes;
+        best.meets_budget = best.rel_error <= budget.max_rel_error && fits_memory(best.memory_bytes)
+                            && fits_throughput(best.ns_per_add);
+        out.push_back(std::move(best));
+    }
+
+    std::stable_sort(out.begin(), out.end(), [](const TunedConfig& a, const TunedConfig& b) {
+        if (a.meets_budget != b.meets_budget) return a.meets_budget;
+        if (a.meets_budget) return a.ns_per_add < b.ns_per_add;
+        return a.rel_error < b.rel_error;
+    });
+    return out;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "sketch.hpp"
+
+// Profile-guided sketch selection.
+//
+// tune() calibrates candidate configurations on a sample of the real stream:
+// for every weighted sketch family and parameter set (bit width, log base,
+// float format) it walks m = 16, 32, ... until the relative RMS error over
+// `trials` differently seeded runs meets the bound (confirmed on as many fresh
+// seeds), the sketch outgrows the memory or throughput budget, the error stops
+// improving, or m reaches kMaxTunerM. add() time is the best of the trials.
+//
+// Error is measured against the exact weighted cardinality of the sample
+// (sum over distinct keys of their largest weight), so configurations that
+// cannot represent the sample's weight range fail on accuracy like any other.
+// O(m)-per-add sketches (ExpSketch, WeightedMinHash, LogExpSketchSlow*) are
+// not candidates.
+
+inline constexpr std::size_t kMaxTunerM = 65536;
+
+struct TunerBudget {
+    double max_rel_error = 0.05;         // relative RMS error bound
+    std::size_t max_memory_bytes = 0;    // memory_usage(TOTAL) bound, 0 = unbounded
+    double min_adds_per_sec = 0.0;       // throughput floor, 0 = none
+};
+
+// One calibrated configuration. Serializes to a flat JSON object; feed its
+// (sketch, m, params) to make_tuned_sketch() to build the sketch.
+struct TunedConfig {
+    std::string sketch;                     // Python class name, e.g. "kQSketch"
+    std::size_t m = 0;
+    std::map<std::string, double> params;   // constructor arguments beyond (m, seed)
+    double rel_error = 0.0;                 // measured relative RMS error
+    double ns_per_add = 0.0;                // measured, best of trials
+    std::size_t memory_bytes = 0;           // memory_usage(TOTAL)
+    bool meets_budget = false;
+
+    [[nodiscard]] std::string to_json() const;
+};
+
+// Builds a sketch from a tuned (sketch, m, params) triple.
+// Throws std::invalid_argument for unknown sketch names.
+std::unique_ptr<Sketch> make_tuned_sketch(const std::string& sketch, std::size_t m, std::uint64_t seed,
+                                          const std::map<std::string, double>& params);
+
+// Calibrates every candidate on (elems, weights). Returns one entry per family
+// and parameter set: those meeting the budget first, fastest first, then the
+// rest by error. Throws std::invalid_argument on an empty or mismatched sample.
+std::vector<TunedConfig> tune(const std::vector<std::string>& elems, const std::vector<double>& weights,
+                              const TunerBudget& budget, std::size_t trials = 5, std::uint64_t seed = 42);
@@ -50,15 +50,3 @@ std::uint32_t argmin(std::vector<int> vec){
     }
     return argmin;
 }
-
-std::uint32_t argmin(compact::vector<int> vec){
-    int min = vec[0];
-    uint32_t argmin = 0;
-    for(uint32_t j = 1; j < vec.size(); j++){
-        if (vec[j] < min){
-            argmin = j;
-            min = vec[j];
-        }
-    }
-    return argmin;
-}
\ No newline at end of file
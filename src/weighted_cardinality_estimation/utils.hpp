@@ -1,5 +1,7 @@
 #pragma once
 #include <compact_vector.hpp>
+#include <algorithm>
+#include <numeric>
 #include <vector>
 #include <cstdint>
 
@@ -7,5 +9,33 @@ void print_vector(std::vector<int> vec);
 void print_vector(std::vector<std::uint32_t> vec);
 std::vector<uint32_t> range(uint32_t min, uint32_t max);
 std::uint32_t argmax(std::vector<double> vec);
-std::uint32_t argmin(compact::vector<int> vec);
 std::uint32_t argmin(std::vector<int> vec);
+
+// Any allocator, so QSketch registers in a SketchPool arena work too.
+template <typename W, typename Allocator>
+std::uint32_t argmin(const compact::vector<int, 0, W, Allocator>& vec) {
+    int min = vec[0];
+    std::uint32_t argmin = 0;
+    for (std::uint32_t j = 1; j < vec.size(); j++) {
+        if (vec[j] < min) {
+            argmin = j;
+            min = vec[j];
+        }
+    }
+    return argmin;
+}
+
+// Sets every element to value. Element writes into a compact::vector are slow,
+// so only the first period of the bit pattern (lcm(bits, 64) bits) is written
+// element by element and the rest is copied word by word.
+template <typename Allocator>
+void fill(compact::vector<int, 0, std::uint64_t, Allocator>& vec, int value) {
+    const std::size_t bits = vec.bits();
+    const std::size_t period_elements = 64 / std::gcd(bits, std::size_t{64});
+    const std::size_t period_words = bits / std::gcd(bits, std::size_t{64});
+    const std::size_t head = std::min(vec.size(), period_elements);
+    for (std::size_t i = 0; i < head; i++) { vec[i] = value; }
+    std::uint64_t* words = vec.get();
+    const std::size_t total_words = vec.bytes() / sizeof(std::uint64_t);
+    for (std::size_t w = period_words; w < total_words; w++) { words[w] = words[w - period_words]; }
+}
@@ -7,6 +7,7 @@
 #include <string>
 #include <vector>
 #include "sketch.hpp"
+#include "hash_scheme_type.hpp"
 #include "hash_util.hpp"
 
 // Weighted HyperLogLog based on Cohen, Katzir & Yehezkel (IPL 2015).
@@ -14,27 +15,38 @@
 //   H1(x) ~ {1..m} selects bucket, H2(x) ~ U(0,1) → g = -log(u)/w.
 //   M_k = min{g(x_i) | H1(x_i) = k}.
 //   Estimator: (K - 1) / sum(M_k for non-inf k) with Poisson correction.
+// H1/H2 come from HashScheme: by default both halves of one 128-bit hash.
 template <typename T = double>
 class WeightedHyperLogLogT : public Sketch, public MergeableMixin {
 public:
-    WeightedHyperLogLogT(std::size_t sketch_size, std::uint64_t master_seed)
+    WeightedHyperLogLogT(std::size_t sketch_size, std::uint64_t master_seed,
+                        HashScheme hash_scheme = kDefaultHashScheme)
         : Sketch(sketch_size, master_seed),
           M_(sketch_size, std::numeric_limits<T>::infinity()),
           seed1_(seeds_[0]),
-          seed2_(seeds_[1]) {}
+          seed2_(seeds_[1]),
+          hash_scheme_(hash_scheme) {}
 
     WeightedHyperLogLogT(std::size_t sketch_size, std::uint64_t master_seed,
-                        const std::vector<T>& registers)
+                        const std::vector<T>& registers,
+                        HashScheme hash_scheme = kDefaultHashScheme)
         : Sketch(sketch_size, master_seed), M_(registers),
           seed1_(seeds_[0]),
-          seed2_(seeds_[1]) {}
+          seed2_(seeds_[1]),
+          hash_scheme_(hash_scheme) {}
 
     void add(const std::string& elem, double weight = 1.0) override {
         validate_weight(weight);
-        std::uint64_t h1 = murmur64(elem, seed1_);
-        std::size_t k = h1 % size;
-        std::uint64_t h2 = murmur64(elem, seed2_);
-        double u = to_unit_interval(h2);
+        std::size_t k;
+        double u;
+        if (hash_scheme_ == HashScheme::MULTIPLY_HIGH_128) {
+            Hash128 h = murmur128(elem, seed1_);
+            k = fast_range(h.lo, size);
+            u = to_unit_interval(h.hi);
+        } else {
+            k = murmur64(elem, seed1_) % size;
+            u = to_unit_interval(murmur64(elem, seed2_));
+        }
         T g = static_cast<T>(-std::log(u) / weight);
         if (g < M_[k]) M_[k] = g;
     }
@@ -60,16 +72,19 @@ public:
     void merge(const WeightedHyperLogLogT& other) {
         if (other.size != size)
             throw std::invalid_argument("Cannot merge sketches of different sizes.");
+        if (other.hash_scheme_ != hash_scheme_)
+            throw std::invalid_argument("Cannot merge sketches with different hash schemes.");
         for (std::size_t i = 0; i < size; ++i)
             M_[i] = std::min(M_[i], other.M_[i]);
     }
 
     [[nodiscard]] std::vector<T> get_registers() const { return M_; }
+    [[nodiscard]] HashScheme get_hash_scheme() const { return hash_scheme_; }
     [[nodiscard]] size_t memory_usage(uint64_t flags) const override {
         uint64_t f = resolve_flags(flags);
         size_t s = 0;
         if (f & MemoryFlag::REGISTERS) s += M_.capacity() * sizeof(T);
-        if (f & MemoryFlag::ALL_WRITE_NO_REGISTERS) s += sizeof(size);
+        if (f & MemoryFlag::ALL_WRITE_NO_REGISTERS) s += sizeof(size) + sizeof(hash_scheme_);
         if (f & MemoryFlag::SEEDS) s += seeds_.bytes();
         return s;
     }
@@ -78,6 +93,7 @@ private:
     std::vector<T> M_;
     std::uint32_t seed1_;
     std::uint32_t seed2_;
+    HashScheme hash_scheme_;
 };
 
 using WeightedHyperLogLog = WeightedHyperLogLogT<double>;
@@ -5,50 +5,72 @@
 #include <stdexcept>
 #include <string>
 #include <vector>
+#include "compact_vector.hpp"
+#include "custom_float_format.hpp"
 #include "sketch.hpp"
+#include "hash_scheme_type.hpp"
 #include "hash_util.hpp"
-#include "quantize_custom_float.hpp"
 
 // Weighted HyperLogLog with CustomFloat register quantization.
-// Combines WeightedHyperLogLog's stochastic averaging (2 seeds, h1 % m)
+// Combines WeightedHyperLogLog's stochastic averaging (bucket + uniform per HashScheme)
 // with CustomFloat quantize-on-write register storage (ALL_NORMAL mode, positive-only).
+// Registers hold bit-packed ALL_NORMAL codes; the maximum code doubles as the empty marker.
 class WeightedHyperLogLogCustomFloat : public Sketch, public MergeableMixin {
 public:
     WeightedHyperLogLogCustomFloat(
         std::size_t sketch_size, std::uint64_t master_seed,
-        int exp_bits, int mant_bits
+        int exp_bits, int mant_bits,
+        HashScheme hash_scheme = kDefaultHashScheme
     ) : Sketch(sketch_size, master_seed),
-        exp_bits_(exp_bits), mant_bits_(mant_bits),
-        M_(sketch_size, custom_float_max(exp_bits, mant_bits, kMode)),
-        seed1_(seeds_[0]), seed2_(seeds_[1]) {}
+        format_(exp_bits, mant_bits),
+        M_(format_.width(), sketch_size),
+        seed1_(seeds_[0]), seed2_(seeds_[1]),
+        hash_scheme_(hash_scheme) {
+        for (std::size_t i = 0; i < size; ++i) M_[i] = format_.max_code();
+    }
 
     WeightedHyperLogLogCustomFloat(
         std::size_t sketch_size, std::uint64_t master_seed,
         int exp_bits, int mant_bits,
-        const std::vector<double>& registers
+        const std::vector<double>& registers,
+        HashScheme hash_scheme = kDefaultHashScheme
     ) : Sketch(sketch_size, master_seed),
-        exp_bits_(exp_bits), mant_bits_(mant_bits),
-        M_(registers),
-        seed1_(seeds_[0]), seed2_(seeds_[1]) {}
+        format_(exp_bits, mant_bits),
+        M_(format_.width(), sketch_size),
+        seed1_(seeds_[0]), seed2_(seeds_[1]),
+        hash_scheme_(hash_scheme) {
+        if (registers.size() != sketch_size)
+            throw std::invalid_argument("Register count does not match sketch size.");
+        std::vector<std::uint64_t> codes(sketch_size);
+        format_.encode_batch(registers.data(), codes.data(), sketch_size);
+        std::copy(codes.begin(), codes.end(), M_.begin());
+    }
 
     void add(const std::string& elem, double weight = 1.0) override {
         validate_weight(weight);
-        std::uint64_t h1 = murmur64(elem, seed1_);
-        std::size_t k = h1 % size;
-        std::uint64_t h2 = murmur64(elem, seed2_);
-        double u = to_unit_interval(h2);
+        std::size_t k;
+        double u;
+        if (hash_scheme_ == HashScheme::MULTIPLY_HIGH_128) {
+            Hash128 h = murmur128(elem, seed1_);
+            k = fast_range(h.lo, size);
+            u = to_unit_interval(h.hi);
+        } else {
+            k = murmur64(elem, seed1_) % size;
+            u = to_unit_interval(murmur64(elem, seed2_));
+        }
         double g = -std::log(u) / weight;
-        double quantized = quantize_custom_float(g, 0, exp_bits_, mant_bits_, kMode);
-        if (quantized < M_[k]) M_[k] = quantized;
+        std::uint64_t code = format_.encode(g);
+        if (code < M_[k]) M_[k] = code;
     }
 
     [[nodiscard]] double estimate() const override {
-        double max_val = custom_float_max(exp_bits_, mant_bits_, kMode);
+        const std::uint64_t empty = format_.max_code();
         std::size_t K = 0;
         double sum = 0.0;
         for (std::size_t i = 0; i < size; ++i) {
-            if (M_[i] < max_val) {
-                sum += M_[i];
+            std::uint64_t code = M_[i];
+            if (code < empty) {
+                sum += format_.decode(code);
                 ++K;
             }
         }
@@ -64,31 +86,37 @@ public:
     void merge(const WeightedHyperLogLogCustomFloat& other) {
         if (other.size != size)
             throw std::invalid_argument("Cannot merge sketches of different sizes.");
-        if (other.exp_bits_ != exp_bits_ || other.mant_bits_ != mant_bits_)
+        if (other.format_ != format_)
             throw std::invalid_argument("Cannot merge sketches with different float formats.");
+        if (other.hash_scheme_ != hash_scheme_)
+            throw std::invalid_argument("Cannot merge sketches with different hash schemes.");
         for (std::size_t i = 0; i < size; ++i)
-            M_[i] = std::min(M_[i], other.M_[i]);
+            M_[i] = std::min<std::uint64_t>(M_[i], other.M_[i]);
     }
 
-    [[nodiscard]] const std::vector<double>& get_registers() const { return M_; }
+    [[nodiscard]] std::vector<double> get_registers() const {
+        std::vector<double> regs(size);
+        for (std::size_t i = 0; i < size; ++i) regs[i] = format_.decode(M_[i]);
+        return regs;
+    }
 
-    [[nodiscard]] int get_exp_bits() const { return exp_bits_; }
-    [[nodiscard]] int get_mant_bits() const { return mant_bits_; }
+    [[nodiscard]] int get_exp_bits() const { return format_.exp_bits(); }
+    [[nodiscard]] int get_mant_bits() const { return format_.mant_bits(); }
+    [[nodiscard]] HashScheme get_hash_scheme() const { return hash_scheme_; }
 
     [[nodiscard]] size_t memory_usage(uint64_t flags) const override {
         uint64_t f = resolve_flags(flags);
         size_t s = 0;
-        if (f & MemoryFlag::REGISTERS) s += M_.capacity() * sizeof(double);
-        if (f & MemoryFlag::ALL_WRITE_NO_REGISTERS) s += sizeof(size);
+        if (f & MemoryFlag::REGISTERS) s += M_.bytes();
+        if (f & MemoryFlag::ALL_WRITE_NO_REGISTERS) s += sizeof(size) + sizeof(hash_scheme_);
         if (f & MemoryFlag::SEEDS) s += seeds_.bytes();
         return s;
     }
 
 private:
-    static constexpr QuantizationMode kMode = QuantizationMode::ALL_NORMAL;
-    int exp_bits_;
-    int mant_bits_;
-    std::vector<double> M_;
+    CustomFloatFormat format_;
+    compact::vector<std::uint64_t> M_;
     std::uint32_t seed1_;
     std::uint32_t seed2_;
+    HashScheme hash_scheme_;
 };
@@ -0,0 +1,800 @@
+#include "wire_format.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "fast_exp_sketch_t.hpp"
+#include "fast_k_q_sketch.hpp"
+#include "hyper_log_log.hpp"
+#include "log_exp_sketch_fast_no_shifted.hpp"
+#include "q_sketch.hpp"
+
+namespace {
+
+constexpr char kMagic[4] = {'W', 'C', 'E', 'W'};
+constexpr char kDeltaMagic[4] = {'W', 'C', 'E', 'D'};
+constexpr std::uint8_t kVersion = 1;
+// Largest m on the wire. Decoding allocates m registers before it can tell a
+// forged size from a real one, so the header caps it; a float64 sketch this
+// large is already 128 MB, twice an aggregation frame.
+constexpr std::uint64_t kMaxSketchSize = 1ULL << 24;
+
+enum class WireTag : std::uint8_t {
+    QSketch = 1,
+    kQSketch = 2,
+    LogExpSketchFastNoShifted = 3,
+    FastExpSketch = 4,
+    FastExpSketchFloat32 = 5,
+    HyperLogLog = 6,
+};
+
+// How a run of register offsets is stored.
+enum class Coding : std::uint8_t {
+    Packed = 0,  // fixed width, the bit length of the largest offset
+    Rans = 1,
+};
+
+[[noreturn]] void malformed(const char* what) {
+    throw std::invalid_argument(std::string("Malformed wire data: ") + what + ".");
+}
+
+// Little-endian writer; every multi-byte field goes through here.
+class Writer {
+public:
+    void u8(std::uint8_t v) { out_.push_back(static_cast<char>(v)); }
+    void u32(std::uint32_t v) {
+        for (int i = 0; i < 4; ++i) { u8(static_cast<std::uint8_t>(v >> (8 * i))); }
+    }
+    void u64(std::uint64_t v) {
+        for (int i = 0; i < 8; ++i) { u8(static_cast<std::uint8_t>(v >> (8 * i))); }
+    }
+    void varint(std::uint64_t v) {
+        while (v >= 0x80) {
+            u8(static_cast<std::uint8_t>(v | 0x80));
+            v >>= 7;
+        }
+        u8(static_cast<std::uint8_t>(v));
+    }
+    void f32(float v) {
+        std::uint32_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        u32(bits);
+    }
+    void f64(double v) {
+        std::uint64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        u64(bits);
+    }
+    void bytes(const std::uint8_t* data, std::size_t n) { out_.append(reinterpret_cast<const char*>(data), n); }
+
+    std::string take() { return std::move(out_); }
+
+private:
+    std::string out_;
+};
+
+class Reader {
+public:
+    explicit Reader(std::string_view data) : data_(data) {}
+
+    std::uint8_t u8() {
+        need(1);
+        return static_cast<std::uint8_t>(data_[pos_++]);
+    }
+    std::uint32_t u32() {
+        std::uint32_t v = 0;
+        for (int i = 0; i < 4; ++i) { v |= static_cast<std::uint32_t>(u8()) << (8 * i); }
+        return v;
+    }
+    std::uint64_t u64() {
+        std::uint64_t v = 0;
+        for (int i = 0; i < 8; ++i) { v |= static_cast<std::uint64_t>(u8()) << (8 * i); }
+        return v;
+    }
+    std::uint64_t varint() {
+        std::uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            const std::uint8_t b = u8();
+            v |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) { return v; }
+        }
+        malformed("varint too long");
+    }
+    float f32() {
+        const std::uint32_t bits = u32();
+        float v;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+    double f64() {
+        const std::uint64_t bits = u64();
+        double v;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+    const std::uint8_t* bytes(std::size_t n) {
+        need(n);
+        const auto* p = reinterpret_cast<const std::uint8_t*>(data_.data() + pos_);
+        pos_ += n;
+        return p;
+    }
+    void expect_end() const {
+        if (pos_ != data_.size()) { malformed("trailing bytes"); }
+    }
+
+private:
+    void need(std::size_t n) const {
+        if (data_.size() - pos_ < n) { malformed("truncated"); }
+    }
+
+    std::string_view data_;
+    std::size_t pos_ = 0;
+};
+
+std::uint64_t zigzag(std::int64_t v) {
+    return (static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63);
+}
+
+std::int64_t unzigzag(std::uint64_t v) {
+    return static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1);
+}
+
+unsigned bit_width(std::uint64_t v) {
+    unsigned w = 0;
+    while (v != 0) {
+        ++w;
+        v >>= 1;
+    }
+    return w;
+}
+
+// ─── Bit packing ─────────────────────────────────────────────────────────────
+
+std::size_t packed_bytes(std::size_t n, unsigned width) { return (n * width + 7) / 8; }
+
+// LSB first; width <= 56 so a value and the pending bits fit the accumulator.
+template <typename U>
+void pack(Writer& w, const U* values, std::size_t n, unsigned width) {
+    std::uint64_t acc = 0;
+    unsigned bits = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        acc |= static_cast<std::uint64_t>(values[i]) << bits;
+        bits += width;
+        while (bits >= 8) {
+            w.u8(static_cast<std::uint8_t>(acc));
+            acc >>= 8;
+            bits -= 8;
+        }
+    }
+    if (bits > 0) { w.u8(static_cast<std::uint8_t>(acc)); }
+}
+
+// Takes the bytes before allocating, so a forged count fails as truncated.
+template <typename U>
+std::vector<U> unpack(Reader& r, std::size_t n, unsigned width) {
+    const std::uint8_t* p = r.bytes(packed_bytes(n, width));
+    std::vector<U> values(n);
+    const std::uint64_t mask = width == 64 ? ~0ULL : (1ULL << width) - 1;
+    std::uint64_t acc = 0;
+    unsigned bits = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        while (bits < width) {
+            acc |= static_cast<std::uint64_t>(*p++) << bits;
+            bits += 8;
+        }
+        values[i] = static_cast<U>(acc & mask);
+        acc >>= width;
+        bits -= width;
+    }
+    return values;
+}
+
+// ─── rANS ────────────────────────────────────────────────────────────────────
+
+// Byte-wise rANS with 32-bit states normalized to [2^23, 2^31). Symbol i of
+// the stream uses state i % 4, so the decoder has four independent chains
+// to overlap. Frequencies sum to 2^12, which bounds the alphabet.
+constexpr unsigned kScaleBits = 12;
+constexpr std::uint32_t kScale = 1U << kScaleBits;
+constexpr std::uint32_t kLow = 1U << 23;
+constexpr std::size_t kLanes = 4;
+
+// Scales counts to sum to kScale, keeping every occurring symbol at >= 1.
+std::vector<std::uint32_t> normalize(const std::vector<std::uint32_t>& counts, std::size_t total) {
+    std::vector<std::uint32_t> freq(counts.size(), 0);
+    std::uint32_t sum = 0;
+    for (std::size_t s = 0; s < counts.size(); ++s) {
+        if (counts[s] == 0) { continue; }
+        freq[s] = std::max<std::uint32_t>(1, static_cast<std::uint32_t>(static_cast<std::uint64_t>(counts[s]) * kScale / total));
+        sum += freq[s];
+    }
+    // Hand the rounding error to (or take it from) the most frequent symbols.
+    std::vector<std::size_t> order;
+    for (std::size_t s = 0; s < freq.size(); ++s) {
+        if (freq[s] != 0) { order.push_back(s); }
+    }
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return freq[a] > freq[b]; });
+    if (sum < kScale) { freq[order.front()] += kScale - sum; }
+    for (std::size_t i = 0; sum > kScale; i = (i + 1) % order.size()) {
+        if (freq[order[i]] > 1) {
+            --freq[order[i]];
+            --sum;
+        }
+    }
+    return freq;
+}
+
+// Writes the occurring symbols with their frequencies, then the stream.
+void rans_encode(Writer& w, const std::uint32_t* symbols, std::size_t n, const std::vector<std::uint32_t>& freq) {
+    std::vector<std::uint32_t> start(freq.size(), 0);
+    std::uint32_t cum = 0;
+    std::size_t present = 0;
+    for (std::size_t s = 0; s < freq.size(); ++s) {
+        start[s] = cum;
+        cum += freq[s];
+        present += freq[s] != 0;
+    }
+
+    // At most 12 bits per symbol plus the flushed states.
+    std::vector<std::uint8_t> buf(2 * n + 4 * kLanes);
+    std::uint8_t* const end = buf.data() + buf.size();
+    std::uint8_t* p = end;
+    std::array<std::uint32_t, kLanes> x;
+    x.fill(kLow);
+    for (std::size_t i = n; i-- > 0;) {
+        std::uint32_t& state = x[i % kLanes];
+        const std::uint32_t f = freq[symbols[i]];
+        const std::uint32_t x_max = ((kLow >> kScaleBits) << 8) * f;
+        while (state >= x_max) {
+            *--p = static_cast<std::uint8_t>(state);
+            state >>= 8;
+        }
+        state = ((state / f) << kScaleBits) + (state % f) + start[symbols[i]];
+    }
+    for (std::size_t lane = kLanes; lane-- > 0;) {
+        p -= 4;
+        for (int b = 0; b < 4; ++b) { p[b] = static_cast<std::uint8_t>(x[lane] >> (8 * b)); }
+    }
+
+    w.varint(present);
+    std::size_t prev = 0;
+    for (std::size_t s = 0; s < freq.size(); ++s) {
+        if (freq[s] == 0) { continue; }
+        w.varint(s - prev);
+        w.varint(freq[s] - 1);
+        prev = s + 1;
+    }
+    w.varint(static_cast<std::size_t>(end - p));
+    w.bytes(p, static_cast<std::size_t>(end - p));
+}
+
+std::vector<std::uint32_t> rans_decode(Reader& r, std::size_t n) {
+    struct Slot {
+        std::uint32_t symbol;
+        std::uint16_t freq;
+        std::uint16_t bias;  // slot - start, so the state update is one multiply-add
+    };
+    std::vector<Slot> slots(kScale);
+    const std::uint64_t present = r.varint();
+    if (present == 0 || present > kScale) { malformed("bad frequency table"); }
+    std::uint64_t symbol = 0;
+    std::uint32_t cum = 0;
+    for (std::uint64_t k = 0; k < present; ++k) {
+        symbol += r.varint();
+        const std::uint64_t f = r.varint() + 1;
+        if (symbol > 0xFFFFFFFFULL || f > kScale - cum) { malformed("bad frequency table"); }
+        for (std::uint32_t j = 0; j < f; ++j) {
+            slots[cum + j] = {static_cast<std::uint32_t>(symbol), static_cast<std::uint16_t>(f),
+                              static_cast<std::uint16_t>(j)};
+        }
+        cum += static_cast<std::uint32_t>(f);
+        ++symbol;
+    }
+    if (cum != kScale) { malformed("bad frequency table"); }
+
+    const std::uint64_t length = r.varint();
+    if (length < 4 * kLanes) { malformed("truncated"); }
+    const std::uint8_t* p = r.bytes(length);
+    const std::uint8_t* const end = p + length;
+    std::array<std::uint32_t, kLanes> x;
+    for (auto& state : x) {
+        state = static_cast<std::uint32_t>(p[0]) | static_cast<std::uint32_t>(p[1]) << 8 |
+                static_cast<std::uint32_t>(p[2]) << 16 | static_cast<std::uint32_t>(p[3]) << 24;
+        p += 4;
+        if (state < kLow || state >= kLow << 8) { malformed("corrupt register stream"); }
+    }
+    // From a normalized state, renormalization reads at most two bytes per
+    // symbol, so a group of four needs no bounds checks while eight bytes
+    // remain.
+    std::vector<std::uint32_t> symbols(n);
+    auto step = [&slots](std::uint32_t state, std::uint32_t& out) {
+        const Slot slot = slots[state & (kScale - 1)];
+        out = slot.symbol;
+        return slot.freq * (state >> kScaleBits) + slot.bias;
+    };
+    auto refill = [](std::uint32_t state, const std::uint8_t*& q) {
+        while (state < kLow) { state = (state << 8) | *q++; }
+        return state;
+    };
+    std::uint32_t x0 = x[0], x1 = x[1], x2 = x[2], x3 = x[3];
+    std::size_t i = 0;
+    for (; i + kLanes <= n && end - p >= 8; i += kLanes) {
+        x0 = step(x0, symbols[i]);
+        x1 = step(x1, symbols[i + 1]);
+        x2 = step(x2, symbols[i + 2]);
+        x3 = step(x3, symbols[i + 3]);
+        x0 = refill(x0, p);
+        x1 = refill(x1, p);
+        x2 = refill(x2, p);
+        x3 = refill(x3, p);
+    }
+    x = {x0, x1, x2, x3};
+    for (; i < n; ++i) {
+        std::uint32_t& state = x[i % kLanes];
+        state = step(state, symbols[i]);
+        while (state < kLow) {
+            if (p == end) { malformed("truncated"); }
+            state = (state << 8) | *p++;
+        }
+    }
+    // The encoder started every lane at kLow, so a complete stream ends there.
+    if (p != end || std::any_of(x.begin(), x.end(), [](std::uint32_t s) { return s != kLow; })) {
+        malformed("corrupt register stream");
+    }
+    return symbols;
+}
+
+// ─── Offsets ─────────────────────────────────────────────────────────────────
+
+// Writes non-negative offsets in whichever coding is smaller.
+void write_offsets(Writer& w, const std::vector<std::uint32_t>& offsets) {
+    const std::uint32_t largest = offsets.empty() ? 0 : *std::max_element(offsets.begin(), offsets.end());
+    const unsigned width = bit_width(largest);
+    if (largest < kScale && width > 0) {
+        std::vector<std::uint32_t> counts(largest + 1, 0);
+        for (std::uint32_t o : offsets) { ++counts[o]; }
+        Writer rans;
+        rans_encode(rans, offsets.data(), offsets.size(), normalize(counts, offsets.size()));
+        std::string coded = rans.take();
+        if (coded.size() < 1 + packed_bytes(offsets.size(), width)) {
+            w.u8(static_cast<std::uint8_t>(Coding::Rans));
+            w.bytes(reinterpret_cast<const std::uint8_t*>(coded.data()), coded.size());
+            return;
+        }
+    }
+    w.u8(static_cast<std::uint8_t>(Coding::Packed));
+    w.u8(static_cast<std::uint8_t>(width));
+    pack(w, offsets.data(), offsets.size(), width);
+}
+
+std::vector<std::uint32_t> read_offsets(Reader& r, std::size_t n) {
+    switch (static_cast<Coding>(r.u8())) {
+    case Coding::Packed: {
+        const unsigned width = r.u8();
+        if (width > 32) { malformed("bad register width"); }
+        return unpack<std::uint32_t>(r, n, width);
+    }
+    case Coding::Rans:
+        return rans_decode(r, n);
+    }
+    malformed("unknown register coding");
+}
+
+// Integer registers as zigzag(min) plus offsets from it; values outside
+// [lo, hi] are rejected.
+void write_int_registers(Writer& w, const std::vector<int>& registers) {
+    const int lowest = registers.empty() ? 0 : *std::min_element(registers.begin(), registers.end());
+    std::vector<std::uint32_t> offsets(registers.size());
+    for (std::size_t i = 0; i < registers.size(); ++i) {
+        offsets[i] = static_cast<std::uint32_t>(static_cast<std::int64_t>(registers[i]) - lowest);
+    }
+    w.varint(zigzag(lowest));
+    write_offsets(w, offsets);
+}
+
+std::vector<int> read_int_registers(Reader& r, std::size_t n, std::int64_t lo, std::int64_t hi) {
+    const std::int64_t lowest = unzigzag(r.varint());
+    // Checked before any addition, so a forged lowest cannot overflow.
+    if (lowest < lo || lowest > hi) { malformed("register out of range"); }
+    const std::vector<std::uint32_t> offsets = read_offsets(r, n);
+    std::vector<int> registers(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (offsets[i] > hi - lowest) { malformed("register out of range"); }
+        registers[i] = static_cast<int>(lowest + offsets[i]);
+    }
+    return registers;
+}
+
+// Float registers: the bits above the mantissa (sign and exponent) as
+// offsets, then the mantissas packed at full width. Registers with an
+// all-ones exponent (infinity; never NaN) carry no mantissa, so unfilled
+// registers cost only their share of the offset stream.
+template <typename T>
+struct FloatLayout;
+
+template <>
+struct FloatLayout<double> {
+    using Bits = std::uint64_t;
+    static constexpr unsigned kMantissaBits = 52;
+    static constexpr std::uint32_t kExponentMask = 0x7FF;
+};
+
+template <>
+struct FloatLayout<float> {
+    using Bits = std::uint32_t;
+    static constexpr unsigned kMantissaBits = 23;
+    static constexpr std::uint32_t kExponentMask = 0xFF;
+};
+
+template <typename T>
+void write_float_registers(Writer& w, const std::vector<T>& registers) {
+    using Layout = FloatLayout<T>;
+    using Bits = typename Layout::Bits;
+    constexpr Bits kMantissaMask = (Bits{1} << Layout::kMantissaBits) - 1;
+    std::vector<std::uint32_t> high(registers.size());
+    std::vector<Bits> mantissa;
+    mantissa.reserve(registers.size());
+    for (std::size_t i = 0; i < registers.size(); ++i) {
+        Bits bits;
+        std::memcpy(&bits, &registers[i], sizeof(bits));
+        high[i] = static_cast<std::uint32_t>(bits >> Layout::kMantissaBits);
+        if ((high[i] & Layout::kExponentMask) != Layout::kExponentMask) {
+            mantissa.push_back(bits & kMantissaMask);
+        } else if ((bits & kMantissaMask) != 0) {
+            throw std::invalid_argument("Cannot encode NaN registers.");
+        }
+    }
+    const std::uint32_t lowest = high.empty() ? 0 : *std::min_element(high.begin(), high.end());
+    for (std::uint32_t& h : high) { h -= lowest; }
+    w.varint(lowest);
+    write_offsets(w, high);
+    pack(w, mantissa.data(), mantissa.size(), Layout::kMantissaBits);
+}
+
+template <typename T>
+std::vector<T> read_float_registers(Reader& r, std::size_t n) {
+    using Layout = FloatLayout<T>;
+    using Bits = typename Layout::Bits;
+    constexpr std::uint64_t kHighLimit = std::uint64_t{1} << (8 * sizeof(Bits) - Layout::kMantissaBits);
+    const std::uint64_t lowest = r.varint();
+    if (lowest >= kHighLimit) { malformed("register out of range"); }
+    std::vector<std::uint32_t> high = read_offsets(r, n);
+    std::size_t finite = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (high[i] >= kHighLimit - lowest) { malformed("register out of range"); }
+        high[i] = static_cast<std::uint32_t>(lowest + high[i]);
+        finite += (high[i] & Layout::kExponentMask) != Layout::kExponentMask;
+    }
+    const std::vector<Bits> mantissa = unpack<Bits>(r, finite, Layout::kMantissaBits);
+    std::vector<T> registers(n);
+    std::size_t next = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        Bits bits = static_cast<Bits>(high[i]) << Layout::kMantissaBits;
+        if ((high[i] & Layout::kExponentMask) != Layout::kExponentMask) { bits |= mantissa[next++]; }
+        std::memcpy(&registers[i], &bits, sizeof(bits));
+    }
+    return registers;
+}
+
+// ─── Per-class parameters ────────────────────────────────────────────────────
+
+struct Header {
+    std::size_t m;
+    std::uint64_t seed;
+};
+
+void write_header(Writer& w, const char (&magic)[4], WireTag tag, std::size_t m, std::uint64_t seed) {
+    if (m > kMaxSketchSize) {
+        throw std::invalid_argument("Sketches larger than " + std::to_string(kMaxSketchSize) +
+                                    " registers have no wire format.");
+    }
+    for (char c : magic) { w.u8(static_cast<std::uint8_t>(c)); }
+    w.u8(kVersion);
+    w.u8(static_cast<std::uint8_t>(tag));
+    w.varint(m);
+    w.u64(seed);
+}
+
+Header read_header(Reader& r, const char (&magic)[4], WireTag tag) {
+    for (char c : magic) {
+        if (r.u8() != static_cast<std::uint8_t>(c)) { malformed(&magic == &kMagic ? "not a sketch" : "not a delta"); }
+    }
+    if (r.u8() != kVersion) { malformed("unsupported version"); }
+    if (r.u8() != static_cast<std::uint8_t>(tag)) {
+        throw std::invalid_argument("Wire data holds a different sketch class.");
+    }
+    Header h{};
+    h.m = r.varint();
+    h.seed = r.u64();
+    if (h.m == 0) { malformed("empty sketch"); }
+    if (h.m > kMaxSketchSize) { malformed("sketch too large"); }
+    return h;
+}
+
+std::uint8_t read_amount_bits(Reader& r) {
+    const std::uint8_t bits = r.u8();
+    if (bits < 2 || bits > 31) { malformed("bad amount_bits"); }
+    return bits;
+}
+
+template <typename S>
+struct WireTraits;
+
+template <>
+struct WireTraits<QSketch> {
+    static constexpr WireTag kTag = WireTag::QSketch;
+    struct Params {
+        std::uint8_t amount_bits;
+        bool operator==(const Params& o) const { return amount_bits == o.amount_bits; }
+    };
+    static Params params(const QSketch& s) { return {s.get_amount_bits()}; }
+    static void write(Writer& w, const Params& p) { w.u8(p.amount_bits); }
+    static Params read(Reader& r) { return {read_amount_bits(r)}; }
+    static std::vector<int> read_registers(Reader& r, std::size_t n, const Params& p) {
+        const std::int64_t half = std::int64_t{1} << (p.amount_bits - 1);
+        return read_int_registers(r, n, -half + 1, half - 1);
+    }
+    static QSketch make(const Header& h, const Params& p, const std::vector<int>& registers) {
+        return {h.m, h.seed, p.amount_bits, registers};
+    }
+};
+
+template <>
+struct WireTraits<kQSketch> {
+    static constexpr WireTag kTag = WireTag::kQSketch;
+    struct Params {
+        std::uint8_t amount_bits;
+        float logarithm_base;
+        bool operator==(const Params& o) const {
+            return amount_bits == o.amount_bits && logarithm_base == o.logarithm_base;
+        }
+    };
+    static Params params(const kQSketch& s) { return {s.get_amount_bits(), s.get_logarithm_base()}; }
+    static void write(Writer& w, const Params& p) {
+        w.u8(p.amount_bits);
+        w.f32(p.logarithm_base);
+    }
+    static Params read(Reader& r) {
+        const std::uint8_t bits = read_amount_bits(r);
+        return {bits, r.f32()};
+    }
+    static std::vector<int> read_registers(Reader& r, std::size_t n, const Params& p) {
+        const std::int64_t half = std::int64_t{1} << (p.amount_bits - 1);
+        return read_int_registers(r, n, -half + 1, half - 1);
+    }
+    static kQSketch make(const Header& h, const Params& p, const std::vector<int>& registers) {
+        return {h.m, h.seed, p.amount_bits, p.logarithm_base, registers};
+    }
+};
+
+template <>
+struct WireTraits<LogExpSketchFastNoShifted> {
+    static constexpr WireTag kTag = WireTag::LogExpSketchFastNoShifted;
+    struct Params {
+        std::uint8_t amount_bits;
+        double v_max;
+        bool operator==(const Params& o) const { return amount_bits == o.amount_bits && v_max == o.v_max; }
+    };
+    static Params params(const LogExpSketchFastNoShifted& s) { return {s.get_amount_bits(), s.get_v_max()}; }
+    static void write(Writer& w, const Params& p) {
+        w.u8(p.amount_bits);
+        w.f64(p.v_max);
+    }
+    static Params read(Reader& r) {
+        const std::uint8_t bits = read_amount_bits(r);
+        return {bits, r.f64()};
+    }
+    static std::vector<int> read_registers(Reader& r, std::size_t n, const Params& p) {
+        return read_int_registers(r, n, 0, (std::int64_t{1} << p.amount_bits) - 1);
+    }
+    static LogExpSketchFastNoShifted make(const Header& h, const Params& p, const std::vector<int>& registers) {
+        return {h.m, h.seed, p.amount_bits, p.v_max, registers};
+    }
+};
+
+template <>
+struct WireTraits<HyperLogLog> {
+    static constexpr WireTag kTag = WireTag::HyperLogLog;
+    struct Params {
+        bool operator==(const Params&) const { return true; }
+    };
+    static Params params(const HyperLogLog&) { return {}; }
+    static void write(Writer&, const Params&) {}
+    static Params read(Reader&) { return {}; }
+    // rho is at most 65: 64 leading zeros plus one.
+    static std::vector<int> read_registers(Reader& r, std::size_t n, const Params&) {
+        return read_int_registers(r, n, 0, 65);
+    }
+    static HyperLogLog make(const Header& h, const Params&, const std::vector<int>& registers) {
+        return {h.m, h.seed, std::vector<std::uint8_t>(registers.begin(), registers.end())};
+    }
+};
+
+template <typename T>
+struct FastExpWireTraits {
+    struct Params {
+        bool operator==(const Params&) const { return true; }
+    };
+    static Params params(const FastExpSketchT<T>&) { return {}; }
+    static void write(Writer&, const Params&) {}
+    static Params read(Reader&) { return {}; }
+    static std::vector<T> read_registers(Reader& r, std::size_t n, const Params&) {
+        return read_float_registers<T>(r, n);
+    }
+    static FastExpSketchT<T> make(const Header& h, const Params&, const std::vector<T>& registers) {
+        return {h.m, h.seed, registers};
+    }
+};
+
+template <>
+struct WireTraits<FastExpSketchT<double>> : FastExpWireTraits<double> {
+    static constexpr WireTag kTag = WireTag::FastExpSketch;
+};
+
+template <>
+struct WireTraits<FastExpSketchT<float>> : FastExpWireTraits<float> {
+    static constexpr WireTag kTag = WireTag::FastExpSketchFloat32;
+};
+
+void write_registers(Writer& w, const std::vector<int>& registers) { write_int_registers(w, registers); }
+
+void write_registers(Writer& w, const std::vector<std::uint8_t>& registers) {
+    write_int_registers(w, std::vector<int>(registers.begin(), registers.end()));
+}
+
+template <typename T>
+void write_registers(Writer& w, const std::vector<T>& registers) { write_float_registers(w, registers); }
+
+template <typename S>
+std::string encode(const S& sketch) {
+    using Traits = WireTraits<S>;
+    Writer w;
+    write_header(w, kMagic, Traits::kTag, sketch.get_sketch_size(), sketch.get_master_seed());
+    Traits::write(w, Traits::params(sketch));
+    write_registers(w, sketch.get_registers());
+    return w.take();
+}
+
+template <typename S>
+S decode(std::string_view data) {
+    using Traits = WireTraits<S>;
+    Reader r(data);
+    const Header h = read_header(r, kMagic, Traits::kTag);
+    const auto p = Traits::read(r);
+    const auto registers = Traits::read_registers(r, h.m, p);
+    r.expect_end();
+    return Traits::make(h, p, registers);
+}
+
+template <typename S>
+void check_mergeable(const S& sketch, const Header& h, const typename WireTraits<S>::Params& p) {
+    if (h.m != sketch.get_sketch_size()) { throw std::invalid_argument("Cannot merge sketches of different sizes."); }
+    if (h.seed != sketch.get_master_seed()) { throw std::invalid_argument("Cannot merge sketches with different seeds."); }
+    if (!(p == WireTraits<S>::params(sketch))) {
+        throw std::invalid_argument("Cannot merge sketches with different parameters.");
+    }
+}
+
+template <typename S>
+void merge(S& sketch, std::string_view data) {
+    using Traits = WireTraits<S>;
+    Reader r(data);
+    const Header h = read_header(r, kMagic, Traits::kTag);
+    const auto p = Traits::read(r);
+    check_mergeable(sketch, h, p);
+    const auto registers = Traits::read_registers(r, h.m, p);
+    r.expect_end();
+    sketch.merge_registers(registers.data(), registers.size());
+}
+
+// ─── Deltas ──────────────────────────────────────────────────────────────────
+
+int register_at(const kQSketch& sketch, std::size_t i) { return sketch.register_at(i); }
+
+template <typename T>
+T register_at(const FastExpSketchT<T>& sketch, std::size_t i) { return sketch.registers()[i]; }
+
+template <typename S>
+std::string encode_delta(S& sketch, std::uint64_t since_epoch) {
+    using Traits = WireTraits<S>;
+    const DirtyRegisters& changes = sketch.changes();
+    if (!changes.tracking()) { throw std::invalid_argument("Sketch is not tracking changes; call track_changes()."); }
+    if (since_epoch > changes.epoch()) { throw std::invalid_argument("since_epoch is ahead of the sketch."); }
+
+    // A replica behind the last checkpoint has missed deltas: resync it with
+    // every register, as one run.
+    std::vector<std::pair<std::size_t, std::size_t>> runs;
+    if (since_epoch == changes.epoch()) {
+        changes.for_each_run([&runs](std::size_t begin, std::size_t length) { runs.emplace_back(begin, length); });
+    } else {
+        runs.emplace_back(0, sketch.get_sketch_size());
+    }
+    std::vector<decltype(register_at(sketch, 0))> values;
+
+    Writer w;
+    write_header(w, kDeltaMagic, Traits::kTag, sketch.get_sketch_size(), sketch.get_master_seed());
+    Traits::write(w, Traits::params(sketch));
+    w.varint(runs.size());
+    std::size_t end = 0;
+    for (const auto& [begin, length] : runs) {
+        w.varint(begin - end);
+        w.varint(length - 1);
+        for (std::size_t i = begin; i < begin + length; ++i) { values.push_back(register_at(sketch, i)); }
+        end = begin + length;
+    }
+    write_registers(w, values);
+    sketch.checkpoint_changes();
+    return w.take();
+}
+
+template <typename S>
+void apply(S& sketch, std::string_view data) {
+    using Traits = WireTraits<S>;
+    Reader r(data);
+    const Header h = read_header(r, kDeltaMagic, Traits::kTag);
+    const auto p = Traits::read(r);
+    check_mergeable(sketch, h, p);
+    const std::uint64_t run_count = r.varint();
+    if (run_count > h.m) { malformed("too many runs"); }
+    std::vector<std::uint32_t> indices;
+    std::uint64_t end = 0;
+    for (std::uint64_t k = 0; k < run_count; ++k) {
+        const std::uint64_t gap = r.varint();
+        if (gap > h.m - end) { malformed("run out of range"); }
+        const std::uint64_t begin = end + gap;
+        const std::uint64_t length = r.varint();
+        if (length >= h.m - begin) { malformed("run out of range"); }
+        end = begin + length + 1;
+        for (std::uint64_t i = begin; i < end; ++i) { indices.push_back(static_cast<std::uint32_t>(i)); }
+    }
+    const auto registers = Traits::read_registers(r, indices.size(), p);
+    r.expect_end();
+    sketch.merge_registers_at(indices.data(), registers.data(), indices.size());
+}
+
+}  // namespace
+
+template <> std::string to_wire(const QSketch& sketch) { return encode(sketch); }
+template <> QSketch from_wire<QSketch>(std::string_view data) { return decode<QSketch>(data); }
+template <> void merge_wire(QSketch& sketch, std::string_view data) { merge(sketch, data); }
+
+template <> std::string to_wire(const kQSketch& sketch) { return encode(sketch); }
+template <> kQSketch from_wire<kQSketch>(std::string_view data) { return decode<kQSketch>(data); }
+template <> void merge_wire(kQSketch& sketch, std::string_view data) { merge(sketch, data); }
+template <> std::string serialize_delta(kQSketch& sketch, std::uint64_t since_epoch) {
+    return encode_delta(sketch, since_epoch);
+}
+template <> void apply_delta(kQSketch& sketch, std::string_view data) { apply(sketch, data); }
+
+template <> std::string to_wire(const LogExpSketchFastNoShifted& sketch) { return encode(sketch); }
+template <> LogExpSketchFastNoShifted from_wire<LogExpSketchFastNoShifted>(std::string_view data) {
+    return decode<LogExpSketchFastNoShifted>(data);
+}
+template <> void merge_wire(LogExpSketchFastNoShifted& sketch, std::string_view data) { merge(sketch, data); }
+
+template <> std::string to_wire(const HyperLogLog& sketch) { return encode(sketch); }
+template <> HyperLogLog from_wire<HyperLogLog>(std::string_view data) { return decode<HyperLogLog>(data); }
+template <> void merge_wire(HyperLogLog& sketch, std::string_view data) { merge(sketch, data); }
+
+template <> std::string to_wire(const FastExpSketchT<double>& sketch) { return encode(sketch); }
+template <> FastExpSketchT<double> from_wire<FastExpSketchT<double>>(std::string_view data) {
+    return decode<FastExpSketchT<double>>(data);
+}
+template <> void merge_wire(FastExpSketchT<double>& sketch, std::string_view data) { merge(sketch, data); }
+template <> std::string serialize_delta(FastExpSketchT<double>& sketch, std::uint64_t since_epoch) {
+    return encode_delta(sketch, since_epoch);
+}
+template <> void apply_delta(FastExpSketchT<double>& sketch, std::string_view data) { apply(sketch, data); }
+
+template <> std::string to_wire(const FastExpSketchT<float>& sketch) { return encode(sketch); }
+template <> FastExpSketchT<float> from_wire<FastExpSketchT<float>>(std::string_view data) {
+    return decode<FastExpSketchT<float>>(data);
+}
+template <> void merge_wire(FastExpSketchT<float>& sketch, std::string_view data) { merge(sketch, data); }
+template <> std::string serialize_delta(FastExpSketchT<float>& sketch, std::uint64_t since_epoch) {
+    return encode_delta(sketch, since_epoch);
+}
+template <> void apply_delta(FastExpSketchT<float>& sketch, std::string_view data) { apply(sketch, data); }
@@ -0,0 +1,85 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+class QSketch;
+class kQSketch;
+class LogExpSketchFastNoShifted;
+class HyperLogLog;
+template <typename T>
+class FastExpSketchT;
+
+// Compact, byte-order independent encoding for shipping sketches between
+// nodes. Smaller than pickle for every supported class; decoding needs no
+// Python and merge_wire() folds the registers into an existing sketch without
+// constructing the sender's sketch.
+//
+// Layout: "WCEW", version byte, class tag, varint m, 64-bit seed, the class
+// parameters (amount_bits, logarithm_base / v_max), then the registers.
+//
+// - Integer registers (QSketch, kQSketch, LogExpSketchFastNoShifted,
+//   HyperLogLog) are sent as offsets from the smallest register. Offsets
+//   cluster on a handful of values, so they are range-coded (rANS, four
+//   interleaved states, 12-bit frequencies) against a table of the offsets
+//   that occur; when that is not smaller, they are bit-packed at the width of
+//   the largest offset.
+// - Float registers (FastExpSketch, FastExpSketchFloat32) are split into sign
+//   plus exponent, coded like integer registers, and the mantissa, which for
+//   exponential minima is close to uniform and is bit-packed unchanged. The
+//   encoding is lossless.
+//
+// Sketches in small mode are sent as their densified registers; m is at most
+// 2^24. Malformed or truncated input throws std::invalid_argument;
+// merge_wire() throws it for a sketch of another class, size, seed or
+// parameters and leaves the target unchanged in every error case.
+template <typename S>
+std::string to_wire(const S& sketch);
+
+template <typename S>
+S from_wire(std::string_view data);
+
+template <typename S>
+void merge_wire(S& sketch, std::string_view data);
+
+// Delta replication (kQSketch, FastExpSketch, FastExpSketchFloat32). Once a
+// sketch calls track_changes(), serialize_delta() sends only the registers
+// changed since its last checkpoint, as (index, value) runs, and then
+// checkpoints. Pass the change epoch the replica last synced at (0 for the
+// first delta); a replica behind the last checkpoint gets every register.
+// apply_delta() folds the runs in with merge semantics, so applying a delta
+// twice or out of order is harmless. Same layout as the full format with
+// magic "WCED", plus the run count and (gap, length - 1) varint pairs before
+// the registers. serialize_delta() throws std::invalid_argument for an
+// untracked sketch or an epoch it has not reached; apply_delta() throws it
+// like merge_wire().
+template <typename S>
+std::string serialize_delta(S& sketch, std::uint64_t since_epoch);
+
+template <typename S>
+void apply_delta(S& sketch, std::string_view data);
+
+template <> std::string to_wire(const QSketch& sketch);
+template <> QSketch from_wire<QSketch>(std::string_view data);
+template <> void merge_wire(QSketch& sketch, std::string_view data);
+template <> std::string to_wire(const kQSketch& sketch);
+template <> kQSketch from_wire<kQSketch>(std::string_view data);
+template <> void merge_wire(kQSketch& sketch, std::string_view data);
+template <> std::string serialize_delta(kQSketch& sketch, std::uint64_t since_epoch);
+template <> void apply_delta(kQSketch& sketch, std::string_view data);
+template <> std::string to_wire(const LogExpSketchFastNoShifted& sketch);
+template <> LogExpSketchFastNoShifted from_wire<LogExpSketchFastNoShifted>(std::string_view data);
+template <> void merge_wire(LogExpSketchFastNoShifted& sketch, std::string_view data);
+template <> std::string to_wire(const HyperLogLog& sketch);
+template <> HyperLogLog from_wire<HyperLogLog>(std::string_view data);
+template <> void merge_wire(HyperLogLog& sketch, std::string_view data);
+template <> std::string to_wire(const FastExpSketchT<double>& sketch);
+template <> FastExpSketchT<double> from_wire<FastExpSketchT<double>>(std::string_view data);
+template <> void merge_wire(FastExpSketchT<double>& sketch, std::string_view data);
+template <> std::string serialize_delta(FastExpSketchT<double>& sketch, std::uint64_t since_epoch);
+template <> void apply_delta(FastExpSketchT<double>& sketch, std::string_view data);
+template <> std::string to_wire(const FastExpSketchT<float>& sketch);
+template <> FastExpSketchT<float> from_wire<FastExpSketchT<float>>(std::string_view data);
+template <> void merge_wire(FastExpSketchT<float>& sketch, std::string_view data);
+template <> std::string serialize_delta(FastExpSketchT<float>& sketch, std::uint64_t since_epoch);
+template <> void apply_delta(FastExpSketchT<float>& sketch, std::string_view data);
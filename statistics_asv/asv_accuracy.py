@@ -1,8 +1,9 @@
 import numpy as np
 
+from weighted_cardinality_estimation import run_trials
 from weighted_cardinality_estimation.stat import elements_stream
 
-from .common import IMPLS, get_seeds
+from .common import IMPLS
 
 # DRAFT: small values so the suite runs quickly.
 # Bump STATISTICAL_RUNS to >=1000 before publishing results.
@@ -10,6 +11,22 @@ SKETCH_SIZE = 64
 STREAM_SIZE = 200
 STATISTICAL_RUNS = 50
 
+# IMPLS entries as run_trials (class name, keyword arguments).
+TRIAL_SPECS: dict[str, tuple[str, dict[str, float]]] = {
+    "ExpSketch": ("ExpSketch", {}),
+    "FastExpSketchFloat32": ("FastExpSketchFloat32", {}),
+    "FastExpSketchFloat16": ("FastExpSketchFloat16", {}),
+    "FastExpSketchBFloat16": ("FastExpSketchBFloat16", {}),
+    "FastExpSketchCustomFloat(e5m10)": ("FastExpSketchCustomFloat", {"exp_bits": 5, "mant_bits": 10}),
+    "FastExpSketchCustomFloat(e8m7)": ("FastExpSketchCustomFloat", {"exp_bits": 8, "mant_bits": 7}),
+    "FastExpSketch": ("FastExpSketch", {}),
+    "FastGMExpSketch": ("FastGMExpSketch", {}),
+    "WeightedMinHash": ("WeightedMinHash", {}),
+    "QSketchDyn(b=8)": ("QSketchDyn", {"amount_bits": 8}),
+    "QSketch(b=8)": ("QSketch", {"amount_bits": 8}),
+    "kQSketch(b=8,k=2)": ("kQSketch", {"amount_bits": 8, "logarithm_base": 2}),
+}
+
 
 class AccuracySuite:
     param_names = ["sketch_type"]
@@ -22,13 +39,8 @@ class AccuracySuite:
 
         stats: dict[str, dict] = {}
         for impl_name in IMPLS:
-            estimates = []
-            for _ in range(STATISTICAL_RUNS):
-                s = IMPLS[impl_name](SKETCH_SIZE, get_seeds(SKETCH_SIZE))
-                s.add_many(elems, weights)
-                estimates.append(s.estimate())
-
-            arr = np.array(estimates)
+            sketch, params = TRIAL_SPECS[impl_name]
+            arr = run_trials(sketch, SKETCH_SIZE, elems, weights, STATISTICAL_RUNS, params=params).estimates
             mean = float(np.mean(arr))
             mre = float(np.mean(np.abs(arr - true_cardinality) / true_cardinality))
             cv = float(np.std(arr) / mean) if mean != 0.0 else 0.0
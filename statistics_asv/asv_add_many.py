@@ -1,4 +1,12 @@
-from weighted_cardinality_estimation.stat import elements_stream
+from weighted_cardinality_estimation import (
+    FastExpSketch,
+    HyperLogLog,
+    QSketch,
+    SketchGroup,
+    WeightedHyperLogLog,
+    kQSketch,
+)
+from weighted_cardinality_estimation.stat import elements_stream, skewed_stream
 
 from .common import IMPLS, get_seeds
 
@@ -22,3 +30,70 @@ class AddManySuite:
     time_add_many.rounds = 2  # type: ignore
     time_add_many.repeat = 3  # type: ignore
     time_add_many.warmup_time = 0.1  # type: ignore
+
+
+def _separate(m: int, seed: int):
+    return [
+        FastExpSketch(m, seed),
+        QSketch(m, seed, amount_bits=8),
+        kQSketch(m, seed, amount_bits=8, logarithm_base=2),
+        HyperLogLog(m, seed),
+    ]
+
+
+class FusedIngestSuite:
+    """The same stream into FastExp + QSketch + kQSketch + HLL: one sketch at a time vs one SketchGroup."""
+
+    param_names = ["mode"]
+    params = [["separate", "group"]]
+
+    def setup(self, mode: str):
+        self.elems = elements_stream(AMOUNT_ELEMENTS, seed=0)
+        self.weights = [1.0] * AMOUNT_ELEMENTS
+        if mode == "group":
+            self.group = SketchGroup(SKETCH_SIZE, 42)
+            self.group.make_fast_exp_sketch()
+            self.group.make_q_sketch(amount_bits=8)
+            self.group.make_k_q_sketch(amount_bits=8, logarithm_base=2)
+            self.group.make_hyper_log_log()
+        else:
+            self.sketches = _separate(SKETCH_SIZE, 42)
+
+    def time_add_many(self, mode: str):
+        if mode == "group":
+            self.group.add_many(self.elems, self.weights)
+            return
+        for s in self.sketches:
+            if isinstance(s, HyperLogLog):
+                s.add_many(self.elems)
+            else:
+                s.add_many(self.elems, self.weights)
+
+    time_add_many.rounds = 2  # type: ignore
+    time_add_many.repeat = 3  # type: ignore
+    time_add_many.warmup_time = 0.1  # type: ignore
+
+
+_PRE_AGGREGATION_IMPLS = {
+    "FastExpSketch": lambda: FastExpSketch(SKETCH_SIZE, 42),
+    "QSketch": lambda: QSketch(SKETCH_SIZE, 42, amount_bits=8),
+    "WeightedHyperLogLog": lambda: WeightedHyperLogLog(SKETCH_SIZE, 42),
+}
+
+
+class PreAggregationSuite:
+    """Zipf(1.2) stream with repeated keys: plain add_many vs add_many(..., pre_aggregate=True)."""
+
+    param_names = ["sketch_type", "pre_aggregate"]
+    params = [list(_PRE_AGGREGATION_IMPLS.keys()), [False, True]]
+
+    def setup(self, sketch_type: str, pre_aggregate: bool):
+        self.instance = _PRE_AGGREGATION_IMPLS[sketch_type]()
+        self.elems, self.weights = skewed_stream(10 * AMOUNT_ELEMENTS, AMOUNT_ELEMENTS, seed=0)
+
+    def time_add_many(self, sketch_type: str, pre_aggregate: bool):
+        self.instance.add_many(self.elems, self.weights, pre_aggregate)
+
+    time_add_many.rounds = 2  # type: ignore
+    time_add_many.repeat = 3  # type: ignore
+    time_add_many.warmup_time = 0.1  # type: ignore
@@ -0,0 +1,28 @@
+from weighted_cardinality_estimation import QSketch, QSketchPool
+
+# DRAFT: small values so the suite runs quickly.
+SKETCH_SIZE = 64
+AMOUNT_SKETCHES = 10_000
+
+
+class ConstructionSuite:
+    """Build and drop AMOUNT_SKETCHES per-key QSketches: separate objects vs one QSketchPool."""
+
+    param_names = ["mode"]
+    params = [["separate", "pool"]]
+
+    def setup(self, mode: str):
+        self.pool = QSketchPool(SKETCH_SIZE, 42, amount_bits=8)
+
+    def time_construct_destruct(self, mode: str):
+        if mode == "pool":
+            for _ in range(AMOUNT_SKETCHES):
+                self.pool.make()
+            self.pool.reset()
+            return
+        sketches = [QSketch(SKETCH_SIZE, 42, amount_bits=8) for _ in range(AMOUNT_SKETCHES)]
+        del sketches
+
+    time_construct_destruct.rounds = 2  # type: ignore
+    time_construct_destruct.repeat = 3  # type: ignore
+    time_construct_destruct.warmup_time = 0.1  # type: ignore
@@ -36,3 +36,10 @@ class MemorySuite:
         return len(zlib.compress(pickle.dumps(self.instance)))
 
     track_serialization_size.unit = "bytes"  # type: ignore
+
+    def track_wire_size(self, impl_name: str) -> int:
+        if not hasattr(self.instance, "to_wire"):
+            raise NotImplementedError
+        return len(self.instance.to_wire())
+
+    track_wire_size.unit = "bytes"  # type: ignore
@@ -3,6 +3,9 @@ from typing import Callable, Union
 
 from weighted_cardinality_estimation import (
     ExpSketch,
+    FastExpSketchBFloat16,
+    FastExpSketchCustomFloat,
+    FastExpSketchFloat16,
     FastExpSketchFloat32,
     FastExpSketch,
     FastGMExpSketch,
@@ -14,6 +17,9 @@ from weighted_cardinality_estimation import (
 
 SketchType = Union[
     ExpSketch,
+    FastExpSketchBFloat16,
+    FastExpSketchCustomFloat,
+    FastExpSketchFloat16,
     FastExpSketchFloat32,
     FastExpSketch,
     FastGMExpSketch,
@@ -26,6 +32,12 @@ SketchType = Union[
 IMPLS: dict[str, Callable[..., SketchType]] = {
     "ExpSketch": lambda m, seeds: ExpSketch(m, seeds),
     "FastExpSketchFloat32": lambda m, seeds: FastExpSketchFloat32(m, seeds),
+    # 16-bit registers: native binary16 / bfloat16 against the bit-packed
+    # CustomFloat formats with the same exponent and mantissa widths.
+    "FastExpSketchFloat16": lambda m, seeds: FastExpSketchFloat16(m, seeds),
+    "FastExpSketchBFloat16": lambda m, seeds: FastExpSketchBFloat16(m, seeds),
+    "FastExpSketchCustomFloat(e5m10)": lambda m, seeds: FastExpSketchCustomFloat(m, seeds, exp_bits=5, mant_bits=10),
+    "FastExpSketchCustomFloat(e8m7)": lambda m, seeds: FastExpSketchCustomFloat(m, seeds, exp_bits=8, mant_bits=7),
     "FastExpSketch": lambda m, seeds: FastExpSketch(m, seeds),
     "FastGMExpSketch": lambda m, seeds: FastGMExpSketch(m, seeds),
     "WeightedMinHash": lambda m, seeds: WeightedMinHash(m, seeds),
@@ -13,6 +13,8 @@ from weighted_cardinality_estimation import (
     LogExpSketchSlowShifted,
     FastExpSketch,
     FastExpSketchCustomFloat,
+    FastExpSketchBFloat16,
+    FastExpSketchFloat16,
     FastExpSketchFloat32,
     LogExpSketchFastNoShifted,
     LogExpSketchFastShifted,
@@ -62,6 +64,12 @@ class SketchSpec:
     max_weight: float
     is_fast: bool = False
     jaccard_atol: float = 0.25
+    # Only for sketches with quantized registers (Q, kQ): upper bound for
+    # jaccard_struct() of disjoint 50-element sets at m=64. Their registers
+    # collide by chance and the collision correction leaves noise: over 2000
+    # disjoint pairs the median was 0.002, but p99 0.12 and the max 0.19.
+    # Sketches without it keep the 0.05 bound of test_jaccard_disjoint_near_zero.
+    jaccard_disjoint_max: float | None = None
     # Maximum acceptable relative error |estimate - true| / true for cardinality tests.
     # Tuned per sketch for m=400, n=500, over 20 random seeds. Set to observed max + ~2% margin.
     estimate_rel_error: float = 0.5
@@ -91,6 +99,14 @@ SKETCH_SPECS: list[SketchSpec] = [
         "FastExpSketchFloat32", lambda m, seed=42: FastExpSketchFloat32(m, seed=seed),
         estimate_rel_error=0.10, min_weight=1e-37, max_weight=1e45,
     ),
+    SketchSpec(
+        "FastExpSketchFloat16", lambda m, seed=42: FastExpSketchFloat16(m, seed=seed),
+        estimate_rel_error=0.10, min_weight=1e-3, max_weight=1e3,
+    ),
+    SketchSpec(
+        "FastExpSketchBFloat16", lambda m, seed=42: FastExpSketchBFloat16(m, seed=seed),
+        estimate_rel_error=0.10, min_weight=1e-37, max_weight=1e38,
+    ),
     SketchSpec(
         "FastExpSketch", lambda m, seed=42: FastExpSketch(m, seed=seed),
         estimate_rel_error=0.12, min_weight=1e-305, max_weight=1e307,
@@ -101,19 +117,19 @@ SKETCH_SPECS: list[SketchSpec] = [
     ),
 
     SketchSpec("QSketch", lambda m, seed=42: QSketch(m, seed=seed, amount_bits=8),
-               estimate_rel_error=0.14, min_weight=1e-37, max_weight=1e38),
+               estimate_rel_error=0.14, jaccard_disjoint_max=0.2, min_weight=1e-37, max_weight=1e38),
     SketchSpec(
         "QSketchDyn", lambda m, seed=42: QSketchDyn(m, seed=seed, amount_bits=8, g_seed=42),
         is_fast=True, estimate_rel_error=0.07, min_weight=1e-37, max_weight=1e307,
     ),
     SketchSpec(
         "kQSketch", lambda m, seed=42: kQSketch(m, seed=seed, amount_bits=8, logarithm_base=2),
-        estimate_rel_error=0.12, min_weight=1e-37, max_weight=1e38,
+        estimate_rel_error=0.12, jaccard_disjoint_max=0.2, min_weight=1e-37, max_weight=1e38,
     ),
     SketchSpec(
         "kQSketchRounding",
         lambda m, seed=42: kQSketchRounding(m, seed=seed, amount_bits=8, logarithm_base=2),
-        estimate_rel_error=0.11, min_weight=1e-37, max_weight=1e38,
+        estimate_rel_error=0.11, jaccard_disjoint_max=0.2, min_weight=1e-37, max_weight=1e38,
     ),
     SketchSpec(
         "kQSketchRoundedDyn",
@@ -0,0 +1,12 @@
+# Runs a command-line tool for ctest: fails unless it exits with EXIT_CODE and
+# its stdout or stderr matches EXPECT. ARGS is the command with '|' between
+# arguments, since ';' does not survive add_test.
+
+string(REPLACE "|" ";" command "${ARGS}")
+execute_process(COMMAND ${command} RESULT_VARIABLE code OUTPUT_VARIABLE out ERROR_VARIABLE err)
+if(NOT code STREQUAL EXIT_CODE)
+    message(FATAL_ERROR "exit code ${code}, expected ${EXIT_CODE}\nstdout: ${out}\nstderr: ${err}")
+endif()
+if(NOT "${out}${err}" MATCHES "${EXPECT}")
+    message(FATAL_ERROR "output does not match '${EXPECT}'\nstdout: ${out}\nstderr: ${err}")
+endif()
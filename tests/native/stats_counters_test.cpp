@@ -0,0 +1,67 @@
+// Hot-path counters in a WCE_STATS build; the native counterpart of
+// tests/test_hot_path_stats.py, whose counter tests the default wheel skips.
+
+#include <wce/fast_exp_sketch.hpp>
+#include <wce/fast_k_q_sketch.hpp>
+#include <wce/fastgm_exp_sketch.hpp>
+#include <wce/k_q_sketch_shifted.hpp>
+#include <wce/log_exp_sketch_fast_shifted.hpp>
+#include <wce/q_sketch.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+static_assert(kStatsEnabled, "stats_counters_test must be built with WCE_STATS");
+
+namespace {
+
+constexpr std::size_t M = 64;
+constexpr std::size_t N = 2000;
+
+int failures = 0;
+
+void check(bool ok, const char* name, const char* what) {
+    if (!ok) {
+        std::fprintf(stderr, "%s: %s\n", name, what);
+        ++failures;
+    }
+}
+
+template <typename S>
+HotPathStats fill(S& sketch) {
+    for (std::size_t i = 0; i < N; ++i) { sketch.add("e" + std::to_string(i), 1.0 + static_cast<double>(i % 5)); }
+    return sketch.stats();
+}
+
+template <typename S>
+void counters_are_consistent(S sketch, const char* name) {
+    const HotPathStats s = fill(sketch);
+    check(s.adds == N, name, "adds == elements added");
+    check(s.adds <= s.iterations && s.iterations <= s.adds * M, name, "adds <= iterations <= adds * m");
+    check(s.early_exits <= s.adds, name, "early_exits <= adds");
+    check(s.register_updates > 0, name, "register_updates > 0");
+    sketch.reset_stats();
+    check(sketch.stats().adds == 0, name, "reset_stats() clears the counters");
+}
+
+}  // namespace
+
+int main() {
+    counters_are_consistent(FastExpSketch(M, 42), "FastExpSketch");
+    counters_are_consistent(FastGMExpSketch(M, 42), "FastGMExpSketch");
+    counters_are_consistent(QSketch(M, 42, 8), "QSketch");
+    counters_are_consistent(kQSketch(M, 42, 8, 2.0f), "kQSketch");
+    counters_are_consistent(kQSketchShifted(M, 42, 8, 2.0f), "kQSketchShifted");
+    counters_are_consistent(LogExpSketchFastShifted(M, 42, 10, 1e5), "LogExpSketchFastShifted");
+
+    FastExpSketch sketch(M, 42);
+    const HotPathStats s = fill(sketch);
+    check(static_cast<double>(s.early_exits) / static_cast<double>(s.adds) > 0.9, "FastExpSketch", "prunes once filled");
+    check(static_cast<double>(s.iterations) / static_cast<double>(s.adds) < M / 2.0, "FastExpSketch",
+          "iterations per add < m / 2");
+    check(s.window_shifts == 0, "FastExpSketch", "no window shifts");
+
+    if (failures == 0) { std::printf("stats counters: ok\n"); }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,172 @@
+"""AggregationServer / AggregationClient: named sketches behind a Unix domain socket."""
+
+import socket
+import struct
+import threading
+
+import pytest
+from weighted_cardinality_estimation import (
+    AggregationClient,
+    AggregationServer,
+    FastExpSketch,
+    HyperLogLog,
+    QSketch,
+)
+from weighted_cardinality_estimation.stat import elements_stream
+
+M = 256
+
+
+@pytest.fixture
+def serve(tmp_path):
+    """Starts a server for a prototype on a background thread; stops it after the test."""
+    running = []
+
+    def start(prototype):
+        server = AggregationServer(str(tmp_path / "wce.sock"), prototype)
+        thread = threading.Thread(target=server.serve)
+        thread.start()
+        running.append((server, thread))
+        return server
+
+    yield start
+    for server, thread in running:
+        server.stop()
+        thread.join()
+
+
+def test_workers_add_into_named_sketches(serve) -> None:
+    server = serve(QSketch(M, 3, amount_bits=8))
+    elems = elements_stream(8000, seed=1)
+    weights = [1.0 + i % 5 for i in range(len(elems))]
+
+    def worker(part: int) -> None:
+        client = AggregationClient(server.socket_path)
+        client.add_many("a", elems[part::4], weights[part::4])
+        client.add_many("b", elems[part::4])
+        client.close()
+
+    threads = [threading.Thread(target=worker, args=(p,)) for p in range(4)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+
+    expected_a = QSketch(M, 3, amount_bits=8)
+    expected_a.add_many(elems, weights)
+    expected_b = QSketch(M, 3, amount_bits=8)
+    expected_b.add_many(elems)
+    client = AggregationClient(server.socket_path)
+    assert client.estimate("a") == expected_a.estimate()
+    assert client.estimate("b") == expected_b.estimate()
+    assert QSketch.from_wire(client.fetch_wire("a")).get_registers() == expected_a.get_registers()
+
+
+def test_merge_sketches_and_wire_bytes(serve) -> None:
+    server = serve(FastExpSketch(M, 5))
+    client = AggregationClient(server.socket_path)
+    expected = FastExpSketch(M, 5)
+    for part in range(3):
+        sketch = FastExpSketch(M, 5)
+        sketch.add_many(elements_stream(500, seed=part))
+        expected.merge(sketch)
+        if part % 2 == 0:
+            client.merge("total", sketch)
+        else:
+            client.merge_wire("total", sketch.to_wire())
+    assert client.estimate("total") == expected.estimate()
+    assert FastExpSketch.from_wire(client.fetch_wire("total")).get_registers() == expected.get_registers()
+
+
+def test_unweighted_prototype(serve) -> None:
+    server = serve(HyperLogLog(M, 3))
+    client = AggregationClient(server.socket_path)
+    elems = elements_stream(4000, seed=1)
+    client.add_many("a", elems[:2000])
+    client.add_many("a", elems[2000:], [5.0] * 2000)  # weights are checked, then ignored
+    part = HyperLogLog(M, 3)
+    part.add_many(elements_stream(1000, seed=2))
+    client.merge("a", part)
+    with pytest.raises(ValueError):
+        client.add_many("a", ["x"], [-1.0])
+
+    expected = HyperLogLog(M, 3)
+    expected.add_many(elems)
+    expected.merge(part)
+    assert HyperLogLog.from_wire(client.fetch_wire("a")).get_registers() == expected.get_registers()
+    assert client.estimate("a") == expected.estimate()
+
+
+def test_unknown_name_reads_as_empty(serve) -> None:
+    server = serve(QSketch(M, 3, amount_bits=8))
+    client = AggregationClient(server.socket_path)
+    assert client.estimate("nobody") == 0.0
+    assert QSketch.from_wire(client.fetch_wire("nobody")).get_registers() == QSketch(M, 3, amount_bits=8).get_registers()
+
+
+def test_bad_requests_raise_and_change_nothing(serve) -> None:
+    server = serve(QSketch(M, 3, amount_bits=8))
+    client = AggregationClient(server.socket_path)
+    client.add_many("a", elements_stream(1000, seed=2))
+    before = client.fetch_wire("a")
+    with pytest.raises(ValueError):
+        client.add_many("a", ["x", "y"], [1.0, -1.0])
+    with pytest.raises(ValueError, match="sizes"):
+        client.merge("a", QSketch(M // 2, 3, amount_bits=8))
+    with pytest.raises(ValueError, match="seeds"):
+        client.merge("a", QSketch(M, 4, amount_bits=8))
+    with pytest.raises(ValueError):
+        client.merge_wire("a", b"not a sketch")
+    # The connection stays usable after an error.
+    assert client.fetch_wire("a") == before
+
+
+def test_failed_merge_wire_creates_no_sketch(serve) -> None:
+    server = serve(QSketch(M, 3, amount_bits=8))
+    client = AggregationClient(server.socket_path)
+    empty = client.fetch_wire("fresh")
+    # A QSketch blob whose rANS states are all zero.
+    forged = b"WCEW\x01\x01\x80\x02" + (3).to_bytes(8, "little") + b"\x08\x00\x01\x01\x00\xff\x1f\x10" + bytes(16)
+    with pytest.raises(ValueError):
+        client.merge_wire("fresh", forged)
+    with pytest.raises(ValueError):
+        client.merge_wire("fresh", QSketch(M, 3, amount_bits=8).to_wire()[:-1])
+    assert client.fetch_wire("fresh") == empty
+
+
+def test_pipelined_requests_all_get_replies(serve) -> None:
+    server = serve(FastExpSketch(M, 5))
+    client = AggregationClient(server.socket_path)
+    client.add_many("a", elements_stream(1000, seed=1))
+    expected = client.fetch_wire("a")
+    # Far more reply bytes than the server buffers per connection: it has to
+    # stop reading until the client catches up, then carry on.
+    count = 4 * (1 << 20) // len(expected) + 1
+    request = struct.pack("<IBI", 6, 4, 1) + b"a"
+    with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as sock:
+        sock.connect(server.socket_path)
+        writer = threading.Thread(target=lambda: (sock.sendall(request * count), sock.shutdown(socket.SHUT_WR)))
+        writer.start()
+        received = bytearray()
+        while chunk := sock.recv(1 << 16):
+            received += chunk
+        writer.join()
+    reply = struct.pack("<IB", len(expected) + 1, 0) + expected
+    assert received == reply * count
+
+
+def test_stop_ends_serve_and_closing_removes_socket(tmp_path) -> None:
+    path = tmp_path / "wce.sock"
+    server = AggregationServer(str(path), QSketch(M, 3, amount_bits=8))
+    thread = threading.Thread(target=server.serve)
+    thread.start()
+    assert path.exists()
+    with pytest.raises(RuntimeError):
+        AggregationServer(str(path), QSketch(M, 3, amount_bits=8))
+    server.stop()
+    thread.join(timeout=10)
+    assert not thread.is_alive()
+    del server
+    assert not path.exists()
+    with pytest.raises(RuntimeError):
+        AggregationClient(str(path))
@@ -1,8 +1,8 @@
 """Benchmarks: update throughput and estimate time for all sketches."""
 
 import pytest
-from conftest import SKETCH_SPECS, WEIGHTED_SPECS
-from weighted_cardinality_estimation.stat import elements_stream, weighted_stream
+from conftest import FAST_WEIGHTED_SPECS, SKETCH_SPECS, WEIGHTED_SPECS
+from weighted_cardinality_estimation.stat import elements_stream, skewed_stream, weighted_stream
 
 pytestmark = pytest.mark.benchmark
 
@@ -10,6 +10,7 @@ M = 128
 N = 500
 ELEMS = elements_stream(N)
 ELEMS_W, WEIGHTS = weighted_stream(N, 1e4, seed=0)
+ELEMS_Z, WEIGHTS_Z = skewed_stream(10 * N, N, seed=0)
 
 WEIGHTED_NAMES = {s.name for s in WEIGHTED_SPECS}
 
@@ -40,3 +41,14 @@ def test_bench_estimate(benchmark, spec) -> None:
     else:
         s.add_many(ELEMS)
     benchmark.pedantic(s.estimate, rounds=100)
+
+
+@pytest.mark.parametrize("pre_aggregate", [False, True], ids=["plain", "pre_aggregate"])
+@pytest.mark.parametrize("spec", FAST_WEIGHTED_SPECS, ids=lambda s: s.name)
+def test_bench_update_zipf(benchmark, spec, pre_aggregate) -> None:
+    """Benchmark: add_many on a Zipf(1.2) stream with repeated keys."""
+    benchmark.pedantic(
+        lambda s: s.add_many(ELEMS_Z, WEIGHTS_Z, pre_aggregate=pre_aggregate),
+        setup=lambda: ((spec.factory(M),), {}),
+        rounds=100,
+    )
@@ -0,0 +1,85 @@
+"""CheckpointFile / from_checkpoint: crash-consistent register checkpoints on disk."""
+
+import pytest
+from weighted_cardinality_estimation import (
+    CheckpointFile,
+    FastExpSketch,
+    FastExpSketchFloat32,
+    QSketch,
+    kQSketch,
+)
+from weighted_cardinality_estimation.stat import elements_stream
+
+M = 1024
+
+FACTORIES = [
+    pytest.param(QSketch, lambda m, seed: QSketch(m, seed, amount_bits=8), id="QSketch"),
+    pytest.param(kQSketch, lambda m, seed: kQSketch(m, seed, amount_bits=8, logarithm_base=2), id="kQSketch"),
+    pytest.param(FastExpSketch, lambda m, seed: FastExpSketch(m, seed), id="FastExpSketch"),
+    pytest.param(FastExpSketchFloat32, lambda m, seed: FastExpSketchFloat32(m, seed), id="FastExpSketchFloat32"),
+]
+
+
+@pytest.mark.parametrize(("cls", "make"), FACTORIES)
+def test_recover_latest_checkpoint(tmp_path, cls, make) -> None:
+    path = str(tmp_path / "sketch.ckpt")
+    sketch = make(M, 3)
+    checkpoint = CheckpointFile(path)
+    assert checkpoint.generation == 0
+    for part in range(3):
+        sketch.add_many(elements_stream(2000, seed=part))
+        checkpoint.write(sketch)
+        assert checkpoint.generation == part + 1
+    del checkpoint
+
+    recovered = cls.from_checkpoint(path)
+    assert recovered.get_registers() == sketch.get_registers()
+    assert recovered.estimate() == sketch.estimate()
+    # The recovered sketch continues exactly like the original.
+    more = elements_stream(500, seed=9)
+    recovered.add_many(more)
+    sketch.add_many(more)
+    assert recovered.get_registers() == sketch.get_registers()
+    assert CheckpointFile(path).generation == 3
+
+
+@pytest.mark.parametrize(("cls", "make"), FACTORIES)
+def test_each_write_keeps_the_state_it_staged(tmp_path, cls, make) -> None:
+    """Adds after a write change blocks the write's snapshot still shares."""
+    path = str(tmp_path / "sketch.ckpt")
+    sketch = make(M, 3)
+    checkpoint = CheckpointFile(path)
+    for part in range(6):
+        sketch.add_many(elements_stream(300 * (part + 1), seed=part))
+        checkpoint.write(sketch)
+        staged = sketch.get_registers()
+        sketch.add_many(elements_stream(200, seed=100 + part))
+        assert cls.from_checkpoint(path).get_registers() == staged
+
+
+def test_small_mode_sketch_is_checkpointed_dense(tmp_path) -> None:
+    path = str(tmp_path / "sketch.ckpt")
+    sketch = FastExpSketch(M, 3, small_capacity=64)
+    sketch.add_many(elements_stream(10, seed=1))
+    CheckpointFile(path).write(sketch)
+    assert FastExpSketch.from_checkpoint(path).get_registers() == sketch.get_registers()
+
+
+def test_errors(tmp_path) -> None:
+    path = str(tmp_path / "sketch.ckpt")
+    with pytest.raises(RuntimeError):
+        QSketch.from_checkpoint(path)
+    checkpoint = CheckpointFile(path)
+    checkpoint.write(QSketch(M, 3, amount_bits=8))
+    with pytest.raises(ValueError, match="different sketch"):
+        checkpoint.write(QSketch(M, 4, amount_bits=8))
+    with pytest.raises(ValueError, match="different sketch"):
+        checkpoint.write(FastExpSketch(M, 3))
+    with pytest.raises(ValueError, match="class"):
+        FastExpSketch.from_checkpoint(path)
+    assert checkpoint.generation == 1
+
+    junk = tmp_path / "junk"
+    junk.write_bytes(b"x" * 5000)
+    with pytest.raises(ValueError, match="Not a checkpoint"):
+        CheckpointFile(str(junk))
@@ -0,0 +1,108 @@
+"""track_changes / serialize_delta / apply_delta: replicating only the registers that changed."""
+
+import pytest
+from weighted_cardinality_estimation import FastExpSketch, FastExpSketchFloat32, kQSketch
+from weighted_cardinality_estimation.stat import elements_stream
+
+M = 1024
+
+FACTORIES = [
+    pytest.param(lambda m, seed: kQSketch(m, seed, amount_bits=8, logarithm_base=2), id="kQSketch"),
+    pytest.param(lambda m, seed: FastExpSketch(m, seed), id="FastExpSketch"),
+    pytest.param(lambda m, seed: FastExpSketchFloat32(m, seed), id="FastExpSketchFloat32"),
+]
+
+
+@pytest.mark.parametrize("make", FACTORIES)
+def test_replica_follows_primary(make) -> None:
+    primary, replica = make(M, 3), make(M, 3)
+    primary.track_changes()
+    epoch = primary.change_epoch
+    assert epoch == 0
+    for part in range(5):
+        primary.add_many(elements_stream(20000 if part == 0 else 1000, seed=part))
+        replica.apply_delta(primary.serialize_delta(epoch))
+        assert primary.change_epoch == epoch + 1
+        epoch = primary.change_epoch
+        assert primary.pending_changes == 0
+        assert replica.get_registers() == primary.get_registers()
+        assert replica.estimate() == primary.estimate()
+
+
+@pytest.mark.parametrize("make", FACTORIES)
+def test_settled_deltas_are_small(make) -> None:
+    primary = make(M, 3)
+    primary.track_changes()
+    primary.add_many(elements_stream(50000, seed=1))
+    primary.serialize_delta(0)
+    primary.add_many(elements_stream(1000, seed=2))
+    assert 0 < primary.pending_changes < M // 4
+    assert len(primary.serialize_delta(1)) < len(primary.to_wire()) // 4
+    assert primary.pending_changes == 0
+
+
+@pytest.mark.parametrize("make", FACTORIES)
+def test_duplicate_and_stale_deltas(make) -> None:
+    primary, replica = make(M, 3), make(M, 3)
+    primary.track_changes()
+    primary.add_many(elements_stream(5000, seed=1))
+    first = primary.serialize_delta(0)
+    primary.add_many(elements_stream(5000, seed=2))
+    second = primary.serialize_delta(1)
+    # Merge semantics: order and repetition do not matter.
+    replica.apply_delta(second)
+    replica.apply_delta(first)
+    replica.apply_delta(second)
+    assert replica.get_registers() == primary.get_registers()
+
+    # A replica that missed deltas passes its old epoch and gets a full resync.
+    late = make(M, 3)
+    late.apply_delta(primary.serialize_delta(0))
+    assert late.get_registers() == primary.get_registers()
+
+
+@pytest.mark.parametrize("make", FACTORIES)
+def test_first_delta_carries_data_added_before_tracking(make) -> None:
+    primary, replica = make(M, 3), make(M, 3)
+    primary.add_many(elements_stream(5000, seed=1))
+    primary.track_changes()
+    assert primary.pending_changes == M
+    replica.apply_delta(primary.serialize_delta(0))
+    assert replica.get_registers() == primary.get_registers()
+    assert primary.pending_changes == 0
+
+
+def test_tracking_promotes_small_mode() -> None:
+    primary = FastExpSketch(M, 3, small_capacity=64)
+    primary.add_many(elements_stream(10, seed=1))
+    assert primary.small_mode
+    primary.track_changes()
+    assert not primary.small_mode
+    replica = FastExpSketch(M, 3)
+    replica.apply_delta(primary.serialize_delta(0))
+    assert replica.get_registers() == primary.get_registers()
+
+
+def test_errors_change_nothing() -> None:
+    primary = kQSketch(M, 3, amount_bits=8, logarithm_base=2)
+    with pytest.raises(ValueError, match="track_changes"):
+        primary.serialize_delta(0)
+    primary.track_changes()
+    primary.add_many(elements_stream(5000, seed=1))
+    with pytest.raises(ValueError):
+        primary.serialize_delta(1)
+    delta = primary.serialize_delta(0)
+
+    replica = kQSketch(M, 3, amount_bits=8, logarithm_base=2)
+    before = replica.get_registers()
+    with pytest.raises(ValueError, match="seeds"):
+        kQSketch(M, 4, amount_bits=8, logarithm_base=2).apply_delta(delta)
+    with pytest.raises(ValueError, match="sizes"):
+        kQSketch(M // 2, 3, amount_bits=8, logarithm_base=2).apply_delta(delta)
+    with pytest.raises(ValueError):
+        replica.apply_delta(primary.to_wire())
+    with pytest.raises(ValueError):
+        replica.apply_delta(delta[:-3])
+    with pytest.raises(ValueError):
+        FastExpSketch(M, 3).apply_delta(delta)
+    assert replica.get_registers() == before
@@ -1,11 +1,17 @@
-"""Tests for FastExpSketchCustomFloat clone_with() feature.
+"""Tests for FastExpSketchCustomFloat clone_with() and bit-packed register storage.
 
 Basic contract, merge, jaccard, pickle, and memory tests are covered by the
 parametric suite via conftest SKETCH_SPECS.
 """
 
+import pickle
+
 import pytest
-from weighted_cardinality_estimation import FastExpSketchCustomFloat
+from weighted_cardinality_estimation import (
+    FastExpSketchCustomFloat,
+    MemoryFlag,
+    WeightedHyperLogLogCustomFloat,
+)
 from weighted_cardinality_estimation.stat import elements_stream
 
 M = 64
@@ -66,3 +72,27 @@ class TestCloneWith:
         s_a_cloned = s_a_high.clone_with(exp_bits=6, mant_bits=5)
         s_b_cloned = s_b_high.clone_with(exp_bits=6, mant_bits=5)
         assert s_a_cloned.jaccard_struct(s_b_cloned) == s_a_low.jaccard_struct(s_b_low)
+
+
+def packed_bytes(m: int, exp_bits: int, mant_bits: int) -> int:
+    return (m * (exp_bits + mant_bits) + 63) // 64 * 8
+
+
+@pytest.mark.parametrize("cls", [FastExpSketchCustomFloat, WeightedHyperLogLogCustomFloat])
+class TestPackedRegisters:
+    @pytest.mark.parametrize(("exp_bits", "mant_bits"), [(2, 1), (5, 10), (8, 7), (11, 52)])
+    def test_register_memory_is_packed(self, cls, exp_bits, mant_bits) -> None:
+        s = cls(1000, seed=42, exp_bits=exp_bits, mant_bits=mant_bits)
+        assert s.memory_usage(MemoryFlag.REGISTERS) == packed_bytes(1000, exp_bits, mant_bits)
+
+    def test_registers_round_trip(self, cls) -> None:
+        s = cls(M, seed=42, exp_bits=5, mant_bits=10)
+        s.add_many(elements_stream(500, seed=0))
+        restored = pickle.loads(pickle.dumps(s))
+        assert restored.get_registers() == s.get_registers()
+        assert restored.estimate() == s.estimate()
+
+    @pytest.mark.parametrize(("exp_bits", "mant_bits"), [(0, 4), (12, 4), (5, 53), (5, -1)])
+    def test_unencodable_format_raises(self, cls, exp_bits, mant_bits) -> None:
+        with pytest.raises(ValueError):
+            cls(M, seed=42, exp_bits=exp_bits, mant_bits=mant_bits)
@@ -0,0 +1,102 @@
+"""FastExpSketchFloat16 / FastExpSketchBFloat16: 16-bit register storage.
+
+Basic contract, merge, jaccard and memory-flag tests are covered by the
+parametric suite via conftest SKETCH_SPECS.
+"""
+
+import pickle
+
+import numpy as np
+import pytest
+from weighted_cardinality_estimation import (
+    FastExpSketchBFloat16,
+    FastExpSketchFloat16,
+    FastExpSketchFloat32,
+    MemoryFlag,
+)
+from weighted_cardinality_estimation.stat import elements_stream
+
+M = 400
+
+
+def _bfloat16(values: list[float]) -> np.ndarray:
+    """Round float32 values to bfloat16 (nearest even) and widen back."""
+    bits = np.asarray(values, dtype=np.float32).view(np.uint32)
+    rounded = (bits + 0x7FFF + ((bits >> 16) & 1)) & 0xFFFF0000
+    return rounded.astype(np.uint32).view(np.float32)
+
+
+# Each register type with a numpy reference for its rounding.
+TYPES = [
+    pytest.param(FastExpSketchFloat16, lambda v: np.asarray(v, np.float32).astype(np.float16).astype(np.float32),
+                 id="Float16"),
+    pytest.param(FastExpSketchBFloat16, _bfloat16, id="BFloat16"),
+]
+
+
+@pytest.mark.parametrize(("cls", "round_to"), TYPES)
+def test_registers_are_rounded_float32(cls, round_to) -> None:
+    elems = elements_stream(1000, seed=0)
+    sketch = cls(M, seed=1)
+    reference = FastExpSketchFloat32(M, seed=1)
+    sketch.add_many(elems)
+    reference.add_many(elems)
+    registers = sketch.get_registers()
+    assert registers == round_to(registers).tolist()
+    # Both track the same minima; rounding moves each by at most one 16-bit
+    # ulp (2^-24 absolute for binary16 subnormals).
+    np.testing.assert_allclose(registers, reference.get_registers(), rtol=2.0**-7, atol=2.0**-24)
+
+
+@pytest.mark.parametrize(("cls", "round_to"), TYPES)
+def test_estimate_close_to_float32(cls, round_to) -> None:
+    elems = elements_stream(2000, seed=3)
+    sketch = cls(M, seed=5)
+    reference = FastExpSketchFloat32(M, seed=5)
+    sketch.add_many(elems, [2.5] * len(elems))
+    reference.add_many(elems, [2.5] * len(elems))
+    assert sketch.estimate() == pytest.approx(reference.estimate(), rel=0.01)
+
+
+@pytest.mark.parametrize(("cls", "round_to"), TYPES)
+def test_register_memory_is_half_of_float32(cls, round_to) -> None:
+    sketch = cls(M, seed=1)
+    reference = FastExpSketchFloat32(M, seed=1)
+    assert sketch.memory_usage(MemoryFlag.REGISTERS) * 2 == reference.memory_usage(MemoryFlag.REGISTERS)
+
+
+@pytest.mark.parametrize(("cls", "round_to"), TYPES)
+def test_merge_equals_single_stream(cls, round_to) -> None:
+    elems = elements_stream(1000, seed=2)
+    whole = cls(M, seed=7)
+    whole.add_many(elems)
+    a = cls(M, seed=7)
+    b = cls(M, seed=7)
+    a.add_many(elems[:500])
+    b.add_many(elems[500:])
+    a.merge(b)
+    assert a.get_registers() == whole.get_registers()
+    assert a.jaccard_struct(whole) == 1.0
+
+
+@pytest.mark.parametrize(("cls", "round_to"), TYPES)
+def test_pickle_round_trip(cls, round_to) -> None:
+    sketch = cls(M, seed=4)
+    sketch.add_many(elements_stream(300, seed=4))
+    restored = pickle.loads(pickle.dumps(sketch))
+    assert restored.get_registers() == sketch.get_registers()
+    assert restored.estimate() == sketch.estimate()
+
+
+def test_float16_range_saturates() -> None:
+    """binary16 tops out at 65504: registers of tiny weights become inf, huge ones 0."""
+    light = FastExpSketchFloat16(64, seed=0)
+    light.add("x", 1e-9)
+    assert any(r == float("inf") for r in light.get_registers())
+    heavy = FastExpSketchFloat16(64, seed=0)
+    heavy.add("x", 1e12)
+    assert min(heavy.get_registers()) == 0.0
+    # bfloat16 keeps float32's range.
+    wide = FastExpSketchBFloat16(64, seed=0)
+    wide.add("x", 1e12)
+    assert min(wide.get_registers()) > 0.0
@@ -0,0 +1,117 @@
+"""HashScheme: versioned bucket selection of the stochastic-averaging sketches."""
+
+import pickle
+
+import pytest
+from weighted_cardinality_estimation import (
+    HashScheme,
+    QSketchDyn,
+    WeightedHyperLogLog,
+    WeightedHyperLogLogCustomFloat,
+    kQSketchRoundedDyn,
+)
+from weighted_cardinality_estimation.stat import elements_stream, relative_error
+
+M = 64
+
+FACTORIES = {
+    "WeightedHyperLogLog": lambda m, scheme: WeightedHyperLogLog(m, seed=3, hash_scheme=scheme),
+    "WeightedHyperLogLogCustomFloat": lambda m, scheme: WeightedHyperLogLogCustomFloat(
+        m, seed=3, exp_bits=8, mant_bits=7, hash_scheme=scheme,
+    ),
+    "QSketchDyn": lambda m, scheme: QSketchDyn(m, seed=3, amount_bits=8, hash_scheme=scheme),
+    "kQSketchRoundedDyn": lambda m, scheme: kQSketchRoundedDyn(
+        m, seed=3, amount_bits=8, logarithm_base=2, hash_scheme=scheme,
+    ),
+}
+MERGEABLE = ["WeightedHyperLogLog", "WeightedHyperLogLogCustomFloat"]
+
+
+def _restore_legacy(sketch):
+    """Rebuild a sketch from its state without the trailing scheme field (pre-HashScheme pickle)."""
+    cls = type(sketch)
+    restored = cls.__new__(cls)
+    restored.__setstate__(sketch.__getstate__()[:-1])
+    return restored
+
+
+@pytest.fixture(params=list(FACTORIES), ids=lambda name: name)
+def factory(request):
+    return FACTORIES[request.param]
+
+
+def test_default_is_multiply_high() -> None:
+    defaults = [
+        WeightedHyperLogLog(M, seed=3),
+        WeightedHyperLogLogCustomFloat(M, seed=3, exp_bits=8, mant_bits=7),
+        QSketchDyn(M, seed=3, amount_bits=8),
+        kQSketchRoundedDyn(M, seed=3, amount_bits=8, logarithm_base=2),
+    ]
+    assert all(s.hash_scheme == HashScheme.MULTIPLY_HIGH_128 for s in defaults)
+
+
+@pytest.mark.parametrize("scheme", [HashScheme.MODULO_TWO_HASHES, HashScheme.MULTIPLY_HIGH_128])
+def test_pickle_preserves_scheme(factory, scheme) -> None:
+    sketch = factory(M, scheme)
+    sketch.add_many(elements_stream(50, seed=0))
+    restored = pickle.loads(pickle.dumps(sketch))
+    assert restored.hash_scheme == scheme
+    elems = elements_stream(50, seed=1)
+    sketch.add_many(elems)
+    restored.add_many(elems)
+    assert restored.__getstate__() == sketch.__getstate__()
+
+
+def test_legacy_state_restores_as_modulo(factory) -> None:
+    """States written before HashScheme existed keep their original bucket mapping."""
+    sketch = factory(M, HashScheme.MODULO_TWO_HASHES)
+    sketch.add_many(elements_stream(50, seed=0))
+    restored = _restore_legacy(sketch)
+    assert restored.hash_scheme == HashScheme.MODULO_TWO_HASHES
+    elems = elements_stream(50, seed=1)
+    sketch.add_many(elems)
+    restored.add_many(elems)
+    assert restored.get_registers() == sketch.get_registers()
+    assert restored.estimate() == sketch.estimate()
+
+
+@pytest.mark.parametrize("name", MERGEABLE)
+def test_legacy_state_stays_mergeable(name) -> None:
+    elems_a = elements_stream(50, seed=0)
+    elems_b = elements_stream(50, seed=1)
+    old = FACTORIES[name](M, HashScheme.MODULO_TWO_HASHES)
+    old.add_many(elems_a)
+    old = _restore_legacy(old)
+    fresh = FACTORIES[name](M, HashScheme.MODULO_TWO_HASHES)
+    fresh.add_many(elems_b)
+    combined = FACTORIES[name](M, HashScheme.MODULO_TWO_HASHES)
+    combined.add_many(elems_a + elems_b)
+    old.merge(fresh)
+    assert old.estimate() == combined.estimate()
+
+
+@pytest.mark.parametrize("name", MERGEABLE)
+def test_merge_scheme_mismatch_raises(name) -> None:
+    a = FACTORIES[name](M, HashScheme.MODULO_TWO_HASHES)
+    b = FACTORIES[name](M, HashScheme.MULTIPLY_HIGH_128)
+    with pytest.raises(ValueError):
+        a.merge(b)
+
+
+def test_schemes_route_differently(factory) -> None:
+    a = factory(M, HashScheme.MODULO_TWO_HASHES)
+    b = factory(M, HashScheme.MULTIPLY_HIGH_128)
+    elems = elements_stream(100, seed=0)
+    a.add_many(elems)
+    b.add_many(elems)
+    assert a.get_registers() != b.get_registers()
+
+
+@pytest.mark.parametrize("name", ["QSketchDyn", "kQSketchRoundedDyn"])
+def test_multiply_high_accuracy(name) -> None:
+    errors = []
+    for seed in range(3):
+        sketch = FACTORIES[name](400, HashScheme.MULTIPLY_HIGH_128)
+        sketch.add_many(elements_stream(500, seed=seed))
+        errors.append(relative_error(sketch.estimate(), 500))
+    assert sorted(errors)[1] <= 0.07
@@ -0,0 +1,58 @@
+"""sketch.stats(): hot-path counters, compiled in only with -DWCE_ENABLE_STATS=ON."""
+
+import pytest
+from conftest import M
+from weighted_cardinality_estimation import (
+    STATS_ENABLED,
+    FastExpSketch,
+    FastGMExpSketch,
+    LogExpSketchFastShifted,
+    QSketch,
+    kQSketch,
+    kQSketchShifted,
+)
+from weighted_cardinality_estimation.stat import weighted_stream
+
+INSTRUMENTED = {
+    "FastExpSketch": lambda: FastExpSketch(M, seed=42),
+    "FastGMExpSketch": lambda: FastGMExpSketch(M, seed=42),
+    "QSketch": lambda: QSketch(M, seed=42, amount_bits=8),
+    "kQSketch": lambda: kQSketch(M, seed=42, amount_bits=8, logarithm_base=2),
+    "kQSketchShifted": lambda: kQSketchShifted(M, seed=42, amount_bits=8, logarithm_base=2),
+    "LogExpSketchFastShifted": lambda: LogExpSketchFastShifted(M, seed=42, amount_bits=10, v_max=1e5),
+}
+
+ELEMS, WEIGHTS = weighted_stream(2000, 2000.0, seed=1)
+
+
+@pytest.mark.skipif(STATS_ENABLED, reason="default build without stats")
+def test_stats_unavailable_without_build_flag() -> None:
+    sketch = FastExpSketch(M, seed=42)
+    sketch.reset_stats()
+    with pytest.raises(RuntimeError):
+        sketch.stats()
+
+
+@pytest.mark.skipif(not STATS_ENABLED, reason="needs -DWCE_ENABLE_STATS=ON")
+@pytest.mark.parametrize("name", INSTRUMENTED)
+def test_counters_are_consistent(name) -> None:
+    sketch = INSTRUMENTED[name]()
+    sketch.add_many(ELEMS, WEIGHTS)
+    s = sketch.stats()
+    assert s.adds == len(ELEMS)
+    assert s.adds <= s.iterations <= s.adds * M
+    assert s.early_exits <= s.adds
+    assert s.iterations_per_add == pytest.approx(s.iterations / s.adds)
+    assert s.prune_rate == pytest.approx(s.early_exits / s.adds)
+    sketch.reset_stats()
+    assert sketch.stats().adds == 0
+
+
+@pytest.mark.skipif(not STATS_ENABLED, reason="needs -DWCE_ENABLE_STATS=ON")
+def test_fast_exp_prunes_once_filled() -> None:
+    sketch = FastExpSketch(M, seed=42)
+    sketch.add_many(ELEMS, WEIGHTS)
+    s = sketch.stats()
+    assert s.prune_rate > 0.9
+    assert s.iterations_per_add < M / 2
+    assert s.window_shifts == 0
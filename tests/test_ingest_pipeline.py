@@ -0,0 +1,72 @@
+"""IngestPipeline: threaded hashing, in-order register updates."""
+
+import pytest
+from conftest import M
+from weighted_cardinality_estimation import (
+    IngestPipeline,
+    MartingaleMinHash,
+    QSketchDyn,
+    kQSketchRoundedDyn,
+)
+from weighted_cardinality_estimation.stat import skewed_stream
+
+WEIGHTED = [
+    pytest.param(lambda: QSketchDyn(M, 7, amount_bits=8), id="QSketchDyn"),
+    pytest.param(lambda: kQSketchRoundedDyn(M, 7, amount_bits=8, logarithm_base=2), id="kQSketchRoundedDyn"),
+]
+
+
+@pytest.mark.parametrize("make", WEIGHTED)
+@pytest.mark.parametrize("producers", [1, 3])
+@pytest.mark.parametrize("n", [100, 20_000])
+def test_matches_sequential_add(make, producers, n) -> None:
+    elems, weights = skewed_stream(n, n // 4, seed=1)
+    plain = make()
+    piped = make()
+    plain.add_many(elems, weights)
+    pipeline = IngestPipeline(piped, producers=producers, ring_capacity=16)
+    pipeline.add_many(elems, weights)
+    assert pipeline.producers == producers
+    assert piped.get_registers() == plain.get_registers()
+    assert piped.estimate() == plain.estimate()
+
+
+@pytest.mark.parametrize("make", WEIGHTED)
+def test_batches_continue_the_stream(make) -> None:
+    elems, weights = skewed_stream(30_000, 5_000, seed=2)
+    plain = make()
+    piped = make()
+    plain.add_many(elems, weights)
+    pipeline = IngestPipeline(piped, producers=2)
+    for start in range(0, len(elems), 7_000):
+        pipeline.add_many(elems[start:start + 7_000], weights[start:start + 7_000])
+    assert piped.estimate() == plain.estimate()
+
+
+def test_unweighted_sketch() -> None:
+    elems = [f"e{i % 9_000}" for i in range(20_000)]
+    plain = MartingaleMinHash(M, 7)
+    piped = MartingaleMinHash(M, 7)
+    plain.add_many(elems)
+    IngestPipeline(piped, producers=2).add_many(elems)
+    assert piped.get_registers() == plain.get_registers()
+    assert piped.estimate() == plain.estimate()
+
+
+def test_bad_weight_leaves_sketch_untouched() -> None:
+    sketch = QSketchDyn(M, 7, amount_bits=8)
+    pipeline = IngestPipeline(sketch, producers=2)
+    elems = [f"e{i}" for i in range(10_000)]
+    weights = [1.0] * len(elems)
+    weights[-1] = -1.0
+    with pytest.raises(ValueError):
+        pipeline.add_many(elems, weights)
+    assert sketch.estimate() == 0.0
+    with pytest.raises(ValueError):
+        pipeline.add_many(elems, weights[:-1])
+
+
+def test_keeps_sketch_alive() -> None:
+    pipeline = IngestPipeline(QSketchDyn(M, 7, amount_bits=8))
+    pipeline.add_many([f"e{i}" for i in range(5_000)], [1.0] * 5_000)
+    assert pipeline.producers >= 1
@@ -24,6 +24,8 @@ def test_jaccard_same_sketch_is_one_weighted(weighted_jaccard_spec) -> None:
 
 
 def test_jaccard_disjoint_near_zero(jaccard_spec) -> None:
+    if jaccard_spec.jaccard_disjoint_max is not None:
+        pytest.skip("quantized registers: see test_jaccard_disjoint_quantized")
     s1 = jaccard_spec.factory(64, seed=0)
     s2 = jaccard_spec.factory(64, seed=0)
     s1.add_many(elements_stream(50, seed=1))
@@ -32,6 +34,18 @@ def test_jaccard_disjoint_near_zero(jaccard_spec) -> None:
     assert 0 <= j <= 0.05
 
 
+def test_jaccard_disjoint_quantized(jaccard_spec) -> None:
+    """Disjoint sets with quantized registers: chance collisions allow a wider bound."""
+    if jaccard_spec.jaccard_disjoint_max is None:
+        pytest.skip("exact registers: see test_jaccard_disjoint_near_zero")
+    s1 = jaccard_spec.factory(64, seed=0)
+    s2 = jaccard_spec.factory(64, seed=0)
+    s1.add_many(elements_stream(50, seed=1))
+    s2.add_many(elements_stream(50, seed=2))
+    j = s1.jaccard_struct(s2)
+    assert 0 <= j <= jaccard_spec.jaccard_disjoint_max
+
+
 def test_jaccard_in_valid_range(weighted_jaccard_spec) -> None:
     (ea, wa), (eb, wb) = jaccard_streams(100, 500.0, 0.5)
     s1 = weighted_jaccard_spec.factory(64, seed=0)
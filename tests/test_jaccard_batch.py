@@ -0,0 +1,67 @@
+"""jaccard_matrix() / jaccard_topk(): batched Jaccard over many sketches of one type."""
+
+import pytest
+from weighted_cardinality_estimation import (
+    FastExpSketch,
+    HyperLogLog,
+    QSketch,
+    jaccard_matrix,
+    jaccard_topk,
+)
+from weighted_cardinality_estimation.stat import elements_stream
+
+N_SKETCHES = 12
+
+
+def _population(spec, m: int = 64):
+    """Sketches over overlapping windows of one stream, so similarities vary."""
+    elems = elements_stream(400, seed=3)
+    sketches = []
+    for i in range(N_SKETCHES):
+        s = spec.factory(m, seed=0)
+        s.add_many(elems[i * 20 : i * 20 + 100])
+        sketches.append(s)
+    return sketches
+
+
+def test_matrix_matches_pairwise(jaccard_spec) -> None:
+    sketches = _population(jaccard_spec)
+    matrix = jaccard_matrix(sketches, threads=2)
+    assert len(matrix) == N_SKETCHES
+    for i, a in enumerate(sketches):
+        assert matrix[i][i] == 1.0
+        for j, b in enumerate(sketches):
+            if i != j:
+                assert matrix[i][j] == pytest.approx(a.jaccard_struct(b), abs=1e-12)
+                assert matrix[i][j] == matrix[j][i]
+
+
+def test_topk_matches_sorted_pairwise(jaccard_spec) -> None:
+    sketches = _population(jaccard_spec)
+    query = sketches[5]
+    expected = sorted(((i, query.jaccard_struct(s)) for i, s in enumerate(sketches)),
+                      key=lambda p: (-p[1], p[0]))
+    top = jaccard_topk(query, sketches, 4)
+    assert [i for i, _ in top] == [i for i, _ in expected[:4]]
+    for (_, got), (_, want) in zip(top, expected):
+        assert got == pytest.approx(want, abs=1e-12)
+
+
+def test_topk_k_larger_than_population() -> None:
+    sketches = [QSketch(64, seed=0, amount_bits=8) for _ in range(3)]
+    for i, s in enumerate(sketches):
+        s.add_many(elements_stream(50, seed=i))
+    assert len(jaccard_topk(sketches[0], sketches, 10)) == 3
+    assert jaccard_topk(sketches[0], sketches, 0) == []
+    assert jaccard_matrix([]) == []
+
+
+def test_rejects_mismatched_sketches() -> None:
+    with pytest.raises(ValueError):
+        jaccard_matrix([FastExpSketch(64, seed=0), QSketch(64, seed=0, amount_bits=8)])
+    with pytest.raises(ValueError):
+        jaccard_matrix([FastExpSketch(64, seed=0), FastExpSketch(32, seed=0)])
+    with pytest.raises(ValueError):
+        jaccard_matrix([QSketch(64, seed=0, amount_bits=8), QSketch(64, seed=0, amount_bits=6)])
+    with pytest.raises(ValueError):
+        jaccard_topk(HyperLogLog(64, seed=0), [HyperLogLog(64, seed=0)], 1)
@@ -0,0 +1,98 @@
+"""KeyedSketchMap: per-key sketches match a dict of sketches fed row by row."""
+
+import numpy as np
+import pytest
+from weighted_cardinality_estimation import (
+    FastExpSketch,
+    KeyedSketchMap,
+    QSketch,
+    WeightedHyperLogLog,
+)
+from weighted_cardinality_estimation.stat import elements_stream
+
+M = 64
+
+
+def _rows(n: int, n_keys: int, seed: int):
+    elems = elements_stream(n, seed=seed)
+    keys = [f"group-{(i * 7919) % n_keys}" for i in range(n)]
+    weights = [1.0 + (i % 5) for i in range(n)]
+    return keys, elems, weights
+
+
+PROTOTYPES = [
+    pytest.param(lambda: FastExpSketch(M, 5), id="FastExpSketch"),
+    pytest.param(lambda: QSketch(M, 5, amount_bits=8), id="QSketch"),
+    pytest.param(lambda: WeightedHyperLogLog(M, 5), id="WeightedHyperLogLog"),
+]
+
+
+@pytest.mark.parametrize("make", PROTOTYPES)
+@pytest.mark.parametrize("n_keys", [1, 40, 700])
+def test_matches_dict_of_sketches(make, n_keys) -> None:
+    keys, elems, weights = _rows(5000, n_keys, seed=1)
+    grouped = KeyedSketchMap(make())
+    grouped.add_many(keys, elems, weights)
+    grouped.add("late-key", "x", 2.0)
+
+    expected = {}
+    for k, e, w in zip(keys, elems, weights):
+        expected.setdefault(k, make()).add(e, w)
+    expected.setdefault("late-key", make()).add("x", 2.0)
+
+    assert grouped.keys() == list(expected)
+    assert len(grouped) == len(expected)
+    for k, sketch in expected.items():
+        assert grouped.get(k).get_registers() == sketch.get_registers()
+        assert grouped.estimate(k) == sketch.estimate()
+
+    estimates = grouped.estimate_all()
+    assert isinstance(estimates, np.ndarray)
+    assert estimates.dtype == np.float64
+    assert estimates.tolist() == [s.estimate() for s in expected.values()]
+
+
+def test_prototype_contents_are_copied() -> None:
+    prototype = FastExpSketch(M, 5)
+    prototype.add("shared", 3.0)
+    grouped = KeyedSketchMap(prototype)
+    grouped.add("a", "x", 1.0)
+    prototype.add("not-seen", 100.0)
+
+    expected = FastExpSketch(M, 5)
+    expected.add("shared", 3.0)
+    expected.add("x", 1.0)
+    assert grouped.get("a").get_registers() == expected.get_registers()
+
+
+def test_merge_matches_single_map() -> None:
+    keys, elems, weights = _rows(4000, 50, seed=2)
+    half = len(keys) // 2
+    left = KeyedSketchMap(FastExpSketch(M, 5))
+    right = KeyedSketchMap(FastExpSketch(M, 5))
+    whole = KeyedSketchMap(FastExpSketch(M, 5))
+    left.add_many(keys[:half], elems[:half], weights[:half])
+    right.add_many(keys[half:], elems[half:], weights[half:])
+    right.add("only-right", "y", 4.0)
+    whole.add_many(keys, elems, weights)
+    whole.add("only-right", "y", 4.0)
+
+    left.merge(right)
+    assert sorted(left.keys()) == sorted(whole.keys())
+    for k in whole.keys():
+        assert left.get(k).get_registers() == whole.get(k).get_registers()
+
+
+def test_rejects_bad_input() -> None:
+    grouped = KeyedSketchMap(QSketch(M, 5, amount_bits=8))
+    grouped.add("a", "x", 1.0)
+    assert "a" in grouped
+    assert "b" not in grouped
+    with pytest.raises(KeyError):
+        grouped.estimate("b")
+    with pytest.raises(KeyError):
+        grouped.get("b")
+    with pytest.raises(ValueError):
+        grouped.add_many(["a", "b"], ["x"], [1.0])
+    with pytest.raises(TypeError):
+        grouped.merge(KeyedSketchMap(FastExpSketch(M, 5)))
@@ -0,0 +1,135 @@
+"""LshIndex: banded candidate search verified against jaccard_struct, and its file format."""
+
+import pytest
+from weighted_cardinality_estimation import FastExpSketch, HyperLogLog, LshIndex, MinHash, QSketch
+from weighted_cardinality_estimation.stat import elements_stream
+
+CLUSTERS = 20
+PER_CLUSTER = 4
+
+
+def _clustered(factory):
+    """CLUSTERS groups of PER_CLUSTER near-duplicate sets; groups are disjoint."""
+    sketches = []
+    for c in range(CLUSTERS):
+        base = elements_stream(120, seed=100 + c)
+        for k in range(PER_CLUSTER):
+            s = factory()
+            s.add_many(base[k * 5 : k * 5 + 100])
+            sketches.append(s)
+    return sketches
+
+
+@pytest.fixture(params=[
+    lambda: FastExpSketch(128, seed=1),
+    lambda: MinHash(128, seed=1),
+], ids=["FastExpSketch", "MinHash"])
+def population(request):
+    sketches = _clustered(request.param)
+    index = LshIndex(bands=16, rows=4)
+    for i, s in enumerate(sketches):
+        assert index.insert(s) == i
+    return index, sketches
+
+
+def test_query_finds_cluster_and_matches_jaccard_struct(population) -> None:
+    index, sketches = population
+    query = sketches[9]
+    found = index.query(query, threshold=0.5)
+    cluster = set(range(8, 12))
+    assert cluster <= {i for i, _ in found}
+    for i, j in found:
+        assert j == pytest.approx(query.jaccard_struct(sketches[i]), abs=1e-12)
+        assert j >= 0.5
+    assert [j for _, j in found] == sorted((j for _, j in found), reverse=True)
+    assert set(index.candidates(query)) >= {i for i, _ in found}
+
+
+def test_pairs_cover_near_duplicates(population) -> None:
+    index, sketches = population
+    pairs = index.pairs(threshold=0.5)
+    assert pairs == sorted(pairs)
+    got = {(i, j) for i, j, _ in pairs}
+    for c in range(CLUSTERS):
+        first = c * PER_CLUSTER
+        for i in range(first, first + PER_CLUSTER):
+            for j in range(i + 1, first + PER_CLUSTER):
+                if sketches[i].jaccard_struct(sketches[j]) >= 0.9:
+                    assert (i, j) in got
+    for i, j, jac in pairs:
+        assert i < j
+        assert jac == pytest.approx(sketches[i].jaccard_struct(sketches[j]), abs=1e-12)
+
+
+def test_save_open_round_trip(population, tmp_path) -> None:
+    index, sketches = population
+    path = str(tmp_path / "index.lsh")
+    index.save(path)
+    reopened = LshIndex.open(path)
+    assert len(reopened) == len(index)
+    assert (reopened.bands, reopened.rows) == (16, 4)
+    assert reopened.pairs(0.5) == index.pairs(0.5)
+    assert reopened.query(sketches[0]) == index.query(sketches[0])
+
+    # Inserting into a mapped index copies it; saving over its own file is safe.
+    extra = type(sketches[0])(128, seed=1)
+    extra.add_many(elements_stream(50, seed=999))
+    assert reopened.insert(extra) == len(sketches)
+    reopened.save(path)
+    assert len(LshIndex.open(path)) == len(sketches) + 1
+    assert reopened.query(extra, threshold=0.99)[0][0] == len(sketches)
+
+
+def test_quantized_sketches() -> None:
+    sketches = _clustered(lambda: QSketch(64, seed=1, amount_bits=8))
+    index = LshIndex(bands=8, rows=2)
+    for s in sketches:
+        index.insert(s)
+    for i, j in index.query(sketches[0], threshold=0.3):
+        assert j == pytest.approx(sketches[0].jaccard_struct(sketches[i]), abs=1e-12)
+
+
+def test_rejects_bad_input(tmp_path) -> None:
+    with pytest.raises(ValueError):
+        LshIndex(bands=0, rows=4)
+    with pytest.raises(ValueError):
+        LshIndex(bands=2, rows=2**63 + 1)  # bands * rows wraps to 2
+    index = LshIndex(bands=16, rows=4)
+    with pytest.raises(ValueError):
+        index.insert(FastExpSketch(32, seed=1))
+    index.insert(FastExpSketch(128, seed=1))
+    with pytest.raises(ValueError):
+        index.insert(MinHash(128, seed=1))
+    with pytest.raises(ValueError):
+        index.insert(HyperLogLog(128, seed=1))
+    bad = tmp_path / "bad.lsh"
+    bad.write_bytes(b"not an index")
+    with pytest.raises(RuntimeError):
+        LshIndex.open(str(bad))
+
+
+
+def _forge_rows(tmp_path, index, rows):
+    path = tmp_path / "index.lsh"
+    index.save(str(path))
+    data = bytearray(path.read_bytes())
+    assert int.from_bytes(data[16:24], "little") == index.rows
+    data[16:24] = rows.to_bytes(8, "little")
+    path.write_bytes(bytes(data))
+    return str(path)
+
+
+def test_open_rejects_forged_rows(tmp_path) -> None:
+    empty = LshIndex(bands=2, rows=4)
+    with pytest.raises(RuntimeError):
+        LshIndex.open(_forge_rows(tmp_path, empty, 2**63 + 1))
+    # An empty index has no register count yet; the first insert checks rows.
+    reopened = LshIndex.open(_forge_rows(tmp_path, empty, 65))
+    with pytest.raises(ValueError):
+        reopened.insert(FastExpSketch(128, seed=1))
+
+    filled = LshIndex(bands=2, rows=4)
+    filled.insert(FastExpSketch(128, seed=1))
+    for rows in (2**63 + 1, 65, 2**40):
+        with pytest.raises(RuntimeError):
+            LshIndex.open(_forge_rows(tmp_path, filled, rows))
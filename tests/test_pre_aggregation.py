@@ -0,0 +1,57 @@
+"""add_many(..., pre_aggregate=True): collapsing repeated keys must not change sketch state."""
+
+import pytest
+from conftest import M
+from weighted_cardinality_estimation.stat import skewed_stream
+
+ORDER_DEPENDENT = {
+    "QSketchDyn",
+    "kQSketchRoundedDyn",
+    "kQSketchShifted",
+    "LogExpSketchFastShifted",
+    "LogExpSketchSlowShifted",
+}
+
+
+def _scaled_stream(spec, n: int, distinct: int, seed: int):
+    elems, weights = skewed_stream(n, distinct, seed=seed)
+    scale = min(max(1.0, spec.min_weight), spec.max_weight / 2)
+    return elems, [w * scale for w in weights]
+
+
+def test_pre_aggregation_exact_flag(weighted_spec) -> None:
+    sketch = weighted_spec.factory(M)
+    assert sketch.pre_aggregation_exact == (weighted_spec.name not in ORDER_DEPENDENT)
+
+
+@pytest.mark.parametrize(("n", "distinct"), [(3000, 50), (5000, 2000)], ids=["hot", "overflow"])
+def test_pre_aggregate_matches_plain(weighted_spec, n, distinct) -> None:
+    """Same registers either way; 'overflow' holds more distinct keys than one table window."""
+    elems, weights = _scaled_stream(weighted_spec, n, distinct, seed=3)
+    plain = weighted_spec.factory(M)
+    folded = weighted_spec.factory(M)
+    plain.add_many(elems, weights)
+    folded.add_many(elems, weights, pre_aggregate=True)
+    assert folded.get_registers() == plain.get_registers()
+    assert folded.estimate() == plain.estimate()
+
+
+def test_pre_aggregate_rejects_bad_input(weighted_spec) -> None:
+    sketch = weighted_spec.factory(M)
+    with pytest.raises((ValueError, RuntimeError)):
+        sketch.add_many(["a", "b"], [1.0], pre_aggregate=True)
+    with pytest.raises((ValueError, RuntimeError)):
+        sketch.add_many(["a", "b"], [1.0, -1.0], pre_aggregate=True)
+
+
+def test_bad_weight_mid_batch_matches_plain(weighted_spec) -> None:
+    """Rows before the bad weight are added either way; nothing after it is."""
+    elems, weights = _scaled_stream(weighted_spec, 3000, 700, seed=5)
+    weights[1500] = -1.0
+    plain = weighted_spec.factory(M)
+    folded = weighted_spec.factory(M)
+    with pytest.raises(ValueError):
+        plain.add_many(elems, weights)
+    with pytest.raises(ValueError):
+        folded.add_many(elems, weights, pre_aggregate=True)
+    assert folded.get_registers() == plain.get_registers()
@@ -5,12 +5,21 @@ Tests verify:
 - Log-uniform spacing property
 - Saturation (no inf, no zero)
 - Truncation behavior
+- CustomFloatFormat (bit-level quantizer) matches quantize_custom_float exactly
 """
 
 import math
+import random
+import sys
 
 import pytest
-from weighted_cardinality_estimation import FastExpSketchCustomFloat
+from custom_float_configs import ALL_CONFIGS
+from weighted_cardinality_estimation import (
+    CustomFloatFormat,
+    FastExpSketchCustomFloat,
+    QuantizationMode,
+    quantize_custom_float,
+)
 from weighted_cardinality_estimation.stat import elements_stream, weighted_stream
 
 
@@ -105,3 +114,52 @@ class TestSaturation:
         assert all(r == 0.5 for r in s.get_registers())
 
 
+
+
+FORMATS = [(1, 0), (2, 1), (3, 0), (3, 4), (5, 10), (11, 52)] + [(c.exp_bits, c.mant_bits) for c in ALL_CONFIGS]
+
+
+def reference(value, exp_bits, mant_bits):
+    return quantize_custom_float(value, 0, exp_bits, mant_bits, QuantizationMode.ALL_NORMAL)
+
+
+def probe_values(exp_bits, mant_bits, n=2000):
+    """Random values spanning the whole double range plus every clamp boundary."""
+    rng = random.Random(exp_bits * 100 + mant_bits)
+    values = [math.ldexp(rng.uniform(0.5, 1.0), rng.randint(-1080, 1030)) for _ in range(n)]
+    values += [math.ldexp(rng.uniform(0.5, 1.0), rng.randint(-20, 20)) for _ in range(n)]
+    lo = CustomFloatFormat(exp_bits, mant_bits).min_value
+    hi = CustomFloatFormat(exp_bits, mant_bits).max_value
+    values += [lo, hi, math.nextafter(lo, 0.0), math.nextafter(hi, 0.0), math.nextafter(lo, math.inf)]
+    values += [0.0, -0.0, -1.0, math.inf, -math.inf, math.nan, 5e-324, sys.float_info.max, 1.0]
+    return values
+
+
+@pytest.mark.parametrize(("exp_bits", "mant_bits"), FORMATS)
+class TestCustomFloatFormat:
+    def test_quantize_matches_reference(self, exp_bits, mant_bits) -> None:
+        fmt = CustomFloatFormat(exp_bits, mant_bits)
+        for v in probe_values(exp_bits, mant_bits):
+            assert fmt.quantize(v) == reference(v, exp_bits, mant_bits), v
+
+    def test_batch_matches_scalar(self, exp_bits, mant_bits) -> None:
+        fmt = CustomFloatFormat(exp_bits, mant_bits)
+        values = probe_values(exp_bits, mant_bits)
+        assert fmt.encode_many(values) == [fmt.encode(v) for v in values]
+        assert fmt.quantize_many(values) == [reference(v, exp_bits, mant_bits) for v in values]
+
+    def test_codes_are_ordered_like_values(self, exp_bits, mant_bits) -> None:
+        fmt = CustomFloatFormat(exp_bits, mant_bits)
+        # -inf saturates to the max code like +inf, so it is left out of the ordering check
+        values = sorted(v for v in probe_values(exp_bits, mant_bits) if v == v and v != -math.inf)
+        codes = fmt.encode_many(values)
+        assert codes == sorted(codes)
+        assert codes[0] == 0
+        assert codes[-1] == fmt.max_code == (1 << (exp_bits + mant_bits)) - 1
+        assert fmt.decode(fmt.max_code) == fmt.max_value
+
+
+@pytest.mark.parametrize(("exp_bits", "mant_bits"), [(0, 3), (12, 3), (5, -1), (5, 53)])
+def test_custom_float_format_rejects_unencodable(exp_bits, mant_bits) -> None:
+    with pytest.raises(ValueError):
+        CustomFloatFormat(exp_bits, mant_bits)
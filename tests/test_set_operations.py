@@ -0,0 +1,86 @@
+"""union_estimate / intersection_estimate / difference_estimate for the ExpSketch family."""
+
+import copy
+
+import pytest
+from weighted_cardinality_estimation import (
+    ExpSketch,
+    ExpSketchFloat32,
+    FastExpSketch,
+    FastExpSketchBFloat16,
+    FastExpSketchFloat16,
+    FastExpSketchFloat32,
+    FastGMExpSketch,
+    difference_estimate,
+    intersection_estimate,
+    union_estimate,
+)
+from weighted_cardinality_estimation.stat import jaccard_streams
+
+M = 400
+FACTORIES = [
+    ExpSketch,
+    ExpSketchFloat32,
+    FastExpSketch,
+    FastExpSketchFloat32,
+    FastExpSketchFloat16,
+    FastExpSketchBFloat16,
+    FastGMExpSketch,
+]
+
+
+@pytest.fixture(params=FACTORIES, ids=lambda f: f.__name__)
+def pair(request):
+    (ea, wa), (eb, wb) = jaccard_streams(500, 1000.0, 0.4, seed=3)
+    a = request.param(M, seed=1)
+    b = request.param(M, seed=1)
+    a.add_many(ea, wa)
+    b.add_many(eb, wb)
+    truth_a = dict(zip(ea, wa))
+    truth_b = dict(zip(eb, wb))
+    return a, b, truth_a, truth_b
+
+
+def test_union_equals_merge_without_mutating(pair) -> None:
+    a, b, _, _ = pair
+    before = a.get_registers()
+    merged = copy.deepcopy(a)
+    merged.merge(b)
+    assert union_estimate(a, b) == pytest.approx(merged.estimate(), rel=1e-6)
+    assert a.get_registers() == before
+
+
+def test_parts_add_up_to_union(pair) -> None:
+    a, b, _, _ = pair
+    union = union_estimate(a, b)
+    parts = intersection_estimate(a, b) + difference_estimate(a, b) + difference_estimate(b, a)
+    assert parts == pytest.approx(union, rel=1e-9)
+    assert intersection_estimate(a, b) == pytest.approx(intersection_estimate(b, a), rel=1e-9)
+    assert intersection_estimate(a, b) == pytest.approx(union * a.jaccard_struct(b), rel=1e-9)
+
+
+def test_estimates_track_true_weights(pair) -> None:
+    a, b, truth_a, truth_b = pair
+    union = sum({**truth_a, **truth_b}.values())
+    inter = sum(w for e, w in truth_a.items() if e in truth_b)
+    only_a = sum(w for e, w in truth_a.items() if e not in truth_b)
+    assert abs(union_estimate(a, b) - union) / union < 0.2
+    assert abs(intersection_estimate(a, b) - inter) / union < 0.1
+    assert abs(difference_estimate(a, b) - only_a) / union < 0.1
+
+
+def test_self_and_empty() -> None:
+    a = FastExpSketch(64, seed=1)
+    empty = FastExpSketch(64, seed=1)
+    a.add_many(["x", "y", "z"], [1.0, 2.0, 3.0])
+    assert difference_estimate(a, a) == 0.0
+    assert intersection_estimate(a, a) == pytest.approx(a.estimate())
+    assert intersection_estimate(a, empty) == 0.0
+    assert union_estimate(empty, empty) == 0.0
+
+
+def test_rejects_mismatched_sketches() -> None:
+    with pytest.raises(ValueError):
+        union_estimate(FastExpSketch(64, seed=1), FastExpSketch(32, seed=1))
+    with pytest.raises(TypeError):
+        union_estimate(FastExpSketch(64, seed=1), ExpSketch(64, seed=1))
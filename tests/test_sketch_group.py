@@ -0,0 +1,81 @@
+"""SketchGroup: one stream fed to several sketches from a shared hash / Fisher-Yates pass."""
+
+import pytest
+from weighted_cardinality_estimation import (
+    FastExpSketch,
+    HyperLogLog,
+    QSketch,
+    RngEngine,
+    SketchGroup,
+    kQSketch,
+)
+from weighted_cardinality_estimation.stat import elements_stream, weighted_stream
+
+M = 64
+SEED = 11
+
+
+def _group_with_all(m: int, engine: RngEngine):
+    group = SketchGroup(m, seed=SEED, rng_engine=engine)
+    members = [
+        group.make_fast_exp_sketch(),
+        group.make_q_sketch(amount_bits=8),
+        group.make_k_q_sketch(amount_bits=8, logarithm_base=2),
+        group.make_hyper_log_log(),
+    ]
+    standalone = [
+        FastExpSketch(m, seed=SEED, rng_engine=engine),
+        QSketch(m, seed=SEED, amount_bits=8, rng_engine=engine),
+        kQSketch(m, seed=SEED, amount_bits=8, logarithm_base=2, rng_engine=engine),
+        HyperLogLog(m, seed=SEED),
+    ]
+    return group, members, standalone
+
+
+@pytest.mark.parametrize("engine", [RngEngine.PCG64, RngEngine.XOSHIRO256PP])
+@pytest.mark.parametrize("m", [16, M, 400])
+def test_members_match_standalone_sketches(m, engine) -> None:
+    group, members, standalone = _group_with_all(m, engine)
+    elems, weights = weighted_stream(2000, 5000.0, seed=0)
+    group.add_many(elems, weights)
+    for s in standalone:
+        if isinstance(s, HyperLogLog):
+            s.add_many(elems)
+        else:
+            s.add_many(elems, weights)
+    for member, alone in zip(members, standalone, strict=True):
+        assert member.get_registers() == alone.get_registers()
+        assert member.estimate() == alone.estimate()
+
+
+def test_unweighted_add_uses_unit_weight() -> None:
+    group = SketchGroup(M, seed=SEED)
+    member = group.make_q_sketch(amount_bits=8)
+    alone = QSketch(M, seed=SEED, amount_bits=8)
+    elems = elements_stream(500, seed=1)
+    group.add_many(elems)
+    alone.add_many(elems)
+    assert member.get_registers() == alone.get_registers()
+
+
+def test_members_outlive_group_reference() -> None:
+    group = SketchGroup(M, seed=SEED)
+    member = group.make_fast_exp_sketch()
+    group.add("x", 2.0)
+    del group
+    assert member.estimate() > 0
+
+
+def test_cannot_grow_after_ingest() -> None:
+    group = SketchGroup(M, seed=SEED)
+    group.make_fast_exp_sketch()
+    group.add("x")
+    with pytest.raises(RuntimeError):
+        group.make_q_sketch(amount_bits=8)
+
+
+def test_len_and_invalid_weight() -> None:
+    group, _, _ = _group_with_all(M, RngEngine.PCG64)
+    assert len(group) == 4
+    with pytest.raises(ValueError):
+        group.add("x", 0.0)
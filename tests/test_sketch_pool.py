@@ -0,0 +1,71 @@
+"""QSketchPool: arena-backed QSketch members match stand-alone sketches."""
+
+import pytest
+from weighted_cardinality_estimation import QSketch, QSketchPool
+from weighted_cardinality_estimation.stat import elements_stream
+
+M = 64
+KEYS = 30
+
+
+def _rows(n: int, seed: int):
+    elems = elements_stream(n, seed=seed)
+    ids = [i % KEYS for i in range(n)]
+    weights = [1.0 + (i % 4) for i in range(n)]
+    return ids, elems, weights
+
+
+@pytest.mark.parametrize("amount_bits", [5, 8])
+def test_members_match_stand_alone_sketches(amount_bits) -> None:
+    pool = QSketchPool(M, seed=3, amount_bits=amount_bits)
+    assert [pool.make() for _ in range(KEYS)] == list(range(KEYS))
+    solo = [QSketch(M, 3, amount_bits=amount_bits) for _ in range(KEYS)]
+
+    ids, elems, weights = _rows(3000, seed=1)
+    pool.add_many(ids, elems, weights)
+    pool.add(7, "one-more", 9.0)
+    for i, e, w in zip(ids, elems, weights):
+        solo[i].add(e, w)
+    solo[7].add("one-more", 9.0)
+
+    for k in range(KEYS):
+        member = pool.get(k)
+        assert type(member) is QSketch
+        assert member.get_registers() == solo[k].get_registers()
+        assert pool.estimate(k) == solo[k].estimate()
+
+
+def test_reset_reuses_memory_and_copies_survive() -> None:
+    pool = QSketchPool(M, seed=3, amount_bits=8)
+    for _ in range(KEYS):
+        pool.make()
+    pool.add_many(*_rows(1000, seed=2))
+    kept = pool.get(0)
+    registers = kept.get_registers()
+    reserved = pool.bytes_reserved
+
+    for _ in range(5):
+        pool.reset()
+        assert len(pool) == 0
+        for _ in range(KEYS):
+            pool.make()
+        pool.add_many(*_rows(1000, seed=3))
+    assert pool.bytes_reserved == reserved
+    assert kept.get_registers() == registers
+    assert pool.get(0).get_registers() != registers
+
+    kept.add("after-reset", 1.0)
+    kept.merge(pool.get(1))
+
+
+def test_rejects_bad_input() -> None:
+    pool = QSketchPool(M, seed=3, amount_bits=8)
+    pool.make()
+    with pytest.raises(IndexError):
+        pool.estimate(1)
+    with pytest.raises(IndexError):
+        pool.add_many([0, 5], ["a", "b"], [1.0, 1.0])
+    with pytest.raises(ValueError):
+        pool.add_many([0], ["a", "b"], [1.0, 1.0])
+    with pytest.raises(ValueError):
+        QSketchPool(M, seed=3, amount_bits=1).make()
@@ -0,0 +1,116 @@
+"""small_capacity: exact small-set mode, promoted to registers on overflow."""
+
+import pickle
+
+import pytest
+from conftest import M
+from weighted_cardinality_estimation import (
+    FastExpSketch,
+    FastExpSketchFloat32,
+    MemoryFlag,
+    QSketch,
+    kQSketch,
+    union_estimate,
+)
+from weighted_cardinality_estimation.stat import skewed_stream
+
+CAPACITY = 16
+
+FACTORIES = [
+    pytest.param(lambda c: FastExpSketch(M, 7, small_capacity=c), id="FastExpSketch"),
+    pytest.param(lambda c: FastExpSketchFloat32(M, 7, small_capacity=c), id="FastExpSketchFloat32"),
+    pytest.param(lambda c: QSketch(M, 7, amount_bits=8, small_capacity=c), id="QSketch"),
+    pytest.param(lambda c: kQSketch(M, 7, amount_bits=8, logarithm_base=2, small_capacity=c), id="kQSketch"),
+]
+
+
+def _stream(distinct: int, seed: int):
+    return skewed_stream(6 * distinct, distinct, seed=seed)
+
+
+@pytest.mark.parametrize("make", FACTORIES)
+def test_exact_while_small(make) -> None:
+    elems, weights = _stream(CAPACITY, seed=1)
+    sketch = make(CAPACITY)
+    sketch.add_many(elems, weights)
+    assert sketch.small_mode
+    assert sketch.small_capacity == CAPACITY
+
+    max_weight = {}
+    for e, w in zip(elems, weights):
+        max_weight[e] = max(w, max_weight.get(e, 0.0))
+    assert sketch.estimate() == pytest.approx(sum(max_weight.values()), rel=1e-12)
+
+
+@pytest.mark.parametrize("make", FACTORIES)
+@pytest.mark.parametrize("distinct", [5, CAPACITY + 1, 300])
+def test_registers_match_plain_sketch(make, distinct) -> None:
+    elems, weights = _stream(distinct, seed=2)
+    small = make(CAPACITY)
+    plain = make(0)
+    small.add_many(elems, weights)
+    plain.add_many(elems, weights)
+    assert small.small_mode == (len(set(elems)) <= CAPACITY)
+    assert not plain.small_mode
+    assert small.get_registers() == plain.get_registers()
+    assert small.jaccard_struct(plain) == plain.jaccard_struct(plain)
+    if not small.small_mode:
+        assert small.estimate() == plain.estimate()
+
+
+@pytest.mark.parametrize("make", FACTORIES)
+@pytest.mark.parametrize(("left", "right"), [(True, True), (True, False), (False, True)])
+def test_merge_matches_plain_sketch(make, left, right) -> None:
+    elems, weights = _stream(12, seed=3)
+    half = len(elems) // 2
+    a = make(CAPACITY if left else 0)
+    b = make(CAPACITY if right else 0)
+    plain = make(0)
+    a.add_many(elems[:half], weights[:half])
+    b.add_many(elems[half:], weights[half:])
+    plain.add_many(elems, weights)
+
+    a.merge(b)
+    assert a.get_registers() == plain.get_registers()
+    assert a.small_mode == (left and right)
+
+
+def test_small_sketch_is_smaller() -> None:
+    small = FastExpSketch(1024, 7, small_capacity=CAPACITY)
+    plain = FastExpSketch(1024, 7)
+    for s in (small, plain):
+        s.add("a", 1.0)
+    assert small.memory_usage(MemoryFlag.TOTAL) * 10 < plain.memory_usage(MemoryFlag.TOTAL)
+
+
+@pytest.mark.parametrize("make", FACTORIES)
+@pytest.mark.parametrize("distinct", [5, 300])
+def test_pickle_keeps_mode(make, distinct) -> None:
+    elems, weights = _stream(distinct, seed=4)
+    sketch = make(CAPACITY)
+    sketch.add_many(elems, weights)
+    restored = pickle.loads(pickle.dumps(sketch))
+    assert restored.small_mode == sketch.small_mode
+    assert restored.estimate() == sketch.estimate()
+    assert restored.get_registers() == sketch.get_registers()
+
+
+def test_snapshot_and_set_operations() -> None:
+    a = FastExpSketch(M, 7, small_capacity=CAPACITY)
+    b = FastExpSketch(M, 7)
+    plain = FastExpSketch(M, 7)
+    for s in (a, plain):
+        s.add("x", 2.0)
+        s.add("y", 3.0)
+    b.add("y", 3.0)
+    b.add("z", 1.0)
+    snap = a.snapshot()
+    a.add("later", 1.0)
+    assert snap.small_mode
+    assert snap.estimate() == 5.0
+    assert union_estimate(snap, b) == union_estimate(plain, b)
+
+
+def test_rejects_bad_capacity() -> None:
+    with pytest.raises(ValueError):
+        FastExpSketch(M, 7, small_capacity=100_000)
@@ -0,0 +1,68 @@
+"""snapshot(): frozen views of FastExpSketch that share registers with the live sketch."""
+
+import pickle
+
+import pytest
+from weighted_cardinality_estimation import (
+    FastExpSketch,
+    FastExpSketchFloat32,
+    jaccard_matrix,
+    union_estimate,
+)
+from weighted_cardinality_estimation.stat import elements_stream
+
+# 5000 registers span several copy-on-write blocks.
+SIZES = [64, 400, 5000]
+
+
+@pytest.fixture(params=[FastExpSketch, FastExpSketchFloat32], ids=lambda f: f.__name__)
+def factory(request):
+    return request.param
+
+
+@pytest.mark.parametrize("m", SIZES)
+def test_snapshot_ignores_later_adds(factory, m) -> None:
+    live = factory(m, seed=1)
+    live.add_many(elements_stream(2000, seed=1), [2.0] * 2000)
+    snap = live.snapshot()
+    registers, estimate = snap.get_registers(), snap.estimate()
+    assert registers == live.get_registers()
+
+    live.add_many(elements_stream(2000, seed=2), [3.0] * 2000)
+    assert live.get_registers() != registers
+    assert snap.get_registers() == registers
+    assert snap.estimate() == estimate
+
+
+@pytest.mark.parametrize("m", SIZES)
+def test_writes_to_snapshot_leave_source_alone(factory, m) -> None:
+    live = factory(m, seed=1)
+    live.add_many(elements_stream(500, seed=1), [1.0] * 500)
+    before = live.get_registers()
+    other = factory(m, seed=1)
+    other.add_many(elements_stream(500, seed=3), [5.0] * 500)
+
+    snap = live.snapshot()
+    snap.merge(other)
+    snap.add("heavy", 1e9)
+    assert live.get_registers() == before
+
+    copy = factory(m, seed=1)
+    copy.add_many(elements_stream(500, seed=1), [1.0] * 500)
+    copy.merge(other)
+    copy.add("heavy", 1e9)
+    assert snap.get_registers() == copy.get_registers()
+
+
+def test_snapshot_works_with_readers(factory) -> None:
+    live = factory(400, seed=1)
+    live.add_many(elements_stream(1000, seed=1), [1.0] * 1000)
+    snap = live.snapshot()
+    assert snap.jaccard_struct(live) == 1.0
+    assert union_estimate(snap, live) == pytest.approx(live.estimate())
+    live.add("late", 10.0)
+    assert jaccard_matrix([snap, live])[0][1] == snap.jaccard_struct(live)
+
+    restored = pickle.loads(pickle.dumps(snap))
+    assert type(restored) is factory
+    assert restored.get_registers() == snap.get_registers()
@@ -0,0 +1,130 @@
+"""Bindings release the GIL: threads can drive separate sketches at once."""
+
+import sys
+import sysconfig
+import threading
+from concurrent.futures import ThreadPoolExecutor
+
+import pytest
+from conftest import M, make_sketches
+from weighted_cardinality_estimation import FastExpSketch, QSketchPool, jaccard_matrix
+from weighted_cardinality_estimation.stat import elements_stream
+
+THREADS = 8
+
+
+@pytest.mark.skipif(not sysconfig.get_config_var("Py_GIL_DISABLED"), reason="needs free-threaded CPython")
+def test_import_keeps_gil_disabled() -> None:
+    assert not sys._is_gil_enabled()
+
+
+def test_concurrent_ingestion_into_separate_sketches(spec) -> None:
+    streams = [elements_stream(2000, seed=s) for s in range(THREADS)]
+    serial = make_sketches(spec, M, seed=5, n=THREADS)
+    for sketch, stream in zip(serial, streams):
+        sketch.add_many(stream)
+
+    parallel = make_sketches(spec, M, seed=5, n=THREADS)
+    start = threading.Barrier(THREADS)
+
+    def ingest(i: int) -> float:
+        start.wait()
+        for chunk in range(0, len(streams[i]), 250):
+            parallel[i].add_many(streams[i][chunk : chunk + 250])
+        return parallel[i].estimate()
+
+    with ThreadPoolExecutor(THREADS) as pool:
+        estimates = list(pool.map(ingest, range(THREADS)))
+    assert estimates == [s.estimate() for s in serial]
+
+
+def test_add_many_lets_other_threads_run() -> None:
+    sketch = FastExpSketch(1024, seed=1)
+    elems = elements_stream(200_000, seed=1)
+    started = threading.Event()
+
+    def ingest() -> None:
+        started.set()
+        sketch.add_many(elems)
+
+    worker = threading.Thread(target=ingest)
+    worker.start()
+    started.wait()
+    spins = 0
+    while worker.is_alive():
+        spins += 1
+    worker.join()
+    # With the GIL held for the whole call this loop would barely run.
+    assert spins > 1000
+
+
+def test_readers_poll_snapshots_while_writer_adds() -> None:
+    live = FastExpSketch(M, seed=1)
+    stream = elements_stream(4000, seed=2)
+    published = [live.snapshot()]
+    done = threading.Event()
+
+    def write() -> None:
+        for chunk in range(0, len(stream), 200):
+            live.add_many(stream[chunk : chunk + 200])
+            published.append(live.snapshot())
+        done.set()
+
+    def read() -> int:
+        polls = 0
+        while not done.is_set() or polls == 0:
+            snap = published[-1]
+            assert snap.jaccard_struct(snap) == 1.0
+            assert jaccard_matrix([snap, published[0]])[0][0] == 1.0
+            snap.estimate()
+            polls += 1
+        return polls
+
+    with ThreadPoolExecutor(THREADS) as pool:
+        readers = [pool.submit(read) for _ in range(THREADS - 1)]
+        write()
+        assert all(r.result() > 0 for r in readers)
+
+    expected = FastExpSketch(M, seed=1)
+    expected.add_many(stream)
+    assert published[-1].get_registers() == expected.get_registers()
+    assert live.estimate() == expected.estimate()
+
+
+
+def test_threads_share_a_sketch_pool() -> None:
+    """Pool members share Fisher-Yates scratch; the binding serializes calls on one pool."""
+    keys = 4 * THREADS
+
+    def rows(i: int):
+        # Thread i writes ids i, i + THREADS, i + 2 * THREADS and i + 3 * THREADS.
+        elems = elements_stream(3000, seed=i)
+        ids = [i + THREADS * (j % 4) for j in range(len(elems))]
+        return ids, elems, [1.0 + j % 3 for j in range(len(elems))]
+
+    def make_pool():
+        pool = QSketchPool(M, seed=5, amount_bits=8)
+        for _ in range(keys):
+            pool.make()
+        return pool
+
+    serial = make_pool()
+    for i in range(THREADS):
+        serial.add_many(*rows(i))
+        serial.add(i, f"single-{i}")
+
+    shared = make_pool()
+    start = threading.Barrier(THREADS)
+
+    def ingest(i: int) -> None:
+        ids, elems, weights = rows(i)
+        start.wait()
+        for chunk in range(0, len(elems), 100):
+            part = slice(chunk, chunk + 100)
+            shared.add_many(ids[part], elems[part], weights[part])
+        shared.add(i, f"single-{i}")
+
+    with ThreadPoolExecutor(THREADS) as pool:
+        list(pool.map(ingest, range(THREADS)))
+    for k in range(keys):
+        assert shared.get(k).get_registers() == serial.get(k).get_registers()
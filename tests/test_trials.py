@@ -0,0 +1,83 @@
+"""run_trials(): native multi-seed accuracy runs."""
+
+import numpy as np
+import pytest
+from conftest import M
+from weighted_cardinality_estimation import (
+    FastExpSketch,
+    QSketch,
+    QSketchDyn,
+    TunedConfig,
+    run_trials,
+)
+from weighted_cardinality_estimation.stat import jaccard_streams, skewed_stream
+
+N_TRIALS = 6
+SEED = 11
+
+
+@pytest.fixture(scope="module")
+def stream():
+    return skewed_stream(3000, 600, seed=0)
+
+
+@pytest.mark.parametrize(
+    ("name", "params", "make"),
+    [
+        ("FastExpSketch", {}, lambda seed: FastExpSketch(M, seed)),
+        ("QSketch", {"amount_bits": 8}, lambda seed: QSketch(M, seed, amount_bits=8)),
+        ("QSketchDyn", {"amount_bits": 8}, lambda seed: QSketchDyn(M, seed, amount_bits=8, g_seed=seed)),
+    ],
+)
+@pytest.mark.parametrize("threads", [1, 3])
+def test_matches_python_loop(stream, name, params, make, threads) -> None:
+    elems, weights = stream
+    result = run_trials(name, M, elems, weights, N_TRIALS, params=params, threads=threads, seed=SEED)
+    expected = []
+    for t in range(N_TRIALS):
+        sketch = make(SEED + t)
+        sketch.add_many(elems, weights)
+        expected.append(sketch.estimate())
+    assert isinstance(result.estimates, np.ndarray)
+    assert result.estimates.tolist() == expected
+    assert result.estimates_b.size == 0
+
+
+def test_jaccard_and_merge(stream) -> None:
+    (ea, wa), (eb, wb) = jaccard_streams(500, 500.0, 0.5, seed=1)
+    result = run_trials("FastExpSketch", M, ea, wa, N_TRIALS, seed=SEED, elems_b=eb, weights_b=wb,
+                        jaccard=True, merge=True)
+    for t in range(N_TRIALS):
+        a = FastExpSketch(M, SEED + t)
+        b = FastExpSketch(M, SEED + t)
+        a.add_many(ea, wa)
+        b.add_many(eb, wb)
+        assert result.estimates_b[t] == b.estimate()
+        assert result.jaccard[t] == pytest.approx(a.jaccard_struct(b))
+        a.merge(b)
+        assert result.union_estimates[t] == a.estimate()
+
+
+def test_tuned_config(stream) -> None:
+    elems, weights = stream
+    config = TunedConfig("QSketch", M, {"amount_bits": 8})
+    by_config = run_trials(config, elems, weights, N_TRIALS, seed=SEED)
+    by_name = run_trials("QSketch", M, elems, weights, N_TRIALS, params={"amount_bits": 8}, seed=SEED)
+    assert by_config.estimates.tolist() == by_name.estimates.tolist()
+
+
+def test_rejects_bad_requests(stream) -> None:
+    elems, weights = stream
+    with pytest.raises(ValueError):
+        run_trials("NoSuchSketch", M, elems, weights)
+    with pytest.raises(ValueError):
+        run_trials("QSketch", M, elems, weights)  # missing amount_bits
+    with pytest.raises(ValueError, match="bogus"):
+        run_trials("QSketch", M, elems, weights, params={"amount_bits": 8, "bogus": 1})
+    with pytest.raises(ValueError):
+        run_trials("FastExpSketch", M, elems, weights, merge=True)  # no second stream
+    with pytest.raises(ValueError):
+        run_trials("QSketchDyn", M, elems, weights, params={"amount_bits": 8},
+                   elems_b=elems, weights_b=weights, merge=True)
+    with pytest.raises(ValueError):
+        run_trials("FastExpSketch", M, elems, [0.0] * len(elems))
@@ -0,0 +1,78 @@
+"""tune(): calibration-driven choice of sketch type and parameters, and its JSON config."""
+
+import json
+import math
+
+import pytest
+import weighted_cardinality_estimation as wce
+from weighted_cardinality_estimation import MemoryFlag, TunedConfig, tune
+from weighted_cardinality_estimation.stat import weighted_stream
+
+MAX_REL_ERROR = 0.1
+MAX_MEMORY = 4096
+
+
+@pytest.fixture(scope="module")
+def sample():
+    return weighted_stream(1500, 1500.0, seed=0)
+
+
+@pytest.fixture(scope="module")
+def configs(sample):
+    elems, weights = sample
+    return tune(elems, weights, max_rel_error=MAX_REL_ERROR, max_memory_bytes=MAX_MEMORY, trials=3)
+
+
+def test_budget_meeting_configs_come_first_fastest_first(configs) -> None:
+    flags = [c.meets_budget for c in configs]
+    assert flags[0], "no configuration met a loose budget"
+    assert flags == sorted(flags, reverse=True)
+    passing = [c.ns_per_add for c in configs if c.meets_budget]
+    assert passing == sorted(passing)
+
+
+def test_passing_configs_respect_the_budget(configs) -> None:
+    for c in configs:
+        if c.meets_budget:
+            assert c.rel_error <= MAX_REL_ERROR
+            assert c.memory_bytes <= MAX_MEMORY
+
+
+def test_make_sketch_builds_the_tuned_configuration(sample, configs) -> None:
+    elems, weights = sample
+    best = configs[0]
+    sketch = best.make_sketch(seed=7)
+    assert type(sketch).__name__ == best.sketch
+    assert isinstance(sketch, getattr(wce, best.sketch))
+    assert sketch.memory_usage(MemoryFlag.TOTAL) == best.memory_bytes
+    sketch.add_many(elems, weights)
+    assert math.isfinite(sketch.estimate())
+
+
+def test_json_round_trip(configs) -> None:
+    for c in configs[:5]:
+        restored = TunedConfig(**json.loads(c.to_json()))
+        assert (restored.sketch, restored.m, restored.params) == (c.sketch, c.m, c.params)
+        assert restored.meets_budget == c.meets_budget
+        assert restored.make_sketch(seed=1).memory_usage(MemoryFlag.TOTAL) == c.memory_bytes
+
+
+def test_unreachable_throughput_meets_nothing(sample) -> None:
+    elems, weights = sample
+    configs = tune(elems, weights, max_rel_error=MAX_REL_ERROR, max_memory_bytes=MAX_MEMORY,
+                   min_adds_per_sec=1e15, trials=2)
+    assert not any(c.meets_budget for c in configs)
+
+
+def test_rejects_bad_input(sample) -> None:
+    elems, weights = sample
+    with pytest.raises(ValueError):
+        tune([], [])
+    with pytest.raises(ValueError):
+        tune(elems, weights[:-1])
+    with pytest.raises(ValueError):
+        tune(elems, [0.0] * len(elems))
+    with pytest.raises(ValueError):
+        TunedConfig("NoSuchSketch", 64, {}).make_sketch()
+    with pytest.raises(ValueError):
+        TunedConfig("kQSketch", 64, {"amount_bits": 8}).make_sketch()
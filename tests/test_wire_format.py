@@ -0,0 +1,226 @@
+"""to_wire / from_wire / merge_wire: compact encoding for sending sketches between nodes."""
+
+import pickle
+import zlib
+
+import pytest
+from weighted_cardinality_estimation import (
+    FastExpSketch,
+    FastExpSketchFloat32,
+    HyperLogLog,
+    LogExpSketchFastNoShifted,
+    QSketch,
+    kQSketch,
+)
+from weighted_cardinality_estimation.stat import elements_stream
+
+M = 256
+
+# Each class with a factory taking (m, seed).
+FACTORIES = [
+    pytest.param(QSketch, lambda m, seed: QSketch(m, seed, amount_bits=8), id="QSketch"),
+    pytest.param(kQSketch, lambda m, seed: kQSketch(m, seed, amount_bits=8, logarithm_base=2), id="kQSketch"),
+    pytest.param(LogExpSketchFastNoShifted,
+                 lambda m, seed: LogExpSketchFastNoShifted(m, seed, amount_bits=10, v_max=1e5),
+                 id="LogExpSketchFastNoShifted"),
+    pytest.param(FastExpSketch, lambda m, seed: FastExpSketch(m, seed), id="FastExpSketch"),
+    pytest.param(FastExpSketchFloat32, lambda m, seed: FastExpSketchFloat32(m, seed), id="FastExpSketchFloat32"),
+]
+
+
+def _filled(make, seed: int = 3, n: int = 3000, offset: int = 0):
+    sketch = make(M, seed)
+    elems = elements_stream(n, seed=seed + offset)
+    sketch.add_many(elems, [1.0 + (i % 7) for i in range(n)])
+    return sketch
+
+
+@pytest.mark.parametrize(("cls", "make"), FACTORIES)
+def test_round_trip(cls, make) -> None:
+    sketch = _filled(make)
+    restored = cls.from_wire(sketch.to_wire())
+    assert isinstance(restored, cls)
+    assert restored.get_registers() == sketch.get_registers()
+    assert restored.estimate() == sketch.estimate()
+
+
+@pytest.mark.parametrize(("cls", "make"), FACTORIES)
+def test_empty_round_trip(cls, make) -> None:
+    sketch = make(M, 3)
+    data = sketch.to_wire()
+    assert len(data) < 64
+    assert cls.from_wire(data).get_registers() == sketch.get_registers()
+
+
+@pytest.mark.parametrize(("cls", "make"), FACTORIES)
+def test_smaller_than_compressed_pickle(cls, make) -> None:
+    sketch = _filled(make)
+    assert len(sketch.to_wire()) < len(zlib.compress(pickle.dumps(sketch)))
+
+
+@pytest.mark.parametrize(("cls", "make"), FACTORIES)
+def test_merge_wire_equals_merge(cls, make) -> None:
+    a = _filled(make, offset=0)
+    b = _filled(make, offset=100)
+    expected = _filled(make, offset=0)
+    expected.merge(b)
+    a.merge_wire(b.to_wire())
+    assert a.get_registers() == expected.get_registers()
+    assert a.estimate() == expected.estimate()
+
+
+@pytest.mark.parametrize(("cls", "make"), FACTORIES)
+def test_mismatches_raise_and_leave_target_unchanged(cls, make) -> None:
+    target = _filled(make)
+    before = target.get_registers()
+    other_class = kQSketch(M, 3, amount_bits=8, logarithm_base=2) if cls is QSketch else QSketch(M, 3, amount_bits=8)
+    for other in (make(M // 2, 3), make(M, 4), other_class):
+        other.add_many(elements_stream(100, seed=9))
+        with pytest.raises(ValueError):
+            target.merge_wire(other.to_wire())
+    assert target.get_registers() == before
+
+
+def test_parameter_mismatch_raises() -> None:
+    target = QSketch(M, 3, amount_bits=8)
+    with pytest.raises(ValueError, match="parameters"):
+        target.merge_wire(QSketch(M, 3, amount_bits=6).to_wire())
+    target = kQSketch(M, 3, amount_bits=8, logarithm_base=2)
+    with pytest.raises(ValueError, match="parameters"):
+        target.merge_wire(kQSketch(M, 3, amount_bits=8, logarithm_base=3).to_wire())
+
+
+@pytest.mark.parametrize(("cls", "make"), FACTORIES)
+def test_malformed_input_raises(cls, make) -> None:
+    data = _filled(make).to_wire()
+    target = _filled(make, offset=50)
+    before = target.get_registers()
+    for bad in (b"", data[:4], data[: len(data) // 2], data[:-1], data + b"\x00", b"XXXX" + data[4:]):
+        with pytest.raises(ValueError):
+            cls.from_wire(bad)
+        with pytest.raises(ValueError):
+            target.merge_wire(bad)
+    assert target.get_registers() == before
+
+
+def _varint(v: int) -> bytes:
+    out = bytearray()
+    while v >= 0x80:
+        out.append(v & 0x7F | 0x80)
+        v >>= 7
+    out.append(v)
+    return bytes(out)
+
+
+def _qsketch_wire(m: int, registers: bytes, lowest: int = 0) -> bytes:
+    """A QSketch blob (amount_bits 8, seed 3) around hand-made register data; lowest is zigzag-coded."""
+    return b"WCEW\x01\x01" + _varint(m) + (3).to_bytes(8, "little") + b"\x08" + _varint(lowest) + registers
+
+
+def _single_symbol_rans(states: list[int], stream: bytes = b"", offset: int = 0) -> bytes:
+    """rANS coding of one offset at frequency 4096: every step keeps the state, so only the states matter."""
+    data = b"".join(s.to_bytes(4, "little") for s in states) + stream
+    return b"\x01" + _varint(1) + _varint(offset) + _varint(4095) + _varint(len(data)) + data
+
+
+def test_hand_made_rans_stream_decodes() -> None:
+    assert QSketch.from_wire(_qsketch_wire(M, _single_symbol_rans([1 << 23] * 4))).get_registers() == [0] * M
+
+
+@pytest.mark.parametrize(
+    "registers",
+    [
+        pytest.param(_single_symbol_rans([0] * 4), id="zero-states"),
+        pytest.param(_single_symbol_rans([1 << 23, 1 << 23, 1 << 23, (1 << 23) - 1]), id="state-below-range"),
+        pytest.param(_single_symbol_rans([1 << 31] * 4), id="state-above-range"),
+        pytest.param(_single_symbol_rans([1 << 23] * 4, b"\x00"), id="trailing-stream-byte"),
+        pytest.param(_single_symbol_rans([1 << 23] * 4)[:-1], id="truncated-states"),
+        pytest.param(b"\x01" + _varint(1) + _varint(0) + _varint(4095) + _varint(1 << 20), id="stream-longer-than-data"),
+    ],
+)
+def test_corrupt_rans_streams_raise(registers: bytes) -> None:
+    data = _qsketch_wire(M, registers)
+    with pytest.raises(ValueError):
+        QSketch.from_wire(data)
+    target = QSketch(M, 3, amount_bits=8)
+    target.add_many(elements_stream(1000, seed=1))
+    before = target.get_registers()
+    with pytest.raises(ValueError):
+        target.merge_wire(data)
+    assert target.get_registers() == before
+
+
+@pytest.mark.parametrize(
+    "lowest",
+    [
+        pytest.param(2**64 - 2, id="int64-max"),
+        pytest.param(2**64 - 1, id="int64-min"),
+        pytest.param(256, id="just-above-range"),
+    ],
+)
+def test_forged_lowest_register_raises(lowest: int) -> None:
+    # Every register is lowest + 1; lowest itself is already out of range.
+    data = _qsketch_wire(M, _single_symbol_rans([1 << 23] * 4, offset=1), lowest=lowest)
+    with pytest.raises(ValueError, match="out of range"):
+        QSketch.from_wire(data)
+    # Float registers: an offset that would wrap the unsigned sum back into range.
+    data = b"WCEW\x01\x04" + _varint(M) + (3).to_bytes(8, "little") + _varint(2**64 - 1)
+    with pytest.raises(ValueError, match="out of range"):
+        FastExpSketch.from_wire(data + _single_symbol_rans([1 << 23] * 4, offset=1))
+
+
+def test_forged_sizes_raise_before_allocating() -> None:
+    # m far beyond any sketch; decoding must not try to allocate it.
+    with pytest.raises(ValueError, match="too large"):
+        QSketch.from_wire(_qsketch_wire(1 << 62, _single_symbol_rans([1 << 23] * 4)))
+    # Plausible m, but 32-bit packed registers the data cannot hold.
+    with pytest.raises(ValueError, match="truncated"):
+        QSketch.from_wire(_qsketch_wire(1 << 24, b"\x00\x20"))
+    with pytest.raises(ValueError, match="too large"):
+        FastExpSketch.from_wire(b"WCEW\x01\x04" + _varint((1 << 24) + 1) + bytes(8))
+
+
+@pytest.mark.parametrize(
+    "make",
+    [
+        pytest.param(lambda c: FastExpSketch(M, 7, small_capacity=c), id="FastExpSketch"),
+        pytest.param(lambda c: QSketch(M, 7, amount_bits=8, small_capacity=c), id="QSketch"),
+    ],
+)
+def test_small_mode_is_sent_densified(make) -> None:
+    elems = elements_stream(5, seed=1)
+    small = make(16)
+    plain = make(0)
+    small.add_many(elems)
+    plain.add_many(elems)
+    assert small.small_mode
+    received = type(small).from_wire(small.to_wire())
+    assert not received.small_mode
+    assert received.get_registers() == plain.get_registers()
+    merged = make(0)
+    merged.merge_wire(small.to_wire())
+    assert merged.get_registers() == plain.get_registers()
+
+
+def test_hyper_log_log() -> None:
+    """Unweighted, so it is not in FACTORIES; the same properties, by hand."""
+    a, b = HyperLogLog(M, 3), HyperLogLog(M, 3)
+    a.add_many(elements_stream(3000, seed=1))
+    b.add_many(elements_stream(3000, seed=2))
+    restored = HyperLogLog.from_wire(a.to_wire())
+    assert restored.get_registers() == a.get_registers()
+    assert restored.estimate() == a.estimate()
+    assert len(a.to_wire()) < len(zlib.compress(pickle.dumps(a)))
+
+    expected = HyperLogLog.from_wire(a.to_wire())
+    expected.merge(b)
+    a.merge_wire(b.to_wire())
+    assert a.get_registers() == expected.get_registers()
+
+    before = a.get_registers()
+    data = b.to_wire()
+    for bad in (HyperLogLog(M // 2, 3).to_wire(), HyperLogLog(M, 4).to_wire(), QSketch(M, 3, amount_bits=8).to_wire(),
+                data[:-1], data + b"\x00"):
+        with pytest.raises(ValueError):
+            a.merge_wire(bad)
+    assert a.get_registers() == before
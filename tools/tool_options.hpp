@@ -0,0 +1,22 @@
+#pragma once
+// Option parsing shared by the command-line tools.
+
+#include <charconv>
+#include <map>
+#include <string>
+#include <system_error>
+
+// Parses all of text into value. Unlike std::stoul, rejects a sign on an
+// unsigned T and trailing characters.
+template <typename T>
+bool parse_number(const std::string& text, T& value) {
+    const char* end = text.data() + text.size();
+    const auto [ptr, ec] = std::from_chars(text.data(), end, value);
+    return ec == std::errc() && ptr == end;
+}
+
+// <name>=<value> from --param; the sketch registry rejects unknown names.
+inline bool parse_param(const std::string& text, std::map<std::string, double>& params) {
+    const auto eq = text.find('=');
+    return eq != std::string::npos && eq > 0 && parse_number(text.substr(eq + 1), params[text.substr(0, eq)]);
+}
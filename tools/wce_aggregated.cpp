@@ -0,0 +1,135 @@
+// wce-aggregated: keep named sketches in one process and let workers feed
+// them over a Unix domain socket (see aggregation_server.hpp).
+//
+//   wce-aggregated --socket=/run/wce.sock --sketch=QSketch --m=4096 --param=amount_bits=8
+//
+// Every name gets a sketch of the one configured class, built like
+// wce-ingest builds it; HyperLogLog, which is unweighted, takes no --param.
+// Only classes with a wire format can be served, since workers may send whole
+// sketches. SIGINT and SIGTERM stop the daemon and
+// remove the socket.
+
+#include <wce/aggregation_server.hpp>
+#include <wce/fast_exp_sketch.hpp>
+#include <wce/fast_k_q_sketch.hpp>
+#include <wce/hyper_log_log.hpp>
+#include <wce/log_exp_sketch_fast_no_shifted.hpp>
+#include <wce/q_sketch.hpp>
+#include <wce/sketch_registry.hpp>
+
+#include "tool_options.hpp"
+
+#include <csignal>
+#include <cstdio>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+using Params = std::map<std::string, double>;
+using ServerFactory = std::function<std::unique_ptr<AggregationServer>(
+    const std::string& socket_path, const std::string& sketch, std::size_t m, std::uint64_t seed, const Params&)>;
+
+template <typename T>
+ServerFactory server_for() {
+    return [](const std::string& socket_path, const std::string& sketch, std::size_t m, std::uint64_t seed,
+              const Params& params) {
+        const auto prototype = find_sketch_kind(sketch)->make(m, seed, params);
+        return std::make_unique<AggregationServer>(socket_path, static_cast<const T&>(*prototype));
+    };
+}
+
+// HyperLogLog is not a weighted Sketch, so it is not in the sketch registry.
+ServerFactory hyper_log_log_server() {
+    return [](const std::string& socket_path, const std::string&, std::size_t m, std::uint64_t seed,
+              const Params& params) {
+        if (!params.empty()) {
+            throw std::invalid_argument("Unknown parameter '" + params.begin()->first + "' for HyperLogLog.");
+        }
+        return std::make_unique<AggregationServer>(socket_path, HyperLogLog(m, seed));
+    };
+}
+
+const std::unordered_map<std::string, ServerFactory>& servers() {
+    static const std::unordered_map<std::string, ServerFactory> table = {
+        {"QSketch", server_for<QSketch>()},
+        {"kQSketch", server_for<kQSketch>()},
+        {"LogExpSketchFastNoShifted", server_for<LogExpSketchFastNoShifted>()},
+        {"FastExpSketch", server_for<FastExpSketch>()},
+        {"FastExpSketchFloat32", server_for<FastExpSketchT<float>>()},
+        {"HyperLogLog", hyper_log_log_server()},
+    };
+    return table;
+}
+
+struct Options {
+    std::string socket;
+    std::string sketch;
+    std::size_t m = 0;
+    std::uint64_t seed = 42;
+    Params params;
+};
+
+bool parse_options(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto value = [&](const char* flag) -> std::optional<std::string> {
+            const std::string prefix = std::string(flag) + "=";
+            if (arg.rfind(prefix, 0) == 0) return arg.substr(prefix.size());
+            return std::nullopt;
+        };
+        if (auto v = value("--socket")) opt.socket = *v;
+        else if (auto v = value("--sketch")) opt.sketch = *v;
+        else if (auto v = value("--m")) { if (!parse_number(*v, opt.m)) return false; }
+        else if (auto v = value("--seed")) { if (!parse_number(*v, opt.seed)) return false; }
+        else if (auto v = value("--param")) { if (!parse_param(*v, opt.params)) return false; }
+        else return false;
+    }
+    return !opt.socket.empty() && !opt.sketch.empty() && opt.m > 0;
+}
+
+AggregationServer* running = nullptr;
+
+extern "C" void handle_signal(int) {
+    if (running != nullptr) running->stop();
+}
+
+int run(const Options& opt) {
+    const auto it = servers().find(opt.sketch);
+    if (it == servers().end()) throw std::invalid_argument("'" + opt.sketch + "' has no wire format");
+    const auto server = it->second(opt.socket, opt.sketch, opt.m, opt.seed, opt.params);
+
+    running = server.get();
+    struct sigaction sa{};
+    sa.sa_handler = handle_signal;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+    server->serve();
+    running = nullptr;
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parse_options(argc, argv, opt)) {
+        std::fprintf(stderr,
+            "usage: %s --socket=<path> --sketch=<Class> --m=<m> [--seed=<seed>] [--param=<name>=<value>]...\n",
+            argv[0]);
+        return 2;
+    }
+    try {
+        return run(opt);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "wce-aggregated: %s\n", e.what());
+        return 1;
+    }
+}
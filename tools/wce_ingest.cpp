@@ -0,0 +1,218 @@
+// wce-ingest: sketch a newline-delimited file natively, for backfills.
+//
+// The input is memory-mapped and split on line boundaries into one chunk per
+// thread. Each thread parses its chunk into its own sketch, and the sketches
+// are merged at the end. Lines are `key<TAB>weight`, or just `key` (weight 1);
+// with --keys-only the whole line is the key. Empty lines are skipped and a
+// trailing '\r' is dropped.
+//
+// Sketches are named by their Python class and take the Python keyword
+// arguments as --param=<name>=<value>, e.g.
+//
+//   wce-ingest --sketch=kQSketch --m=4096 --param=amount_bits=8 --param=logarithm_base=2 events.tsv
+//
+// A parameter the class does not take exits with status 1; a malformed or
+// missing option, including a negative or zero --m, prints usage and exits
+// with status 2.
+//
+// Non-mergeable and order-dependent sketches (pre_aggregation_exact() false)
+// are fed by one thread in file order, so their state matches add_many().
+// Output is the estimate, or with --output=json the sketch's configuration,
+// estimate and get_registers() (non-finite values as Infinity/NaN, which
+// Python's json module reads).
+
+#include <wce/mapped_file.hpp>
+#include <wce/sketch_registry.hpp>
+
+#include "tool_options.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <map>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Params = std::map<std::string, double>;
+
+std::string json_number(double v) {
+    if (std::isnan(v)) return "NaN";
+    if (std::isinf(v)) return v > 0 ? "Infinity" : "-Infinity";
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.17g", v);
+    return buf;
+}
+
+std::string json_array(const std::vector<double>& values) {
+    std::string out = "[";
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        if (i > 0) out += ", ";
+        out += json_number(values[i]);
+    }
+    return out + "]";
+}
+
+struct Options {
+    std::string sketch;
+    std::size_t m = 0;
+    std::uint64_t seed = 42;
+    Params params;
+    unsigned threads = 0;  // 0 = all cores
+    bool keys_only = false;
+    std::string output = "estimate";
+    std::string out;
+    std::string input;
+};
+
+bool parse_options(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto value = [&](const char* flag) -> std::optional<std::string> {
+            const std::string prefix = std::string(flag) + "=";
+            if (arg.rfind(prefix, 0) == 0) return arg.substr(prefix.size());
+            return std::nullopt;
+        };
+        if (auto v = value("--sketch")) opt.sketch = *v;
+        else if (auto v = value("--m")) { if (!parse_number(*v, opt.m)) return false; }
+        else if (auto v = value("--seed")) { if (!parse_number(*v, opt.seed)) return false; }
+        else if (auto v = value("--threads")) { if (!parse_number(*v, opt.threads)) return false; }
+        else if (auto v = value("--output")) opt.output = *v;
+        else if (auto v = value("--out")) opt.out = *v;
+        else if (auto v = value("--param")) { if (!parse_param(*v, opt.params)) return false; }
+        else if (arg == "--keys-only") opt.keys_only = true;
+        else if (arg.rfind("--", 0) != 0 && opt.input.empty()) opt.input = arg;
+        else return false;
+    }
+    return !opt.sketch.empty() && opt.m > 0 && !opt.input.empty()
+        && (opt.output == "estimate" || opt.output == "json");
+}
+
+// [begin, end) of chunk t of n, both on line starts.
+std::pair<std::size_t, std::size_t> chunk(const std::uint8_t* data, std::size_t size, unsigned t, unsigned n) {
+    auto line_start = [&](std::size_t pos) {
+        if (pos == 0 || pos >= size) return pos >= size ? size : pos;
+        const void* nl = std::memchr(data + pos - 1, '\n', size - pos + 1);
+        return nl == nullptr ? size : static_cast<std::size_t>(static_cast<const std::uint8_t*>(nl) - data) + 1;
+    };
+    return {line_start(size / n * t), t + 1 == n ? size : line_start(size / n * (t + 1))};
+}
+
+// Adds every line of [begin, end) to sketch; returns the number of lines added.
+std::size_t ingest(Sketch& sketch, const std::uint8_t* data, std::size_t begin, std::size_t end, bool keys_only) {
+    const char* text = reinterpret_cast<const char*>(data);
+    std::string key;
+    std::size_t lines = 0;
+    for (std::size_t pos = begin; pos < end;) {
+        const void* nl = std::memchr(text + pos, '\n', end - pos);
+        const std::size_t line_end = nl == nullptr ? end : static_cast<std::size_t>(static_cast<const char*>(nl) - text);
+        std::size_t stop = line_end;
+        if (stop > pos && text[stop - 1] == '\r') --stop;
+        if (stop > pos) {
+            double weight = 1.0;
+            std::size_t key_end = stop;
+            if (!keys_only) {
+                const void* tab = std::memchr(text + pos, '\t', stop - pos);
+                if (tab != nullptr) {
+                    key_end = static_cast<std::size_t>(static_cast<const char*>(tab) - text);
+                    const auto [ptr, ec] = std::from_chars(text + key_end + 1, text + stop, weight);
+                    if (ec != std::errc() || ptr != text + stop || !(weight > 0.0) || !std::isfinite(weight)) {
+                        throw std::invalid_argument("bad weight in line at byte " + std::to_string(pos));
+                    }
+                }
+            }
+            key.assign(text + pos, key_end - pos);
+            sketch.add(key, weight);
+            ++lines;
+        }
+        pos = line_end + 1;
+    }
+    return lines;
+}
+
+int run(const Options& opt) {
+    const SketchKind* k = find_sketch_kind(opt.sketch);
+    if (k == nullptr) throw std::invalid_argument("unknown sketch '" + opt.sketch + "'");
+
+    const MappedFile file(opt.input);
+    file.advise_sequential();
+    auto result = k->make(opt.m, opt.seed, opt.params);
+    unsigned threads = opt.threads != 0 ? opt.threads : std::max(1u, std::thread::hardware_concurrency());
+    if (!k->merge || !result->pre_aggregation_exact()) threads = 1;
+
+    std::vector<std::unique_ptr<Sketch>> sketches(threads);
+    std::vector<std::size_t> lines(threads, 0);
+    std::vector<std::exception_ptr> errors(threads);
+    sketches[0] = std::move(result);
+    for (unsigned t = 1; t < threads; ++t) sketches[t] = k->make(opt.m, opt.seed, opt.params);
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t] {
+            try {
+                const auto [begin, end] = chunk(file.data(), file.size(), t, threads);
+                lines[t] = ingest(*sketches[t], file.data(), begin, end, opt.keys_only);
+            } catch (...) {
+                errors[t] = std::current_exception();
+            }
+        });
+    }
+    for (auto& th : pool) th.join();
+    for (const auto& e : errors) {
+        if (e) std::rethrow_exception(e);
+    }
+    std::size_t total_lines = lines[0];
+    for (unsigned t = 1; t < threads; ++t) {
+        k->merge(*sketches[0], *sketches[t]);
+        total_lines += lines[t];
+    }
+
+    const Sketch& sketch = *sketches[0];
+    std::string text;
+    if (opt.output == "estimate") {
+        text = json_number(sketch.estimate()) + "\n";
+    } else {
+        text = "{\"sketch\": \"" + opt.sketch + "\", \"m\": " + std::to_string(opt.m)
+             + ", \"seed\": " + std::to_string(opt.seed) + ", \"params\": {";
+        bool first = true;
+        for (const auto& [name, v] : opt.params) {
+            text += (first ? "\"" : ", \"") + name + "\": " + json_number(v);
+            first = false;
+        }
+        text += "}, \"lines\": " + std::to_string(total_lines) + ", \"estimate\": " + json_number(sketch.estimate())
+              + ", \"registers\": " + json_array(k->registers(sketch)) + "}\n";
+    }
+
+    std::FILE* f = opt.out.empty() ? stdout : std::fopen(opt.out.c_str(), "w");
+    if (f == nullptr) throw std::runtime_error("cannot open " + opt.out);
+    const bool ok = std::fwrite(text.data(), 1, text.size(), f) == text.size();
+    if (f != stdout) std::fclose(f);
+    if (!ok) throw std::runtime_error("cannot write output");
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parse_options(argc, argv, opt)) {
+        std::fprintf(stderr,
+            "usage: %s --sketch=<Class> --m=<m> [--seed=<seed>] [--param=<name>=<value>]...\n"
+            "          [--threads=<n>] [--keys-only] [--output=estimate|json] [--out=<file>] <input>\n",
+            argv[0]);
+        return 2;
+    }
+    try {
+        return run(opt);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "wce-ingest: %s\n", e.what());
+        return 1;
+    }
+}